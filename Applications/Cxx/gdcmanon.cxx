@@ -25,11 +25,16 @@
 #include "gdcmCryptoFactory.h"
 #include "gdcmUIDGenerator.h"
 #include "gdcmAnonymizer.h"
+#include "gdcmBatchAnonymizer.h"
+#include "gdcmUIDMappingTable.h"
 #include "gdcmGlobal.h"
 #include "gdcmDefs.h"
 #include "gdcmDirectory.h"
 
 #include <getopt.h>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
 
 
 static void PrintVersion()
@@ -150,78 +155,6 @@ static bool AnonymizeOneFileDumb(gdcm::Anonymizer &anon, const char *filename, c
   return success;
 }
 
-static bool AnonymizeOneFile(gdcm::Anonymizer &anon, const char *filename, const char *outfilename, bool continuemode = false)
-{
-  gdcm::Reader reader;
-  reader.SetFileName( filename );
-  if( !reader.Read() )
-    {
-    std::cerr << "Could not read : " << filename << std::endl;
-    if( continuemode )
-      {
-      std::cerr << "Skipping from anonymization process (continue mode)." << std::endl;
-      return true;
-      }
-    else
-      {
-      std::cerr << "Check [--continue] option for skipping files." << std::endl;
-      return false;
-      }
-    }
-  gdcm::File &file = reader.GetFile();
-  gdcm::MediaStorage ms;
-  ms.SetFromFile(file);
-  if( !gdcm::Defs::GetIODNameFromMediaStorage(ms) )
-    {
-    std::cerr << "The Media Storage Type of your file is not supported: " << ms << std::endl;
-    std::cerr << "Please report" << std::endl;
-    return false;
-    }
-
-  anon.SetFile( file );
-
-  if( deidentify )
-    {
-    //anon.RemovePrivateTags();
-    //anon.RemoveRetired();
-    if( !anon.BasicApplicationLevelConfidentialityProfile( true ) )
-      {
-      std::cerr << "Could not De-indentify : " << filename << std::endl;
-      return false;
-      }
-    }
-  else if ( reidentify )
-    {
-    if( !anon.BasicApplicationLevelConfidentialityProfile( false ) )
-      {
-      std::cerr << "Could not Re-indentify : " << filename << std::endl;
-      return false;
-      }
-    }
-
-  gdcm::FileMetaInformation &fmi = file.GetHeader();
-  fmi.Clear();
-
-  gdcm::Writer writer;
-  writer.SetFileName( outfilename );
-  writer.SetFile( file );
-  if( !writer.Write() )
-    {
-    std::cerr << "Could not Write : " << outfilename << std::endl;
-    if( strcmp(filename,outfilename) != 0 )
-      {
-      gdcm::System::RemoveFile( outfilename );
-      }
-    else
-      {
-      std::cerr << "gdcmanon just corrupted: " << filename << " for you (data lost)." << std::endl;
-      }
-
-    return false;
-    }
-  return true;
-}
-
 static bool GetRSAKeys(gdcm::CryptographicMessageSyntax &cms, const char *privpath = nullptr, const char *certpath = nullptr)
 {
   if( privpath && *privpath )
@@ -260,6 +193,8 @@ static void PrintHelp()
   std::cout << "  -r --recursive              recursively process (sub-)directories." << std::endl;
   std::cout << "     --continue               Do not stop when file found is not DICOM." << std::endl;
   std::cout << "     --root-uid               Root UID." << std::endl;
+  std::cout << "     --threads %d             Number of threads (default: 1, 0 = all cores)." << std::endl;
+  std::cout << "     --uid-map %s             UID mapping file, loaded if present and updated." << std::endl;
   std::cout << "     --resources-path         Resources path." << std::endl;
   std::cout << "  -k --key                    Path to RSA Private Key." << std::endl;
   std::cout << "  -c --certificate            Path to Certificate." << std::endl;
@@ -356,6 +291,10 @@ int main(int argc, char *argv[])
   int remove_tag = 0;
   int replace_tag = 0;
   int crypto_api = 0;
+  int threads = 0;
+  int uidmap = 0;
+  unsigned int nthreads = 1;
+  std::string uidmap_path;
   std::vector<gdcm::Tag> empty_tags;
   std::vector<gdcm::Tag> clear_tags;
   std::vector<gdcm::Tag> remove_tags;
@@ -396,6 +335,8 @@ int main(int argc, char *argv[])
         {"replace", required_argument, &replace_tag, 1},
         {"continue", no_argument, &continuemode, 1},
         {"crypto", required_argument, &crypto_api, 1}, //20
+        {"threads", required_argument, &threads, 1},
+        {"uid-map", required_argument, &uidmap, 1},
 
         {"verbose", no_argument, nullptr, 'V'},
         {"warning", no_argument, nullptr, 'W'},
@@ -545,6 +486,24 @@ int main(int argc, char *argv[])
               return 1;
               }
             }
+          else if( option_index == 21 ) /* threads */
+            {
+            gdcm_assert( strcmp(s, "threads") == 0 );
+            char *end;
+            errno = 0;
+            const long n = strtol(optarg, &end, 10);
+            if( end == optarg || *end || errno || n < 0 || n > UINT_MAX )
+              {
+              std::cerr << "Invalid number of threads: " << optarg << std::endl;
+              return 1;
+              }
+            nthreads = (unsigned int)n;
+            }
+          else if( option_index == 22 ) /* uid-map */
+            {
+            gdcm_assert( strcmp(s, "uid-map") == 0 );
+            uidmap_path = optarg;
+            }
           //printf (" with arg %s", optarg);
           }
         //printf ("\n");
@@ -881,15 +840,22 @@ int main(int argc, char *argv[])
     cms_ptr->SetCipherType( ciphertype );
     }
 
-  // Setup gdcm::Anonymizer
-  gdcm::Anonymizer anon;
-  if( !dumb_mode )
+  // UID mapping, possibly shared with a previous run:
+  gdcm::UIDMappingTable uidmaptable;
+  if( uidmap && gdcm::System::FileExists( uidmap_path.c_str() ) )
     {
-    anon.SetCryptographicMessageSyntax( cms_ptr );
+    if( !uidmaptable.Load( uidmap_path.c_str() ) )
+      {
+      std::cerr << "Could not load UID mapping file: " << uidmap_path << std::endl;
+      delete cms_ptr;
+      return 1;
+      }
     }
 
+  int ret = 0;
   if( dumb_mode )
     {
+    gdcm::Anonymizer anon;
     for(unsigned int i = 0; i < nfiles; ++i)
       {
       const char *in  = filenames[i].c_str();
@@ -898,25 +864,40 @@ int main(int argc, char *argv[])
         empty_privatetags, clear_privatetags, remove_privatetags, replace_privatetags_value, (continuemode > 0 ? true: false)) )
         {
         //std::cerr << "Could not anonymize: " << in << std::endl;
-        delete cms_ptr;
-        return 1;
+        ret = 1;
+        break;
         }
       }
     }
   else
     {
-    for(unsigned int i = 0; i < nfiles; ++i)
-      {
-      const char *in  = filenames[i].c_str();
-      const char *out = outfilenames[i].c_str();
-      if( !AnonymizeOneFile(anon, in, out, (continuemode > 0 ? true: false)) )
+    // Files are processed in order when nthreads is 1
+    gdcm::BatchAnonymizer batch;
+    batch.SetNumberOfThreads( nthreads );
+    batch.SetDeidentify( deidentify ? true : false );
+    batch.SetCryptographicMessageSyntax( cms_ptr );
+    batch.SetUIDMappingTable( &uidmaptable );
+    batch.SetSkipUnreadableFiles( continuemode > 0 ? true : false );
+    if( !batch.Anonymize( filenames, outfilenames ) )
+      {
+      gdcm::Directory::FilenamesType const &failed = batch.GetFailedFilenames();
+      for( size_t i = 0; i < failed.size(); ++i )
         {
-        //std::cerr << "Could not anonymize: " << in << std::endl;
-        delete cms_ptr;
-        return 1;
+        std::cerr << "Could not anonymize: " << failed[i] << std::endl;
         }
+      if( !continuemode )
+        {
+        std::cerr << "Check [--continue] option for skipping unreadable files." << std::endl;
+        }
+      ret = 1;
       }
     }
+  // Even on failure, the files already written use the UIDs from the table:
+  if( uidmap && !uidmaptable.Save( uidmap_path.c_str() ) )
+    {
+    std::cerr << "Could not save UID mapping file: " << uidmap_path << std::endl;
+    ret = 1;
+    }
   delete cms_ptr;
-  return 0;
+  return ret;
 }
@@ -89,6 +89,7 @@
 #include "gdcmJPEGCodec.h"
 #include "gdcmJPEGLSCodec.h"
 #include "gdcmSequenceOfFragments.h"
+#include "gdcmInstrumentation.h"
 
 #include <string>
 #include <iostream>
@@ -121,6 +122,16 @@ static void PrintLossyWarning()
   std::cout << "WARNING: this mode is very experimental." << std::endl;
 }
 
+// Write the instrumentation counters on any exit path of main:
+struct InstrumentationOutput
+{
+  ~InstrumentationOutput()
+    {
+    if( !Filename.empty() ) gdcm::Instrumentation::WriteJSON( Filename.c_str() );
+    }
+  std::string Filename;
+};
+
 static void PrintHelp()
 {
   PrintVersion();
@@ -166,6 +177,7 @@ static void PrintHelp()
   std::cout << "  -h --help       print help." << std::endl;
   std::cout << "  -v --version    print version." << std::endl;
   std::cout << "     --quiet      do not print to stdout." << std::endl;
+  std::cout << "     --instrumentation FILE  write timers and counters as JSON to FILE ('-' for stdout)." << std::endl;
   std::cout << "JPEG Options:" << std::endl;
   std::cout << "  -q --quality %*f           set quality." << std::endl;
   std::cout << "JPEG-LS Options:" << std::endl;
@@ -570,6 +582,7 @@ int main (int argc, char *argv[])
   int ignoreerrors = 0;
   int jpeglserror = 0;
   int jpeglserror_value = 0;
+  InstrumentationOutput instrumentation;
 
   while (true) {
     //int this_option_optind = optind ? optind : 1;
@@ -627,6 +640,7 @@ int main (int argc, char *argv[])
         {"number-resolution", 1, &nres, 1}, //
         {"irreversible", 0, &irreversible, 1}, //
         {"allowed-error", 1, &jpeglserror, 1}, //
+        {"instrumentation", 1, nullptr, 0},
 
 // General options !
         {"verbose", 0, &verbose, 1},
@@ -719,6 +733,11 @@ int main (int argc, char *argv[])
             gdcm_assert( strcmp(s, "allowed-error") == 0 );
             jpeglserror_value = atoi(optarg);
             }
+          else if( option_index == 50 ) /* instrumentation */
+            {
+            gdcm_assert( strcmp(s, "instrumentation") == 0 );
+            instrumentation.Filename = optarg;
+            }
           //printf (" with arg %s, index = %d", optarg, option_index);
           }
         //printf ("\n");
@@ -931,6 +950,7 @@ int main (int argc, char *argv[])
     gdcm::Trace::SetWarning( (verbose  > 0 ? true : false) );
     gdcm::Trace::SetError( (verbose  > 0 ? true : false) );
     }
+  if( !instrumentation.Filename.empty() ) gdcm::Instrumentation::EnabledOn();
 
   gdcm::FileMetaInformation::SetSourceApplicationEntityTitle( "gdcmconv" );
   if( !rootuid )
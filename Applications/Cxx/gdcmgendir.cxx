@@ -46,6 +46,7 @@ static void PrintHelp()
   std::cout << "  -r --recursive          recursive." << std::endl;
   std::cout << "     --descriptor          descriptor." << std::endl;
   std::cout << "     --root-uid               Root UID." << std::endl;
+  std::cout << "     --threads %d             Number of threads used to scan files (default: 1, 0 = all cores)." << std::endl;
   std::cout << "General Options:" << std::endl;
   std::cout << "  -V --verbose   more verbose (warning+error)." << std::endl;
   std::cout << "  -W --warning   print warning info." << std::endl;
@@ -74,6 +75,8 @@ int main(int argc, char *argv[])
   int resourcespath = 0;
   int rootuid = 0;
   int descriptor = 0;
+  int threads = 0;
+  unsigned int nthreads = 1;
   std::string descriptor_str;
   std::string root;
   while (true) {
@@ -85,6 +88,7 @@ int main(int argc, char *argv[])
         {"root-uid", 1, &rootuid, 1}, // specific Root (not GDCM)
         {"resources-path", 1, &resourcespath, 1},
         {"descriptor", 1, &descriptor, 1},
+        {"threads", 1, &threads, 1},
 
         {"verbose", 0, &verbose, 1},
         {"warning", 0, &warning, 1},
@@ -140,6 +144,11 @@ int main(int argc, char *argv[])
             gdcm_assert( descriptor_str.empty() );
             descriptor_str = optarg;
             }
+          else if( option_index == 6 ) /* threads */
+            {
+            gdcm_assert( strcmp(s, "threads") == 0 );
+            nthreads = (unsigned int)atoi(optarg);
+            }
           //printf (" with arg %s", optarg);
           }
         //printf ("\n");
@@ -331,6 +340,7 @@ int main(int argc, char *argv[])
 
   gen.SetFilenames( filenames );
   gen.SetDescriptor( descriptor_str.c_str() );
+  gen.SetNumberOfThreads( nthreads );
   if( !gen.Generate() )
     {
     std::cerr << "Problem during generation" << std::endl;
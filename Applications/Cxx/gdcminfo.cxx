@@ -33,6 +33,7 @@
 #include "gdcmImageHelper.h"
 #include "gdcmSplitMosaicFilter.h"
 #include "gdcmImageChangePlanarConfiguration.h"
+#include "gdcmInstrumentation.h"
 
 #ifdef GDCM_USE_SYSTEM_POPPLER
 #include <poppler/poppler-config.h>
@@ -330,6 +331,16 @@ static void PrintVersion()
   std::cout << date << std::endl;
 }
 
+// Write the instrumentation counters on any exit path of main:
+struct InstrumentationOutput
+{
+  ~InstrumentationOutput()
+    {
+    if( !Filename.empty() ) gdcm::Instrumentation::WriteJSON( Filename.c_str() );
+    }
+  std::string Filename;
+};
+
 static void PrintHelp()
 {
   PrintVersion();
@@ -351,6 +362,7 @@ static void PrintHelp()
   std::cout << "     --force-spacing    force spacing." << std::endl;
   std::cout << "     --mosaic           dump image information of MOSAIC." << std::endl;
   std::cout << "     --scipm            Include Image Plane Module for Secondary Capture Image." << std::endl;
+  std::cout << "     --instrumentation FILE  write timers and counters as JSON to FILE ('-' for stdout)." << std::endl;
 
   std::cout << "General Options:" << std::endl;
   std::cout << "  -V --verbose   more verbose (warning+error)." << std::endl;
@@ -628,6 +640,7 @@ int main(int argc, char *argv[])
   int forcerescale = 0;
   int forcespacing = 0;
   int scipm = 0;
+  InstrumentationOutput instrumentation;
 
   int resourcespath = 0;
   int verbose = 0;
@@ -650,6 +663,7 @@ int main(int argc, char *argv[])
         {"force-spacing", 0, &forcespacing, 1},
         {"mosaic", 0, &mosaic, 1},
         {"scipm", 0, &scipm, 1},
+        {"instrumentation", 1, nullptr, 0},
 
         {"verbose", 0, &verbose, 1},
         {"warning", 0, &warning, 1},
@@ -688,6 +702,11 @@ int main(int argc, char *argv[])
             gdcm_assert( xmlpath.empty() );
             xmlpath = optarg;
             }
+          else if( option_index == 10 ) /* instrumentation */
+            {
+            gdcm_assert( strcmp(s, "instrumentation") == 0 );
+            instrumentation.Filename = optarg;
+            }
           //printf (" with arg %s", optarg);
           }
         //printf ("\n");
@@ -792,6 +811,8 @@ int main(int argc, char *argv[])
     gdcm::Trace::SetError( verbose != 0);
     }
 
+  if( !instrumentation.Filename.empty() ) gdcm::Instrumentation::EnabledOn();
+
   if( !gdcm::System::FileExists(filename.c_str()) )
     {
     return 1;
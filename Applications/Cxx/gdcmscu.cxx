@@ -38,6 +38,7 @@
 #include "gdcmBaseRootQuery.h"
 #include "gdcmQueryFactory.h"
 #include "gdcmPrinter.h"
+#include "gdcmInstrumentation.h"
 
 
 static void PrintVersion()
@@ -47,6 +48,16 @@ static void PrintVersion()
   std::cout << date << std::endl;
 }
 
+// Write the instrumentation counters on any exit path of main:
+struct InstrumentationOutput
+{
+  ~InstrumentationOutput()
+    {
+    if( !Filename.empty() ) gdcm::Instrumentation::WriteJSON( Filename.c_str() );
+    }
+  std::string Filename;
+};
+
 static void PrintHelp()
 {
   PrintVersion();
@@ -94,6 +105,7 @@ static void PrintHelp()
   std::cout << "     --queryhelp print query help." << std::endl;
   std::cout << "  -v --version   print version." << std::endl;
   std::cout << "  -L --log-file  set log file (instead of cout)." << std::endl;
+  std::cout << "     --instrumentation FILE  write timers and counters as JSON to FILE ('-' for stdout)." << std::endl;
 
   try
     {
@@ -178,6 +190,7 @@ int main(int argc, char *argv[])
   int recursive = 0;
   int logfile = 0;
   std::string logfilename;
+  InstrumentationOutput instrumentation;
   gdcm::Tag tag;
   std::vector< std::pair<gdcm::Tag, std::string> > keys;
   
@@ -224,6 +237,7 @@ int main(int argc, char *argv[])
       {"image", 0, &imagequery, 1}, // --image
       {"log-file", 1, &logfile, 1}, // --log-file
       {"get", 0, &getmode, 1}, // --get
+      {"instrumentation", 1, nullptr, 0}, // (31) --instrumentation
       {nullptr, 0, nullptr, 0} // required
     };
     static const char short_options[] = "i:H:p:L:VWDEhvk:o:r";
@@ -306,6 +320,11 @@ int main(int argc, char *argv[])
             gdcm_assert( strcmp(s, "log-file") == 0 );
             logfilename = optarg;
           }
+          else if( option_index == 31 ) /* instrumentation */
+          {
+            gdcm_assert( strcmp(s, "instrumentation") == 0 );
+            instrumentation.Filename = optarg;
+          }
           else
           {
             // If you reach here someone mess-up the index and the argument in
@@ -472,6 +491,7 @@ int main(int argc, char *argv[])
     {
     gdcm::Trace::SetStreamToFile( logfilename.c_str() );
     }
+  if( !instrumentation.Filename.empty() ) gdcm::Instrumentation::EnabledOn();
   gdcm::FileMetaInformation::SetSourceApplicationEntityTitle( callaetitle.c_str() );
   if( !rootuid )
     {
@@ -0,0 +1,57 @@
+# Round trip of gdcmtar --enhance / --unenhance on a few generated MR slices.
+# Required variables: GDCMIMG, GDCMANON, GDCMTAR, GDCMRAW, WORKDIR
+foreach(var GDCMIMG GDCMANON GDCMTAR GDCMRAW WORKDIR)
+  if(NOT ${var})
+    message(FATAL_ERROR "${var} is not set")
+  endif()
+endforeach()
+
+function(run)
+  execute_process(COMMAND ${ARGN} RESULT_VARIABLE res OUTPUT_QUIET)
+  if(NOT res EQUAL 0)
+    message(FATAL_ERROR "Failed (${res}): ${ARGN}")
+  endif()
+endfunction()
+
+file(REMOVE_RECURSE ${WORKDIR})
+file(MAKE_DIRECTORY ${WORKDIR}/slices)
+
+set(nslices 4)
+math(EXPR last "${nslices} - 1")
+foreach(i RANGE ${last})
+  # 4x4 8bits slice, each slice has its own content:
+  set(pixels "")
+  foreach(p RANGE 15)
+    math(EXPR c "65 + ${p} + ${i}")
+    string(ASCII ${c} ch)
+    string(APPEND pixels "${ch}")
+  endforeach()
+  file(WRITE ${WORKDIR}/slice${i}.pgm "P5\n4 4\n255\n${pixels}")
+  run(${GDCMIMG} -C 1.2.840.10008.5.1.4.1.1.4 -T 1.2.3.1 -S 1.2.3.2
+    -i ${WORKDIR}/slice${i}.pgm -o ${WORKDIR}/slice${i}.dcm)
+  run(${GDCMANON} --dumb
+    --replace "8,8=ORIGINAL\\PRIMARY"
+    --replace "20,32=0\\0\\${i}"
+    --replace "20,37=1\\0\\0\\0\\1\\0"
+    --replace "20,52=1.2.3.3"
+    --replace "28,30=1\\1"
+    -i ${WORKDIR}/slice${i}.dcm -o ${WORKDIR}/slices/slice${i}.dcm)
+endforeach()
+
+# Enhanced MR Image Storage, frames are streamed to the output file:
+run(${GDCMTAR} --enhance ${WORKDIR}/slices ${WORKDIR}/enhanced)
+set(enhanced ${WORKDIR}/enhanced/1.2.3.1/1.2.3.2/1.2.3.3/new.dcm)
+if(NOT EXISTS ${enhanced})
+  message(FATAL_ERROR "Missing: ${enhanced}")
+endif()
+
+# Back to one file per frame:
+run(${GDCMTAR} --unenhance ${enhanced} ${WORKDIR}/unenhanced)
+foreach(i RANGE ${last})
+  run(${GDCMRAW} -i ${WORKDIR}/slices/slice${i}.dcm -o ${WORKDIR}/slice${i}.raw)
+  run(${GDCMRAW} -i ${WORKDIR}/unenhanced${i} -o ${WORKDIR}/unenhanced${i}.raw)
+  run(${CMAKE_COMMAND} -E compare_files ${WORKDIR}/slice${i}.raw ${WORKDIR}/unenhanced${i}.raw)
+endforeach()
+if(EXISTS ${WORKDIR}/unenhanced${nslices})
+  message(FATAL_ERROR "Too many frames")
+endif()
@@ -40,9 +40,15 @@
 #include "gdcmAnonymizer.h"
 #include "gdcmTagKeywords.h"
 #include "gdcmMrProtocol.h"
+#include "gdcmFileStreamer.h"
+#include "gdcmSystem.h"
+#include "gdcmParallelFor.h"
 
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <set>
+#include <atomic>
 
 #include <stdio.h>     /* for printf */
 #include <stdlib.h>    /* for exit */
@@ -70,6 +76,7 @@ static void PrintHelp()
   std::cout << "  -M --mosaic         Split SIEMENS Mosaic image into multiple frames." << std::endl;
   std::cout << "     --mosaic-private When splitting SIEMENS Mosaic image into multiple frames, preserve private attributes (advanced user only)." << std::endl;
   std::cout << "  -p --pattern        Specify trailing file pattern." << std::endl;
+  std::cout << "     --threads %d     Number of mosaics split at once when input is a directory (default: 1, 0 = all cores)." << std::endl;
   std::cout << "     --root-uid       Root UID." << std::endl;
   //std::cout << "     --resources-path     Resources path." << std::endl;
   std::cout << "General Options:" << std::endl;
@@ -707,41 +714,48 @@ static int MakeImageEnhanced( std::string const & filename, std::string const &o
         }
       }
 
-    for( ; file != files.end(); ++file, ++count )
+    // Native Pixel Data is streamed: the enhanced header is written once, then
+    // the frames are appended one file at a time. Encapsulated Pixel Data is
+    // still concatenated in memory.
+    const gdcm::ByteValue *bv0 = currentim.GetDataElement().GetByteValue();
+    const bool streamed = bv0 != nullptr;
+    const unsigned long framelen = currentim.GetBufferLength();
+    if( !streamed )
       {
-      gdcm::ImageReader reader;
-      reader.SetFileName( file->c_str() );
-      if( !reader.Read() )
-        {
-        gdcm_assert( 0 );
-        }
-      const gdcm::Image &im = reader.GetImage();
-
-      //gdcm::ImageWriter writer;
-      gdcm::Writer writer;
-      writer.SetFileName( fg.GetFilename( count ) );
-      writer.SetFile( reader.GetFile() );
-      writer.GetFile().GetHeader().Clear();
-      if( !writer.Write() )
-        {
-        gdcm_assert( 0 );
-        }
-
-      if( !ConcatenateImages(currentim, im) )
+      for( ; file != files.end(); ++file, ++count )
         {
-        gdcm_assert( 0 );
-        }
+        gdcm::ImageReader reader;
+        reader.SetFileName( file->c_str() );
+        if( !reader.Read() )
+          {
+          gdcm_assert( 0 );
+          }
+        const gdcm::Image &im = reader.GetImage();
+
+        //gdcm::ImageWriter writer;
+        gdcm::Writer writer;
+        writer.SetFileName( fg.GetFilename( count ) );
+        writer.SetFile( reader.GetFile() );
+        writer.GetFile().GetHeader().Clear();
+        if( !writer.Write() )
+          {
+          gdcm_assert( 0 );
+          }
 
-      // check consistency 
-      if( false )
-        {
-        //gdcm::DataSet & enhds = im0.GetFile().GetDataSet();
-        //gdcm::DataSet & ds = reader.GetFile().GetDataSet();
-        // TODO
+        if( !ConcatenateImages(currentim, im) )
+          {
+          gdcm_assert( 0 );
+          }
         }
       }
+    else if( bv0->GetLength() < framelen )
+      {
+      std::cerr << "Pixel Data is too short: " << reffile << std::endl;
+      return 1;
+      }
 
-    im0.SetFileName( (targetname + "/new.dcm").c_str() );
+    const std::string newfilename = targetname + "/new.dcm";
+    im0.SetFileName( newfilename.c_str() );
     //  im.SetFile( reader.GetFile() );
 
     gdcm::DataSet &ds = im0.GetFile().GetDataSet();
@@ -765,13 +779,74 @@ static int MakeImageEnhanced( std::string const & filename, std::string const &o
     de.SetVR( gdcm::Attribute<0x0008, 0x0016>::GetVR() );
     ds.Insert( de );
 
+    // the first frame is kept aside while the header is written:
+    const gdcm::DataElement frame0 = currentim.GetDataElement();
+    if( streamed )
+      {
+      currentim.SetDimension( 2, (unsigned int)files.size() );
+      currentim.SetDataElement( gdcm::DataElement( gdcm::Tag(0x7fe0,0x0010) ) );
+      }
     im0.SetImage( currentim );
     if( !im0.Write() )
       {
-      std::cerr << "Could not write: " << std::endl;
+      std::cerr << "Could not write: " << newfilename << std::endl;
+      return 1;
+      }
+    if( !streamed ) continue;
+
+    const gdcm::Tag pixeldata(0x7fe0,0x0010);
+    gdcm::FileStreamer fs;
+    fs.SetTemplateFileName( newfilename.c_str() );
+    fs.SetOutputFileName( newfilename.c_str() );
+    fs.CheckDataElement( pixeldata );
+    fs.ReserveDataElement( framelen * files.size() );
+    if( !fs.StartDataElement( pixeldata )
+      || !fs.AppendToDataElement( pixeldata, frame0.GetByteValue()->GetPointer(), framelen ) )
+      {
+      std::cerr << "Could not write Pixel Data: " << newfilename << std::endl;
       return 1;
       }
+    for( ; file != files.end(); ++file, ++count )
+      {
+      gdcm::ImageReader reader;
+      reader.SetFileName( file->c_str() );
+      if( !reader.Read() )
+        {
+        std::cerr << "Could not read: " << *file << std::endl;
+        return 1;
+        }
+      const gdcm::Image &im = reader.GetImage();
 
+      gdcm::Writer writer;
+      writer.SetFileName( fg.GetFilename( count ) );
+      writer.SetFile( reader.GetFile() );
+      writer.GetFile().GetHeader().Clear();
+      if( !writer.Write() )
+        {
+        std::cerr << "Could not write: " << fg.GetFilename( count ) << std::endl;
+        return 1;
+        }
+
+      const gdcm::ByteValue *bv = im.GetDataElement().GetByteValue();
+      if( !bv || bv->GetLength() < framelen
+        || im.GetDimension(0) != currentim.GetDimension(0)
+        || im.GetDimension(1) != currentim.GetDimension(1)
+        || im.GetPixelFormat() != currentim.GetPixelFormat() )
+        {
+        std::cerr << "Frame is not compatible with volume: " << *file << std::endl;
+        return 1;
+        }
+      if( !fs.AppendToDataElement( pixeldata, bv->GetPointer(), framelen ) )
+        {
+        std::cerr << "Could not write Pixel Data: " << newfilename << std::endl;
+        return 1;
+        }
+      }
+    if( !fs.StopDataElement( pixeldata ) )
+      {
+      std::cerr << "Could not write Pixel Data: " << newfilename << std::endl;
+      return 1;
+      }
     }
 
   std::vector< gdcm::Directory::FilenamesType > const &unsorted = dv.GetUnsortedFiles();
@@ -949,6 +1024,164 @@ static bool RemapSharedIntoOld( gdcm::DataSet & ds,
 
 } // namespace gdcm
 
+// Split a SIEMENS Mosaic into one file per slice, named after outprefix and
+// pattern. The filter is reused for all the mosaics of a series.
+static bool SplitMosaic(gdcm::SplitMosaicFilter & filter, const std::string & filename,
+  const std::string & outprefix, const std::string & pattern, bool mosaic_private)
+{
+  gdcm::ImageReader reader;
+  reader.SetFileName( filename.c_str() );
+  if( !reader.Read() )
+    {
+    std::cerr << "could not read: " << filename << std::endl;
+    return false;
+    }
+
+  filter.SetImage( reader.GetImage() );
+  filter.SetFile( reader.GetFile() );
+  bool b = filter.Split();
+  if( !b )
+    {
+    std::cerr << "Could not split : " << filename << std::endl;
+    return false;
+    }
+
+  const gdcm::Image &image = filter.GetImage();
+  const unsigned int *dims = image.GetDimensions();
+  const gdcm::DataElement &pixeldata = image.GetDataElement();
+  const gdcm::ByteValue *bv = pixeldata.GetByteValue();
+  size_t slice_len = image.GetBufferLength() / dims[2];
+
+  gdcm::FilenameGenerator fg;
+  fg.SetNumberOfFilenames( dims[2] );
+  fg.SetPrefix( outprefix.c_str() );
+  fg.SetPattern( pattern.c_str() );
+  if( !fg.Generate() )
+    {
+    std::cerr << "could not generate filenames" << std::endl;
+    return false;
+    }
+  const double *cosines = image.GetDirectionCosines();
+  gdcm::DirectionCosines dc( cosines );
+  double normal[3];
+  dc.Cross( normal );
+  const double *origin = image.GetOrigin();
+  double zspacing = image.GetSpacing(2);
+
+  gdcm::DataSet & ds = reader.GetFile().GetDataSet();
+
+  // parsed once per series:
+  const gdcm::MrProtocol::SliceArray *psa = filter.GetMrProtocolSliceArray();
+  if( !psa ) return false;
+  const gdcm::MrProtocol::SliceArray &sa = *psa;
+
+  size_t size = sa.Slices.size();
+  if( size < dims[2] ) return false;
+
+  if( !mosaic_private )
+  {
+    gdcm::Anonymizer ano;
+    ano.SetFile( reader.GetFile() );
+    // Remove CSA header
+    ano.RemovePrivateTags();
+  }
+
+  double slicePos[3];
+  double sliceNor[3];
+  namespace kwd = gdcm::Keywords;
+  gdcm::UIDGenerator ug;
+
+  kwd::InstanceNumber instart;
+  instart.Set(ds);
+  int istart = instart.GetValue();
+
+  for(unsigned int i = 0; i < dims[2]; ++i)
+    {
+    const gdcm::MrProtocol::Slice & protSlice = sa.Slices[i];
+    const gdcm::MrProtocol::Vector3 & protV = protSlice.Position;
+    const gdcm::MrProtocol::Vector3 & protN = protSlice.Normal;
+    slicePos[0] = protV.dSag;
+    slicePos[1] = protV.dCor;
+    slicePos[2] = protV.dTra;
+    sliceNor[0] = protN.dSag;
+    sliceNor[1] = protN.dCor;
+    sliceNor[2] = protN.dTra;
+
+    double new_origin[3];
+    for (int j = 0; j < 3; j++)
+      {
+      // the n'th slice is n * z-spacing aloung the IOP-derived
+      // z-axis
+      new_origin[j] = origin[j] + normal[j] * i * zspacing;
+      if( std::fabs(slicePos[j] - new_origin[j]) > 1e-3 )
+        {
+        gdcmErrorMacro("Invalid position found");
+        return false;
+        }
+      const double snv_dot = gdcm::DirectionCosines::Dot( normal, sliceNor );
+      if( std::fabs(1. - snv_dot) > 1e-6 )
+        {
+        gdcmErrorMacro("Invalid direction found");
+        return false;
+        }
+      }
+
+    kwd::SOPInstanceUID sid;
+    sid.SetValue( ug.Generate() );
+    ds.Replace( sid.GetAsDataElement() );
+
+    const char *outfilenamei = fg.GetFilename(i);
+    kwd::SliceLocation sl;
+    sl.SetValue( new_origin[2] );
+    ds.Replace( sl.GetAsDataElement() );
+    kwd::InstanceNumber in;
+    in.SetValue( istart + i ); // Start at mosaic instance number
+    ds.Replace( in.GetAsDataElement() );
+    gdcm::ImageWriter writer;
+    writer.SetFileName( outfilenamei );
+    //writer.SetFile( filter.GetFile() );
+    writer.SetFile( reader.GetFile() );
+
+    //
+    //writer.SetImage( filter.GetImage() );
+    gdcm::Image &slice = writer.GetImage();
+    slice = filter.GetImage();
+    slice.SetOrigin( new_origin );
+    slice.SetNumberOfDimensions( 2 );
+    gdcm_assert( slice.GetPixelFormat() == filter.GetImage().GetPixelFormat() );
+    slice.SetSpacing(2, filter.GetImage().GetSpacing(2) );
+    //slice.Print( std::cout );
+    gdcm::DataElement &pd = slice.GetDataElement();
+    const char *sliceptr = bv->GetPointer() + i * slice_len;
+    pd.SetByteValue( sliceptr, (uint32_t)slice_len);
+
+    if( !writer.Write() )
+      {
+      std::cerr << "Failed to write: " << outfilenamei << std::endl;
+      return false;
+      }
+    }
+
+  return true;
+}
+
+// Split many mosaics at once: each thread has its own filter
+static bool SplitMosaics(std::vector<std::string> const & filenames,
+  std::vector<std::string> const & outprefixes, const std::string & pattern,
+  bool mosaic_private, unsigned int nthreads)
+{
+  nthreads = gdcm::ParallelFor::GetNumberOfThreads( nthreads, filenames.size() );
+  std::vector<gdcm::SplitMosaicFilter> filters( nthreads );
+  std::atomic<bool> success( true );
+  // a failure does not stop the other mosaics:
+  gdcm::ParallelFor::Run( filenames.size(), nthreads, [&](size_t i, unsigned int t) {
+    if( !SplitMosaic( filters[t], filenames[i], outprefixes[i], pattern, mosaic_private ) )
+      success = false;
+    return true;
+  } );
+  return success;
+}
+
 int main (int argc, char *argv[])
 {
   int c;
@@ -961,6 +1194,8 @@ int main (int argc, char *argv[])
   int resourcespath = 0;
   int mosaic = 0;
   int mosaic_private = 0;
+  int threads = 0;
+  unsigned int nthreads = 1;
   int enhance = 1;
   int unenhance = 0;
   std::string xmlpath;
@@ -986,6 +1221,7 @@ int main (int argc, char *argv[])
         {"root-uid", 1, &rootuid, 1}, // specific Root (not GDCM)
         //{"resources-path", 0, &resourcespath, 1},
         {"mosaic-private", 0, &mosaic_private, 1}, // keep private attributes
+        {"threads", required_argument, &threads, 1},
 
 // General options !
         {"verbose", 0, &verbose, 1},
@@ -1030,6 +1266,11 @@ int main (int argc, char *argv[])
             gdcm_assert( strcmp(s, "root-uid") == 0 );
             root = optarg;
             }
+          else if( option_index == 8 ) /* threads */
+            {
+            gdcm_assert( strcmp(s, "threads") == 0 );
+            nthreads = (unsigned int)atoi(optarg);
+            }
           else if( option_index == 7 ) /* resourcespath */
             {
             gdcm_assert( strcmp(s, "resources-path") == 0 );
@@ -1229,150 +1470,46 @@ int main (int argc, char *argv[])
 
   if( mosaic )
     {
-    gdcm::ImageReader reader;
-    reader.SetFileName( filename.c_str() );
-    if( !reader.Read() )
+    if( !gdcm::System::FileIsDirectory( filename.c_str() ) )
       {
-      std::cerr << "could not read: " << filename << std::endl;
-      return 1;
+      gdcm::SplitMosaicFilter filter;
+      return SplitMosaic( filter, filename, outfilename, pattern, mosaic_private != 0 ) ? 0 : 1;
       }
-
-    gdcm::SplitMosaicFilter filter;
-    filter.SetImage( reader.GetImage() );
-    filter.SetFile( reader.GetFile() );
-    bool b = filter.Split();
-    if( !b )
+    // A directory of mosaics (eg. a fMRI run): outfilename is the output
+    // directory, the slices of <input>/<name>.dcm are written as
+    // <output>/<name>_<pattern>
+    gdcm::Directory d;
+    d.Load( filename.c_str() );
+    std::vector<std::string> const & filenames = d.GetFilenames();
+    if( !gdcm::System::FileIsDirectory( outfilename.c_str() )
+      && !gdcm::System::MakeDirectory( outfilename.c_str() ) )
       {
-      std::cerr << "Could not split : " << filename << std::endl;
+      std::cerr << "could not create directory: " << outfilename << std::endl;
       return 1;
       }
-
-    const gdcm::Image &image = filter.GetImage();
-    const unsigned int *dims = image.GetDimensions();
-    const gdcm::DataElement &pixeldata = image.GetDataElement();
-    const gdcm::ByteValue *bv = pixeldata.GetByteValue();
-    size_t slice_len = image.GetBufferLength() / dims[2];
-
-    gdcm::FilenameGenerator fg;
-    fg.SetNumberOfFilenames( dims[2] );
-    fg.SetPrefix( outfilename.c_str() );
-    fg.SetPattern( pattern.c_str() );
-    if( !fg.Generate() )
+    std::vector<std::string> outprefixes;
+    outprefixes.reserve( filenames.size() );
+    for( size_t i = 0; i < filenames.size(); ++i )
       {
-      std::cerr << "could not generate filenames" << std::endl;
-      return 1;
-      }
-    const double *cosines = image.GetDirectionCosines();
-    gdcm::DirectionCosines dc( cosines );
-    double normal[3];
-    dc.Cross( normal );
-    const double *origin = image.GetOrigin();
-    double zspacing = image.GetSpacing(2);
-
-    gdcm::CSAHeader csa;
-    gdcm::DataSet & ds = reader.GetFile().GetDataSet();
-
-    gdcm::MrProtocol mrprot;
-    if( !csa.GetMrProtocol(ds, mrprot) ) return 1;
-
-    gdcm::MrProtocol::SliceArray sa;
-    b = mrprot.GetSliceArray(sa);
-    if( !b ) return 1;
-
-    size_t size = sa.Slices.size();
-    if( !size ) return 1;
-
-    if( !mosaic_private )
-    {
-      gdcm::Anonymizer ano;
-      ano.SetFile( reader.GetFile() );
-      // Remove CSA header
-      ano.RemovePrivateTags();
-    }
-
-    double slicePos[3];
-    double sliceNor[3];
-    namespace kwd = gdcm::Keywords;
-    gdcm::UIDGenerator ug;
-
-    kwd::InstanceNumber instart;
-    instart.Set(ds);
-    int istart = instart.GetValue();
-
-    for(unsigned int i = 0; i < dims[2]; ++i)
-      {
-      gdcm::MrProtocol::Slice & protSlice = sa.Slices[i];
-      gdcm::MrProtocol::Vector3 & protV = protSlice.Position;
-      gdcm::MrProtocol::Vector3 & protN = protSlice.Normal;
-      slicePos[0] = protV.dSag;
-      slicePos[1] = protV.dCor;
-      slicePos[2] = protV.dTra;
-      sliceNor[0] = protN.dSag;
-      sliceNor[1] = protN.dCor;
-      sliceNor[2] = protN.dTra;
-
-      double new_origin[3];
-      for (int j = 0; j < 3; j++)
-        {
-        // the n'th slice is n * z-spacing aloung the IOP-derived
-        // z-axis
-        new_origin[j] = origin[j] + normal[j] * i * zspacing;
-        if( std::fabs(slicePos[j] - new_origin[j]) > 1e-3 )
-          {
-          gdcmErrorMacro("Invalid position found");
-          return 1;
-          }
-        const double snv_dot = gdcm::DirectionCosines::Dot( normal, sliceNor );
-        if( std::fabs(1. - snv_dot) > 1e-6 )
-          {
-          gdcmErrorMacro("Invalid direction found");
-          return 1;
-          }
-        }
-
-      kwd::SOPInstanceUID sid;
-      sid.SetValue( ug.Generate() );
-      ds.Replace( sid.GetAsDataElement() );
-
-      const char *outfilenamei = fg.GetFilename(i);
-      kwd::SliceLocation sl;
-      sl.SetValue( new_origin[2] );
-      ds.Replace( sl.GetAsDataElement() );
-      kwd::InstanceNumber in;
-      in.SetValue( istart + i ); // Start at mosaic instance number
-      ds.Replace( in.GetAsDataElement() );
-      gdcm::ImageWriter writer;
-      writer.SetFileName( outfilenamei );
-      //writer.SetFile( filter.GetFile() );
-      writer.SetFile( reader.GetFile() );
-
-      //
-      //writer.SetImage( filter.GetImage() );
-      gdcm::Image &slice = writer.GetImage();
-      slice = filter.GetImage();
-      slice.SetOrigin( new_origin );
-      slice.SetNumberOfDimensions( 2 );
-      gdcm_assert( slice.GetPixelFormat() == filter.GetImage().GetPixelFormat() );
-      slice.SetSpacing(2, filter.GetImage().GetSpacing(2) );
-      //slice.Print( std::cout );
-      gdcm::DataElement &pd = slice.GetDataElement();
-      const char *sliceptr = bv->GetPointer() + i * slice_len;
-      pd.SetByteValue( sliceptr, (uint32_t)slice_len);
-
-      if( !writer.Write() )
-        {
-        std::cerr << "Failed to write: " << outfilename << std::endl;
-        return 1;
-        }
+      gdcm::Filename fn( filenames[i].c_str() );
+      std::string name = fn.GetName();
+      const std::string::size_type dot = name.rfind( '.' );
+      if( dot != std::string::npos && dot != 0 ) name.resize( dot );
+      outprefixes.push_back( outfilename + "/" + name + "_" );
       }
-
-    return 0;
+    return SplitMosaics( filenames, outprefixes, pattern, mosaic_private != 0, nthreads ) ? 0 : 1;
     }
   else if ( unenhance )
     {
-    gdcm::ImageReader reader;
-    reader.SetFileName( filename.c_str() );
-    if( !reader.Read() )
+    // Only the header is read in memory, the frames are then read and
+    // written one at a time
+    std::ifstream is( filename.c_str(), std::ios::binary );
+    gdcm::Reader reader;
+    reader.SetStream( is );
+    const gdcm::Tag tpixeldata(0x7fe0,0x0010);
+    std::set<gdcm::Tag> skiptags;
+    skiptags.insert( tpixeldata );
+    if( !is.good() || !reader.ReadUpToTag( tpixeldata, skiptags ) || is.eof() )
       {
       std::cerr << "could not read: " << filename << std::endl;
       return 1;
@@ -1397,6 +1534,31 @@ int main (int argc, char *argv[])
       return 1;
       }
 
+    // the stream is positioned on the first frame, which requires native
+    // Pixel Data:
+    const gdcm::TransferSyntax &ts = file.GetHeader().GetDataSetTransferSyntax();
+    if( ts.IsEncapsulated()
+      || ts == gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian
+      || ts.GetSwapCode() != gdcm::SwapCode::LittleEndian )
+      {
+      std::cerr << "decompress first" << std::endl;
+      return 1;
+      }
+    const std::vector<unsigned int> dims = gdcm::ImageHelper::GetDimensionsValue( file );
+    const gdcm::PixelFormat pf = gdcm::ImageHelper::GetPixelFormatValue( file );
+    if( pf.GetBitsAllocated() % 8 != 0 )
+      {
+      std::cerr << "Unsupported Bits Allocated: " << pf.GetBitsAllocated() << std::endl;
+      return 1;
+      }
+    const size_t slice_len = (size_t)dims[0] * dims[1] * pf.GetPixelSize();
+    const size_t offset = reader.GetStreamCurrentPosition();
+    if( gdcm::System::FileSize( filename.c_str() ) < offset + slice_len * dims[2] )
+      {
+      std::cerr << "Pixel Data is too short" << std::endl;
+      return 1;
+      }
+
   // Preserve info:
   gdcm::DataElement oldsopclassuid = ds.GetDataElement( gdcm::Tag(0x8,0x16) );
   gdcm::DataElement oldinstanceuid = ds.GetDataElement( gdcm::Tag(0x8,0x18) );
@@ -1409,21 +1571,6 @@ int main (int argc, char *argv[])
     de.SetVR( gdcm::Attribute<0x0008, 0x0016>::GetVR() );
     ds.Replace( de );
 
-    const gdcm::Image &image = reader.GetImage();
-    const unsigned int *dims = image.GetDimensions();
-    //std::cout << image << std::endl;
-    const gdcm::DataElement &pixeldata = image.GetDataElement();
-    //const gdcm::ByteValue *bv = pixeldata.GetByteValue();
-    gdcm::SmartPointer<gdcm::ByteValue> bv = const_cast<gdcm::ByteValue*>(pixeldata.GetByteValue());
-    if( !bv )
-    {
-      std::cerr << "decompress first" << std::endl;
-      return 1;
-    }
-    unsigned long slice_len = image.GetBufferLength() / dims[2];
-    gdcm_assert( slice_len * dims[2] == image.GetBufferLength() );
-    //gdcm_assert( image.GetBufferLength() == bv->GetLength() );
-
     gdcm::FilenameGenerator fg;
     fg.SetNumberOfFilenames( dims[2] );
     fg.SetPrefix( outfilename.c_str() );
@@ -1433,12 +1580,6 @@ int main (int argc, char *argv[])
       std::cerr << "could not generate" << std::endl;
       return 1;
       }
-    const double *cosines = image.GetDirectionCosines();
-    gdcm::DirectionCosines dc( cosines );
-    double normal[3];
-    dc.Cross( normal );
-    //const double *origin = image.GetOrigin();
-    //double zspacing = image.GetSpacing(2);
 
     // Remove SharedFunctionalGroupsSequence
     gdcm::SmartPointer<gdcm::SequenceOfItems> sfgs =
@@ -1450,9 +1591,13 @@ int main (int argc, char *argv[])
       ds.GetDataElement( gdcm::Tag( 0x5200,0x9230 ) ).GetValueAsSQ();
     ds.Remove( gdcm::Tag( 0x5200,0x9230 ) );
     gdcm_assert( ds.FindDataElement( gdcm::Tag( 0x5200,0x9230 ) ) == false );
+    if( !sfgs || sfgs->GetNumberOfItems() != 1
+      || !pffgs || pffgs->GetNumberOfItems() < dims[2] )
+      {
+      std::cerr << "Invalid Functional Groups" << std::endl;
+      return 1;
+      }
     ds.Remove( gdcm::Tag( 0x28,0x8) );
-    ds.Remove( gdcm::Tag( 0x7fe0,0x0010) );
-    gdcm_assert( ds.FindDataElement( gdcm::Tag( 0x7fe0,0x0010) ) == false );
     //ds.Remove( gdcm::Tag( 0x0008,0x0012) );
     //ds.Remove( gdcm::Tag( 0x0008,0x0013) );
 
@@ -1477,60 +1622,44 @@ int main (int argc, char *argv[])
   gdcm::Attribute<0x8,0x13> instcreationtime;
   instcreationtime.SetValue( gdcm::DTComp( date + datelen, 13 ) );
   ds.Replace( instcreationtime.GetAsDataElement() );
-  const char *offset = gdcm::System::GetTimezoneOffsetFromUTC();
+  const char *offset_from_utc = gdcm::System::GetTimezoneOffsetFromUTC();
   gdcm::Attribute<0x8,0x201> timezoneoffsetfromutc;
-  timezoneoffsetfromutc.SetValue( offset );
+  timezoneoffsetfromutc.SetValue( offset_from_utc );
   ds.Replace( timezoneoffsetfromutc.GetAsDataElement() );
 
+    // All output files share the same Pixel Data value, which is filled in
+    // place with the current frame:
+    gdcm::SmartPointer<gdcm::ByteValue> frame = new gdcm::ByteValue;
+    frame->SetLength( (uint32_t)slice_len );
+    gdcm::DataElement newpixeldata( tpixeldata );
+    newpixeldata.SetVR( pf.GetBitsAllocated() > 8 ? gdcm::VR::OW : gdcm::VR::OB );
+    newpixeldata.SetValue( *frame );
+    ds.Replace( newpixeldata );
+    char *frameptr = (char*)frame->GetVoidPointer();
+
     for(unsigned int i = 0; i < dims[2]; ++i)
       {
-#if 0
-      double new_origin[3];
-      for (int j = 0; j < 3; j++)
+      if( !is.read( frameptr, slice_len ) )
         {
-        // the n'th slice is n * z-spacing aloung the IOP-derived
-        // z-axis
-        new_origin[j] = origin[j] + normal[j] * i * zspacing;
+        std::cerr << "Failed to read frame: " << i << std::endl;
+        return 1;
         }
-#endif
 
       const char *outfilenamei = fg.GetFilename(i);
-      //gdcm::ImageWriter writer;
       gdcm::Writer writer;
       writer.SetFileName( outfilenamei );
-      //writer.SetFile( filter.GetFile() );
-      writer.SetFile( reader.GetFile() );
+      writer.SetFile( file );
 
       if ( !gdcm::RemapSharedIntoOld( ds, sfgs, pffgs, i ) )
         {
         return 1;
         }
 
-      //
-      //writer.SetImage( filter.GetImage() );
-      //gdcm::Image & //slice = writer.GetImage();
-      //slice = reader.GetImage();
-//      slice.SetOrigin( new_origin );
-//      slice.SetNumberOfDimensions( 2 );
-//      gdcm_assert( slice.GetPixelFormat() == reader.GetImage().GetPixelFormat() );
-//      slice.SetSpacing(2, reader.GetImage().GetSpacing(2) );
-      //slice.Print( std::cout );
-//      gdcm::DataElement &pd = slice.GetDataElement();
-      const char *sliceptr = bv->GetPointer() + i * slice_len;
-      gdcm::DataElement newpixeldata( gdcm::Tag(0x7fe0,0x0010) );
-      newpixeldata.SetVR( pixeldata.GetVR() );
-      newpixeldata.SetByteValue( sliceptr, (uint32_t)slice_len); // slow !
-      ds.Replace( newpixeldata );
-
       if( !writer.Write() )
         {
         std::cerr << "Failed to write: " << outfilenamei << std::endl;
         return 1;
         }
-      //else
-      //  {
-      //  std::cout << "Success to write: " << outfilenamei << std::endl;
-      //  }
       }
 
     return 0;
@@ -47,6 +47,10 @@ def get_numpy_array_type(gdcm_pixel_format):
 def gdcm_to_numpy(image):
     """Converts a GDCM image to a numpy array.
     """
+    if hasattr(image, 'GetMemoryView'):
+      # pixel data is decoded once, numpy array shares the memory
+      return numpy.asarray(image.GetMemoryView())
+
     pf = image.GetPixelFormat()
 
     assert pf.GetScalarType() in get_gdcm_to_numpy_typemap().keys(), \
@@ -0,0 +1,314 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmDecimalString.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+
+namespace gdcm
+{
+
+static inline bool IsSpace(char c)
+{
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// Powers of ten exactly representable as double
+static const double ExactPowersOfTen[] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+const char *DecimalString::Parse(const char *first, const char *last, double &value)
+{
+  const char *p = first;
+  while( p != last && IsSpace(*p) ) ++p;
+  const char *start = p;
+  bool negative = false;
+  if( p != last && (*p == '+' || *p == '-') )
+    {
+    negative = *p == '-';
+    ++p;
+    }
+  // value is mantissa * 10^exponent, only the first 19 significant digits
+  // are kept:
+  uint64_t mantissa = 0;
+  int ndigits = 0;
+  int exponent = 0;
+  bool exact = true;
+  bool anydigit = false;
+  bool fraction = false;
+  for( ; p != last; ++p )
+    {
+    if( *p == '.' && !fraction )
+      {
+      fraction = true;
+      continue;
+      }
+    if( !IsDigit(*p) ) break;
+    anydigit = true;
+    if( ndigits < 19 )
+      {
+      if( mantissa || *p != '0' )
+        {
+        mantissa = mantissa * 10 + (uint64_t)(*p - '0');
+        ++ndigits;
+        }
+      if( fraction ) --exponent;
+      }
+    else
+      {
+      if( *p != '0' ) exact = false;
+      if( !fraction ) ++exponent;
+      }
+    }
+  if( !anydigit )
+    {
+    value = 0;
+    return nullptr;
+    }
+  if( p != last && (*p == 'e' || *p == 'E') )
+    {
+    ++p;
+    bool expnegative = false;
+    if( p != last && (*p == '+' || *p == '-') )
+      {
+      expnegative = *p == '-';
+      ++p;
+      }
+    if( p == last || !IsDigit(*p) )
+      {
+      // same as operator>>: "1e" is not a number
+      value = 0;
+      return nullptr;
+      }
+    int e = 0;
+    for( ; p != last && IsDigit(*p); ++p )
+      {
+      if( e < 100000 ) e = e * 10 + (*p - '0');
+      }
+    exponent += expnegative ? -e : e;
+    }
+
+  if( !mantissa )
+    {
+    value = negative ? -0.0 : 0.0;
+    return p;
+    }
+  // Both the mantissa and the power of ten are exact, so is the result of
+  // a single multiplication or division:
+  if( exact && mantissa <= (uint64_t(1) << 53) && exponent >= -22 && exponent <= 22 )
+    {
+    double v = (double)mantissa;
+    if( exponent < 0 )
+      v /= ExactPowersOfTen[-exponent];
+    else
+      v *= ExactPowersOfTen[exponent];
+    value = negative ? -v : v;
+    return p;
+    }
+  // Rare (more than 15 significant digits, very large or small numbers):
+  std::istringstream is( std::string( start, p ) );
+  is.imbue( std::locale::classic() );
+  double v = 0;
+  is >> v;
+  value = v;
+  return is.fail() ? nullptr : p;
+}
+
+const char *DecimalString::Parse(const char *first, const char *last, int32_t &value)
+{
+  const char *p = first;
+  while( p != last && IsSpace(*p) ) ++p;
+  bool negative = false;
+  if( p != last && (*p == '+' || *p == '-') )
+    {
+    negative = *p == '-';
+    ++p;
+    }
+  if( p == last || !IsDigit(*p) )
+    {
+    value = 0;
+    return nullptr;
+    }
+  int64_t v = 0;
+  for( ; p != last && IsDigit(*p); ++p )
+    {
+    // saturate, any value above 2^32 overflows anyway:
+    if( v < (int64_t(1) << 32) ) v = v * 10 + (*p - '0');
+    }
+  if( negative ) v = -v;
+  if( v > std::numeric_limits<int32_t>::max() )
+    {
+    value = std::numeric_limits<int32_t>::max();
+    return nullptr;
+    }
+  if( v < std::numeric_limits<int32_t>::min() )
+    {
+    value = std::numeric_limits<int32_t>::min();
+    return nullptr;
+    }
+  value = (int32_t)v;
+  return p;
+}
+
+// Write the number 0.d1d2...dn * 10^(exponent+1) with n = ndigits (d1 != 0)
+// in at most size characters, using the same layout as the historical DS
+// writer: ".25", "12.5", "1e-05" is written "1e-5", etc. Return 0 if it does
+// not fit.
+static unsigned int Layout(const char *digits, int ndigits, int exponent,
+  char *out, int size)
+{
+  char tmp[40];
+  int n = 0;
+  if( exponent >= size || exponent < -3 )
+    {
+    tmp[n++] = digits[0];
+    if( ndigits > 1 )
+      {
+      tmp[n++] = '.';
+      for( int i = 1; i < ndigits; ++i ) tmp[n++] = digits[i];
+      }
+    n += snprintf( tmp + n, sizeof(tmp) - n, "e%d", exponent );
+    }
+  else if( exponent >= 0 )
+    {
+    for( int i = 0; i <= exponent; ++i ) tmp[n++] = i < ndigits ? digits[i] : '0';
+    if( ndigits > exponent + 1 )
+      {
+      tmp[n++] = '.';
+      for( int i = exponent + 1; i < ndigits; ++i ) tmp[n++] = digits[i];
+      }
+    }
+  else
+    {
+    tmp[n++] = '.';
+    for( int i = 0; i < -exponent - 1; ++i ) tmp[n++] = '0';
+    for( int i = 0; i < ndigits; ++i ) tmp[n++] = digits[i];
+    }
+  if( n > size ) return 0;
+  memcpy( out, tmp, n );
+  out[n] = 0;
+  return (unsigned int)n;
+}
+
+unsigned int DecimalString::Format(double value, char buffer[17])
+{
+  if( !std::isfinite( value ) )
+    {
+    return (unsigned int)snprintf( buffer, 17, "%g", value );
+    }
+  char *out = buffer;
+  int size = 16;
+  if( std::signbit( value ) )
+    {
+    *out++ = '-';
+    value = -value;
+    --size;
+    }
+  if( value == 0 )
+    {
+    strcpy( out, "0" );
+    return (unsigned int)(out - buffer) + 1;
+    }
+  // 17 significant digits identify any double:
+  char line[40];
+  snprintf( line, sizeof(line), "%.16e", value );
+  char digits[17];
+  int ndigits = 0;
+  const char *c = line;
+  // skip the decimal separator, whatever the locale:
+  for( ; *c && *c != 'e' && *c != 'E'; ++c )
+    {
+    if( IsDigit(*c) && ndigits < 17 ) digits[ndigits++] = *c;
+    }
+  int exponent = 0;
+  if( *c )
+    {
+    ++c;
+    const bool negative = *c == '-';
+    if( *c == '-' || *c == '+' ) ++c;
+    for( ; IsDigit(*c); ++c ) exponent = exponent * 10 + (*c - '0');
+    if( negative ) exponent = -exponent;
+    }
+
+  // Shortest precision reading back to value; otherwise the highest
+  // precision fitting in the 16 characters:
+  char candidate[17];
+  unsigned int best = 0;
+  for( int precision = 1; precision <= ndigits; ++precision )
+    {
+    char rounded[17];
+    memcpy( rounded, digits, precision );
+    int e = exponent;
+    int n = precision;
+    if( precision < ndigits && digits[precision] >= '5' )
+      {
+      int i = precision - 1;
+      for( ; i >= 0 && rounded[i] == '9'; --i ) rounded[i] = '0';
+      if( i >= 0 )
+        {
+        ++rounded[i];
+        }
+      else
+        {
+        rounded[0] = '1';
+        n = 1;
+        ++e;
+        }
+      }
+    while( n > 1 && rounded[n - 1] == '0' ) --n;
+    const unsigned int len = Layout( rounded, n, e, candidate, size );
+    if( !len ) continue;
+    // rounding up may overflow, eg. for the largest double:
+    double v;
+    const bool valid = Parse( candidate, candidate + len, v ) != nullptr;
+    if( !valid && best ) continue;
+    memcpy( out, candidate, len + 1 );
+    best = len;
+    if( valid && v == value ) break;
+    }
+  // a single digit always fits, best cannot be 0
+  return (unsigned int)(out - buffer) + best;
+}
+
+unsigned int DecimalString::Format(int32_t value, char buffer[12])
+{
+  char tmp[12];
+  int n = 0;
+  // work on negative values, -INT32_MIN does not fit:
+  int32_t v = value < 0 ? value : -value;
+  do
+    {
+    tmp[n++] = (char)('0' - v % 10);
+    v /= 10;
+    } while( v );
+  unsigned int len = 0;
+  if( value < 0 ) buffer[len++] = '-';
+  while( n ) buffer[len++] = tmp[--n];
+  buffer[len] = 0;
+  return len;
+}
+
+} // end namespace gdcm
@@ -0,0 +1,53 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMDECIMALSTRING_H
+#define GDCMDECIMALSTRING_H
+
+#include "gdcmTypes.h"
+
+namespace gdcm
+{
+
+/**
+ * \brief DecimalString
+ * \details Conversion between the text of Decimal String (DS) and Integer
+ * String (IS) values and numbers, without going through iostreams.
+ * Conversions do not depend on the C or C++ locale: the decimal separator is
+ * always '.'.
+ */
+class GDCM_EXPORT DecimalString
+{
+public:
+  /// Parse a number at the beginning of [first,last), after any white space.
+  /// Return the position past the number, or nullptr when there is no number
+  /// (in which case \p value is set to 0) or when it overflows (\p value is
+  /// then the largest/smallest representable value).
+  /// Only the characters accepted by operator>> are consumed, eg. "1.5\2"
+  /// stops before the backslash.
+  static const char *Parse(const char *first, const char *last, double &value);
+  static const char *Parse(const char *first, const char *last, int32_t &value);
+
+  /// Write \p value in at most 16 characters (the maximum length of a DS
+  /// value) plus the terminating null character, using the shortest text
+  /// reading back to \p value when there is one. Return the number of
+  /// characters written (not counting the null character).
+  static unsigned int Format(double value, char buffer[17]);
+  /// Write \p value (at most 11 characters) plus the terminating null
+  /// character. Return the number of characters written.
+  static unsigned int Format(int32_t value, char buffer[12]);
+};
+
+} // end namespace gdcm
+
+#endif //GDCMDECIMALSTRING_H
@@ -24,7 +24,7 @@ namespace gdcm
 
 const char* DummyValueGenerator::Generate(const char *input)
 {
-  static char digest[2*20+1] = {};
+  static thread_local char digest[2*20+1] = {};
   bool b = false;
   if( input )
     {
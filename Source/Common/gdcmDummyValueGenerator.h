@@ -30,7 +30,8 @@ public:
   /** Generate a dummy value from an input value. This is guarantee to always
    * return the same output value when input is identical.  Return an array of
    * bytes that can be used for anonymization purpose, return NULL on error
-   * NOT THREAD SAFE
+   * The returned buffer is per thread, and is overwritten by the next call
+   * from the same thread.
    */
   static const char* Generate(const char *input);
 
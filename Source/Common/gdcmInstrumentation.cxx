@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmInstrumentation.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace gdcm
+{
+
+static const char *const ProbeNames[] = {
+  "read",
+  "write",
+  "decode/raw",
+  "decode/rle",
+  "decode/jpeg",
+  "decode/jpegls",
+  "decode/jpeg2000",
+  "encode/raw",
+  "encode/rle",
+  "encode/jpeg",
+  "encode/jpegls",
+  "encode/jpeg2000",
+  "byteswap",
+  "lut",
+  "rescale",
+  "pdu/send",
+  "pdu/receive",
+};
+
+struct ProbeCounters
+{
+  std::atomic<uint64_t> Count;
+  std::atomic<uint64_t> Nanoseconds;
+  std::atomic<uint64_t> Bytes;
+};
+
+// zero initialized (static storage):
+static ProbeCounters Probes[Instrumentation::NumberOfProbes];
+static std::atomic<bool> Enabled( getenv("GDCM_INSTRUMENTATION") != nullptr );
+
+void Instrumentation::SetEnabled(bool enabled)
+{
+  Enabled.store( enabled, std::memory_order_relaxed );
+}
+
+void Instrumentation::EnabledOn()
+{
+  SetEnabled(true);
+}
+
+void Instrumentation::EnabledOff()
+{
+  SetEnabled(false);
+}
+
+bool Instrumentation::GetEnabled()
+{
+  return Enabled.load( std::memory_order_relaxed );
+}
+
+void Instrumentation::Reset()
+{
+  for( int i = 0; i < NumberOfProbes; ++i )
+    {
+    Probes[i].Count = 0;
+    Probes[i].Nanoseconds = 0;
+    Probes[i].Bytes = 0;
+    }
+}
+
+void Instrumentation::Add(ProbeType p, uint64_t nanoseconds, uint64_t bytes)
+{
+  if( !GetEnabled() || p < 0 || p >= NumberOfProbes ) return;
+  ProbeCounters &c = Probes[p];
+  c.Count.fetch_add( 1, std::memory_order_relaxed );
+  c.Nanoseconds.fetch_add( nanoseconds, std::memory_order_relaxed );
+  c.Bytes.fetch_add( bytes, std::memory_order_relaxed );
+}
+
+const char *Instrumentation::GetProbeName(ProbeType p)
+{
+  static_assert( sizeof(ProbeNames) / sizeof(*ProbeNames) == NumberOfProbes,
+    "ProbeNames does not match ProbeType" );
+  if( p < 0 || p >= NumberOfProbes ) return nullptr;
+  return ProbeNames[p];
+}
+
+uint64_t Instrumentation::GetCount(ProbeType p)
+{
+  if( p < 0 || p >= NumberOfProbes ) return 0;
+  return Probes[p].Count.load( std::memory_order_relaxed );
+}
+
+double Instrumentation::GetSeconds(ProbeType p)
+{
+  if( p < 0 || p >= NumberOfProbes ) return 0;
+  return (double)Probes[p].Nanoseconds.load( std::memory_order_relaxed ) * 1e-9;
+}
+
+uint64_t Instrumentation::GetBytes(ProbeType p)
+{
+  if( p < 0 || p >= NumberOfProbes ) return 0;
+  return Probes[p].Bytes.load( std::memory_order_relaxed );
+}
+
+void Instrumentation::PrintJSON(std::ostream &os)
+{
+  os << "{";
+  bool first = true;
+  for( int i = 0; i < NumberOfProbes; ++i )
+    {
+    const ProbeType p = (ProbeType)i;
+    const uint64_t count = GetCount(p);
+    if( !count ) continue;
+    os << (first ? "\n" : ",\n");
+    first = false;
+    os << "  \"" << GetProbeName(p) << "\": { \"count\": " << count
+      << ", \"seconds\": " << GetSeconds(p)
+      << ", \"bytes\": " << GetBytes(p) << " }";
+    }
+  os << (first ? "}" : "\n}") << std::endl;
+}
+
+bool Instrumentation::WriteJSON(const char *filename)
+{
+  if( !filename ) return false;
+  if( strcmp( filename, "-" ) == 0 )
+    {
+    PrintJSON( std::cout );
+    return true;
+    }
+  std::ofstream os( filename );
+  if( !os ) return false;
+  PrintJSON( os );
+  return !os.fail();
+}
+
+uint64_t Instrumentation::GetTime()
+{
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch() ).count();
+}
+
+InstrumentationTimer::InstrumentationTimer(Instrumentation::ProbeType p):
+  Probe(p),Active(Instrumentation::GetEnabled()),Bytes(0),Start(0)
+{
+  if( Active ) Start = Instrumentation::GetTime();
+}
+
+InstrumentationTimer::~InstrumentationTimer()
+{
+  if( Active )
+    {
+    Instrumentation::Add( Probe, Instrumentation::GetTime() - Start, Bytes );
+    }
+}
+
+} // end namespace gdcm
@@ -0,0 +1,130 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMINSTRUMENTATION_H
+#define GDCMINSTRUMENTATION_H
+
+#include "gdcmTypes.h"
+
+#include <iosfwd>
+
+namespace gdcm
+{
+
+/**
+ * \brief Instrumentation
+ * \details Process wide timers and counters for the hot paths of the library
+ * (parsing, codecs, byte swapping, LUT, rescaling, network PDU). Each probe
+ * accumulates the number of calls, the time spent and the number of bytes
+ * processed.
+ * Instrumentation is off by default, in which case a probe costs a single
+ * flag test. It is turned on with SetEnabled(true), or by setting the
+ * environment variable GDCM_INSTRUMENTATION before the program starts.
+ * Counters are updated atomically and can be read from any thread.
+ *
+ * \see InstrumentationTimer
+ */
+class GDCM_EXPORT Instrumentation
+{
+public:
+  typedef enum {
+    Read = 0,      // Reader: parsing of the data set
+    Write,         // Writer: encoding of the data set
+    DecodeRAW,
+    DecodeRLE,
+    DecodeJPEG,
+    DecodeJPEGLS,
+    DecodeJPEG2000,
+    EncodeRAW,
+    EncodeRLE,
+    EncodeJPEG,
+    EncodeJPEGLS,
+    EncodeJPEG2000,
+    ByteSwap,
+    LookupTable,
+    Rescale,
+    PDUSend,
+    PDUReceive,
+    NumberOfProbes // Must be last
+  } ProbeType;
+
+  /// Turn instrumentation on (default: off, unless GDCM_INSTRUMENTATION is set)
+  static void SetEnabled(bool enabled);
+  static void EnabledOn();
+  static void EnabledOff();
+  static bool GetEnabled();
+
+  /// Reset all probes to zero
+  static void Reset();
+
+  /// Record one call to probe \p p, which took \p nanoseconds and processed
+  /// \p bytes. This is a no-op when instrumentation is disabled.
+  static void Add(ProbeType p, uint64_t nanoseconds, uint64_t bytes);
+
+  /// Name of a probe as found in the JSON output (eg. "decode/jpegls")
+  static const char *GetProbeName(ProbeType p);
+
+  /// Number of calls recorded for \p p
+  static uint64_t GetCount(ProbeType p);
+  /// Accumulated time in seconds recorded for \p p
+  static double GetSeconds(ProbeType p);
+  /// Accumulated number of bytes recorded for \p p
+  static uint64_t GetBytes(ProbeType p);
+
+  /// Dump all probes having recorded at least one call as a JSON object
+  static void PrintJSON(std::ostream &os);
+  /// Same as PrintJSON, to \p filename ("-" is the standard output).
+  /// Return false when the file cannot be written
+  static bool WriteJSON(const char *filename);
+
+  /// Monotonic clock used by the timers, in nanoseconds
+  static uint64_t GetTime();
+};
+
+/**
+ * \brief InstrumentationTimer
+ * \details Scoped timer, records the elapsed time of its scope to a probe
+ * of Instrumentation when destroyed:
+ * \code
+ * {
+ * InstrumentationTimer timer( Instrumentation::DecodeRLE );
+ * timer.SetBytes( len );
+ * ... decode ...
+ * }
+ * \endcode
+ */
+class GDCM_EXPORT InstrumentationTimer
+{
+public:
+  explicit InstrumentationTimer(Instrumentation::ProbeType p);
+  ~InstrumentationTimer();
+  InstrumentationTimer(const InstrumentationTimer &) = delete;
+  InstrumentationTimer &operator=(const InstrumentationTimer &) = delete;
+
+  /// Whether the scope is being timed (instrumentation was enabled)
+  bool IsActive() const { return Active; }
+  /// Number of bytes processed within the scope
+  void SetBytes(uint64_t bytes) { Bytes = bytes; }
+  /// Do not record anything (eg. the operation did not take place)
+  void Cancel() { Active = false; }
+
+private:
+  Instrumentation::ProbeType Probe;
+  bool Active;
+  uint64_t Bytes;
+  uint64_t Start;
+};
+
+} // end namespace gdcm
+
+#endif //GDCMINSTRUMENTATION_H
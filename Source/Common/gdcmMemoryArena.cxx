@@ -0,0 +1,87 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmMemoryArena.h"
+
+#include <new>
+
+namespace gdcm
+{
+
+static const size_t ArenaAlignment = 16;
+
+static int GetStreamArenaIndex()
+{
+  static const int index = std::ios_base::xalloc();
+  return index;
+}
+
+MemoryArena::MemoryArena(size_t blocksize):
+  ReferenceCount(0),
+  BlockSize(blocksize < 1024 ? 1024 : blocksize),
+  Current(nullptr),Remaining(0),Allocated(0)
+{
+}
+
+MemoryArena::~MemoryArena()
+{
+  for( std::vector<char*>::const_iterator it = Blocks.begin(); it != Blocks.end(); ++it )
+    {
+    ::operator delete( *it );
+    }
+}
+
+void *MemoryArena::Allocate(size_t size)
+{
+  // keep every allocation aligned:
+  size = (size + ArenaAlignment - 1) & ~(ArenaAlignment - 1);
+  std::lock_guard<std::mutex> guard( Lock );
+  if( size > Remaining )
+    {
+    const size_t blocksize = size > BlockSize ? size : BlockSize;
+    // operator new returns memory suitably aligned for any fundamental type:
+    char *block = static_cast<char*>( ::operator new( blocksize ) );
+    Blocks.push_back( block );
+    Current = block;
+    Remaining = blocksize;
+    }
+  void *p = Current;
+  Current += size;
+  Remaining -= size;
+  Allocated += size;
+  return p;
+}
+
+size_t MemoryArena::GetNumberOfBlocks() const
+{
+  std::lock_guard<std::mutex> guard( Lock );
+  return Blocks.size();
+}
+
+size_t MemoryArena::GetAllocatedSize() const
+{
+  std::lock_guard<std::mutex> guard( Lock );
+  return Allocated;
+}
+
+void MemoryArena::SetStreamArena(std::istream &is, MemoryArena *arena)
+{
+  is.pword( GetStreamArenaIndex() ) = arena;
+}
+
+MemoryArena *MemoryArena::GetStreamArena(std::istream &is)
+{
+  return static_cast<MemoryArena*>( is.pword( GetStreamArenaIndex() ) );
+}
+
+} // end namespace gdcm
@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMMEMORYARENA_H
+#define GDCMMEMORYARENA_H
+
+#include "gdcmTypes.h"
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <istream>
+
+namespace gdcm
+{
+
+/**
+ * \brief MemoryArena
+ * \details Monotonic allocator: memory is carved out of large blocks and is
+ * only given back to the system, all at once, when the arena is destroyed.
+ * Used by Reader (see Reader::SetUseMemoryArena) so that the many small
+ * values created while parsing a data set do not each go through
+ * malloc/free. Requests larger than GetMaximumAllocationSize() (typically
+ * Pixel Data) are not served by the arena.
+ *
+ * The arena is reference counted (SmartPointer); every value allocated from
+ * it holds a reference, so the arena outlives anything pointing into it.
+ * Allocate and the reference count are thread safe.
+ */
+class GDCM_EXPORT MemoryArena
+{
+public:
+  explicit MemoryArena(size_t blocksize = 64 * 1024);
+  ~MemoryArena();
+  MemoryArena(const MemoryArena &) = delete;
+  MemoryArena &operator=(const MemoryArena &) = delete;
+
+  /// Return \p size bytes, aligned on 16 bytes. The memory is not
+  /// initialized and cannot be freed individually.
+  void *Allocate(size_t size);
+
+  /// Largest request served by Allocate (a quarter of the block size)
+  size_t GetMaximumAllocationSize() const { return BlockSize / 4; }
+
+  /// Number of blocks allocated so far
+  size_t GetNumberOfBlocks() const;
+  /// Number of bytes handed out by Allocate so far
+  size_t GetAllocatedSize() const;
+
+  /// \internal Associate \p arena to the input stream \p is: values parsed
+  /// from \p is are allocated from \p arena (nullptr to disable). The caller
+  /// keeps \p arena alive while \p is is being read.
+  static void SetStreamArena(std::istream &is, MemoryArena *arena);
+  static MemoryArena *GetStreamArena(std::istream &is);
+
+  void Register() {
+    ReferenceCount.fetch_add( 1, std::memory_order_relaxed );
+  }
+  void UnRegister() {
+    if( ReferenceCount.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+      {
+      delete this;
+      }
+  }
+
+private:
+  std::atomic<long> ReferenceCount;
+  const size_t BlockSize;
+  mutable std::mutex Lock;
+  std::vector<char*> Blocks;
+  char *Current;
+  size_t Remaining;
+  size_t Allocated;
+};
+
+} // end namespace gdcm
+
+#endif //GDCMMEMORYARENA_H
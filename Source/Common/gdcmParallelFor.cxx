@@ -0,0 +1,69 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmParallelFor.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace gdcm
+{
+
+unsigned int ParallelFor::GetNumberOfThreads(unsigned int nthreads, size_t n)
+{
+  if( !nthreads ) nthreads = std::thread::hardware_concurrency();
+  if( !nthreads ) nthreads = 1;
+  if( nthreads > n ) nthreads = n ? (unsigned int)n : 1;
+  return nthreads;
+}
+
+bool ParallelFor::Run(size_t n, unsigned int nthreads, TaskType const &task)
+{
+  nthreads = GetNumberOfThreads( nthreads, n );
+  if( nthreads == 1 )
+    {
+    for( size_t i = 0; i < n; ++i )
+      {
+      if( !task( i, 0 ) ) return false;
+      }
+    return true;
+    }
+
+  std::atomic<size_t> next( 0 );
+  std::atomic<bool> failed( false );
+  auto worker = [&](unsigned int t) {
+    for( size_t i = next++; i < n && !failed; i = next++ )
+      {
+      if( !task( i, t ) )
+        {
+        failed = true;
+        }
+      }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve( nthreads - 1 );
+  for( unsigned int t = 1; t < nthreads; ++t )
+    {
+    threads.push_back( std::thread( worker, t ) );
+    }
+  // calling thread does its share of the work:
+  worker( 0 );
+  for( size_t t = 0; t < threads.size(); ++t )
+    {
+    threads[t].join();
+    }
+  return !failed;
+}
+
+} // end namespace gdcm
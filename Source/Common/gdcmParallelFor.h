@@ -0,0 +1,52 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMPARALLELFOR_H
+#define GDCMPARALLELFOR_H
+
+#include "gdcmTypes.h"
+
+#include <functional>
+
+namespace gdcm
+{
+
+/**
+ * \brief ParallelFor
+ * \details \internal Worker loop shared by the classes having a
+ * SetNumberOfThreads option (Writer, Scanner, Sorter, codecs, ...).
+ *
+ * Items are handed out one at a time from a shared counter, so that items
+ * of very different cost are balanced. The calling thread processes items
+ * too; with a single thread everything runs on the calling thread, in order.
+ */
+class GDCM_EXPORT ParallelFor
+{
+public:
+  /// Signature of the work: process item i, on thread t (in [0, number of
+  /// threads)). Return false to stop: the items not yet started are skipped.
+  typedef std::function<bool (size_t i, unsigned int t)> TaskType;
+
+  /// Number of threads Run starts for n items when asked for nthreads:
+  /// 0 means the number of hardware threads, the result is between 1 and n
+  /// (1 when n is 0).
+  static unsigned int GetNumberOfThreads(unsigned int nthreads, size_t n);
+
+  /// Call task for every item in [0,n), on GetNumberOfThreads(nthreads, n)
+  /// threads. Return false when a task returned false.
+  static bool Run(size_t n, unsigned int nthreads, TaskType const &task);
+};
+
+} // end namespace gdcm
+
+#endif //GDCMPARALLELFOR_H
@@ -16,8 +16,10 @@
 #include "gdcmDefs.h"
 #include "gdcmFilename.h"
 
+#include <atomic>
 #include <climits> // PATH_MAX
 #include <cstring> // strcpy
+#include <mutex>
 #ifdef _WIN32
 #include <windows.h> // MAX_PATH
 #endif
@@ -32,10 +34,14 @@ static unsigned int GlobalCount;
 class GlobalInternal
 {
 public:
-  GlobalInternal():GlobalDicts(),GlobalDefs() {}
+  GlobalInternal():GlobalDicts(),GlobalDefs(),DefsLoaded(false) {}
   Dicts GlobalDicts; // Part 6 + Part 4 elements
 // TODO need H table for TransferSyntax / MediaStorage / Part 3 ...
   Defs GlobalDefs;
+  // GlobalDefs is only written once, under DefsLock, then published:
+  std::mutex DefsLock;
+  std::atomic<bool> DefsLoaded;
+  std::mutex PathsLock; // ResourcePaths
 
   // Resource paths:
   // By default only construct two paths:
@@ -103,11 +109,21 @@ Global::~Global()
 bool Global::LoadResourcesFiles()
 {
   gdcm_assert( Internals != nullptr ); // paranoid
+  if( Internals->DefsLoaded.load( std::memory_order_acquire ) )
+    {
+    return true;
+    }
+  std::lock_guard<std::mutex> lock( Internals->DefsLock );
+  if( Internals->DefsLoaded.load( std::memory_order_relaxed ) )
+    {
+    return true;
+    }
   const char *filename = Locate( "Part3.xml" );
   if( filename )
     {
     if( Internals->GlobalDefs.IsEmpty() )
       Internals->GlobalDefs.LoadFromFile(filename);
+    Internals->DefsLoaded.store( true, std::memory_order_release );
     return true;
     }
   // resource manager was not set properly
@@ -120,6 +136,7 @@ bool Global::Append(const char *path)
     {
     return false;
     }
+  std::lock_guard<std::mutex> lock( Internals->PathsLock );
   Internals->ResourcePaths.emplace_back(path );
   return true;
 }
@@ -130,6 +147,7 @@ bool Global::Prepend(const char *path)
     {
     return false;
     }
+  std::lock_guard<std::mutex> lock( Internals->PathsLock );
   Internals->ResourcePaths.insert( Internals->ResourcePaths.begin(), path );
   return true;
 }
@@ -141,11 +159,12 @@ bool Global::Prepend(const char *path)
 const char *Global::Locate(const char *resfile) const
 {
 #ifdef _WIN32
-  static char path[MAX_PATH];
+  static thread_local char path[MAX_PATH];
 #else
-  static char path[PATH_MAX];
+  static thread_local char path[PATH_MAX];
 #endif
 
+  std::lock_guard<std::mutex> lock( Internals->PathsLock );
   std::vector<std::string>::const_iterator it = Internals->ResourcePaths.begin();
   for( ; it != Internals->ResourcePaths.end(); ++it)
     {
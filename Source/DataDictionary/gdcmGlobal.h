@@ -45,6 +45,9 @@ class Defs;
  * pattern.  It makes sure that the Dict singleton is created
  * before and destroyed after all other singletons in GDCM.
  *
+ * Thread safety: the Dicts are filled at load time and never modified
+ * afterwards, so lookups are lock free and can be done from any thread.
+ * The Defs are read-only once LoadResourcesFiles returned.
  */
 class GDCM_EXPORT Global // why expose the symbol I think I only need to expose the instance...
 {
@@ -69,19 +72,19 @@ public:
 
   /// Load all internal XML files, resource path need to have been
   /// set before calling this member function (see Append/Prepend members func)
-  /// \warning not thread safe !
+  /// The files are only loaded once, concurrent calls are safe and wait for
+  /// the first one to complete.
   bool LoadResourcesFiles();
 
   /// Append path at the end of the path list
-  /// \warning not thread safe !
   bool Append(const char *path);
 
   /// Prepend path at the beginning of the path list
-  /// \warning not thread safe !
   bool Prepend(const char *path);
 
 protected:
   /// Locate a resource file
+  /// The returned pointer is only valid until the next call from the same thread.
   const char *Locate(const char *resfile) const;
 
 private:
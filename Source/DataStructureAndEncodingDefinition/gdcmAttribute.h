@@ -182,24 +182,24 @@ public:
   // API to talk to the run-time layer: gdcm::DataElement
   DataElement GetAsDataElement() const {
     DataElement ret( GetTag() );
-    std::ostringstream os;
-    // os.imbue(std::locale::classic()); // This is not required AFAIK
-    EncodingImplementation<VRToEncoding<TVR>::Mode>::Write(Internal,
-      GetNumberOfValues(),os);
+    std::string str;
+    // DS and IS values do not depend on the locale
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::WriteToString(Internal,
+      GetNumberOfValues(),str);
     ret.SetVR( GetVR() );
     gdcm_assert( ret.GetVR() != VR::SQ );
     if( (VR::VRType)VRToEncoding<TVR>::Mode == VR::VRASCII )
       {
       if( GetVR() != VR::UI )
         {
-        if( os.str().size() % 2 )
+        if( str.size() % 2 )
           {
-          os << " ";
+          str += ' ';
           }
         }
       }
-    VL::Type osStrSize = (VL::Type)os.str().size();
-    ret.SetByteValue( os.str().c_str(), osStrSize );
+    VL::Type strSize = (VL::Type)str.size();
+    ret.SetByteValue( str.c_str(), strSize );
     return ret;
   }
 
@@ -244,11 +244,8 @@ protected:
     //  }
     //else
       {
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwap(Internal,
-        GetNumberOfValues(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwapFromBuffer(Internal,
+        GetNumberOfValues(),bv->GetPointer(),bv->GetLength());
       }
   }
   void SetByteValue(const ByteValue *bv) {
@@ -261,11 +258,8 @@ protected:
     //  }
     //else
       {
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::Read(Internal,
-        GetNumberOfValues(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadFromBuffer(Internal,
+        GetNumberOfValues(),bv->GetPointer(),bv->GetLength());
       }
   }
 #if 0 // TODO  FIXME the implicit way:
@@ -417,24 +411,24 @@ public:
   // API to talk to the run-time layer: gdcm::DataElement
   DataElement GetAsDataElement() const {
     DataElement ret( Tag(Group,Element) );
-    std::ostringstream os;
-    // os.imbue(std::locale::classic()); // This is not required AFAIK
-    EncodingImplementation<VRToEncoding<TVR>::Mode>::Write(&Internal,
-      GetNumberOfValues(),os);
+    std::string str;
+    // DS and IS values do not depend on the locale
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::WriteToString(&Internal,
+      GetNumberOfValues(),str);
     ret.SetVR( GetVR() );
     gdcm_assert( ret.GetVR() != VR::SQ );
     if( (VR::VRType)VRToEncoding<TVR>::Mode == VR::VRASCII )
       {
       if( GetVR() != VR::UI )
         {
-        if( os.str().size() % 2 )
+        if( str.size() % 2 )
           {
-          os << " ";
+          str += ' ';
           }
         }
       }
-    VL::Type osStrSize = (VL::Type)os.str().size();
-    ret.SetByteValue( os.str().c_str(), osStrSize );
+    VL::Type strSize = (VL::Type)str.size();
+    ret.SetByteValue( str.c_str(), strSize );
     return ret;
   }
 
@@ -479,11 +473,8 @@ protected:
     //  }
     //else
       {
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwap(&Internal,
-        GetNumberOfValues(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwapFromBuffer(&Internal,
+        GetNumberOfValues(),bv->GetPointer(),bv->GetLength());
       }
   }
   void SetByteValue(const ByteValue *bv) {
@@ -496,11 +487,8 @@ protected:
     //  }
     //else
       {
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::Read(&Internal,
-        GetNumberOfValues(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadFromBuffer(&Internal,
+        GetNumberOfValues(),bv->GetPointer(),bv->GetLength());
       }
   }
 #if 0 // TODO  FIXME the implicit way:
@@ -645,26 +633,26 @@ public:
 
   DataElement GetAsDataElement() const {
     DataElement ret( GetTag() );
-    std::ostringstream os;
+    std::string str;
     if( Internal )
       {
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::Write(Internal,
-        GetNumberOfValues(),os);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::WriteToString(Internal,
+        GetNumberOfValues(),str);
       if( (VR::VRType)VRToEncoding<TVR>::Mode == VR::VRASCII )
         {
         if( GetVR() != VR::UI )
           {
-          if( os.str().size() % 2 )
+          if( str.size() % 2 )
             {
-            os << " ";
+            str += ' ';
             }
           }
         }
       }
     ret.SetVR( GetVR() );
     gdcm_assert( ret.GetVR() != VR::SQ );
-    VL::Type osStrSize = (VL::Type) os.str().size();
-    ret.SetByteValue( os.str().c_str(), osStrSize);
+    VL::Type strSize = (VL::Type) str.size();
+    ret.SetByteValue( str.c_str(), strSize);
     return ret;
   }
   void SetFromDataElement(DataElement const &de) {
@@ -689,10 +677,7 @@ public:
 protected:
   void SetByteValue(const ByteValue *bv) {
     gdcm_assert( bv ); // FIXME
-    std::stringstream ss;
-    std::string s = std::string( bv->GetPointer(), bv->GetLength() );
     Length = bv->GetLength(); // HACK FIXME
-    ss.str( s );
     ArrayType *internal;
     ArrayType buffer[256];
     if( bv->GetLength() < 256 )
@@ -703,7 +688,8 @@ protected:
       {
       internal = new ArrayType[(VL::Type)bv->GetLength()]; // over allocation
       }
-    EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadComputeLength(internal, Length, ss);
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadComputeLengthFromBuffer(internal, Length,
+      bv->GetPointer(), bv->GetLength());
     SetValues( internal, Length, true );
     if( !(bv->GetLength() < 256) )
       {
@@ -12,13 +12,89 @@
 
 =========================================================================*/
 #include "gdcmByteValue.h"
+#include "gdcmMemoryArena.h"
 
 #include <algorithm> // req C++11
 #include <cstring> // memcpy
+#include <new>
 
 namespace gdcm_ns
 {
 
+  // Every ByteValue is preceded by the MemoryArena it was allocated from
+  // (nullptr for the heap)
+  static const size_t ArenaHeaderSize = sizeof(MemoryArena*);
+  static_assert( alignof(ByteValue) <= ArenaHeaderSize, "ByteValue would be misaligned" );
+
+  void *ByteValue::operator new(size_t size) {
+    char *p = static_cast<char*>( ::operator new( size + ArenaHeaderSize ) );
+    *reinterpret_cast<MemoryArena**>(p) = nullptr;
+    return p + ArenaHeaderSize;
+  }
+  void ByteValue::operator delete(void *p) {
+    if( !p ) return;
+    char *header = static_cast<char*>(p) - ArenaHeaderSize;
+    MemoryArena *arena = *reinterpret_cast<MemoryArena**>(header);
+    // memory from an arena is only released with the arena itself:
+    if( arena ) arena->UnRegister();
+    else ::operator delete( header );
+  }
+  ByteValue *ByteValue::New(MemoryArena *arena) {
+    if( !arena ) return new ByteValue;
+    char *p = static_cast<char*>( arena->Allocate( ArenaHeaderSize + sizeof(ByteValue) ) );
+    ByteValue *bv = ::new( p + ArenaHeaderSize ) ByteValue;
+    arena->Register();
+    *reinterpret_cast<MemoryArena**>(p) = arena;
+    bv->Arena = arena;
+    return bv;
+  }
+
+  void ByteValue::ResizeInternal(size_t size) {
+    if( size == 0 )
+      {
+      FreeInternal();
+      return;
+      }
+    if( size <= InternalSize )
+      {
+      // same as std::vector: no reallocation when shrinking
+      InternalSize = size;
+      return;
+      }
+    char *buffer;
+    bool fromarena = false;
+    if( size <= sizeof(InlineBuffer) )
+      {
+      // short values (US, UL, DA, TM, most CS...) do not need an allocation
+      buffer = InlineBuffer;
+      }
+    else if( Arena && size <= Arena->GetMaximumAllocationSize() )
+      {
+      buffer = static_cast<char*>( Arena->Allocate( size ) );
+      fromarena = true;
+      }
+    else
+      {
+      buffer = new char[size];
+      }
+    const size_t oldsize = InternalSize;
+    if( buffer != Internal )
+      {
+      if( oldsize ) memcpy(buffer, Internal, oldsize);
+      FreeInternal();
+      }
+    memset(buffer + oldsize, 0, size - oldsize);
+    Internal = buffer;
+    InternalSize = size;
+    InternalFromArena = fromarena;
+  }
+  void ByteValue::FreeInternal() {
+    if( Internal != InlineBuffer && !InternalFromArena ) delete[] Internal;
+    Internal = nullptr;
+    InternalSize = 0;
+    InternalFromArena = false;
+  }
+
   void ByteValue::SetLength(VL vl) {
     VL l(vl);
 #ifdef GDCM_SUPPORT_BROKEN_IMPLEMENTATION
@@ -41,8 +117,7 @@ namespace gdcm_ns
 #ifdef SHORT_READ_HACK
     if( l <= 0xff )
 #endif
-      Internal.resize(l);
-      //Internal.reserve(l);
+      ResizeInternal(l);
       }
     catch(...)
       {
@@ -65,8 +140,8 @@ namespace gdcm_ns
     // I cannot check IsPrintable some file contains \2 or \0 in a VR::LO element
     // See: acr_image_with_non_printable_in_0051_1010.acr
     //gdcm_assert( IsPrintable(length) );
-    std::vector<char>::const_iterator it = Internal.begin();
-    for(; it != Internal.begin()+length; ++it)
+    const char *it = Internal;
+    for(; it != Internal+length; ++it)
       {
       const char &c = *it;
       if ( !( isprint((unsigned char)c) || isspace((unsigned char)c) ) ) os << ".";
@@ -75,14 +150,14 @@ namespace gdcm_ns
   }
   void ByteValue::PrintHex(std::ostream &os, VL maxlength ) const {
     VL length = std::min(maxlength, Length);
-    // WARNING: Internal.end() != Internal.begin()+Length
-    std::vector<char>::const_iterator it = Internal.begin();
+    // WARNING: Internal+InternalSize != Internal+Length
+    const char *it = Internal;
     os << std::hex;
-    for(; it != Internal.begin()+length; ++it)
+    for(; it != Internal+length; ++it)
       {
       //const char &c = *it;
       uint8_t v = *it;
-      if( it != Internal.begin() ) os << "\\";
+      if( it != Internal ) os << "\\";
       os << std::setw( 2 ) << std::setfill( '0' ) << (uint16_t)v;
       //++it;
       //os << std::setw( 1 ) << std::setfill( '0' ) << (int)*it;
@@ -93,9 +168,9 @@ namespace gdcm_ns
   bool ByteValue::GetBuffer(char *buffer, unsigned long length) const {
     // SIEMENS_GBS_III-16-ACR_NEMA_1.acr has a weird pixel length
     // so we need an inequality
-    if( length <= Internal.size() )
+    if( length <= InternalSize )
       {
-      if(!Internal.empty()) memcpy(buffer, Internal.data(), length);
+      if(InternalSize) memcpy(buffer, Internal, length);
       return true;
       }
     gdcmDebugMacro( "Could not handle length= " << length );
@@ -123,8 +198,8 @@ namespace gdcm_ns
     count1=count2=1;
     os << "<PersonName number = \"" << count1 << "\" >\n" ;
     os << "<SingleByte>\n<FamilyName> " ;
-    std::vector<char>::const_iterator it = Internal.begin();
-    for(; it != (Internal.begin() + Length); ++it)
+    const char *it = Internal;
+    for(; it != (Internal + Length); ++it)
       {
       const char &c = *it;
       if ( c == '^' )
@@ -269,9 +344,9 @@ namespace gdcm_ns
 
     int count = 1;
     os << "<Value number = \"" << count << "\" >";
-    std::vector<char>::const_iterator it = Internal.begin();
+    const char *it = Internal;
 
-    for(; it != (Internal.begin() + Length); ++it)
+    for(; it != (Internal + Length); ++it)
       {
       const char &c = *it;
       if ( c == '\\' )
@@ -303,15 +378,15 @@ namespace gdcm_ns
   void ByteValue::PrintHexXML(std::ostream &os ) const
     {
     //VL length = std::min(maxlength, Length);
-    // WARNING: Internal.end() != Internal.begin()+Length
+    // WARNING: Internal+InternalSize != Internal+Length
 
-    std::vector<char>::const_iterator it = Internal.begin();
+    const char *it = Internal;
     os << std::hex;
-    for(; it != Internal.begin() + Length; ++it)
+    for(; it != Internal + Length; ++it)
       {
       //const char &c = *it;
       uint8_t v = *it;
-      if( it != Internal.begin() ) os << "\\";
+      if( it != Internal ) os << "\\";
       os << std::setw( 2 ) << std::setfill( '0' ) << (uint16_t)v;
       //++it;
       //os << std::setw( 1 ) << std::setfill( '0' ) << (int)*it;
@@ -321,11 +396,14 @@ namespace gdcm_ns
    
   void ByteValue::Append(ByteValue const & bv)
     {
-    //Internal.resize( Length + bv.Length );
-    Internal.insert( Internal.end(), bv.Internal.begin(), bv.Internal.end());
+    const size_t offset = InternalSize;
+    const size_t count = bv.InternalSize;
+    ResizeInternal( offset + count );
+    // bv may be *this:
+    if( count ) memcpy( Internal + offset, bv.Internal, count );
     Length += bv.Length;
     // post condition
-    gdcm_assert( Internal.size() % 2 == 0 && Internal.size() == Length );
+    gdcm_assert( InternalSize % 2 == 0 && InternalSize == Length );
     }
    
 } // end namespace gdcm_ns
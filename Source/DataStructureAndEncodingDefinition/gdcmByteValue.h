@@ -24,6 +24,7 @@
 #include <algorithm>
 #include <cstring>
 
+namespace gdcm { class MemoryArena; }
 namespace gdcm_ns
 {
 #if !defined(SWIGPYTHON) && !defined(SWIGCSHARP) && !defined(SWIGJAVA) && !defined(SWIGPHP)
@@ -35,29 +36,51 @@ using namespace gdcm;
 class GDCM_EXPORT ByteValue : public Value
 {
 public:
-  ByteValue(const char* array = nullptr, VL const &vl = 0): Length(vl) {
+  ByteValue(const char* array = nullptr, VL const &vl = 0):
+    Internal(nullptr),InternalSize(0),Arena(nullptr),InternalFromArena(false),Length(vl) {
       VL bytes_count_to_copy = Length;
       if( vl.IsOdd() )
         {
         gdcmDebugMacro( "Odd length" );
-        Internal.resize(vl+1);
         ++Length;
         }
-      Internal.resize(Length);
+      ResizeInternal(Length);
       if( array )
-        std::memcpy(Internal.data(), array, bytes_count_to_copy);
+        std::memcpy(Internal, array, bytes_count_to_copy);
   }
 
   /// \warning casting to uint32_t
-  ByteValue(std::vector<char> &v):Internal(v),Length((uint32_t)v.size()) {}
+  ByteValue(std::vector<char> &v):
+    Internal(nullptr),InternalSize(0),Arena(nullptr),InternalFromArena(false),Length((uint32_t)v.size()) {
+    ResizeInternal(v.size());
+    if( !v.empty() ) std::memcpy(Internal, v.data(), v.size());
+  }
+  /// The copy is allocated on the heap, even when \p val comes from a
+  /// MemoryArena
+  ByteValue(const ByteValue &val):Value(val),
+    Internal(nullptr),InternalSize(0),Arena(nullptr),InternalFromArena(false),Length(val.Length) {
+    ResizeInternal(val.InternalSize);
+    if( InternalSize ) std::memcpy(Internal, val.Internal, InternalSize);
+  }
   //ByteValue(std::ostringstream const &os) {
   //  (void)os;
   //   gdcm_assert(0); // TODO
   //}
   ~ByteValue() override {
-    Internal.clear();
+    FreeInternal();
   }
 
+#ifndef SWIG
+  /// Create a ByteValue. When \p arena is set, the object and its (small)
+  /// value are allocated from \p arena, which stays alive as long as the
+  /// ByteValue does.
+  static ByteValue *New(MemoryArena *arena);
+
+  // every ByteValue records where it was allocated, see New
+  static void *operator new(size_t size);
+  static void operator delete(void *p);
+#endif
+
   // When 'dumping' dicom file we still have some information from
   // Either the VR: eg LO (private tag)
   void PrintASCII(std::ostream &os, VL maxlength ) const;
@@ -72,8 +95,8 @@ public:
 
   bool IsEmpty() const {
 #if 0
-    if( Internal.empty() ) gdcm_assert( Length == 0 );
-    return Internal.empty();
+    if( !InternalSize ) gdcm_assert( Length == 0 );
+    return !InternalSize;
 #else
   return Length == 0;
 #endif
@@ -84,57 +107,60 @@ public:
   // Does a reallocation
   void SetLength(VL vl) override;
 
-  operator const std::vector<char>& () const { return Internal; }
+  operator std::vector<char> () const { return std::vector<char>(Internal, Internal + InternalSize); }
 
   ByteValue &operator=(const ByteValue &val) {
-    Internal = val.Internal;
-    Length = val.Length;
+    if( this != &val )
+      {
+      ResizeInternal(val.InternalSize);
+      if( InternalSize ) std::memcpy(Internal, val.Internal, InternalSize);
+      Length = val.Length;
+      }
     return *this;
     }
 
   bool operator==(const ByteValue &val) const {
     if( Length != val.Length )
       return false;
-    if( Internal == val.Internal )
+    if( InternalSize == val.InternalSize
+      && (!InternalSize || std::memcmp(Internal, val.Internal, InternalSize) == 0) )
       return true;
     return false;
     }
   bool operator==(const Value &val) const override
     {
     const ByteValue &bv = dynamic_cast<const ByteValue&>(val);
-    return Length == bv.Length && Internal == bv.Internal;
+    return *this == bv;
     }
 
   void Append(ByteValue const & bv);
 
   void Clear() override {
-    Internal.clear();
+    FreeInternal();
   }
   // Use that only if you understand what you are doing
   const char *GetPointer() const {
-    if(!Internal.empty()) return &Internal[0];
+    if(InternalSize) return Internal;
     return nullptr;
   }
   // Use that only if you really understand what you are doing
   const void *GetVoidPointer() const {
-    if(!Internal.empty()) return &Internal[0];
+    if(InternalSize) return Internal;
     return nullptr;
   }
   void *GetVoidPointer() {
-    if(!Internal.empty()) return &Internal[0];
+    if(InternalSize) return Internal;
     return nullptr;
   }
   void Fill(char c) {
-    //if( Internal.empty() ) return;
-    std::vector<char>::iterator it = Internal.begin();
-    for(; it != Internal.end(); ++it) *it = c;
+    if( InternalSize ) std::memset(Internal, c, InternalSize);
   }
   bool GetBuffer(char *buffer, unsigned long length) const;
   bool WriteBuffer(std::ostream &os) const {
     if( Length ) {
-      //gdcm_assert( Internal.size() <= Length );
-      gdcm_assert( !(Internal.size() % 2) );
-      os.write(&Internal[0], Internal.size() );
+      //gdcm_assert( InternalSize <= Length );
+      gdcm_assert( !(InternalSize % 2) );
+      os.write(Internal, InternalSize );
       }
     return true;
   }
@@ -142,16 +168,16 @@ public:
   template <typename TSwap, typename TType>
   std::istream &Read(std::istream &is, bool readvalues = true) {
     // If Length is odd we have detected that in SetLength
-    // and calling std::vector::resize make sure to allocate *AND*
+    // and calling ResizeInternal make sure to allocate *AND*
     // initialize values to 0 so we are sure to have a \0 at the end
     // even in this case
     if(Length)
       {
       if( readvalues )
         {
-        is.read(&Internal[0], Length);
-        gdcm_assert( Internal.size() == Length || Internal.size() == Length + 1 );
-        TSwap::SwapArray((TType*)GetVoidPointer(), Internal.size() / sizeof(TType) );
+        is.read(Internal, Length);
+        gdcm_assert( InternalSize == Length || InternalSize == Length + 1 );
+        TSwap::SwapArray((TType*)GetVoidPointer(), InternalSize / sizeof(TType) );
         }
       else
         {
@@ -169,11 +195,11 @@ public:
 
   template <typename TSwap, typename TType>
   std::ostream const &Write(std::ostream &os) const {
-    gdcm_assert( !(Internal.size() % 2) );
-    if( !Internal.empty() ) {
-      //os.write(&Internal[0], Internal.size());
-      std::vector<char> copy = Internal;
-      TSwap::SwapArray((TType*)(void*)&copy[0], Internal.size() / sizeof(TType) );
+    gdcm_assert( !(InternalSize % 2) );
+    if( InternalSize ) {
+      //os.write(Internal, InternalSize);
+      std::vector<char> copy(Internal, Internal + InternalSize);
+      TSwap::SwapArray((TType*)(void*)&copy[0], InternalSize / sizeof(TType) );
       os.write(&copy[0], copy.size());
       }
     return os;
@@ -212,18 +238,18 @@ protected:
   void Print(std::ostream &os) const override {
   // This is perfectly valid to have a Length = 0 , so we cannot check
   // the length for printing
-  if( !Internal.empty() )
+  if( InternalSize )
     {
     if( IsPrintable(Length) )
       {
-      // WARNING: Internal.end() != Internal.begin()+Length
-      std::vector<char>::size_type length = Length;
-      if( Internal.back() == 0 ) --length;
-      std::copy(Internal.begin(), Internal.begin()+length,
+      // WARNING: Internal+InternalSize != Internal+Length
+      size_t length = Length;
+      if( Internal[InternalSize-1] == 0 ) --length;
+      std::copy(Internal, Internal+length,
         std::ostream_iterator<char>(os));
       }
     else
-      os << "Loaded:" << Internal.size();
+      os << "Loaded:" << InternalSize;
     }
   else
     {
@@ -241,9 +267,21 @@ friend std::ostream& operator<<(std::ostream &os,const char c);
   }
 
 private:
-  std::vector<char> Internal;
+  // Resize the buffer to \p size bytes, keeping its content; new bytes are
+  // set to zero
+  void ResizeInternal(size_t size);
+  void FreeInternal();
+
+  // Internal points to InlineBuffer, to memory from Arena or to the heap
+  char *Internal;
+  size_t InternalSize;
+  // Arena this ByteValue was allocated from (see New), if any
+  MemoryArena *Arena;
+  bool InternalFromArena;
+  // Storage of the values of up to 16 bytes
+  alignas(8) char InlineBuffer[16];
 
-  // WARNING Length IS NOT Internal.size() some *featured* DICOM
+  // WARNING Length IS NOT InternalSize some *featured* DICOM
   // implementation define odd length, we always load them as even number
   // of byte, so we need to keep the right Length
   VL Length;
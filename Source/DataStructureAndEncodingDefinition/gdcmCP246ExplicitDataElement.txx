@@ -16,6 +16,7 @@
 #define GDCMCP246EXPLICITDATAELEMENT_TXX
 
 #include "gdcmSequenceOfItems.h"
+#include "gdcmMemoryArena.h"
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmVL.h"
 #include "gdcmParseException.h"
@@ -175,7 +176,7 @@ std::istream &CP246ExplicitDataElement::ReadValue(std::istream &is, bool readval
   else
     {
     //gdcm_assert( TagField != Tag(0x7fe0,0x0010) );
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     }
   // We have the length we should be able to read the value
   ValueField->SetLength(ValueLengthField); // perform realloc
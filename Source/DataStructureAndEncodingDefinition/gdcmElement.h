@@ -21,6 +21,7 @@
 #include "gdcmByteValue.h"
 #include "gdcmDataElement.h"
 #include "gdcmSwapper.h"
+#include "gdcmDecimalString.h"
 
 #include <string>
 #include <vector>
@@ -126,23 +127,23 @@ public:
 
   DataElement GetAsDataElement() const {
     DataElement ret;
-    std::ostringstream os;
-    EncodingImplementation<VRToEncoding<TVR>::Mode>::Write(Internal,
-      GetLength(),os);
+    std::string str;
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::WriteToString(Internal,
+      GetLength(),str);
     ret.SetVR( (VR::VRType)TVR );
     gdcm_assert( ret.GetVR() != VR::SQ );
     if( (VR::VRType)VRToEncoding<TVR>::Mode == VR::VRASCII )
       {
       if( GetVR() != VR::UI )
         {
-        if( os.str().size() % 2 )
+        if( str.size() % 2 )
           {
-          os << " ";
+          str += ' ';
           }
         }
       }
-    VL::Type osStrSize = (VL::Type)os.str().size();
-    ret.SetByteValue( os.str().c_str(), osStrSize );
+    VL::Type strSize = (VL::Type)str.size();
+    ret.SetByteValue( str.c_str(), strSize );
 
     return ret;
   }
@@ -151,6 +152,11 @@ public:
     return EncodingImplementation<VRToEncoding<TVR>::Mode>::Read(Internal,
       GetLength(),_is);
     }
+  /// Same as Read, from the \p len bytes of \p buffer (eg. a string value)
+  void Read(const char *buffer, size_t len) {
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadFromBuffer(Internal,
+      GetLength(),buffer,len);
+    }
   void Write(std::ostream &_os) const {
     return EncodingImplementation<VRToEncoding<TVR>::Mode>::Write(Internal,
       GetLength(),_os);
@@ -162,11 +168,8 @@ public:
     const ByteValue *bv = dynamic_cast<const ByteValue*>(&v);
     if( bv ) {
       //memcpy(Internal, bv->GetPointer(), bv->GetLength());
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::Read(Internal,
-        GetLength(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadFromBuffer(Internal,
+        GetLength(),bv->GetPointer(),bv->GetLength());
     }
   }
 protected:
@@ -174,11 +177,8 @@ protected:
     const ByteValue *bv = dynamic_cast<const ByteValue*>(&v);
     gdcm_assert( bv ); // That would be bad...
     //memcpy(Internal, bv->GetPointer(), bv->GetLength());
-    std::stringstream ss;
-    std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-    ss.str( s );
-    EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwap(Internal,
-      GetLength(),ss);
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwapFromBuffer(Internal,
+      GetLength(),bv->GetPointer(),bv->GetLength());
   }
 };
 
@@ -261,8 +261,104 @@ public:
       _os << "\\" << data[i];
       }
     }
+
+  // Same as Read/ReadComputeLength/Write, on the content of a value instead
+  // of a stream. DS and IS values are converted without iostreams, see the
+  // specializations below.
+  template<typename T>
+  static inline void ReadFromBuffer(T* data, unsigned long length,
+                          const char *buffer, size_t len) {
+    std::stringstream ss;
+    ss.str( std::string( buffer, len ) );
+    Read(data,length,ss);
+    }
+  template<typename T>
+  static inline void ReadNoSwapFromBuffer(T* data, unsigned long length,
+                          const char *buffer, size_t len) {
+    ReadFromBuffer(data,length,buffer,len);
+    }
+  template<typename T>
+  static inline void ReadComputeLengthFromBuffer(T* data, unsigned int &length,
+                          const char *buffer, size_t len) {
+    std::stringstream ss;
+    ss.str( std::string( buffer, len ) );
+    ReadComputeLength(data,length,ss);
+    }
+  template<typename T>
+  static inline void WriteToString(const T* data, unsigned long length,
+                           std::string &str) {
+    std::ostringstream os;
+    Write(data,length,os);
+    str = os.str();
+    }
 };
 
+namespace details {
+inline const char *SkipWhiteSpaces(const char *p, const char *end) {
+  while( p != end && (*p == ' ' || (*p >= '\t' && *p <= '\r')) ) ++p;
+  return p;
+}
+// Same parsing as EncodingImplementation<VR::VRASCII>::Read on a stream
+template<typename T>
+inline void ReadDecimalStrings(T* data, unsigned long length,
+  const char *p, const char *end) {
+  for(unsigned long i=0; i<length; ++i) {
+    if( i ) {
+      // Get the separator in between the values
+      p = SkipWhiteSpaces(p, end);
+      if( p == end ) return;
+      ++p;
+      }
+    p = SkipWhiteSpaces(p, end);
+    if( p == end ) return;
+    p = DecimalString::Parse(p, end, data[i]);
+    if( !p ) return;
+    }
+}
+// Same parsing as EncodingImplementation<VR::VRASCII>::ReadComputeLength
+template<typename T>
+inline void ReadComputeLengthDecimalStrings(T* data, unsigned int &length,
+  const char *p, const char *end) {
+  length = 0;
+  for(;;) {
+    p = SkipWhiteSpaces(p, end);
+    T &value = data[length++];
+    if( p == end ) return;
+    const char *next = DecimalString::Parse(p, end, value);
+    // an empty value reads as 0, eg. "1\\\\3"
+    if( next ) p = SkipWhiteSpaces(next, end);
+    if( p == end || *p != '\\' ) return;
+    ++p;
+    }
+}
+template<typename T>
+inline void WriteDecimalStrings(const T* data, unsigned long length,
+  std::string &str) {
+  str.clear();
+  char buf[16+1];
+  for(unsigned long i=0; i<length; ++i) {
+    if( i ) str += '\\';
+    str.append( buf, DecimalString::Format(data[i], buf) );
+    }
+}
+} // end namespace details
+
+template<> inline void EncodingImplementation<VR::VRASCII>::ReadFromBuffer(double* data, unsigned long length, const char *buffer, size_t len) {
+  details::ReadDecimalStrings(data, length, buffer, buffer + len);
+}
+template<> inline void EncodingImplementation<VR::VRASCII>::ReadFromBuffer(int32_t* data, unsigned long length, const char *buffer, size_t len) {
+  details::ReadDecimalStrings(data, length, buffer, buffer + len);
+}
+template<> inline void EncodingImplementation<VR::VRASCII>::ReadComputeLengthFromBuffer(double* data, unsigned int &length, const char *buffer, size_t len) {
+  details::ReadComputeLengthDecimalStrings(data, length, buffer, buffer + len);
+}
+template<> inline void EncodingImplementation<VR::VRASCII>::ReadComputeLengthFromBuffer(int32_t* data, unsigned int &length, const char *buffer, size_t len) {
+  details::ReadComputeLengthDecimalStrings(data, length, buffer, buffer + len);
+}
+template<> inline void EncodingImplementation<VR::VRASCII>::WriteToString(const int32_t* data, unsigned long length, std::string &str) {
+  details::WriteDecimalStrings(data, length, str);
+}
+
 //#define VRDS16ILLEGAL
 
 #ifdef VRDS16ILLEGAL
@@ -280,144 +376,6 @@ std::string to_string ( Float data ) {
     throw "Impossible Conversion"; // should not happen ...
   }
 }
-#else
-// http://stackoverflow.com/questions/32631178/writing-ieee-754-1985-double-as-ascii-on-a-limited-16-bytes-string
-
-static inline void clean(char *mant) {
-  char *ix = mant + strlen(mant) - 1;
-  while(('0' == *ix) && (ix > mant)) {
-    *ix-- = '\0';
-  }
-  if ('.' == *ix) {
-    *ix = '\0';
-  }
-}
-
-static int add1(char *buf, int n) {
-  if (n < 0) return 1;
-  if (buf[n] == '9') {
-    buf[n] = '0';
-    return add1(buf, n-1);
-  }
-  else {
-    buf[n] = (char)(buf[n] + 1);
-  }
-  return 0;
-}
-
-static int doround(char *buf, unsigned int n) {
-  char c;
-  if (n >= strlen(buf)) return 0;
-  c = buf[n];
-  buf[n] = 0;
-  if ((c >= '5') && (c <= '9')) return add1(buf, n-1);
-  return 0;
-}
-
-#if defined(_MSC_VER) && (_MSC_VER < 1900)
-#define snprintf _snprintf
-#endif
-
-static int roundat(char *buf, size_t bufLen, unsigned int i, int iexp) {
-  if (doround(buf, i) != 0) {
-    iexp += 1;
-    switch(iexp) {
-    case -2:
-      strcpy(buf, ".01");
-      break;
-    case -1:
-      strcpy(buf, ".1");
-      break;
-    case 0:
-      strcpy(buf, "1.");
-      break;
-    case 1:
-      strcpy(buf, "10");
-      break;
-    case 2:
-      strcpy(buf, "100");
-      break;
-    default:
-      snprintf(buf, bufLen, "1e%d", iexp);
-    }
-    return 1;
-  }
-  return 0;
-}
-
-template < typename Float >
-static void x16printf(char *buf, int size, Float f) {
-  char line[40];
-  char *mant = line + 1;
-  int iexp, lexp, i;
-  char exp[6];
-
-  if (f < 0) {
-    f = -f;
-    size -= 1;
-    *buf++ = '-';
-  }
-  snprintf(line, sizeof(line), "%1.16e", f);
-  if (line[0] == '-') {
-    f = -f;
-    size -= 1;
-    *buf++ = '-';
-    snprintf(line, sizeof(line), "%1.16e", f);
-  }
-  *mant = line[0];
-  i = (int)strcspn(mant, "eE");
-  mant[i] = '\0';
-  iexp = (int)strtol(mant + i + 1, nullptr, 10);
-  lexp = snprintf(exp, sizeof(exp), "e%d", iexp);
-  if ((iexp >= size) || (iexp < -3)) {
-    i = roundat(mant, sizeof(line) - 1, size - 1 -lexp, iexp);
-    if(i == 1) {
-      strcpy(buf, mant);
-      return;
-    }
-    buf[0] = mant[0];
-    buf[1] = '.';
-    strncpy(buf + i + 2, mant + 1, size - 2 - lexp);
-    buf[size-lexp] = 0;
-    clean(buf);
-    strcat(buf, exp);
-  }
-  else if (iexp >= size - 2) {
-    roundat(mant, sizeof(line) - 1, iexp + 1, iexp);
-    strcpy(buf, mant);
-  }
-  else if (iexp >= 0) {
-    i = roundat(mant, sizeof(line) - 1, size - 1, iexp);
-    if (i == 1) {
-      strcpy(buf, mant);
-      return;
-    }
-    memcpy(buf, mant, iexp + 1);
-    buf[iexp + 1] = '.';
-    strncpy(buf + iexp + 2, mant + iexp + 1, size - iexp - 1);
-    buf[size] = 0;
-    clean(buf);
-  }
-  else {
-    int j;
-    i = roundat(mant, sizeof(line) - 1, size + 1 + iexp, iexp);
-    if (i == 1) {
-      strcpy(buf, mant);
-      return;
-    }
-    buf[0] = '.';
-    for(j=0; j< -1 - iexp; j++) {
-      buf[j+1] = '0';
-    }
-    memcpy(buf - iexp, mant, size + 1 + iexp);
-    buf[size] = 0;
-    clean(buf);
-  }
-}
-#if defined(_MSC_VER) && (_MSC_VER < 1900)
-#undef snprintf
-#endif
-
 #endif
 
 template<> inline void EncodingImplementation<VR::VRASCII>::Write(const double* data, unsigned long length, std::ostream &_os)  {
@@ -427,21 +385,27 @@ template<> inline void EncodingImplementation<VR::VRASCII>::Write(const double*
 #ifdef VRDS16ILLEGAL
     _os << to_string(data[0]);
 #else
+    // At most 16 bytes per value, see DecimalString::Format
     char buf[16+1];
-    x16printf(buf, 16, data[0]);
-    _os << buf;
+    _os.write(buf, DecimalString::Format(data[0], buf));
 #endif
     for(unsigned long i=1; i<length; ++i) {
       gdcm_assert( _os );
 #ifdef VRDS16ILLEGAL
       _os << "\\" << to_string(data[i]);
 #else
-      x16printf(buf, 16, data[i]);
-      _os << "\\" << buf;
+      _os << "\\";
+      _os.write(buf, DecimalString::Format(data[i], buf));
 #endif
       }
     }
 
+#ifndef VRDS16ILLEGAL
+template<> inline void EncodingImplementation<VR::VRASCII>::WriteToString(const double* data, unsigned long length, std::string &str) {
+  details::WriteDecimalStrings(data, length, str);
+}
+#endif
+
 
 // Implementation to perform binary read and write
 // TODO rewrite operation so that either:
@@ -515,6 +479,42 @@ public:
     //ByteSwap<T>::SwapRangeFromSwapCodeIntoSystem((T*)data,
     //  _os.GetSwapCode(), length);
   }
+
+  // Same as Read/ReadComputeLength/Write, on the content of a value instead
+  // of a stream
+  template<typename T>
+  static inline void ReadComputeLengthFromBuffer(T* data, unsigned int &length,
+    const char *buffer, size_t len) {
+    gdcm_assert( data );
+    length /= (unsigned int)sizeof(T);
+    const size_t size = length * sizeof(T);
+    if( len ) memcpy( (void*)data, buffer, size < len ? size : len );
+  }
+  template<typename T>
+  static inline void ReadNoSwapFromBuffer(T* data, unsigned long length,
+    const char *buffer, size_t len) {
+    gdcm_assert( data );
+    gdcm_assert( length );
+    const size_t size = length * sizeof(T);
+    if( len ) memcpy( (void*)data, buffer, size < len ? size : len );
+  }
+  template<typename T>
+  static inline void ReadFromBuffer(T* data, unsigned long length,
+    const char *buffer, size_t len) {
+    ReadNoSwapFromBuffer(data,length,buffer,len);
+    SwapperNoOp::SwapArray(data,length);
+  }
+  template<typename T>
+  static inline void WriteToString(const T* data, unsigned long length,
+    std::string &str) {
+    gdcm_assert( data );
+    gdcm_assert( length );
+    str.resize( length * sizeof(T) );
+    for(unsigned long i=0; i<length;++i) {
+      const T swappedData = SwapperNoOp::Swap(data[i]);
+      memcpy( &str[i * sizeof(T)], &swappedData, sizeof(T) );
+    }
+  }
 };
 
 // For particular case for ASCII string
@@ -667,11 +667,8 @@ public:
       }
     else
       {
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::Read(Internal,
-        GetLength(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadFromBuffer(Internal,
+        GetLength(),bv->GetPointer(),bv->GetLength());
       }
   }
   void SetFromDataElement(DataElement const &de) {
@@ -711,6 +708,12 @@ public:
     EncodingImplementation<VRToEncoding<TVR>::Mode>::Read(Internal,
       GetLength(),_is);
     }
+  /// Same as Read, from the \p len bytes of \p buffer (eg. a string value)
+  void Read(const char *buffer, size_t len) {
+    if( !Internal ) return;
+    EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadFromBuffer(Internal,
+      GetLength(),buffer,len);
+    }
   //void ReadComputeLength(std::istream &_is) {
   //  if( !Internal ) return;
   //  EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadComputeLength(Internal,
@@ -727,21 +730,21 @@ public:
     gdcm_assert( ret.GetVR() != VR::SQ );
     if( Internal )
       {
-      std::ostringstream os;
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::Write(Internal,
-        GetLength(),os);
+      std::string str;
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::WriteToString(Internal,
+        GetLength(),str);
       if( (VR::VRType)VRToEncoding<TVR>::Mode == VR::VRASCII )
         {
         if( GetVR() != VR::UI )
           {
-          if( os.str().size() % 2 )
+          if( str.size() % 2 )
             {
-            os << " ";
+            str += ' ';
             }
           }
         }
-      VL::Type osStrSize = (VL::Type)os.str().size();
-      ret.SetByteValue( os.str().c_str(), osStrSize );
+      VL::Type strSize = (VL::Type)str.size();
+      ret.SetByteValue( str.c_str(), strSize );
       }
     return ret;
   }
@@ -772,11 +775,8 @@ protected:
       }
     else
       {
-      std::stringstream ss;
-      std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-      ss.str( s );
-      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwap(Internal,
-        GetLength(),ss);
+      EncodingImplementation<VRToEncoding<TVR>::Mode>::ReadNoSwapFromBuffer(Internal,
+        GetLength(),bv->GetPointer(),bv->GetLength());
       }
   }
 
@@ -15,6 +15,7 @@
 #define GDCMEXPLICITDATAELEMENT_TXX
 
 #include "gdcmSequenceOfItems.h"
+#include "gdcmMemoryArena.h"
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmVL.h"
 #include "gdcmParseException.h"
@@ -83,7 +84,7 @@ std::istream &ExplicitDataElement::ReadPreValue(std::istream &is)
     is.seekg( -4, std::ios::cur );
     TagField = Tag(0x7fe0,0x0010);
     VRField = VR::OW;
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     std::streampos s = is.tellg();
     is.seekg( 0, std::ios::end);
     std::streampos e = is.tellg();
@@ -236,7 +237,7 @@ std::istream &ExplicitDataElement::ReadValue(std::istream &is, bool readvalues)
   else
     {
     //gdcm_assert( TagField != Tag(0x7fe0,0x0010) );
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     }
   // We have the length we should be able to read the value
   this->SetValueFieldLength( ValueLengthField, readvalues );
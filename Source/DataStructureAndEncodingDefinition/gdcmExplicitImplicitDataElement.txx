@@ -17,6 +17,7 @@
 #include "gdcmExplicitImplicitDataElement.h"
 
 #include "gdcmSequenceOfItems.h"
+#include "gdcmMemoryArena.h"
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmVL.h"
 #include "gdcmExplicitDataElement.h"
@@ -85,7 +86,7 @@ std::istream &ExplicitImplicitDataElement::ReadPreValue(std::istream &is)
     is.seekg( -4, std::ios::cur );
     TagField = Tag(0x7fe0,0x0010);
     VRField = VR::OW;
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     std::streampos s = is.tellg();
     is.seekg( 0, std::ios::end);
     std::streampos e = is.tellg();
@@ -180,7 +181,7 @@ std::istream &ExplicitImplicitDataElement::ReadPreValue(std::istream &is)
     {
     if( true /*ValueLengthField < 8 */ )
       {
-      ValueField = new ByteValue;
+      ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
       }
     else
       {
@@ -244,7 +245,7 @@ std::istream &ExplicitImplicitDataElement::ReadPreValue(std::istream &is)
 #endif
       else
         {
-        ValueField = new ByteValue;
+        ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
         }
       }
     }
@@ -397,7 +398,7 @@ std::istream &ExplicitImplicitDataElement::ReadValue(std::istream &is, bool read
   else
     {
     //gdcm_assert( TagField != Tag(0x7fe0,0x0010) );
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     }
   // We have the length we should be able to read the value
   this->SetValueFieldLength( ValueLengthField, readvalues );
@@ -17,6 +17,8 @@
 #include "gdcmObject.h"
 #include "gdcmDataSet.h"
 #include "gdcmFileMetaInformation.h"
+#include "gdcmSmartPointer.h"
+#include "gdcmMemoryArena.h"
 
 namespace gdcm_ns
 {
@@ -62,9 +64,16 @@ public:
   /// Set Data Set
   void SetDataSet( const DataSet &ds) { DS = ds; }
 
+  /// Arena the values of the data set were allocated from, when read with
+  /// Reader::SetUseMemoryArena. The arena is released once the File and all
+  /// the values allocated from it are gone.
+  MemoryArena *GetMemoryArena() const { return Arena; }
+  void SetMemoryArena( MemoryArena *arena ) { Arena = arena; }
+
 private:
   FileMetaInformation Header;
   DataSet DS;
+  SmartPointer<MemoryArena> Arena;
 };
 //-----------------------------------------------------------------------------
 inline std::ostream& operator<<(std::ostream &os, const File &val)
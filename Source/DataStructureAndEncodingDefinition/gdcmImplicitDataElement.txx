@@ -15,6 +15,7 @@
 #define GDCMIMPLICITDATAELEMENT_TXX
 
 #include "gdcmSequenceOfItems.h"
+#include "gdcmMemoryArena.h"
 #include "gdcmValueIO.h"
 #include "gdcmSwapper.h"
 #ifdef GDCM_WORDS_BIGENDIAN
@@ -111,7 +112,7 @@ std::istream &ImplicitDataElement::ReadValue(std::istream &is, bool readvalues)
     {
     if( true /*ValueLengthField < 8 */ )
       {
-      ValueField = new ByteValue;
+      ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
       }
     else
       {
@@ -185,7 +186,7 @@ std::istream &ImplicitDataElement::ReadValue(std::istream &is, bool readvalues)
 #endif
       else
         {
-        ValueField = new ByteValue;
+        ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
         }
       }
     }
@@ -348,7 +349,7 @@ std::istream &ImplicitDataElement::ReadValueWithLength(std::istream& is, VL & le
     {
     if( true /*ValueLengthField < 8*/ )
       {
-      ValueField = new ByteValue;
+      ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
       }
     else
       {
@@ -423,7 +424,7 @@ std::istream &ImplicitDataElement::ReadValueWithLength(std::istream& is, VL & le
 #endif
       else
         {
-        ValueField = new ByteValue;
+        ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
         }
       }
     }
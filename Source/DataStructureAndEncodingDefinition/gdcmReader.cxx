@@ -19,9 +19,11 @@
 
 #include "gdcmDeflateStream.h"
 #include "gdcmSystem.h"
+#include "gdcmInstrumentation.h"
 
 #include "gdcmExplicitDataElement.h"
 #include "gdcmImplicitDataElement.h"
+#include "gdcmSequenceOfItems.h"
 
 #ifdef _MSC_VER
 #include <windows.h> // MultiByteToWideChar
@@ -35,6 +37,92 @@
 #include "gdcmVR16ExplicitDataElement.h"
 #endif
 
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+namespace
+{
+// Read only, seekable view of a memory buffer
+class MemoryStreamBuf : public std::streambuf
+{
+public:
+  MemoryStreamBuf(char *p, size_t n) { setg(p, p, p + n); }
+protected:
+  pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override
+    {
+    if( which & std::ios_base::out ) return pos_type(off_type(-1));
+    off_type cur = gptr() - eback();
+    const off_type end = egptr() - eback();
+    if( dir == std::ios_base::beg ) cur = 0;
+    else if( dir == std::ios_base::end ) cur = end;
+    if( off < -cur || off > end - cur ) return pos_type(off_type(-1));
+    setg( eback(), eback() + cur + off, egptr() );
+    return pos_type( cur + off );
+    }
+  pos_type seekpos(pos_type pos, std::ios_base::openmode which) override
+    {
+    return seekoff( off_type(pos), std::ios_base::beg, which );
+    }
+};
+
+// Inflate everything left in a seekable stream at once: the compressed
+// length is known, so the raw deflate bit stream is decoded in a single
+// inflate call instead of being pulled through a small stream buffer.
+// Return false (and leave the stream untouched) when the stream cannot
+// seek or the bit stream is invalid.
+bool InflateRemaining(std::istream &is, std::vector<char> &out)
+{
+  const std::streampos start = is.tellg();
+  if( start == std::streampos(-1) ) return false;
+  is.seekg( 0, std::ios::end );
+  const std::streampos end = is.tellg();
+  if( end == std::streampos(-1) || end < start )
+    {
+    is.clear();
+    is.seekg( start, std::ios::beg );
+    return false;
+    }
+  std::vector<char> in( (size_t)(end - start) );
+  is.seekg( start, std::ios::beg );
+  if( !in.empty() ) is.read( in.data(), (std::streamsize)in.size() );
+  z_stream strm = {};
+  if( !is || in.size() > std::numeric_limits<uInt>::max()
+    || inflateInit2( &strm, -MAX_WBITS ) != Z_OK )
+    {
+    is.clear();
+    is.seekg( start, std::ios::beg );
+    return false;
+    }
+  out.resize( std::max( in.size() * 4, (size_t)65536 ) );
+  strm.next_in = (Bytef*)in.data();
+  strm.avail_in = (uInt)in.size();
+  int ret = Z_OK;
+  while( ret == Z_OK )
+    {
+    if( strm.total_out == out.size() )
+      out.resize( out.size() * 2 );
+    const size_t avail = std::min( out.size() - (size_t)strm.total_out,
+      (size_t)std::numeric_limits<uInt>::max() );
+    strm.next_out = (Bytef*)out.data() + strm.total_out;
+    strm.avail_out = (uInt)avail;
+    ret = inflate( &strm, Z_NO_FLUSH );
+    }
+  out.resize( strm.total_out );
+  inflateEnd( &strm );
+  // Some writers do not terminate the last deflate block, what could be
+  // decoded is kept (see srwithgraphdeflated.dcm):
+  if( ret == Z_STREAM_END || (ret == Z_BUF_ERROR && strm.avail_in == 0) )
+    {
+    return true;
+    }
+  gdcmDebugMacro( "Could not inflate: " << ret );
+  is.clear();
+  is.seekg( start, std::ios::beg );
+  return false;
+}
+}
+
 
 namespace gdcm_ns
 {
@@ -43,6 +131,8 @@ Reader::Reader():F(new File)
 {
   Stream = nullptr;
   Ifstream = nullptr;
+  LazySequenceParsing = false;
+  UseMemoryArena = false;
 }
 
 Reader::~Reader()
@@ -343,6 +433,44 @@ bool Reader::InternalReadCommon(const T_Caller &caller)
     return false;
     }
   bool success = true;
+  // Sequences read from Stream are kept unparsed, until the end of this call:
+  struct LazyParsingScope
+    {
+    LazyParsingScope(std::istream &is, bool lazy):IS(is) { SequenceOfItems::SetLazyParsing(IS, lazy); }
+    ~LazyParsingScope() { SequenceOfItems::SetLazyParsing(IS, false); }
+    std::istream &IS;
+    } lazyscope( *Stream, LazySequenceParsing );
+  // Values read from Stream are allocated from the arena of the File:
+  if( UseMemoryArena && !F->GetMemoryArena() )
+    {
+    F->SetMemoryArena( new MemoryArena );
+    }
+  struct MemoryArenaScope
+    {
+    MemoryArenaScope(std::istream &is, MemoryArena *arena):IS(is) { MemoryArena::SetStreamArena(IS, arena); }
+    ~MemoryArenaScope() { MemoryArena::SetStreamArena(IS, nullptr); }
+    std::istream &IS;
+    } arenascope( *Stream, UseMemoryArena ? F->GetMemoryArena() : nullptr );
+  // Time spent and bytes consumed from Stream, when leaving this call:
+  struct InstrumentationScope
+    {
+    InstrumentationScope(std::istream &is):IS(is),Timer(Instrumentation::Read),Start(0)
+      {
+      if( Timer.IsActive() ) Start = IS.tellg();
+      }
+    ~InstrumentationScope()
+      {
+      if( !Timer.IsActive() ) return;
+      const std::ios::iostate state = IS.rdstate();
+      IS.clear();
+      const std::streamoff end = IS.tellg();
+      IS.setstate( state );
+      if( Start >= 0 && end >= Start ) Timer.SetBytes( (uint64_t)(end - Start) );
+      }
+    std::istream &IS;
+    InstrumentationTimer Timer;
+    std::streamoff Start;
+    } instrumentationscope( *Stream );
 
   try
     {
@@ -428,8 +556,21 @@ bool Reader::InternalReadCommon(const T_Caller &caller)
   // algorithm
   if( ts == TransferSyntax::DeflatedExplicitVRLittleEndian )
     {
+    std::vector<char> inflated;
+    if( InflateRemaining( is, inflated ) )
+      {
+      MemoryStreamBuf membuf( inflated.data(), inflated.size() );
+      std::istream mis( &membuf );
+      SequenceOfItems::SetLazyParsing( mis, LazySequenceParsing );
+      MemoryArena::SetStreamArena( mis, MemoryArena::GetStreamArena( is ) );
+      caller.template ReadCommon<ExplicitDataElement,SwapperNoOp>(mis);
+      return is.good();
+      }
 
-    zlib_stream::zip_istream gzis( is );
+    // Not seekable: inflate while parsing, using large buffers
+    const size_t buffersize = 65536;
+    zlib_stream::zip_istream gzis( is, -MAX_WBITS, buffersize, buffersize );
+    MemoryArena::SetStreamArena( gzis, MemoryArena::GetStreamArena( is ) );
     // FIXME: we also know in this case that we are dealing with Explicit:
     gdcm_assert( ts.GetNegociatedType() == TransferSyntax::Explicit );
     //F->GetDataSet().ReadUpToTag<ExplicitDataElement,SwapperNoOp>(gzis,tag, skiptags);
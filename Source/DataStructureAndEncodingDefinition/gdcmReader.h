@@ -87,6 +87,22 @@ public:
   /// Will only read the specified selected private tags.
   bool ReadSelectedPrivateTags(std::set<PrivateTag> const & ptags, bool readvalues = true);
 
+  /// Set/Get whether sequences are parsed lazily: their encoded items are
+  /// kept as read and only parsed when first accessed (see SequenceOfItems).
+  /// Only Explicit/Implicit VR Little/Big Endian data sets read from a
+  /// seekable stream benefit from it (Deflated data sets are inflated in
+  /// memory first when the stream is seekable). Default is off.
+  void SetLazySequenceParsing(bool lazy) { LazySequenceParsing = lazy; }
+  bool GetLazySequenceParsing() const { return LazySequenceParsing; }
+
+  /// Set/Get whether the values are allocated from a MemoryArena owned by
+  /// the File (see File::GetMemoryArena) instead of one by one from the heap.
+  /// This reduces the cost of parsing (and releasing) many headers; values
+  /// larger than MemoryArena::GetMaximumAllocationSize (eg. Pixel Data) still
+  /// come from the heap. Default is off.
+  void SetUseMemoryArena(bool use) { UseMemoryArena = use; }
+  bool GetUseMemoryArena() const { return UseMemoryArena; }
+
   /// Test whether this is a DICOM file
   /// \warning need to call either SetFileName or SetStream first
   bool CanRead() const;
@@ -120,6 +136,8 @@ private:
   TransferSyntax GuessTransferSyntax();
   std::istream *Stream;
   std::ifstream *Ifstream;
+  bool LazySequenceParsing;
+  bool UseMemoryArena;
 
   // prevent copy/move to avoid 2 ifstream leak
   Reader(const Reader &) = delete;
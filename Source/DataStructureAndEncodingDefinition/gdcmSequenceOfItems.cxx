@@ -12,12 +12,91 @@
 
 =========================================================================*/
 #include "gdcmSequenceOfItems.h"
+#include "gdcmExplicitDataElement.h"
+#include "gdcmImplicitDataElement.h"
+
+#include <sstream>
 
 namespace gdcm_ns
 {
 
+static int GetLazyParsingIndex()
+{
+  static const int index = std::ios_base::xalloc();
+  return index;
+}
+
+void SequenceOfItems::SetLazyParsing(std::istream &is, bool lazy)
+{
+  is.iword( GetLazyParsingIndex() ) = lazy ? 1 : 0;
+}
+
+bool SequenceOfItems::GetLazyParsing(std::istream &is)
+{
+  return is.iword( GetLazyParsingIndex() ) != 0;
+}
+
+void SequenceOfItems::Materialize() const
+{
+  if( !DeferredEncoding ) return;
+  SequenceOfItems *self = const_cast<SequenceOfItems*>(this);
+  const int encoding = DeferredEncoding;
+  const bool swap = DeferredSwap;
+  self->DeferredEncoding = 0;
+
+  std::stringstream ss;
+  // nested sequences are parsed on demand too:
+  SetLazyParsing( ss, true );
+  ss.write( DeferredItems.data(), (std::streamsize)DeferredItems.size() );
+  if( SequenceLengthField.IsUndefined() )
+    {
+    const Tag seqDelItem(0xfffe,0xe0dd);
+    const VL zero = 0;
+    if( swap )
+      {
+      seqDelItem.Write<SwapperDoOp>(ss);
+      zero.Write<SwapperDoOp>(ss);
+      }
+    else
+      {
+      seqDelItem.Write<SwapperNoOp>(ss);
+      zero.Write<SwapperNoOp>(ss);
+      }
+    }
+  bool ok = false;
+  try
+    {
+    if( encoding == 1 && !swap )
+      self->ReadItems<ExplicitDataElement,SwapperNoOp>(ss);
+    else if( encoding == 1 )
+      self->ReadItems<ExplicitDataElement,SwapperDoOp>(ss);
+    else if( !swap )
+      self->ReadItems<ImplicitDataElement,SwapperNoOp>(ss);
+    else
+      self->ReadItems<ImplicitDataElement,SwapperDoOp>(ss);
+    ok = !ss.fail();
+    }
+  catch( std::exception &ex )
+    {
+    gdcmErrorMacro( "Could not parse Sequence: " << ex.what() ); (void)ex;
+    }
+  catch( ... )
+    {
+    gdcmErrorMacro( "Could not parse Sequence" );
+    }
+  if( !ok )
+    {
+    // keep the encoded items, so that they are still written back as read:
+    self->Items.clear();
+    self->DeferredEncoding = encoding;
+    return;
+    }
+  self->DeferredItems.clear();
+}
+
 void SequenceOfItems::AddItem(Item const &item)
 {
+  Materialize();
   Items.push_back( item );
   if( !SequenceLengthField.IsUndefined() )
     {
@@ -36,11 +115,14 @@ Item & SequenceOfItems::AddNewUndefinedLengthItem()
 void SequenceOfItems::Clear()
 {
   Items.clear();
+  DeferredItems.clear();
+  DeferredEncoding = 0;
   gdcm_assert( SequenceLengthField.IsUndefined() );
 }
 
 bool SequenceOfItems::RemoveItemByIndex( const SizeType position )
 {
+  Materialize();
   if( position < 1 || position > Items.size() )
     {
     return false;
@@ -51,6 +133,7 @@ bool SequenceOfItems::RemoveItemByIndex( const SizeType position )
 
 Item &SequenceOfItems::GetItem(SizeType position)
 {
+  Materialize();
   if( position < 1 || position > Items.size() )
     {
     throw Exception( "Out of Range" );
@@ -60,6 +143,7 @@ Item &SequenceOfItems::GetItem(SizeType position)
 
 const Item &SequenceOfItems::GetItem(SizeType position) const
 {
+  Materialize();
   if( position < 1 || position > Items.size() )
     {
     throw Exception( "Out of Range" );
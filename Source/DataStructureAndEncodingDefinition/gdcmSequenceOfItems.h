@@ -19,10 +19,13 @@
 #include "gdcmItem.h"
 
 #include <vector>
+#include <string>
 #include <cstring> // strcmp
 
 namespace gdcm_ns
 {
+class ExplicitDataElement;
+class ImplicitDataElement;
 
 /**
  * \brief Class to represent a Sequence Of Items
@@ -35,6 +38,17 @@ namespace gdcm_ns
  * SEQUENCE OF ITEMS (VALUE REPRESENTATION SQ)
  * A Value Representation for Data Elements that contain a sequence of
  * Data Sets. Sequence of Items allows for Nested Data Sets.
+ *
+ * When the input stream was marked with SetLazyParsing (see
+ * Reader::SetLazySequenceParsing), Read only keeps the encoded items. They
+ * are parsed the first time the items are accessed (GetItem, Begin,
+ * GetNumberOfItems, ...). The element headers are walked at read time to
+ * check the structure of the items; sequences needing one of the fixes of
+ * the regular parsing (wrong lengths, unexpected tags, invalid VR) are parsed
+ * right away instead.
+ * \warning Items of a lazy sequence are only valid once parsed, use the
+ * accessors instead of the Items member. Parsing is not thread safe: the
+ * same lazy sequence should not be first accessed from several threads.
  */
 class GDCM_EXPORT SequenceOfItems : public Value
 {
@@ -44,13 +58,13 @@ public:
   typedef ItemVector::size_type SizeType;
   typedef ItemVector::iterator Iterator;
   typedef ItemVector::const_iterator ConstIterator;
-  Iterator Begin() { return Items.begin(); }
-  Iterator End() { return Items.end(); }
-  ConstIterator Begin() const { return Items.begin(); }
-  ConstIterator End() const { return Items.end(); }
+  Iterator Begin() { Materialize(); return Items.begin(); }
+  Iterator End() { Materialize(); return Items.end(); }
+  ConstIterator Begin() const { Materialize(); return Items.begin(); }
+  ConstIterator End() const { Materialize(); return Items.end(); }
 
   /// \brief constructor (UndefinedLength by default)
-  SequenceOfItems():SequenceLengthField(0xFFFFFFFF) { }
+  SequenceOfItems():DeferredEncoding(0),DeferredSwap(false),SequenceLengthField(0xFFFFFFFF) { }
   //SequenceOfItems(VL const &vl = 0xFFFFFFFF):SequenceLengthField(vl),NType(type) { }
 
   /// \brief Returns the SQ length, as read from disk
@@ -82,9 +96,9 @@ public:
   /// Index starts at 1 not 0
   bool RemoveItemByIndex( const SizeType index );
 
-  bool IsEmpty() const { return Items.empty(); }
-  SizeType GetNumberOfItems() const {  return Items.size(); }
-  void SetNumberOfItems(SizeType n) {  Items.resize(n); }
+  bool IsEmpty() const { Materialize(); return Items.empty(); }
+  SizeType GetNumberOfItems() const { Materialize(); return Items.size(); }
+  void SetNumberOfItems(SizeType n) { Materialize(); Items.resize(n); }
 
   /* WARNING: first item is #1 (see DICOM standard)
    *  Each Item shall be implicitly assigned an ordinal position starting with the value 1 for the
@@ -97,13 +111,37 @@ public:
   SequenceOfItems &operator=(const SequenceOfItems &val) {
     SequenceLengthField = val.SequenceLengthField;
     Items = val.Items;
+    DeferredItems = val.DeferredItems;
+    DeferredEncoding = val.DeferredEncoding;
+    DeferredSwap = val.DeferredSwap;
     return *this;
     }
 
+  /// Mark/unmark is so that the sequences read from it are only parsed on
+  /// first access
+  static void SetLazyParsing(std::istream &is, bool lazy);
+  static bool GetLazyParsing(std::istream &is);
+
+  /// Return whether the items were not parsed yet
+  bool IsDeferred() const { return DeferredEncoding != 0; }
+
   template <typename TDE, typename TSwap>
   std::istream &Read(std::istream &is, bool readvalues = true)
     {
     (void)readvalues;
+    const int encoding = GetDeferredEncoding( (const TDE*)nullptr );
+    if( encoding && GetLazyParsing( is ) && ReadDeferred<TSwap>( is, encoding == 1 ) )
+      {
+      DeferredEncoding = encoding;
+      DeferredSwap = IsSwapped( (const TSwap*)nullptr );
+      return is;
+      }
+    return ReadItems<TDE,TSwap>( is );
+    }
+
+  template <typename TDE, typename TSwap>
+  std::istream &ReadItems(std::istream &is)
+    {
     const Tag seqDelItem(0xfffe,0xe0dd);
     if( SequenceLengthField.IsUndefined() )
       {
@@ -200,10 +238,19 @@ public:
   template <typename TDE,typename TSwap>
   std::ostream const &Write(std::ostream &os) const
     {
-    typename ItemVector::const_iterator it = Items.begin();
-    for(;it != Items.end(); ++it)
+    if( IsDeferred() && IsDeferredEncoding<TDE,TSwap>() )
       {
-      it->Write<TDE,TSwap>(os);
+      // items were never parsed, write them back as read
+      os.write( DeferredItems.data(), (std::streamsize)DeferredItems.size() );
+      }
+    else
+      {
+      Materialize();
+      typename ItemVector::const_iterator it = Items.begin();
+      for(;it != Items.end(); ++it)
+        {
+        it->Write<TDE,TSwap>(os);
+        }
       }
     if( SequenceLengthField.IsUndefined() )
       {
@@ -219,6 +266,7 @@ public:
 
 //protected:
   void Print(std::ostream &os) const override {
+    Materialize();
     os << "\t(" << SequenceLengthField << ")\n";
     ItemVector::const_iterator it =
       Items.begin();
@@ -244,11 +292,40 @@ public:
   bool operator==(const Value &val) const override
     {
     const SequenceOfItems &sqi = dynamic_cast<const SequenceOfItems&>(val);
+    Materialize();
+    sqi.Materialize();
     return SequenceLengthField == sqi.SequenceLengthField &&
       Items == sqi.Items;
     }
 
 private:
+  // Encoding of the items which can be kept unparsed: 1 explicit, 2 implicit
+  static int GetDeferredEncoding(const ExplicitDataElement *) { return 1; }
+  static int GetDeferredEncoding(const ImplicitDataElement *) { return 2; }
+  static int GetDeferredEncoding(const void *) { return 0; }
+  static bool IsSwapped(const SwapperDoOp *) { return true; }
+  static bool IsSwapped(const void *) { return false; }
+  template <typename TDE,typename TSwap>
+  bool IsDeferredEncoding() const {
+    return GetDeferredEncoding( (const TDE*)nullptr ) == DeferredEncoding
+      && IsSwapped( (const TSwap*)nullptr ) == DeferredSwap;
+  }
+  template <typename TSwap>
+  bool ReadDeferred(std::istream &is, bool explicitvr);
+  template <typename TSwap>
+  static void SkipItems(std::istream &is, bool explicitvr, std::streampos end,
+    bool fragments);
+  template <typename TSwap>
+  static void SkipNestedDataSet(std::istream &is, bool explicitvr, std::streampos end);
+  /// Parse the deferred items, if any. On failure the items stay deferred,
+  /// and are written back unchanged.
+  void Materialize() const;
+
+  /// \brief Encoded items, not parsed yet (Sequence Delimitation Item excluded)
+  std::string DeferredItems;
+  int DeferredEncoding;
+  bool DeferredSwap;
+
 public:
   /// \brief Total length of the Sequence (or 0xffffffff) if undefined
   VL SequenceLengthField;
@@ -20,11 +20,19 @@ namespace gdcm_ns
 template <typename TDE>
 VL SequenceOfItems::ComputeLength() const
 {
-  typename ItemVector::const_iterator it = Items.begin();
   VL length = 0;
-  for(;it != Items.end(); ++it)
+  if( IsDeferred() && GetDeferredEncoding( (const TDE*)nullptr ) == DeferredEncoding )
     {
-    length += it->template GetLength<TDE>();
+    length = (uint32_t)DeferredItems.size();
+    }
+  else
+    {
+    Materialize();
+    typename ItemVector::const_iterator it = Items.begin();
+    for(;it != Items.end(); ++it)
+      {
+      length += it->template GetLength<TDE>();
+      }
     }
   if( SequenceLengthField.IsUndefined() )
     {
@@ -37,6 +45,120 @@ VL SequenceOfItems::ComputeLength() const
   return length;
 }
 
+// Walk the items up to (and including) the Sequence Delimitation Item, or up
+// to end for a defined length. Any structure the eager parsing would have to
+// fix (wrong lengths, unexpected tags, invalid VR) throws an Exception.
+template <typename TSwap>
+void SequenceOfItems::SkipItems(std::istream &is, bool explicitvr,
+  std::streampos end, bool fragments)
+{
+  const Tag itemStart(0xfffe, 0xe000);
+  const Tag seqDelItem(0xfffe,0xe0dd);
+  const bool undefined = end == std::streampos(-1);
+  Tag t;
+  VL vl;
+  while( undefined || is.tellg() < end )
+    {
+    if( !t.Read<TSwap>(is) || !vl.Read<TSwap>(is) ) break;
+    if( undefined && t == seqDelItem ) return;
+    if( t != itemStart ) throw Exception( "Unexpected Tag in Sequence" );
+    if( fragments && !vl.IsUndefined() )
+      is.seekg( (std::streamoff)vl, std::ios::cur );
+    else if( fragments )
+      throw Exception( "Undefined length Fragment" );
+    else if( vl.IsUndefined() )
+      SkipNestedDataSet<TSwap>(is, explicitvr, std::streampos(-1));
+    else
+      SkipNestedDataSet<TSwap>(is, explicitvr, is.tellg() + (std::streamoff)vl);
+    }
+  if( !undefined && is && is.tellg() == end ) return;
+  throw Exception( undefined ? "No Sequence Delimitation Item" : "Wrong Sequence Length" );
+}
+
+// Walk the data elements up to (and including) the Item Delimitation Item,
+// or up to end for a defined length Item
+template <typename TSwap>
+void SequenceOfItems::SkipNestedDataSet(std::istream &is, bool explicitvr,
+  std::streampos end)
+{
+  const Tag itemDelItem(0xfffe,0xe00d);
+  const Tag pixeldata(0x7fe0,0x0010);
+  const bool undefined = end == std::streampos(-1);
+  Tag t;
+  while( undefined || is.tellg() < end )
+    {
+    if( !t.Read<TSwap>(is) ) break;
+    VL vl;
+    VR vr = VR::INVALID;
+    if( t == itemDelItem || !explicitvr )
+      {
+      vl.Read<TSwap>(is);
+      }
+    else
+      {
+      vr.Read(is); // throws on invalid VR
+      if( VR::GetLength(vr) == 4 )
+        vl.Read<TSwap>(is);
+      else
+        vl.template Read16<TSwap>(is);
+      }
+    if( !is ) break;
+    if( t == itemDelItem )
+      {
+      if( undefined ) return;
+      throw Exception( "Item Delimitation Item in defined length Item" );
+      }
+    if( vl.IsUndefined() )
+      {
+      // Sequence, encapsulated Pixel Data or cp246 UN (Implicit VR)
+      const bool fragments = explicitvr ? vr != VR::SQ && vr != VR::UN : t == pixeldata;
+      SkipItems<TSwap>(is, explicitvr && vr != VR::UN, std::streampos(-1), fragments);
+      }
+    else if( explicitvr && vr == VR::SQ )
+      SkipItems<TSwap>(is, explicitvr, is.tellg() + (std::streamoff)vl, false);
+    else
+      is.seekg( (std::streamoff)vl, std::ios::cur );
+    }
+  if( !undefined && is && is.tellg() == end ) return;
+  throw Exception( undefined ? "No Item Delimitation Item" : "Wrong Item Length" );
+}
+
+template <typename TSwap>
+bool SequenceOfItems::ReadDeferred(std::istream &is, bool explicitvr)
+{
+  const std::streampos start = is.tellg();
+  if( start == std::streampos(-1) ) return false; // not seekable
+  const bool undefined = SequenceLengthField.IsUndefined();
+  try
+    {
+    // Check the structure first, so that broken sequences go through the
+    // regular (eager) code path and its fixes:
+    SkipItems<TSwap>(is, explicitvr,
+      undefined ? std::streampos(-1) : start + (std::streamoff)SequenceLengthField, false);
+    }
+  catch( Exception &ex )
+    {
+    gdcmDebugMacro( ex.what() ); (void)ex;
+    is.clear();
+    is.seekg( start, std::ios::beg );
+    return false;
+    }
+  // do not keep the Sequence Delimitation Item
+  const std::streamoff len = is.tellg() - start - (undefined ? 8 : 0);
+  DeferredItems.resize( (size_t)len );
+  is.seekg( start, std::ios::beg );
+  if( len && !is.read( &DeferredItems[0], len ) )
+    {
+    is.clear();
+    is.seekg( start, std::ios::beg );
+    DeferredItems.clear();
+    return false;
+    }
+  if( undefined )
+    is.seekg( 8, std::ios::cur );
+  return true;
+}
+
 } // end namespace gdcm_ns
 
 #endif // GDCMSEQUENCEOFITEMS_TXX
@@ -16,6 +16,7 @@
 #define GDCMUNEXPLICITDATAELEMENT_TXX
 
 #include "gdcmSequenceOfItems.h"
+#include "gdcmMemoryArena.h"
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmVL.h"
 #include "gdcmParseException.h"
@@ -192,7 +193,7 @@ std::istream &UNExplicitDataElement::ReadValue(std::istream &is, bool readvalues
   else
     {
     //gdcm_assert( TagField != Tag(0x7fe0,0x0010) );
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     }
   // We have the length we should be able to read the value
   ValueField->SetLength(ValueLengthField); // perform realloc
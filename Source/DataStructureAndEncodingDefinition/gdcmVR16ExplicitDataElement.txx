@@ -15,6 +15,7 @@
 #define GDCMVR16EXPLICITDATAELEMENT_TXX
 
 #include "gdcmSequenceOfItems.h"
+#include "gdcmMemoryArena.h"
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmVL.h"
 #include "gdcmParseException.h"
@@ -240,7 +241,7 @@ std::istream &VR16ExplicitDataElement::ReadValue(std::istream &is, bool readvalu
   else
     {
     //gdcm_assert( TagField != Tag(0x7fe0,0x0010) );
-    ValueField = new ByteValue;
+    ValueField = ByteValue::New( MemoryArena::GetStreamArena(is) );
     }
   // We have the length we should be able to read the value
   ValueField->SetLength(ValueLengthField); // perform realloc
@@ -15,6 +15,7 @@
 #include "gdcmFileMetaInformation.h"
 #include "gdcmDataSet.h"
 #include "gdcmTrace.h"
+#include "gdcmInstrumentation.h"
 
 #include "gdcmExplicitDataElement.h"
 #include "gdcmImplicitDataElement.h"
@@ -26,11 +27,17 @@
 #include "gdcmParseException.h"
 
 #include "gdcmDeflateStream.h"
+#include "gdcmParallelFor.h"
+
+#include <streambuf>
+#include <vector>
+#include <algorithm>
 
 namespace gdcm
 {
 
-Writer::Writer():Stream(nullptr),Ofstream(nullptr),F(new File),CheckFileMetaInformation(true),WriteDataSetOnly(false)
+Writer::Writer():Stream(nullptr),Ofstream(nullptr),F(new File),CheckFileMetaInformation(true),WriteDataSetOnly(false),
+  PixelDataBuffer(nullptr),PixelDataLength(0),PixelDataVR(VR::OW),NumberOfThreads(1)
 {
 }
 
@@ -55,6 +62,8 @@ bool Writer::Write()
   std::ostream &os = *Stream;
   FileMetaInformation &Header = F->GetHeader();
   DataSet &DS = F->GetDataSet();
+  InstrumentationTimer timer( Instrumentation::Write );
+  const std::streamoff start = timer.IsActive() ? (std::streamoff)os.tellp() : 0;
 
   if( DS.IsEmpty() )
     {
@@ -62,28 +71,16 @@ bool Writer::Write()
     return false;
     }
 
-  // Should I check that 0002,0002 / 0008,0016 and 0002,0003 / 0008,0018 match ?
+  if( PixelDataBuffer )
+    {
+    return WriteWithPixelDataBuffer();
+    }
 
   if( !WriteDataSetOnly )
     {
-    if( CheckFileMetaInformation )
+    if( !WriteFileMetaInformation(os) )
       {
-      FileMetaInformation duplicate( Header );
-      try
-        {
-        duplicate.FillFromDataSet( DS );
-        }
-      catch(gdcm::Exception &ex)
-        {
-        (void)ex;  //to avoid unreferenced variable warning on release
-        gdcmErrorMacro( "Could not recreate the File Meta Header, please report:" << ex.what() );
-        return false;
-        }
-      duplicate.Write(os);
-      }
-    else
-      {
-      Header.Write(os);
+      return false;
       }
     }
 
@@ -96,17 +93,8 @@ bool Writer::Write()
 
   if( ts == TransferSyntax::DeflatedExplicitVRLittleEndian )
     {
-    //gzostream gzos(os.rdbuf());
-      try {
-      zlib_stream::zip_ostream gzos( os );
-      gdcm_assert( ts.GetNegociatedType() == TransferSyntax::Explicit );
-      DS.Write<ExplicitDataElement,SwapperNoOp>(gzos);
-      //gzos.flush();
-      } catch (...){
-		  return false;
-	  }
-
-    return !os.fail();
+    gdcm_assert( ts.GetNegociatedType() == TransferSyntax::Explicit );
+    return WriteDeflatedDataSet(os);
     }
 
   try
@@ -151,6 +139,287 @@ bool Writer::Write()
     return false;
     }
 
+  if( timer.IsActive() )
+    {
+    const std::streamoff end = os.tellp();
+    if( start >= 0 && end >= start ) timer.SetBytes( (uint64_t)(end - start) );
+    }
+  os.flush();
+  if (Ofstream)
+    {
+    Ofstream->close();
+    }
+
+  return !os.fail();
+}
+
+bool Writer::WriteFileMetaInformation(std::ostream &os)
+{
+  FileMetaInformation &Header = F->GetHeader();
+  const DataSet &DS = F->GetDataSet();
+  // Should I check that 0002,0002 / 0008,0016 and 0002,0003 / 0008,0018 match ?
+  if( CheckFileMetaInformation )
+    {
+    FileMetaInformation duplicate( Header );
+    try
+      {
+      duplicate.FillFromDataSet( DS );
+      }
+    catch(gdcm::Exception &ex)
+      {
+      (void)ex;  //to avoid unreferenced variable warning on release
+      gdcmErrorMacro( "Could not recreate the File Meta Header, please report:" << ex.what() );
+      return false;
+      }
+    duplicate.Write(os);
+    }
+  else
+    {
+    Header.Write(os);
+    }
+  return true;
+}
+
+namespace {
+// Append everything written to a std::vector<char>
+class VectorStreamBuf : public std::streambuf
+{
+public:
+  explicit VectorStreamBuf(std::vector<char> &v):V(v) {}
+protected:
+  int_type overflow(int_type c) override
+    {
+    if( !traits_type::eq_int_type(c, traits_type::eof()) )
+      {
+      V.push_back( traits_type::to_char_type(c) );
+      }
+    return traits_type::not_eof(c);
+    }
+  std::streamsize xsputn(const char *s, std::streamsize n) override
+    {
+    V.insert( V.end(), s, s + n );
+    return n;
+    }
+private:
+  std::vector<char> &V;
+};
+
+// Raw deflate bit stream (no zlib header) of [in, in+len), compressed by
+// independent chunks on nthreads threads. Each chunk is primed with the end
+// of the previous one (as in pigz) and ends on a byte aligned sync flush,
+// so that the concatenation is a single valid deflate bit stream.
+bool DeflateBuffer(const char *in, size_t len, int level, unsigned int nthreads,
+  std::vector< std::vector<char> > &out)
+{
+  const size_t chunksize = 128 * 1024;
+  const size_t dictsize = 32 * 1024;
+  const size_t nchunks = len ? (len + chunksize - 1) / chunksize : 1;
+  out.assign( nchunks, std::vector<char>() );
+  auto task = [&](size_t i, unsigned int) {
+    const size_t offset = i * chunksize;
+    const size_t n = std::min( chunksize, len - offset );
+    const bool last = i + 1 == nchunks;
+    z_stream strm = {};
+    if( deflateInit2( &strm, level, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY ) != Z_OK )
+      {
+      return false;
+      }
+    if( offset )
+      {
+      const size_t d = std::min( dictsize, offset );
+      if( deflateSetDictionary( &strm, (const Bytef*)in + offset - d, (uInt)d ) != Z_OK )
+        {
+        deflateEnd( &strm );
+        return false;
+        }
+      }
+    std::vector<char> &o = out[i];
+    // room for the sync flush marker:
+    o.resize( deflateBound( &strm, (uLong)n ) + 16 );
+    strm.next_in = (Bytef*)in + offset;
+    strm.avail_in = (uInt)n;
+    int ret;
+    do
+      {
+      if( strm.total_out == o.size() ) o.resize( o.size() * 2 );
+      strm.next_out = (Bytef*)o.data() + strm.total_out;
+      strm.avail_out = (uInt)(o.size() - strm.total_out);
+      ret = deflate( &strm, last ? Z_FINISH : Z_SYNC_FLUSH );
+      }
+    while( last ? ret == Z_OK : (ret == Z_OK && strm.avail_out == 0) );
+    o.resize( strm.total_out );
+    deflateEnd( &strm );
+    return last ? ret == Z_STREAM_END : ret == Z_OK;
+  };
+  return ParallelFor::Run( nchunks, nthreads, task );
+}
+
+// Write the DataSet elements in [first,last) into os
+template <typename TDE>
+void WriteRange(std::ostream &os, DataSet::ConstIterator first, DataSet::ConstIterator last)
+{
+  for( ; first != last; ++first )
+    {
+    first->Write<TDE,SwapperNoOp>(os);
+    }
+}
+
+// Compute the length of everything but Pixel Data, in one pass
+template <typename TDE>
+size_t ComputeLengthWithoutPixelData(const DataSet &ds)
+{
+  const Tag pixeldata(0x7fe0,0x0010);
+  size_t len = 0;
+  DataSet::ConstIterator it = ds.Begin();
+  for( ; it != ds.End(); ++it )
+    {
+    if( it->GetTag() != pixeldata )
+      {
+      const VL vl = it->GetLength<TDE>();
+      if( !vl.IsUndefined() ) len += vl;
+      }
+    }
+  return len;
+}
+}
+
+bool Writer::WriteDeflatedDataSet(std::ostream &os)
+{
+  const DataSet &DS = F->GetDataSet();
+  std::vector<char> raw;
+  std::vector< std::vector<char> > compressed;
+  try
+    {
+    VectorStreamBuf rawbuf( raw );
+    std::ostream ros( &rawbuf );
+    DS.Write<ExplicitDataElement,SwapperNoOp>(ros);
+    if( !DeflateBuffer( raw.data(), raw.size(), Z_DEFAULT_COMPRESSION,
+        NumberOfThreads, compressed ) )
+      {
+      gdcmErrorMacro( "Could not deflate DataSet" );
+      return false;
+      }
+    }
+  catch(std::exception &ex)
+    {
+    (void)ex;  //to avoid unreferenced variable warning on release
+    gdcmErrorMacro( ex.what() );
+    return false;
+    }
+  catch(...)
+    {
+    gdcmErrorMacro( "what the hell" );
+    return false;
+    }
+  size_t total = 0;
+  for( size_t i = 0; i < compressed.size(); ++i )
+    {
+    os.write( compressed[i].data(), compressed[i].size() );
+    total += compressed[i].size();
+    }
+  // PS 3.5 A.5: padded with a trailing NULL byte to an even length
+  if( total % 2 ) os.put( 0 );
+  return !os.fail();
+}
+
+bool Writer::WriteWithPixelDataBuffer()
+{
+  std::ostream &os = *Stream;
+  const FileMetaInformation &Header = F->GetHeader();
+  const DataSet &DS = F->GetDataSet();
+  const Tag pixeldata(0x7fe0,0x0010);
+
+  const TransferSyntax &ts = Header.GetDataSetTransferSyntax();
+  if( !ts.IsValid() )
+    {
+    gdcmErrorMacro( "Invalid Transfer Syntax" );
+    return false;
+    }
+  if( ts.IsEncapsulated() )
+    {
+    gdcmErrorMacro( "Pixel Data buffer cannot be used with encapsulated Transfer Syntax: " << ts );
+    return false;
+    }
+  if( PixelDataVR != VR::OB && PixelDataVR != VR::OW )
+    {
+    gdcmErrorMacro( "Pixel Data buffer VR should be OB or OW: " << PixelDataVR );
+    return false;
+    }
+  if( PixelDataLength >= 0xFFFFFFFE )
+    {
+    gdcmErrorMacro( "Pixel Data buffer is too large: " << PixelDataLength );
+    return false;
+    }
+
+  if( ts.GetSwapCode() == SwapCode::BigEndian
+    || ts == TransferSyntax::DeflatedExplicitVRLittleEndian )
+    {
+    // Pixel Data has to be transformed anyway, simply copy it into a
+    // DataSet and use the regular code path:
+    DataElement de( pixeldata, 0, PixelDataVR );
+    de.SetByteValue( PixelDataBuffer, VL((uint32_t)PixelDataLength) );
+    SmartPointer<File> copy = new File( *F );
+    copy->GetDataSet().Replace( de );
+    SmartPointer<File> orig = F;
+    const char *buffer = PixelDataBuffer;
+    F = copy;
+    PixelDataBuffer = nullptr;
+    const bool ret = Write();
+    PixelDataBuffer = buffer;
+    F = orig;
+    return ret;
+    }
+
+  const bool isexplicit = ts.GetNegociatedType() == TransferSyntax::Explicit;
+  // Everything before Pixel Data (including the Pixel Data element header),
+  // and everything after it (trailing padding, odd length padding):
+  std::vector<char> head, tail;
+  try
+    {
+    head.reserve( 1024 + (isexplicit ? ComputeLengthWithoutPixelData<ExplicitDataElement>(DS)
+        : ComputeLengthWithoutPixelData<ImplicitDataElement>(DS)) );
+    VectorStreamBuf headbuf( head );
+    std::ostream hos( &headbuf );
+    if( !WriteDataSetOnly )
+      {
+      if( !WriteFileMetaInformation(hos) )
+        {
+        return false;
+        }
+      }
+    DataSet::ConstIterator it = DS.GetDES().lower_bound( DataElement(pixeldata) );
+    if( isexplicit )
+      WriteRange<ExplicitDataElement>(hos, DS.Begin(), it);
+    else
+      WriteRange<ImplicitDataElement>(hos, DS.Begin(), it);
+    if( it != DS.End() && it->GetTag() == pixeldata ) ++it; // replaced by PixelDataBuffer
+
+    const bool odd = PixelDataLength % 2 != 0;
+    const VL vl = (uint32_t)(PixelDataLength + (odd ? 1 : 0));
+    pixeldata.Write<SwapperNoOp>(hos);
+    if( isexplicit ) PixelDataVR.Write(hos);
+    vl.Write<SwapperNoOp>(hos);
+
+    VectorStreamBuf tailbuf( tail );
+    std::ostream tos( &tailbuf );
+    if( odd ) tail.push_back( 0 );
+    if( isexplicit )
+      WriteRange<ExplicitDataElement>(tos, it, DS.End());
+    else
+      WriteRange<ImplicitDataElement>(tos, it, DS.End());
+    }
+  catch(std::exception &ex)
+    {
+    (void)ex;  //to avoid unreferenced variable warning on release
+    gdcmErrorMacro( ex.what() );
+    return false;
+    }
+
+  // std::filebuf writes large blocks directly (together with pending data)
+  os.write( head.data(), head.size() );
+  os.write( PixelDataBuffer, PixelDataLength );
+  if( !tail.empty() ) os.write( tail.data(), tail.size() );
+
   os.flush();
   if (Ofstream)
     {
@@ -66,6 +66,24 @@ public:
   void SetFile(const File& f) { F = f; }
   File &GetFile() { return *F; }
 
+  /// High throughput mode: take the value of Pixel Data (7fe0,0010) from
+  /// \p buffer instead of the DataSet (any Pixel Data in the DataSet is
+  /// ignored). The buffer is not copied and must remain valid until Write()
+  /// returns. Everything else is serialized in one contiguous block, so the
+  /// whole file goes out in a couple of write calls.
+  /// Only native (not encapsulated) pixel data is supported, \p vr is
+  /// either OB or OW. Pass nullptr to go back to the default behavior.
+  void SetPixelDataBuffer(const char *buffer, size_t length, VR const &vr = VR::OW) {
+    PixelDataBuffer = buffer;
+    PixelDataLength = length;
+    PixelDataVR = vr;
+  }
+
+  /// Set the number of threads used to compress a Deflated Explicit VR Little
+  /// Endian data set, 1 by default. 0 means use the number of hardware threads.
+  void SetNumberOfThreads(unsigned int nthreads) { NumberOfThreads = nthreads; }
+  unsigned int GetNumberOfThreads() const { return NumberOfThreads; }
+
   /// Undocumented function, do not use (= leave default)
   void SetCheckFileMetaInformation(bool b) { CheckFileMetaInformation = b; }
   void CheckFileMetaInformationOff() { CheckFileMetaInformation = false; }
@@ -87,9 +105,17 @@ protected:
   bool GetCheckFileMetaInformation() const { return CheckFileMetaInformation; }
 
 private:
+  bool WriteFileMetaInformation(std::ostream &os);
+  bool WriteWithPixelDataBuffer();
+  bool WriteDeflatedDataSet(std::ostream &os);
+
   SmartPointer<File> F;
   bool CheckFileMetaInformation;
   bool WriteDataSetOnly;
+  const char *PixelDataBuffer;
+  size_t PixelDataLength;
+  VR PixelDataVR;
+  unsigned int NumberOfThreads;
 };
 
 } // end namespace gdcm
@@ -19,6 +19,7 @@
 #include "gdcmSwapper.h"
 #include "gdcmDataSetHelper.h"
 #include "gdcmUIDGenerator.h"
+#include "gdcmUIDMappingTable.h"
 #include "gdcmAttribute.h"
 #include "gdcmDummyValueGenerator.h"
 #include "gdcmDicts.h"
@@ -28,6 +29,8 @@
 #include "gdcmEvent.h"
 #include "gdcmAnonymizeEvent.h"
 
+#include <mutex>
+
 namespace gdcm
 {
 // PS 3.15 - 2008
@@ -524,12 +527,10 @@ bool Anonymizer::RemovePrivateTags()
 
 /*
  * Implementation note:
- * In order to implement the dummy 'memory' we use a static std::map
- * this works great but we cannot be thread safe.
- * In order to be thread safe, we would need to externalize this map generation
- * maybe using a Scanner do the operation once (Scanner is doing) the merging
- * automatically...
- * this is left as an exercise for the reader :)
+ * The dummy UID 'memory' is kept in a UIDMappingTable, which is thread safe.
+ * By default a process wide table is used, user can share its own table across
+ * multiple Anonymizer (see BatchAnonymizer). Non-UID dummy values are kept in
+ * a static std::map protected by a mutex, which is only held for the lookup.
  */
 bool Anonymizer::BasicApplicationLevelConfidentialityProfile(bool deidentify)
 {
@@ -945,12 +946,24 @@ generate a DICOMDIR
 }
 
 Anonymizer::DummyMapNonUIDTags Anonymizer::dummyMapNonUIDTags;
-Anonymizer::DummyMapUIDTags Anonymizer::dummyMapUIDTags;
+static std::mutex dummyMapNonUIDTagsLock;
+
+static UIDMappingTable &GetDefaultUIDMappingTable()
+{
+  static UIDMappingTable table;
+  return table;
+}
+
+UIDMappingTable *Anonymizer::GetUIDMappingTable() const
+{
+  return UIDMapping ? UIDMapping : &GetDefaultUIDMappingTable();
+}
 
 void Anonymizer::ClearInternalUIDs()
 {
+  std::lock_guard<std::mutex> lock( dummyMapNonUIDTagsLock );
   dummyMapNonUIDTags.clear();
-  dummyMapUIDTags.clear();
+  GetDefaultUIDMappingTable().Clear();
 }
 
 bool Anonymizer::BALCPProtect(DataSet &ds, Tag const & tag, IOD const & iod)
@@ -972,7 +985,6 @@ bool Anonymizer::BALCPProtect(DataSet &ds, Tag const & tag, IOD const & iod)
     if ( IsVRUI( tag ) )
       {
       std::string UIDToAnonymize;
-      UIDGenerator uid;
 
       if( !copy.IsEmpty() )
         {
@@ -985,20 +997,13 @@ bool Anonymizer::BALCPProtect(DataSet &ds, Tag const & tag, IOD const & iod)
       std::string anonymizedUID;
       if( !UIDToAnonymize.empty() )
         {
-        if ( dummyMapUIDTags.count( UIDToAnonymize ) == 0 )
-          {
-          anonymizedUID = uid.Generate();
-          dummyMapUIDTags[ UIDToAnonymize ] = anonymizedUID;
-          }
-        else
-          {
-          anonymizedUID = dummyMapUIDTags[ UIDToAnonymize ];
-          }
+        anonymizedUID = GetUIDMappingTable()->GetOrCreate( UIDToAnonymize.c_str() );
         }
       else
         {
         // gdcmData/LEADTOOLS_FLOWERS-16-MONO2-JpegLossless.dcm
         // has an empty 0008,0018 attribute, let's try to handle creating new UID
+        UIDGenerator uid;
         anonymizedUID = uid.Generate();
         }
 
@@ -1010,19 +1015,22 @@ bool Anonymizer::BALCPProtect(DataSet &ds, Tag const & tag, IOD const & iod)
       TagValueKey tvk;
       tvk.first = tag;
 
-      gdcm_assert( dummyMapNonUIDTags.count( tvk ) == 0 || dummyMapNonUIDTags.count( tvk ) == 1 );
-      if( dummyMapNonUIDTags.count( tvk ) == 0 )
+      // Only the map lookup is done under the lock, the dummy value is
+      // computed outside (it only depends on the key, first insert wins):
+      std::string v;
+      bool found;
+        {
+        std::lock_guard<std::mutex> lock( dummyMapNonUIDTagsLock );
+        DummyMapNonUIDTags::const_iterator it = dummyMapNonUIDTags.find( tvk );
+        found = it != dummyMapNonUIDTags.end();
+        if( found ) v = it->second;
+        }
+      if( !found )
         {
         const char *ret = DummyValueGenerator::Generate( tvk.second.c_str() );
-        if( ret )
-          {
-          dummyMapNonUIDTags[ tvk ] = ret;
-          }
-        else
-          dummyMapNonUIDTags[ tvk ] = "";
+        std::lock_guard<std::mutex> lock( dummyMapNonUIDTagsLock );
+        v = dummyMapNonUIDTags.insert( std::make_pair( tvk, std::string( ret ? ret : "" ) ) ).first->second;
         }
-
-      std::string &v = dummyMapNonUIDTags[ tvk ];
       copy.SetByteValue( v.c_str(), (uint32_t)v.size() );
       }
       ds.Replace( copy );
@@ -26,6 +26,7 @@ namespace gdcm
 class TagPath;
 class IOD;
 class CryptographicMessageSyntax;
+class UIDMappingTable;
 
 /**
  * \brief Anonymizer
@@ -77,7 +78,7 @@ class CryptographicMessageSyntax;
 class GDCM_EXPORT Anonymizer : public Subject
 {
 public:
-  Anonymizer():F(new File),CMS(nullptr) {}
+  Anonymizer():F(new File),CMS(nullptr),UIDMapping(nullptr) {}
   ~Anonymizer() override;
 
   /// Make Tag t empty (if not found tag will be created)
@@ -130,20 +131,27 @@ public:
   /// PS 3.15 / E.1.1 De-Identifier
   /// An Application may claim conformance to the Basic Application Level Confidentiality Profile as a deidentifier
   /// if it protects all Attributes that might be used by unauthorized entities to identify the patient.
-  /// NOT THREAD SAFE
+  /// Multiple Anonymizer (one per thread) can run concurrently, as long as
+  /// they do not share the same File or CryptographicMessageSyntax.
   bool BasicApplicationLevelConfidentialityProfile(bool deidentify = true);
 
   /// Set/Get CMS key that will be used to encrypt the dataset within BasicApplicationLevelConfidentialityProfile
   void SetCryptographicMessageSyntax( CryptographicMessageSyntax *cms );
   const CryptographicMessageSyntax *GetCryptographicMessageSyntax() const;
 
+  /// Set/Get the table used to remap UIDs within BasicApplicationLevelConfidentialityProfile.
+  /// When not set (default), a process wide table is used (see ClearInternalUIDs).
+  /// The table is not owned by the Anonymizer.
+  void SetUIDMappingTable( UIDMappingTable *table ) { UIDMapping = table; }
+  UIDMappingTable *GetUIDMappingTable() const;
+
   /// for wrapped language: instantiate a reference counted object
   static SmartPointer<Anonymizer> New() { return new Anonymizer; }
 
   /// Return the list of Tag that will be considered when anonymizing a DICOM file.
   static std::vector<Tag> GetBasicApplicationLevelConfidentialityProfileAttributes();
 
-  /// Clear the internal mapping of real UIDs to generated UIDs
+  /// Clear the internal (process wide) mapping of real UIDs to generated UIDs
   /// \warning the mapping is definitely lost
   static void ClearInternalUIDs();
 
@@ -162,12 +170,11 @@ private:
   // I would prefer to have a smart pointer to DataSet but DataSet does not derive from Object...
   SmartPointer<File> F;
   CryptographicMessageSyntax *CMS;
+  UIDMappingTable *UIDMapping;
 
   typedef std::pair< Tag, std::string > TagValueKey;
   typedef std::map< TagValueKey, std::string > DummyMapNonUIDTags;
-  typedef std::map< std::string, std::string > DummyMapUIDTags;
   static DummyMapNonUIDTags dummyMapNonUIDTags;
-  static DummyMapUIDTags dummyMapUIDTags;
 };
 
 /**
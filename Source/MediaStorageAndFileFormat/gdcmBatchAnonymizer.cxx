@@ -0,0 +1,258 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmBatchAnonymizer.h"
+#include "gdcmAnonymizer.h"
+#include "gdcmUIDMappingTable.h"
+#include "gdcmCryptographicMessageSyntax.h"
+#include "gdcmReader.h"
+#include "gdcmWriter.h"
+#include "gdcmMediaStorage.h"
+#include "gdcmDefs.h"
+#include "gdcmSystem.h"
+#include "gdcmTrace.h"
+#include "gdcmParallelFor.h"
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+#include <cstring>
+
+namespace gdcm
+{
+
+// Forward every call to a shared CryptographicMessageSyntax, one thread at a
+// time. None of the implementations document being thread safe.
+class SerializedCryptographicMessageSyntax : public CryptographicMessageSyntax
+{
+public:
+  SerializedCryptographicMessageSyntax(CryptographicMessageSyntax &cms):CMS(cms) {}
+
+  bool ParseCertificateFile( const char *filename ) override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    return CMS.ParseCertificateFile( filename );
+    }
+  bool ParseKeyFile( const char *filename ) override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    return CMS.ParseKeyFile( filename );
+    }
+  bool SetPassword(const char * pass, size_t passLen) override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    return CMS.SetPassword( pass, passLen );
+    }
+  bool Encrypt(char *output, size_t &outlen, const char *array, size_t len) const override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    return CMS.Encrypt( output, outlen, array, len );
+    }
+  bool Decrypt(char *output, size_t &outlen, const char *array, size_t len) const override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    return CMS.Decrypt( output, outlen, array, len );
+    }
+  void SetCipherType(CipherTypes type) override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    CMS.SetCipherType( type );
+    }
+  CipherTypes GetCipherType() const override
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    return CMS.GetCipherType();
+    }
+
+private:
+  CryptographicMessageSyntax &CMS;
+  mutable std::mutex Lock;
+};
+
+class BatchAnonymizerInternals
+{
+public:
+  BatchAnonymizerInternals():
+    NumberOfThreads(1),
+    Deidentify(true),
+    SkipUnreadableFiles(false),
+    CMS(nullptr),
+    UserTable(nullptr)
+  {}
+
+  unsigned int NumberOfThreads;
+  bool Deidentify;
+  bool SkipUnreadableFiles;
+  CryptographicMessageSyntax *CMS;
+  UIDMappingTable *UserTable;
+  UIDMappingTable Table;
+
+  // State of the current Anonymize call:
+  std::mutex FailedLock;
+  Directory::FilenamesType Failed;
+
+  UIDMappingTable &GetTable() { return UserTable ? *UserTable : Table; }
+
+  bool AnonymizeOneFile(Anonymizer &anon, const char *filename, const char *outfilename);
+};
+
+bool BatchAnonymizerInternals::AnonymizeOneFile(Anonymizer &anon,
+  const char *filename, const char *outfilename)
+{
+  Reader reader;
+  reader.SetFileName( filename );
+  if( !reader.Read() )
+    {
+    if( SkipUnreadableFiles )
+      {
+      gdcmWarningMacro( "Skipping unreadable file: " << filename );
+      return true;
+      }
+    gdcmErrorMacro( "Could not read: " << filename );
+    return false;
+    }
+  File &file = reader.GetFile();
+  MediaStorage ms;
+  ms.SetFromFile(file);
+  if( !Defs::GetIODNameFromMediaStorage(ms) )
+    {
+    gdcmErrorMacro( "The Media Storage Type is not supported: " << ms << " for " << filename );
+    return false;
+    }
+
+  anon.SetFile( file );
+  if( !anon.BasicApplicationLevelConfidentialityProfile( Deidentify ) )
+    {
+    gdcmErrorMacro( "Could not " << (Deidentify ? "de" : "re")
+      << "-identify: " << filename );
+    return false;
+    }
+
+  FileMetaInformation &fmi = file.GetHeader();
+  fmi.Clear();
+
+  Writer writer;
+  writer.SetFileName( outfilename );
+  writer.SetFile( file );
+  if( !writer.Write() )
+    {
+    gdcmErrorMacro( "Could not write: " << outfilename );
+    if( strcmp(filename,outfilename) != 0 )
+      {
+      System::RemoveFile( outfilename );
+      }
+    else
+      {
+      gdcmErrorMacro( "Input file was overwritten: " << filename << " (data lost)" );
+      }
+    return false;
+    }
+  return true;
+}
+
+BatchAnonymizer::BatchAnonymizer():Internals(new BatchAnonymizerInternals)
+{
+}
+
+BatchAnonymizer::~BatchAnonymizer()
+{
+  delete Internals;
+}
+
+void BatchAnonymizer::SetNumberOfThreads(unsigned int nthreads)
+{
+  Internals->NumberOfThreads = nthreads;
+}
+
+unsigned int BatchAnonymizer::GetNumberOfThreads() const
+{
+  return Internals->NumberOfThreads;
+}
+
+void BatchAnonymizer::SetDeidentify(bool deidentify)
+{
+  Internals->Deidentify = deidentify;
+}
+
+bool BatchAnonymizer::GetDeidentify() const
+{
+  return Internals->Deidentify;
+}
+
+void BatchAnonymizer::SetCryptographicMessageSyntax( CryptographicMessageSyntax *cms )
+{
+  Internals->CMS = cms;
+}
+
+void BatchAnonymizer::SetUIDMappingTable( UIDMappingTable *table )
+{
+  Internals->UserTable = table;
+}
+
+UIDMappingTable &BatchAnonymizer::GetUIDMappingTable()
+{
+  return Internals->GetTable();
+}
+
+void BatchAnonymizer::SetSkipUnreadableFiles(bool skip)
+{
+  Internals->SkipUnreadableFiles = skip;
+}
+
+bool BatchAnonymizer::Anonymize(Directory::FilenamesType const &filenames,
+  Directory::FilenamesType const &outfilenames)
+{
+  Internals->Failed.clear();
+  if( filenames.size() != outfilenames.size() )
+    {
+    gdcmErrorMacro( "Number of input and output filenames differ" );
+    return false;
+    }
+  if( !Internals->CMS )
+    {
+    gdcmErrorMacro( "Need a certificate" );
+    return false;
+    }
+  if( filenames.empty() ) return true;
+
+  SerializedCryptographicMessageSyntax cms( *Internals->CMS );
+  const unsigned int nthreads =
+    ParallelFor::GetNumberOfThreads( Internals->NumberOfThreads, filenames.size() );
+  // One Anonymizer per thread, all sharing the UID mapping table:
+  std::vector< SmartPointer<Anonymizer> > anons( nthreads );
+  for( unsigned int t = 0; t < nthreads; ++t )
+    {
+    anons[t] = new Anonymizer;
+    anons[t]->SetCryptographicMessageSyntax( &cms );
+    anons[t]->SetUIDMappingTable( &Internals->GetTable() );
+    }
+  // Dynamic scheduling: files have very different sizes
+  ParallelFor::Run( filenames.size(), nthreads, [&](size_t i, unsigned int t) {
+    if( !Internals->AnonymizeOneFile( *anons[t], filenames[i].c_str(), outfilenames[i].c_str() ) )
+      {
+      std::lock_guard<std::mutex> lock( Internals->FailedLock );
+      Internals->Failed.push_back( filenames[i] );
+      }
+    return true;
+  } );
+
+  std::sort( Internals->Failed.begin(), Internals->Failed.end() );
+  return Internals->Failed.empty();
+}
+
+Directory::FilenamesType const &BatchAnonymizer::GetFailedFilenames() const
+{
+  return Internals->Failed;
+}
+
+} // end namespace gdcm
@@ -0,0 +1,87 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMBATCHANONYMIZER_H
+#define GDCMBATCHANONYMIZER_H
+
+#include "gdcmDirectory.h"
+
+namespace gdcm
+{
+class BatchAnonymizerInternals;
+class CryptographicMessageSyntax;
+class UIDMappingTable;
+
+/**
+ * \brief BatchAnonymizer
+ * \details Apply the Basic Application Level Confidentiality Profile
+ * (de-identification or re-identification) to a list of files using multiple
+ * threads.
+ *
+ * Each file is streamed independently through read -> anonymize -> write, so
+ * that memory usage only depends on the number of threads. All worker threads
+ * share one UIDMappingTable, so that UIDs are consistently remapped across the
+ * whole set of files. Use UIDMappingTable::Load / UIDMappingTable::Save to
+ * keep this remapping consistent across runs.
+ *
+ * Calls to the CryptographicMessageSyntax are serialized internally, the
+ * same instance is shared by all threads.
+ *
+ * \warning Global::LoadResourcesFiles must have been called before Anonymize
+ *
+ * \see Anonymizer UIDMappingTable
+ */
+class GDCM_EXPORT BatchAnonymizer
+{
+public:
+  BatchAnonymizer();
+  ~BatchAnonymizer();
+  BatchAnonymizer(const BatchAnonymizer&) = delete;
+  void operator=(const BatchAnonymizer&) = delete;
+
+  /// Set/Get number of worker threads (default: 1). 0 means use the number
+  /// of hardware threads.
+  void SetNumberOfThreads(unsigned int nthreads);
+  unsigned int GetNumberOfThreads() const;
+
+  /// Set/Get de-identify (true, default) or re-identify (false) mode.
+  void SetDeidentify(bool deidentify);
+  bool GetDeidentify() const;
+
+  /// Set CMS key that will be used to encrypt/decrypt the datasets (required).
+  void SetCryptographicMessageSyntax( CryptographicMessageSyntax *cms );
+
+  /// Set the table used to remap UIDs. The table is not owned.
+  /// When not set, an internal table is used (see GetUIDMappingTable).
+  void SetUIDMappingTable( UIDMappingTable *table );
+  UIDMappingTable &GetUIDMappingTable();
+
+  /// When a file cannot be read, skip it instead of reporting a failure (default: false)
+  void SetSkipUnreadableFiles(bool skip);
+
+  /// Process all filenames[i] into outfilenames[i]. Both lists must have the
+  /// same length. Return false if any file failed.
+  bool Anonymize(Directory::FilenamesType const &filenames,
+    Directory::FilenamesType const &outfilenames);
+
+  /// Return the list of input files which could not be processed during the
+  /// last call to Anonymize (sorted)
+  Directory::FilenamesType const &GetFailedFilenames() const;
+
+private:
+  BatchAnonymizerInternals *Internals;
+};
+
+} // end namespace gdcm
+
+#endif //GDCMBATCHANONYMIZER_H
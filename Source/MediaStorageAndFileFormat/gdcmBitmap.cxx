@@ -20,6 +20,7 @@
 #include "gdcmJPEGLSCodec.h"
 #include "gdcmJPEG2000Codec.h"
 #include "gdcmRLECodec.h"
+#include "gdcmInstrumentation.h"
 
 #include <cstring>
 
@@ -53,7 +54,8 @@ Bitmap::Bitmap():
   PixelData(),
   LUT(new LookupTable),
   NeedByteSwap(false),
-  LossyFlag(false)
+  LossyFlag(false),
+  NumberOfThreads(1)
 {}
 
 Bitmap::~Bitmap() = default;
@@ -346,6 +348,8 @@ bool Bitmap::TryRAWCodec(char *buffer, bool &lossyflag) const
     codec.SetPixelFormat( GetPixelFormat() );
     codec.SetNeedByteSwap( GetNeedByteSwap() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
+    InstrumentationTimer timer( Instrumentation::DecodeRAW );
+    timer.SetBytes( len );
     DataElement out;
     //bool r = codec.Decode(PixelData, out);
     bool r = codec.DecodeBytes(bv->GetPointer(), bv->GetLength(),
@@ -356,7 +360,11 @@ bool Bitmap::TryRAWCodec(char *buffer, bool &lossyflag) const
       Bitmap *i = const_cast<Bitmap*>(this);
       i->SetNeedByteSwap(false);
       }
-    if( !r ) return false;
+    if( !r )
+      {
+      timer.Cancel();
+      return false;
+      }
     //const ByteValue *outbv = out.GetByteValue();
     //gdcm_assert( outbv );
     if( len != bv->GetLength() )
@@ -471,12 +479,20 @@ bool Bitmap::TryJPEGCodec(char *buffer, bool &lossyflag) const
     codec.SetPhotometricInterpretation( GetPhotometricInterpretation() );
     codec.SetPixelFormat( GetPixelFormat() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
+    InstrumentationTimer timer( Instrumentation::DecodeJPEG );
+    timer.SetBytes( len );
     DataElement out;
-    bool r = codec.Decode(PixelData, out);
-    // PHILIPS_Gyroscan-12-MONO2-Jpeg_Lossless.dcm
-    if( !r )
+    // Decode straight into the user buffer whenever possible:
+    const bool direct = codec.DecodeToBuffer(PixelData, buffer, len);
+    if( !direct )
       {
-      return false;
+      bool r = codec.Decode(PixelData, out);
+      // PHILIPS_Gyroscan-12-MONO2-Jpeg_Lossless.dcm
+      if( !r )
+        {
+        timer.Cancel();
+        return false;
+        }
       }
     // FIXME ! This should be done all the time for all codec:
     // Did PI change or not ?
@@ -535,18 +551,20 @@ bool Bitmap::TryJPEGCodec(char *buffer, bool &lossyflag) const
     //  Bitmap *i = (Bitmap*)this;
     //  i->SetPhotometricInterpretation( PhotometricInterpretation::RGB );
     //  }
-    const ByteValue *outbv = out.GetByteValue();
-    gdcm_assert( outbv );
-    unsigned long check = outbv->GetLength();  // FIXME
-    (void)check;
-    // DermaColorLossLess.dcm has a len of 63531, but DICOM will give us: 63532 ...
-    if( len > outbv->GetLength() )
+    if( !direct )
       {
-      gdcmErrorMacro( "Impossible length: " << len << " should be (max): " << outbv->GetLength() );
-      return false;
+      const ByteValue *outbv = out.GetByteValue();
+      gdcm_assert( outbv );
+      // DermaColorLossLess.dcm has a len of 63531, but DICOM will give us: 63532 ...
+      if( len > outbv->GetLength() )
+        {
+        gdcmErrorMacro( "Impossible length: " << len << " should be (max): " << outbv->GetLength() );
+        timer.Cancel();
+        return false;
+        }
+      gdcm_assert( len <= outbv->GetLength() );
+      if(buffer) memcpy(buffer, outbv->GetPointer(), len /*outbv->GetLength()*/ );  // FIXME
       }
-    gdcm_assert( len <= outbv->GetLength() );
-    if(buffer) memcpy(buffer, outbv->GetPointer(), len /*outbv->GetLength()*/ );  // FIXME
 
     lossyflag = codec.IsLossy();
     //gdcm_assert( codec.IsLossy() == ts.IsLossy() );
@@ -613,9 +631,15 @@ bool Bitmap::TryPVRGCodec(char *buffer, bool &lossyflag) const
     codec.SetPhotometricInterpretation( GetPhotometricInterpretation() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
     codec.SetDimensions( GetDimensions() );
+    InstrumentationTimer timer( Instrumentation::DecodeJPEG );
+    timer.SetBytes( GetBufferLength() );
     DataElement out;
     bool r = codec.Decode(PixelData, out);
-    if(!r) return false;
+    if(!r)
+      {
+      timer.Cancel();
+      return false;
+      }
     codec.SetLossyFlag( ts.IsLossy() );
     gdcm_assert( r );
     if ( GetPlanarConfiguration() != codec.GetPlanarConfiguration() )
@@ -653,9 +677,15 @@ bool Bitmap::TryKAKADUCodec(char *buffer, bool &lossyflag) const
     codec.SetPhotometricInterpretation( GetPhotometricInterpretation() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
     codec.SetDimensions( GetDimensions() );
+    InstrumentationTimer timer( Instrumentation::DecodeJPEG2000 );
+    timer.SetBytes( GetBufferLength() );
     DataElement out;
     bool r = codec.Decode(PixelData, out);
-    if( !r ) return false;
+    if( !r )
+      {
+      timer.Cancel();
+      return false;
+      }
     const ByteValue *outbv = out.GetByteValue();
     gdcm_assert( outbv );
     unsigned long check = outbv->GetLength();  // FIXME
@@ -727,17 +757,28 @@ bool Bitmap::TryJPEGLSCodec(char *buffer, bool &lossyflag) const
     codec.SetPhotometricInterpretation( GetPhotometricInterpretation() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
     codec.SetDimensions( GetDimensions() );
-    DataElement out;
-    bool r = codec.Decode(PixelData, out);
-    if( !r ) return false;
-    const ByteValue *outbv = out.GetByteValue();
-    gdcm_assert( outbv );
-    unsigned long check = outbv->GetLength();  // FIXME
-    (void)check;
-    gdcm_assert( len <= outbv->GetLength() );
-    // DermaColorLossLess.dcm has a len of 63531, but DICOM will give us: 63532 ...
-    gdcm_assert( len <= outbv->GetLength() );
-    memcpy(buffer, outbv->GetPointer(), len /*outbv->GetLength()*/ );  // FIXME
+    codec.SetNumberOfThreads( NumberOfThreads );
+    InstrumentationTimer timer( Instrumentation::DecodeJPEGLS );
+    timer.SetBytes( len );
+    // Decode straight into the caller buffer when the codestream matches:
+    if( !codec.DecodeToBuffer(PixelData, buffer, len) )
+      {
+      DataElement out;
+      bool r = codec.Decode(PixelData, out);
+      if( !r )
+        {
+        timer.Cancel();
+        return false;
+        }
+      const ByteValue *outbv = out.GetByteValue();
+      gdcm_assert( outbv );
+      unsigned long check = outbv->GetLength();  // FIXME
+      (void)check;
+      gdcm_assert( len <= outbv->GetLength() );
+      // DermaColorLossLess.dcm has a len of 63531, but DICOM will give us: 63532 ...
+      gdcm_assert( len <= outbv->GetLength() );
+      memcpy(buffer, outbv->GetPointer(), len /*outbv->GetLength()*/ );  // FIXME
+      }
 
     //gdcm_assert( codec.IsLossy() == ts.IsLossy() );
     lossyflag = codec.IsLossy();
@@ -777,7 +818,7 @@ bool Bitmap::TryJPEGLSCodec(char *buffer, bool &lossyflag) const
         i->SetPixelFormat( codec.GetPixelFormat() );
         }
 
-    return r;
+    return true;
     }
   return false;
 }
@@ -885,9 +926,15 @@ bool Bitmap::TryJPEG2000Codec(char *buffer, bool &lossyflag) const
     codec.SetPhotometricInterpretation( GetPhotometricInterpretation() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
     codec.SetDimensions( GetDimensions() );
+    InstrumentationTimer timer( Instrumentation::DecodeJPEG2000 );
+    timer.SetBytes( len );
     DataElement out;
     bool r = codec.Decode(PixelData, out);
-    if(!r) return false;
+    if(!r)
+      {
+      timer.Cancel();
+      return false;
+      }
     gdcm_assert( r );
     const ByteValue *outbv = out.GetByteValue();
     gdcm_assert( outbv );
@@ -983,9 +1030,22 @@ bool Bitmap::TryRLECodec(char *buffer, bool &lossyflag ) const
     codec.SetLUT( GetLUT() );
     codec.SetNeedOverlayCleanup( AreOverlaysInPixelData() || UnusedBitsPresentInPixelData() );
     codec.SetBufferLength( len );
+    codec.SetNumberOfThreads( NumberOfThreads );
+    InstrumentationTimer timer( Instrumentation::DecodeRLE );
+    timer.SetBytes( len );
+    // Decode straight into the user buffer whenever possible:
+    if( buffer && codec.DecodeToBuffer(PixelData, buffer, len) )
+      {
+      lossyflag = false;
+      return true;
+      }
     DataElement out;
     bool r = codec.Decode(PixelData, out);
-    if( !r ) return false;
+    if( !r )
+      {
+      timer.Cancel();
+      return false;
+      }
     const ByteValue *outbv = out.GetByteValue();
     //unsigned long check = outbv->GetLength();  // FIXME
     // DermaColorLossLess.dcm has a len of 63531, but DICOM will give us: 63532 ...
@@ -139,6 +139,12 @@ public:
   /// Specifically set that the image was compressed using a lossy compression mechanism
   void SetLossyFlag(bool f) { LossyFlag = f; }
 
+  /// Set the number of threads the codecs may use to decode the frames in
+  /// GetBuffer (JPEG-LS, RLE), 1 by default. 0 means use the number of
+  /// hardware threads.
+  void SetNumberOfThreads(unsigned int nthreads) { NumberOfThreads = nthreads; }
+  unsigned int GetNumberOfThreads() const { return NumberOfThreads; }
+
 protected:
   bool TryRAWCodec(char *buffer, bool &lossyflag) const;
   bool TryJPEGCodec(char *buffer, bool &lossyflag) const;
@@ -176,6 +182,7 @@ protected:
   // I believe the following 3 ivars can be derived from TS ...
   bool NeedByteSwap; // FIXME: remove me
   bool LossyFlag;
+  unsigned int NumberOfThreads;
 
 private:
   bool GetBufferInternal(char *buffer, bool &lossyflag) const;
@@ -26,6 +26,7 @@
 #include "gdcmVR.h"
 #include "gdcmCodeString.h"
 
+#include <unordered_map>
 
 namespace gdcm
 {
@@ -42,313 +43,186 @@ public:
   Scanner scanner;
   std::vector<uint32_t> OffsetTable;
   std::string FileSetID;
-};
-
-bool DICOMDIRGenerator::ComputeDirectoryRecordsOffset(const SequenceOfItems *sqi, VL start)
-{
-  SequenceOfItems::SizeType nitems = sqi->GetNumberOfItems();
-  std::vector<uint32_t> &offsets = Internals->OffsetTable;
-  Internals->OffsetTable.resize( nitems + 1 );
-  offsets[0] = start;
-  for(SequenceOfItems::SizeType i = 1; i <= nitems; ++i)
-    {
-    const Item &item = sqi->GetItem(i);
-    offsets[i] = offsets[i-1] + item.GetLength<ExplicitDataElement>();
-    }
-
-//#define MDEBUG
-#ifdef MDEBUG
-  for(unsigned int i = 0; i <= nitems; ++i)
-    {
-    std::cout << "offset #" << i << " -> "<< offsets[i] << std::endl;
-    }
-#endif
 
-  return true;
-}
+  // Hash indices built once after the scan, mapping a key value (Patient ID,
+  // Study/Series/SOP Instance UID) to the first file where it was found:
+  typedef std::unordered_map<std::string, const char*> IndexType;
+  IndexType PatientIndex;
+  IndexType StudyIndex;
+  IndexType SeriesIndex;
+  IndexType ImageIndex;
+  void BuildIndices();
+  const char *GetFilename(IndexType const &index, const char *value) const;
+  Scanner::TagToValue const &GetMapping(IndexType const &index, const char *value) const;
+
+  // One entry per Directory Record, in the same order as the Directory
+  // Record Sequence:
+  enum RecordType { PATIENT = 0, STUDY, SERIES, IMAGE };
+  struct Record
+    {
+    RecordType Type;
+    std::string Key;     // reference value for this record
+    bool HasParent;
+    std::string Parent;  // reference value of the upper level record
+    };
+  std::vector<Record> Records;
+  void AddRecord(RecordType type, const char *key, Tag const &parenttag, Scanner::TagToValue const &ttv);
+};
 
-static const char *GetLowerLevelDirectoryRecord(const char *input)
+static const char *FindValue(Scanner::TagToValue const &ttv, Tag const &t)
 {
-  if( !input ) return nullptr;
-
-  if( strcmp( input, "PATIENT " ) == 0 )
-    {
-    return "STUDY ";
-    }
-  else if( strcmp( input, "STUDY ") == 0 )
-    {
-    return "SERIES";
-    }
-  else if( strcmp( input, "SERIES" ) == 0 )
-    {
-    return "IMAGE ";
-    }
-  else if( strcmp( input, "IMAGE " ) == 0 )
-    {
-    return nullptr;
-    }
-  gdcm_assert( 0 );
-  //std::cerr << "COULD NOT FIND:" << input << std::endl;
+  Scanner::TagToValue::const_iterator it = ttv.find( t );
+  if( it != ttv.end() ) return it->second;
   return nullptr;
 }
 
-
-DICOMDIRGenerator::MyPair DICOMDIRGenerator::GetReferenceValueForDirectoryType(size_t itemidx)
+void DICOMDIRGeneratorInternal::BuildIndices()
 {
-  /*
-   * PS 3.11 - 2008 / D.3.3 Directory Information in DICOMDIR
-   * The Patient ID at the patient level shall be unique for each patient directory record in one File Set.
-  */
-  /*
-   * This function will return the Patient ID when directorytype          == "PATIENT"
-   * This function will return the Study Instance UID when directorytype  == "STUDY"
-   * This function will return the Series Instance UID when directorytype == "SERIES"
-   * This function will return the SOP Instance UID when directorytype    == "IMAGE"
-   */
-  MyPair ret;
-  const SequenceOfItems *sqi = GetDirectoryRecordSequence();
-  const Item &item = sqi->GetItem(itemidx);
-  const DataSet &ds = item.GetNestedDataSet();
-  Attribute<0x4,0x1430> directoryrecordtype;
-  directoryrecordtype.Set( ds );
-
-  const char *input = directoryrecordtype.GetValue();
-  gdcm_assert( input );
-
-  if( strcmp( input, "PATIENT " ) == 0 )
-    {
-    Attribute<0x10,0x20> patientid;
-    patientid.Set( ds );
-    gdcm_assert( patientid.GetValue() );
-    ret.first = patientid.GetValue();
-    ret.second = patientid.GetTag();
-    }
-  else if( strcmp( input, "STUDY ") == 0 )
-    {
-    Attribute <0x20,0xd> studyuid;
-    studyuid.Set( ds );
-    gdcm_assert( studyuid.GetValue() );
-    ret.first = studyuid.GetValue();
-    ret.second = studyuid.GetTag();
-    }
-  else if( strcmp( input, "SERIES" ) == 0 )
-    {
-    Attribute <0x20,0xe> seriesuid;
-    seriesuid.Set( ds );
-    gdcm_assert( seriesuid.GetValue() );
-    ret.first = seriesuid.GetValue();
-    ret.second = seriesuid.GetTag();
-    }
-  else if( strcmp( input, "IMAGE " ) == 0 )
-    {
-    Attribute <0x04,0x1511> sopuid;
-    sopuid.Set( ds );
-    gdcm_assert( sopuid.GetValue() );
-    ret.first = sopuid.GetValue();
-    ret.second = Tag(0x8,0x18); // watch out !
-    }
-  else
+  PatientIndex.clear();
+  StudyIndex.clear();
+  SeriesIndex.clear();
+  ImageIndex.clear();
+  Records.clear();
+  // Traverse files in order, so that the first file wins:
+  FilenamesType const &filenames = scanner.GetFilenames();
+  FilenamesType::const_iterator it = filenames.begin();
+  for( ; it != filenames.end(); ++it )
     {
-    gdcm_assert( 0 );
+    const char *filename = it->c_str();
+    if( !scanner.IsKey( filename ) ) continue;
+    Scanner::TagToValue const &ttv = scanner.GetMapping( filename );
+    // scanner owns the filename string, it is safe to keep a pointer
+    const char *fn = scanner.GetMappings().find( filename )->first;
+    const char *v;
+    if( (v = FindValue( ttv, Tag(0x10,0x20) )) ) PatientIndex.insert( IndexType::value_type(v, fn) );
+    if( (v = FindValue( ttv, Tag(0x20,0xd) )) )  StudyIndex.insert( IndexType::value_type(v, fn) );
+    if( (v = FindValue( ttv, Tag(0x20,0xe) )) )  SeriesIndex.insert( IndexType::value_type(v, fn) );
+    if( (v = FindValue( ttv, Tag(0x8,0x18) )) )  ImageIndex.insert( IndexType::value_type(v, fn) );
     }
-  return ret;
 }
 
-static Tag GetParentTag(Tag const &t)
+const char *DICOMDIRGeneratorInternal::GetFilename(IndexType const &index, const char *value) const
 {
-  Tag ret;
-  if( t == Tag(0x8,0x18) )
-    {
-    ret = Tag(0x20,0xe);
-    }
-  else if( t == Tag(0x20,0xe) )
-    {
-    ret = Tag(0x20,0xd);
-    }
-  else if( t == Tag(0x20,0xd) )
-    {
-    ret = Tag(0x10,0x20);
-    }
-  else if( t == Tag(0x10,0x20) )
-    {
-    ret = Tag(0x0,0x0);
-    }
-  else
-    {
-    gdcm_assert( 0 );
-    }
-  return ret;
+  IndexType::const_iterator it = index.find( value );
+  if( it != index.end() ) return it->second;
+  return nullptr;
 }
 
-bool DICOMDIRGenerator::SeriesBelongToStudy(const char *seriesuid, const char *studyuid)
+Scanner::TagToValue const &DICOMDIRGeneratorInternal::GetMapping(IndexType const &index, const char *value) const
 {
-  gdcm_assert( seriesuid );
-  gdcm_assert( studyuid );
-  const Scanner &scanner = GetScanner();
-
-  Scanner::TagToValue const &ttv = scanner.GetMappingFromTagToValue(Tag(0x20,0xe), seriesuid);
-  Tag tstudyuid(0x20,0xd);
-  bool b = false;
-  if( ttv.find( tstudyuid ) != ttv.end() )
-    {
-    const char *v = ttv.find(tstudyuid)->second;
-    if( v && strcmp(v, studyuid ) == 0 )
-      {
-      b = true;
-      }
-    }
-
-  return b;
+  const char *fn = GetFilename( index, value );
+  if( fn ) return scanner.GetMapping( fn );
+  return scanner.GetMappings().find( "" )->second; // dummy file
 }
 
-bool DICOMDIRGenerator::ImageBelongToSeries(const char *sopuid, const char *seriesuid, Tag const &t1, Tag const &t2)
+void DICOMDIRGeneratorInternal::AddRecord(RecordType type, const char *key, Tag const &parenttag, Scanner::TagToValue const &ttv)
 {
-  gdcm_assert( seriesuid );
-  gdcm_assert( sopuid );
-  const Scanner &scanner = GetScanner();
-
-  Scanner::TagToValue const &ttv = scanner.GetMappingFromTagToValue(t1, sopuid);
-  bool b = false;
-  if( ttv.find( t2 ) != ttv.end() )
-    {
-    const char *v = ttv.find(t2)->second;
-    if( v && strcmp(v, seriesuid) == 0 )
-      {
-      b = true;
-      }
-    }
-
-  return b;
-}
-
-bool DICOMDIRGenerator::ImageBelongToSameSeries(const char *sopuid1, const char *sopuid2, Tag const &t)
-{
-  gdcm_assert( sopuid1 );
-  gdcm_assert( sopuid2 );
-  const Scanner &scanner = GetScanner();
-
-  Scanner::TagToValue const &ttv1 = scanner.GetMappingFromTagToValue(t, sopuid1);
-  Scanner::TagToValue const &ttv2 = scanner.GetMappingFromTagToValue(t, sopuid2);
-  Tag tseriesuid = GetParentTag( t );
-  if( tseriesuid == Tag(0x0,0x0) )
+  Record r;
+  r.Type = type;
+  r.Key = key;
+  if( type == PATIENT )
     {
     // Let's pretend that Patient belong to the same 'root' element:
-    return true;
+    r.HasParent = true;
     }
-  bool b = false;
-  const char *seriesuid1 = nullptr;
-  if( ttv1.find( tseriesuid ) != ttv1.end() )
-    {
-    seriesuid1 = ttv1.find(tseriesuid)->second;
-    }
-  const char *seriesuid2 = nullptr;
-  if( ttv2.find( tseriesuid ) != ttv2.end() )
+  else
     {
-    seriesuid2 = ttv2.find(tseriesuid)->second;
+    const char *parent = FindValue( ttv, parenttag );
+    r.HasParent = parent != nullptr;
+    if( parent ) r.Parent = parent;
     }
-  gdcm_assert( seriesuid1 );
-  gdcm_assert( seriesuid2 );
-
-  b = strcmp( seriesuid1, seriesuid2) == 0;
-  return b;
+  Records.push_back( r );
 }
 
-size_t DICOMDIRGenerator::FindLowerLevelDirectoryRecord( size_t item1, const char *directorytype )
+bool DICOMDIRGenerator::ComputeDirectoryRecordsOffset(const SequenceOfItems *sqi, VL start)
 {
-//  return FindNextDirectoryRecord( item1, GetLowerLevelDirectoryRecord( directorytype ) );
-  const char *lowerdirectorytype = GetLowerLevelDirectoryRecord( directorytype );
-  if( !lowerdirectorytype ) return 0;
-
-  const SequenceOfItems *sqi = GetDirectoryRecordSequence();
   SequenceOfItems::SizeType nitems = sqi->GetNumberOfItems();
-  for(SequenceOfItems::SizeType i = item1 + 1; i <= nitems; ++i)
+  std::vector<uint32_t> &offsets = Internals->OffsetTable;
+  Internals->OffsetTable.resize( nitems + 1 );
+  offsets[0] = start;
+  for(SequenceOfItems::SizeType i = 1; i <= nitems; ++i)
     {
     const Item &item = sqi->GetItem(i);
-    const DataSet &ds = item.GetNestedDataSet();
-    Attribute<0x4,0x1430> directoryrecordtype;
-    directoryrecordtype.Set( ds );
-
-    // found a match ?
-    if( strcmp( lowerdirectorytype, directoryrecordtype.GetValue() ) == 0 )
-      {
-      // Need to make sure belong to same parent record:
-      MyPair refval1 = GetReferenceValueForDirectoryType(item1);
-      MyPair refval2 = GetReferenceValueForDirectoryType(i);
-      bool b = ImageBelongToSeries(refval2.first.c_str(),
-        refval1.first.c_str(), refval2.second, refval1.second);
-      if( b ) return i;
-      }
-    //gdcm_assert( strncmp( lowerdirectorytype, directoryrecordtype.GetValue(), strlen( lowerdirectorytype ) ) != 0 );
+    offsets[i] = offsets[i-1] + item.GetLength<ExplicitDataElement>();
     }
 
-  // Not found
-  return 0;
-
-}
-
-/*
- * Finding the next Directory Record type is easy, simply starting from the start and iterating
- * to the end guarantees traversing everything without omitting anyone.
- *
- * TODO: Need to make sure that Series belong to the same Study...
- */
-size_t DICOMDIRGenerator::FindNextDirectoryRecord( size_t item1, const char *directorytype )
-{
-  if( !directorytype ) return 0;
-  const SequenceOfItems *sqi = GetDirectoryRecordSequence();
-  SequenceOfItems::SizeType nitems = sqi->GetNumberOfItems();
-  for(SequenceOfItems::SizeType i = item1 + 1; i <= nitems; ++i)
+//#define MDEBUG
+#ifdef MDEBUG
+  for(unsigned int i = 0; i <= nitems; ++i)
     {
-    const Item &item = sqi->GetItem(i);
-    const DataSet &ds = item.GetNestedDataSet();
-    Attribute<0x4,0x1430> directoryrecordtype;
-    directoryrecordtype.Set( ds );
-
-    // found a match ?
-    if( strcmp( directorytype, directoryrecordtype.GetValue() ) == 0 )
-      {
-      // Need to make sure belong to same parent record:
-      MyPair refval1 = GetReferenceValueForDirectoryType(item1);
-      MyPair refval2 = GetReferenceValueForDirectoryType(i);
-      bool b = ImageBelongToSameSeries(refval1.first.c_str(), refval2.first.c_str(), refval1.second);
-      if( b ) return i;
-      }
-    //gdcm_assert( strncmp( directorytype, directoryrecordtype.GetValue(), strlen( directorytype ) ) != 0 );
+    std::cout << "offset #" << i << " -> "<< offsets[i] << std::endl;
     }
+#endif
 
-  // Not found
-  return 0;
+  return true;
 }
 
+/*
+ * Directory Records are stored as: all PATIENT, then all STUDY, then all
+ * SERIES and finally all IMAGE. A record points to the next record of the
+ * same type sharing the same parent, and to the first record of the lower
+ * level type having itself as parent. Both are computed in a single pass
+ * using hash tables keyed on (type, parent reference value).
+ */
 bool DICOMDIRGenerator::TraverseDirectoryRecords(VL start )
 {
   SequenceOfItems *sqi = GetDirectoryRecordSequence();
 
   ComputeDirectoryRecordsOffset(sqi, start);
 
+  typedef DICOMDIRGeneratorInternal::Record Record;
+  std::vector<Record> const &records = Internals->Records;
   SequenceOfItems::SizeType nitems = sqi->GetNumberOfItems();
+  gdcm_assert( records.size() == nitems );
+  if( records.size() != nitems ) return false;
+
+  std::unordered_map<std::string, size_t> lastsibling;
+  std::unordered_map<std::string, size_t> firstchild;
+  SequenceOfItems::SizeType lastpatient = 0;
   for(SequenceOfItems::SizeType i = 1; i <= nitems; ++i)
     {
-    Item &item = sqi->GetItem(i);
-    DataSet &ds = item.GetNestedDataSet();
-    Attribute<0x4,0x1430> directoryrecordtype;
-    directoryrecordtype.Set( ds );
-    //std::cout << "FOUND DIRECTORY TYPE:" << directoryrecordtype.GetValue() << std::endl;
-    size_t next = FindNextDirectoryRecord( i, directoryrecordtype.GetValue() );
-    if( next )
+    const Record &r = records[i-1];
+    if( r.Type == DICOMDIRGeneratorInternal::PATIENT ) lastpatient = i;
+    if( !r.HasParent ) continue;
+    const std::string key = std::string(1, (char)r.Type) + r.Parent;
+    std::unordered_map<std::string, size_t>::iterator it = lastsibling.find( key );
+    if( it != lastsibling.end() )
       {
+      DataSet &ds = sqi->GetItem( it->second ).GetNestedDataSet();
       Attribute<0x4,0x1400> offsetofthenextdirectoryrecord = {0};
-      offsetofthenextdirectoryrecord.SetValue( Internals->OffsetTable[ next - 1 ] );
+      offsetofthenextdirectoryrecord.SetValue( Internals->OffsetTable[ i - 1 ] );
       ds.Replace( offsetofthenextdirectoryrecord.GetAsDataElement() );
+      it->second = i;
+      }
+    else
+      {
+      lastsibling.insert( std::make_pair( key, i ) );
+      firstchild.insert( std::make_pair( key, i ) );
       }
-    size_t lower = FindLowerLevelDirectoryRecord( i, directoryrecordtype.GetValue() );
-    if( lower )
+    }
+
+  for(SequenceOfItems::SizeType i = 1; i <= nitems; ++i)
+    {
+    const Record &r = records[i-1];
+    if( r.Type == DICOMDIRGeneratorInternal::IMAGE ) continue;
+    const std::string key = std::string(1, (char)(r.Type + 1)) + r.Key;
+    std::unordered_map<std::string, size_t>::const_iterator it = firstchild.find( key );
+    if( it != firstchild.end() )
       {
+      DataSet &ds = sqi->GetItem(i).GetNestedDataSet();
       Attribute<0x4,0x1420> offsetofreferencedlowerleveldirectoryentity = {0};
-      offsetofreferencedlowerleveldirectoryentity.SetValue( Internals->OffsetTable[ lower - 1 ] );
+      offsetofreferencedlowerleveldirectoryentity.SetValue( Internals->OffsetTable[ it->second - 1 ] );
       ds.Replace( offsetofreferencedlowerleveldirectoryentity.GetAsDataElement() );
       }
     }
+
+  // The root Directory Entity is made of the PATIENT records:
+  if( lastpatient )
+    {
+    Attribute<0x4,0x1202> offsetofthelastdirectoryrecordoftherootdirectoryentity = {0};
+    offsetofthelastdirectoryrecordoftherootdirectoryentity.SetValue( Internals->OffsetTable[ lastpatient - 1 ] );
+    GetFile().GetDataSet().Replace( offsetofthelastdirectoryrecordoftherootdirectoryentity.GetAsDataElement() );
+    }
   return true;
 }
 
@@ -417,7 +291,7 @@ bool DICOMDIRGenerator::AddPatientDirectoryRecord()
     const char *pid = it->c_str();
     if( ! (pid && *pid) )
       {
-      const char *fn = scanner.GetFilenameFromTagToValue(patientid.GetTag(), pid);
+      const char *fn = Internals->GetFilename(Internals->PatientIndex, pid);
       gdcmErrorMacro( "Missing Patient ID from file: " << fn );
       (void)fn; //warning removal
       return false;
@@ -426,7 +300,7 @@ bool DICOMDIRGenerator::AddPatientDirectoryRecord()
     patientid.SetValue( pid );
     ds.Insert( patientid.GetAsDataElement() );
 
-    Scanner::TagToValue const &ttv = scanner.GetMappingFromTagToValue(patientid.GetTag(), pid);
+    Scanner::TagToValue const &ttv = Internals->GetMapping(Internals->PatientIndex, pid);
     Attribute<0x10,0x10> patientsname;
     if( ttv.find( patientsname.GetTag() ) != ttv.end() )
       {
@@ -440,6 +314,7 @@ bool DICOMDIRGenerator::AddPatientDirectoryRecord()
     //SingleDataElementInserter<0x10,0x40>(ds, scanner);
 
     sqi->AddItem( item );
+    Internals->AddRecord( DICOMDIRGeneratorInternal::PATIENT, pid, Tag(0x0,0x0), ttv );
     }
 
   return true;
@@ -491,7 +366,7 @@ bool DICOMDIRGenerator::AddStudyDirectoryRecord()
     const char *studyuid = it->c_str();
     if( ! (studyuid && *studyuid) )
       {
-      const char *fn = scanner.GetFilenameFromTagToValue(studyinstanceuid.GetTag(), studyuid);
+      const char *fn = Internals->GetFilename(Internals->StudyIndex, studyuid);
       gdcmErrorMacro( "Missing Study Instance UID from file: " << fn );
       (void)fn;//warning removal
       return false;
@@ -506,7 +381,7 @@ bool DICOMDIRGenerator::AddStudyDirectoryRecord()
     //SingleDataElementInserter<0x8,0x1030>(ds, scanner);
     //SingleDataElementInserter<0x8,0x50>(ds, scanner);
     //SingleDataElementInserter<0x20,0x10>(ds, scanner);
-    Scanner::TagToValue const &ttv = scanner.GetMappingFromTagToValue(studyinstanceuid.GetTag(), studyuid);
+    Scanner::TagToValue const &ttv = Internals->GetMapping(Internals->StudyIndex, studyuid);
 
     Attribute<0x8,0x20> studydate;
     if( ttv.find( studydate.GetTag() ) != ttv.end() )
@@ -540,6 +415,7 @@ bool DICOMDIRGenerator::AddStudyDirectoryRecord()
       }
 
     sqi->AddItem( item );
+    Internals->AddRecord( DICOMDIRGeneratorInternal::STUDY, studyuid, Tag(0x10,0x20), ttv );
     }
 
   return true;
@@ -592,7 +468,7 @@ bool DICOMDIRGenerator::AddSeriesDirectoryRecord()
     const char *seriesuid = it->c_str();
     if( ! (seriesuid && *seriesuid) )
       {
-      const char *fn = scanner.GetFilenameFromTagToValue(seriesinstanceuid.GetTag(), seriesuid);
+      const char *fn = Internals->GetFilename(Internals->SeriesIndex, seriesuid);
       gdcmErrorMacro( "Missing Study Instance UID from file: " << fn );
       (void)fn;//warning removal
       return false;
@@ -601,7 +477,7 @@ bool DICOMDIRGenerator::AddSeriesDirectoryRecord()
     seriesinstanceuid.SetValue( seriesuid );
     ds.Insert( seriesinstanceuid.GetAsDataElement() );
 
-    Scanner::TagToValue const &ttv = scanner.GetMappingFromTagToValue(seriesinstanceuid.GetTag(), seriesuid);
+    Scanner::TagToValue const &ttv = Internals->GetMapping(Internals->SeriesIndex, seriesuid);
     Attribute<0x8,0x60> modality;
     if( ttv.find( modality.GetTag() ) != ttv.end() )
       {
@@ -616,6 +492,7 @@ bool DICOMDIRGenerator::AddSeriesDirectoryRecord()
       }
 
     sqi->AddItem( item );
+    Internals->AddRecord( DICOMDIRGeneratorInternal::SERIES, seriesuid, Tag(0x20,0xd), ttv );
     }
 
   return true;
@@ -673,9 +550,9 @@ bool DICOMDIRGenerator::AddImageDirectoryRecord()
     ds.Insert( directoryrecordtype.GetAsDataElement() );
 
     const char *sopuid = it->c_str();
-    Scanner::TagToValue const &ttv = scanner.GetMappingFromTagToValue(sopinstanceuid.GetTag(), sopuid);
+    Scanner::TagToValue const &ttv = Internals->GetMapping(Internals->ImageIndex, sopuid);
     Attribute<0x0004,0x1500> referencedfileid;
-    const char *fn_str = scanner.GetFilenameFromTagToValue(sopinstanceuid.GetTag(), sopuid);
+    const char *fn_str = Internals->GetFilename(Internals->ImageIndex, sopuid);
     referencedfileid.SetNumberOfValues( 1 );
     Filename fn = fn_str;
     std::string relative = fn.ToWindowsSlashes();
@@ -734,6 +611,7 @@ bool DICOMDIRGenerator::AddImageDirectoryRecord()
     ds.Insert( de2 );
 
     sqi->AddItem( item );
+    Internals->AddRecord( DICOMDIRGeneratorInternal::IMAGE, sopuid, Tag(0x20,0xe), ttv );
     }
 
   return true;
@@ -877,6 +755,7 @@ bool DICOMDIRGenerator::Generate()
     {
     return false;
     }
+  Internals->BuildIndices();
 
   //scanner.Print( std::cout );
 
@@ -993,29 +872,8 @@ the File-set.
   offsetofthefirstdirectoryrecordoftherootdirectoryentity.SetValue( fmi_len + fmi_len_offset );
   ds.Replace( offsetofthefirstdirectoryrecordoftherootdirectoryentity.GetAsDataElement() );
 
-  VL fmi_len_offset2 = 0;
-{
-  DataSet::ConstIterator it = ds.Begin();
-  for( ; it != ds.End() && it->GetTag() <= Tag(0x0004,0x1220); ++it)
-    {
-    const DataElement &detmp = *it;
-    fmi_len_offset2 += detmp.GetLength<ExplicitDataElement>();
-    }
-}
-
-{
-  //const DataElement &de_drs = ds.GetDataElement( Tag(0x4,0x1220) ); // DirectoryRecordSequence
-  SmartPointer<SequenceOfItems> sqi = de_drs.GetValueAsSQ();
-  SequenceOfItems::SizeType n = sqi->GetNumberOfItems();
-  const Item &item = sqi->GetItem( n ); // last item
-  VL sub = item.GetLength<ExplicitDataElement>();
-  // Let's subtract item length as well as the item sequence delimiter end (tag + vl => 8)
-  offsetofthelastdirectoryrecordoftherootdirectoryentity.SetValue( fmi_len + fmi_len_offset2 - sub - 8 );
-
-  ds.Replace( offsetofthelastdirectoryrecordoftherootdirectoryentity.GetAsDataElement() );
-
+  // Offset of the last root record is set along with the other links:
   TraverseDirectoryRecords(offsetofthefirstdirectoryrecordoftherootdirectoryentity.GetValue() );
-}
 
   return true;
 }
@@ -1055,4 +913,9 @@ void DICOMDIRGenerator::SetDescriptor( const char *d )
   Internals->FileSetID = d;
 }
 
+void DICOMDIRGenerator::SetNumberOfThreads( unsigned int nthreads )
+{
+  Internals->scanner.SetNumberOfThreads( nthreads );
+}
+
 } // end namespace gdcm
@@ -71,6 +71,10 @@ public:
   /// \warning this need to be a valid VR::CS value
   void SetDescriptor( const char *d );
 
+  /// Set the number of threads used to scan the input files (default: 1).
+  /// 0 means use the number of hardware threads. See Scanner::SetNumberOfThreads
+  void SetNumberOfThreads( unsigned int nthreads );
+
   /// Main function to generate the DICOMDIR
   bool Generate();
 
@@ -89,14 +93,7 @@ private:
   const char *ComputeFileID(const char *);
   bool TraverseDirectoryRecords(VL start );
   bool ComputeDirectoryRecordsOffset(const SequenceOfItems *sqi, VL start);
-  size_t FindNextDirectoryRecord( size_t item1, const char *directorytype );
   SequenceOfItems *GetDirectoryRecordSequence();
-  size_t FindLowerLevelDirectoryRecord( size_t item1, const char *directorytype );
-  typedef std::pair< std::string, Tag> MyPair;
-  MyPair GetReferenceValueForDirectoryType(size_t item);
-  bool SeriesBelongToStudy(const char *seriesuid, const char *studyuid);
-  bool ImageBelongToSeries(const char *sopuid, const char *seriesuid, Tag const &t1, Tag const &t2);
-  bool ImageBelongToSameSeries(const char *sopuid, const char *seriesuid, Tag const &t);
 
   DICOMDIRGeneratorInternal * Internals;
 };
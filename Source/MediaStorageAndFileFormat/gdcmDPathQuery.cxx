@@ -0,0 +1,276 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmDPathQuery.h"
+#include "gdcmDataSet.h"
+#include "gdcmPrivateTag.h"
+#include "gdcmReader.h"
+#include "gdcmSequenceOfItems.h"
+
+#include <map>
+#include <set>
+#include <sstream>
+#include <cstdio>
+#include <cstring>
+
+namespace gdcm {
+
+// The plan is a prefix tree: a data set node lists the attributes walked
+// in the data set, an element node lists the paths ending on the attribute
+// and the items walked in its sequence. Nodes refer to each other by index.
+static const size_t NoNode = (size_t)-1;
+
+struct DPathQueryDataSetNode {
+  std::map<Tag, size_t> Public;
+  std::vector<std::pair<PrivateTag, size_t> > Private;
+  std::set<uint16_t> PrivateGroups;
+};
+
+struct DPathQueryElementNode {
+  DPathQueryElementNode() : AnyItem(NoNode) {}
+  std::vector<size_t> Paths;
+  std::map<unsigned int, size_t> Items;
+  size_t AnyItem;
+};
+
+class DPathQueryInternals {
+ public:
+  DPathQueryInternals() { DataSets.resize(1); }
+  std::vector<DPathQueryDataSetNode> DataSets;  // [0] is the root data set
+  std::vector<DPathQueryElementNode> Elements;
+  std::vector<std::string> Paths;
+
+  size_t AddElement(size_t dsnode, const std::string &comp);
+  size_t AddItem(size_t elnode, const std::string &comp);
+  void Walk(const DataSet &ds, size_t dsnode,
+            DPathQuery::ResultsType &results) const;
+  void Visit(const DataElement &de, size_t elnode,
+             DPathQuery::ResultsType &results) const;
+};
+
+static bool IsAnyOwner(const PrivateTag &pt) {
+  const char *owner = pt.GetOwner();
+  return owner[0] == '*' && owner[1] == 0;
+}
+
+size_t DPathQueryInternals::AddElement(size_t dsnode, const std::string &comp) {
+  PrivateTag pt;
+  Tag t;
+  const size_t newnode = Elements.size();
+  if (pt.ReadFromCommaSeparatedString(comp.c_str())) {
+    std::vector<std::pair<PrivateTag, size_t> > &privates =
+        DataSets[dsnode].Private;
+    for (std::vector<std::pair<PrivateTag, size_t> >::const_iterator it =
+             privates.begin();
+         it != privates.end(); ++it) {
+      if (it->first == pt && strcmp(it->first.GetOwner(), pt.GetOwner()) == 0)
+        return it->second;
+    }
+    privates.push_back(std::make_pair(pt, newnode));
+    DataSets[dsnode].PrivateGroups.insert(pt.GetGroup());
+  } else if (t.ReadFromCommaSeparatedString(comp.c_str())) {
+    std::map<Tag, size_t>::const_iterator it = DataSets[dsnode].Public.find(t);
+    if (it != DataSets[dsnode].Public.end()) return it->second;
+    DataSets[dsnode].Public[t] = newnode;
+  } else {
+    return NoNode;
+  }
+  Elements.resize(newnode + 1);
+  return newnode;
+}
+
+size_t DPathQueryInternals::AddItem(size_t elnode, const std::string &comp) {
+  size_t *dsnode;
+  unsigned int index = 0;
+  if (comp == "*") {
+    dsnode = &Elements[elnode].AnyItem;
+  } else if (sscanf(comp.c_str(), "%u", &index) == 1 && index > 0) {
+    std::map<unsigned int, size_t>::iterator it =
+        Elements[elnode].Items.insert(std::make_pair(index, NoNode)).first;
+    dsnode = &it->second;
+  } else {
+    return NoNode;
+  }
+  if (*dsnode == NoNode) {
+    *dsnode = DataSets.size();
+    DataSets.resize(DataSets.size() + 1);
+  }
+  return *dsnode;
+}
+
+void DPathQueryInternals::Visit(const DataElement &de, size_t elnode,
+                                DPathQuery::ResultsType &results) const {
+  const DPathQueryElementNode &node = Elements[elnode];
+  for (std::vector<size_t>::const_iterator it = node.Paths.begin();
+       it != node.Paths.end(); ++it) {
+    results[*it].push_back(de);
+  }
+  if (node.Items.empty() && node.AnyItem == NoNode) return;
+  SmartPointer<SequenceOfItems> sqi = de.GetValueAsSQ();
+  if (!sqi) return;
+  const SequenceOfItems::SizeType n = sqi->GetNumberOfItems();
+  if (node.AnyItem != NoNode) {
+    for (SequenceOfItems::SizeType i = 1; i <= n; ++i) {
+      Walk(sqi->GetItem(i).GetNestedDataSet(), node.AnyItem, results);
+    }
+  }
+  for (std::map<unsigned int, size_t>::const_iterator it = node.Items.begin();
+       it != node.Items.end() && it->first <= n; ++it) {
+    Walk(sqi->GetItem(it->first).GetNestedDataSet(), it->second, results);
+  }
+}
+
+void DPathQueryInternals::Walk(const DataSet &ds, size_t dsnode,
+                               DPathQuery::ResultsType &results) const {
+  const DPathQueryDataSetNode &node = DataSets[dsnode];
+  const DataSet::DataElementSet &des = ds.GetDES();
+  // Public attributes, both sides are sorted:
+  DataSet::ConstIterator dit = des.begin();
+  for (std::map<Tag, size_t>::const_iterator it = node.Public.begin();
+       it != node.Public.end() && dit != des.end(); ++it) {
+    dit = des.lower_bound(DataElement(it->first));
+    if (dit != des.end() && dit->GetTag() == it->first) {
+      Visit(*dit, it->second, results);
+    }
+  }
+  // Private attributes are found through the creators of their group:
+  for (std::set<uint16_t>::const_iterator git = node.PrivateGroups.begin();
+       git != node.PrivateGroups.end(); ++git) {
+    const uint16_t group = *git;
+    for (dit = des.lower_bound(DataElement(Tag(group, 0x0010)));
+         dit != des.end() && dit->GetTag().GetGroup() == group &&
+         dit->GetTag().GetElement() < 0x100;
+         ++dit) {
+      const ByteValue *bv = dit->GetByteValue();
+      if (!bv) continue;
+      std::string owner =
+          std::string(bv->GetPointer(), bv->GetLength()).c_str();
+      owner.erase(owner.find_last_not_of(' ') + 1);
+      const uint16_t block = (uint16_t)(dit->GetTag().GetElement() << 8);
+      for (std::vector<std::pair<PrivateTag, size_t> >::const_iterator it =
+               node.Private.begin();
+           it != node.Private.end(); ++it) {
+        const PrivateTag &pt = it->first;
+        if (pt.GetGroup() != group) continue;
+        if (!IsAnyOwner(pt) && owner != pt.GetOwner()) continue;
+        const Tag t(group, (uint16_t)(block | (pt.GetElement() & 0xff)));
+        DataSet::ConstIterator found = des.find(DataElement(t));
+        if (found != des.end()) {
+          Visit(*found, it->second, results);
+        }
+      }
+    }
+  }
+}
+
+DPathQuery::DPathQuery() : Internals(new DPathQueryInternals) {}
+
+DPathQuery::~DPathQuery() { delete Internals; }
+
+int DPathQuery::AddPath(const char *path) {
+  DPath dpath;
+  if (!dpath.ConstructFromString(path)) return -1;
+  return AddPath(dpath);
+}
+
+int DPathQuery::AddPath(DPath const &dpath) {
+  // DPath is normalized as: \gggg,eeee\item\gggg,ee,owner...
+  std::ostringstream oss;
+  oss << dpath;
+  const std::string path = oss.str();
+  std::vector<std::string> comps;
+  std::istringstream is(path);
+  std::string sub;
+  while (std::getline(is, sub, '\\')) comps.push_back(sub);
+  // odd number of components after the empty root, ending on an attribute:
+  if (comps.size() < 2 || !comps[0].empty() || comps.size() % 2 != 0) {
+    gdcmErrorMacro("Path does not address an attribute: " << path);
+    return -1;
+  }
+  // validate first, so that a bad path does not leave dangling nodes:
+  for (size_t i = 1; i < comps.size(); ++i) {
+    PrivateTag pt;
+    Tag t;
+    unsigned int index;
+    const char *str = comps[i].c_str();
+    const bool istag = pt.ReadFromCommaSeparatedString(str) ||
+                       t.ReadFromCommaSeparatedString(str);
+    const bool isitem = comps[i] == "*" ||
+                        (sscanf(str, "%u", &index) == 1 && index > 0);
+    if ((i % 2 == 1 && !istag) || (i % 2 == 0 && !isitem)) {
+      gdcmErrorMacro("Invalid path component: " << comps[i]);
+      return -1;
+    }
+  }
+  size_t dsnode = 0;
+  size_t elnode = NoNode;
+  for (size_t i = 1; i < comps.size(); ++i) {
+    if (i % 2 == 1)
+      elnode = Internals->AddElement(dsnode, comps[i]);
+    else
+      dsnode = Internals->AddItem(elnode, comps[i]);
+  }
+  const size_t index = Internals->Paths.size();
+  Internals->Elements[elnode].Paths.push_back(index);
+  Internals->Paths.push_back(path);
+  return (int)index;
+}
+
+size_t DPathQuery::GetNumberOfPaths() const { return Internals->Paths.size(); }
+
+void DPathQuery::Clear() {
+  delete Internals;
+  Internals = new DPathQueryInternals;
+}
+
+bool DPathQuery::Execute(DataSet const &ds, ResultsType &results) const {
+  results.clear();
+  results.resize(Internals->Paths.size());
+  Internals->Walk(ds, 0, results);
+  for (ResultsType::const_iterator it = results.begin(); it != results.end();
+       ++it) {
+    if (!it->empty()) return true;
+  }
+  return false;
+}
+
+bool DPathQuery::Read(Reader &reader, ResultsType &results) const {
+  const DPathQueryDataSetNode &root = Internals->DataSets[0];
+  std::set<Tag> tags;
+  for (std::map<Tag, size_t>::const_iterator it = root.Public.begin();
+       it != root.Public.end(); ++it) {
+    tags.insert(it->first);
+  }
+  bool success;
+  if (root.PrivateGroups.empty()) {
+    success = reader.ReadSelectedTags(tags);
+  } else {
+    // private elements cannot be selected before their creator is known,
+    // read the groups completely:
+    Tag last(*root.PrivateGroups.rbegin(), 0xffff);
+    if (!tags.empty() && last < *tags.rbegin()) last = *tags.rbegin();
+    success = reader.ReadUpToTag(last);
+  }
+  if (!success) return false;
+  Execute(reader.GetFile().GetDataSet(), results);
+  return true;
+}
+
+void DPathQuery::Print(std::ostream &os) const {
+  for (std::vector<std::string>::const_iterator it = Internals->Paths.begin();
+       it != Internals->Paths.end(); ++it) {
+    os << *it << std::endl;
+  }
+}
+
+}  // end namespace gdcm
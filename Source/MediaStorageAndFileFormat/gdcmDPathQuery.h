@@ -0,0 +1,76 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMDPATHQUERY_H
+#define GDCMDPATHQUERY_H
+
+#include "gdcmDPath.h"
+#include "gdcmDataElement.h"
+
+#include <vector>
+
+namespace gdcm {
+
+class DataSet;
+class Reader;
+class DPathQueryInternals;
+
+/**
+ * \brief Compiled set of DPath expressions
+ * All the paths added to a query are merged into a single traversal plan
+ * (a prefix tree of tags and item numbers), so that the matches of every
+ * path are extracted in one walk of a DataSet instead of one walk per path.
+ * The wildcard '*' can be used in place of an item number (any item) and
+ * in place of a private creator (eg. "/0029,10,*" matches any creator).
+ * \see DPath
+ */
+class GDCM_EXPORT DPathQuery {
+ public:
+  DPathQuery();
+  ~DPathQuery();
+  DPathQuery(const DPathQuery &) = delete;
+  DPathQuery &operator=(const DPathQuery &) = delete;
+
+  /// Add a path to the query. Return the index of the path in the results,
+  /// or -1 when the path is invalid or does not end on a data element.
+  int AddPath(DPath const &dpath);
+  int AddPath(const char *path);
+
+  /// Return the number of paths in the query
+  size_t GetNumberOfPaths() const;
+
+  /// Remove all paths
+  void Clear();
+
+  /// results[i] contains the data elements matching path i, in data set order
+  typedef std::vector<std::vector<DataElement> > ResultsType;
+
+  /// Extract the data elements matching all the paths from \param ds.
+  /// Return true when at least one path was matched.
+  bool Execute(DataSet const &ds, ResultsType &results) const;
+
+  /// Read from \param reader only the top level attributes needed by the
+  /// query, then Execute it on the resulting data set. Use
+  /// Reader::SetLazySequenceParsing so that only the sequences walked by
+  /// the query are parsed. Return false when the file could not be read.
+  bool Read(Reader &reader, ResultsType &results) const;
+
+  void Print(std::ostream &os) const;
+
+ private:
+  DPathQueryInternals *Internals;
+};
+
+}  // end namespace gdcm
+
+#endif  // GDCMDPATHQUERY_H
@@ -500,8 +500,8 @@ void DictPrinter::PrintDataElement2(std::ostream& os, const DataSet &ds, const D
     SmartPointer<SequenceOfItems> sqi = de.GetValueAsSQ();
     if( sqi )
       {
-      SequenceOfItems::ItemVector::const_iterator it = sqi->Items.begin();
-      for(; it != sqi->Items.end(); ++it)
+      SequenceOfItems::ItemVector::const_iterator it = sqi->Begin();
+      for(; it != sqi->End(); ++it)
         {
         const Item &item = *it;
         const DataSet &nestedds = item.GetNestedDataSet();
@@ -12,9 +12,10 @@
 
 =========================================================================*/
 #include "gdcmDirectionCosines.h"
+#include "gdcmDecimalString.h"
 
 #include <cmath> // fabs
-#include <cstdio> // sscanf
+#include <cstring> // strlen
 #include <limits>
 
 namespace gdcm
@@ -145,9 +146,16 @@ bool DirectionCosines::SetFromString(const char *str)
 {
   if( str )
     {
-    const int n = sscanf( str, R"(%lf\%lf\%lf\%lf\%lf\%lf)",
-      Values, Values+1, Values+2, Values+3, Values+4, Values+5 );
-    if( n == 6 )
+    // Parse the 6 backslash separated values, independently of the locale:
+    const char *p = str;
+    const char *end = str + strlen(str);
+    int n = 0;
+    for( ; n < 6 && p; ++n )
+      {
+      if( n && (p == end || *p++ != '\\') ) break;
+      p = DecimalString::Parse( p, end, Values[n] );
+      }
+    if( n == 6 && p )
       {
       return true;
       }
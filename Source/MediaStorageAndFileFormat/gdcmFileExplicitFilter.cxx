@@ -167,8 +167,8 @@ bool FileExplicitFilter::ProcessDataSet(DataSet &ds, Dicts const & dicts)
       de.SetVLToUndefined();
       gdcm_assert( sqi->GetLength().IsUndefined() );
       // recursive
-      SequenceOfItems::ItemVector::iterator sit = sqi->Items.begin();
-      for(; sit != sqi->Items.end(); ++sit)
+      SequenceOfItems::ItemVector::iterator sit = sqi->Begin();
+      for(; sit != sqi->End(); ++sit)
         {
         //Item &item = const_cast<Item&>(*sit);
         Item &item = *sit;
@@ -271,6 +271,7 @@ public:
     const char *outfilename = OutFilename.c_str();
     gdcm_assert( outfilename );
     actualde = 0;
+    CurrentVR = VR::UN;
       {
       std::ifstream is( outfilename, std::ios::binary );
       if( !is.good() ) return false;
@@ -309,10 +310,23 @@ public:
           }
         actualde = de.GetVL() + 2 * de.GetVR().GetLength() + 4;
         thepos -= actualde;
+        // keep the VR of the template (eg. OW Pixel Data):
+        if( de.GetVR() == VR::OB || de.GetVR() == VR::OW )
+          CurrentVR = de.GetVR();
         }
-      else
+      else if( t == Tag(0x7fe0,0x0010) && TS.IsExplicit() )
         {
-        // no attribute found, easy case !
+        // no attribute found, easy case ! Pixel Data VR follows Bits Allocated:
+        Reader bareader;
+        bareader.SetFileName( outfilename );
+        std::set<Tag> batag;
+        batag.insert( Tag(0x28,0x100) );
+        if( bareader.ReadSelectedTags( batag ) )
+          {
+          Attribute<0x28,0x100> ba = { 0 };
+          ba.SetFromDataSet( bareader.GetFile().GetDataSet() );
+          if( ba.GetValue() ) CurrentVR = ba.GetValue() > 8 ? VR::OW : VR::OB;
+          }
         }
       }
     gdcm_assert( pFile == nullptr );
@@ -528,6 +542,7 @@ public:
       // found a free spot:
       private_creator.GetTag().SetElement( curtag.GetElement() );
       actualde = 0;
+      CurrentVR = VR::UN;
       }
 
     // copy trailing stuff
@@ -671,6 +686,7 @@ private:
   FILE* pFile{nullptr};
   std::streampos thepos;
   size_t actualde;
+  VR CurrentVR{VR::UN};
   size_t CurrentDataLenth;
   Tag CurrentGroupTag;
   off64_t ReservedDataLength{0};
@@ -733,8 +749,7 @@ private:
       tag.Write<SwapperNoOp>(ss);
     if( TS.GetNegociatedType() == TransferSyntax::Explicit )
       {
-      VR un = VR::UN;
-      un.Write(ss);
+      CurrentVR.Write(ss);
       }
     if( TS.GetSwapCode() == SwapCode::BigEndian )
       vl.Write<SwapperDoOp>(ss);
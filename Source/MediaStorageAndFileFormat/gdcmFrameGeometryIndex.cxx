@@ -0,0 +1,485 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmFrameGeometryIndex.h"
+#include "gdcmDataSet.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmAttribute.h"
+
+#include <algorithm>
+#include <map>
+
+namespace gdcm
+{
+
+// Values of one attribute for all frames: N values per frame, or a single
+// set of N values when it was found in the Shared Functional Groups Sequence.
+template <typename T, unsigned int N>
+struct FrameField
+{
+  bool Shared;
+  std::vector<T> Values;
+  std::vector<unsigned char> Present;
+
+  FrameField():Shared(false) {}
+  void Resize(size_t n)
+    {
+    Values.assign( n * N, T() );
+    Present.assign( n, 0 );
+    }
+  void Clear()
+    {
+    Shared = false;
+    Values.clear();
+    Present.clear();
+    }
+  // Called once the shared item is parsed (in slot 0): otherwise keep one
+  // value per frame
+  void SetNumberOfFrames(size_t n)
+    {
+    Shared = !Present.empty() && Present[0];
+    if( !Shared ) Resize( n );
+    }
+  // A shared value is never overridden by a per-frame one
+  bool Set(size_t i, const T *v)
+    {
+    if( Shared ) return false;
+    Present[i] = 1;
+    std::copy( v, v + N, Values.begin() + i * N );
+    return true;
+    }
+  bool Get(size_t frame, T *out) const
+    {
+    const size_t i = Shared ? 0 : frame;
+    if( i >= Present.size() || !Present[i] ) return false;
+    for( unsigned int k = 0; k < N; ++k ) out[k] = Values[i * N + k];
+    return true;
+    }
+};
+
+// Dimension Index Values is VM 1-n: frame i uses
+// Values[Offsets[2*i], Offsets[2*i+1])
+struct DimensionIndexField
+{
+  bool Shared;
+  std::vector<unsigned int> Offsets;
+  std::vector<unsigned int> Values;
+  std::vector<unsigned char> Present;
+
+  DimensionIndexField():Shared(false) {}
+  void Resize(size_t n)
+    {
+    Offsets.assign( 2 * n, 0 );
+    Present.assign( n, 0 );
+    }
+  void Clear()
+    {
+    Shared = false;
+    Offsets.clear();
+    Values.clear();
+    Present.clear();
+    }
+  void SetNumberOfFrames(size_t n)
+    {
+    Shared = !Present.empty() && Present[0];
+    if( !Shared ) Resize( n );
+    }
+  bool Set(size_t i, const std::vector<unsigned int> &v)
+    {
+    if( Shared ) return false;
+    Present[i] = 1;
+    Offsets[2 * i] = (unsigned int)Values.size();
+    Values.insert( Values.end(), v.begin(), v.end() );
+    Offsets[2 * i + 1] = (unsigned int)Values.size();
+    return true;
+    }
+  bool Get(size_t frame, std::vector<unsigned int> &out) const
+    {
+    const size_t i = Shared ? 0 : frame;
+    out.clear();
+    if( i >= Present.size() || !Present[i] ) return false;
+    out.assign( Values.begin() + Offsets[2 * i], Values.begin() + Offsets[2 * i + 1] );
+    return true;
+    }
+};
+
+class FrameGeometryIndexInternals
+{
+public:
+  FrameGeometryIndexInternals():NumberOfFrames(0)
+  {
+    for( int i = 0; i < NumberOfFunctionalGroups; ++i ) InShared[i] = InPerFrame[i] = false;
+  }
+
+  static const int NumberOfFunctionalGroups = FrameGeometryIndex::FrameContent + 1;
+
+  unsigned int NumberOfFrames;
+  // Functional group found in the Shared Functional Groups Sequence:
+  bool InShared[NumberOfFunctionalGroups];
+  // Values of the functional group taken from the Per-frame Functional Groups Sequence:
+  bool InPerFrame[NumberOfFunctionalGroups];
+
+  FrameField<double,3> Positions;
+  FrameField<double,6> Orientations;
+  FrameField<double,2> PixelSpacings;
+  FrameField<double,1> SliceThicknesses;
+  FrameField<double,1> SpacingBetweenSlices;
+  FrameField<double,2> InterceptSlopes;
+  FrameField<double,2> CenterWidths;
+  DimensionIndexField DimensionIndices;
+  // Stack ID are usually shared by many frames, store an index in StackIDs:
+  FrameField<unsigned int,1> StackIDIndices;
+  std::vector<std::string> StackIDs;
+  std::map<std::string, unsigned int> StackIDMap;
+  FrameField<unsigned int,1> InStackPositionNumbers;
+  FrameField<unsigned int,1> TemporalPositionIndices;
+
+  void Clear();
+  void SetNumberOfFrames(size_t n);
+  bool IsComplete(FrameGeometryIndex::FunctionalGroup fg) const;
+  bool ParseFunctionalGroup(FrameGeometryIndex::FunctionalGroup fg, const DataSet &ds, size_t i);
+};
+
+void FrameGeometryIndexInternals::Clear()
+{
+  NumberOfFrames = 0;
+  for( int i = 0; i < NumberOfFunctionalGroups; ++i ) InShared[i] = InPerFrame[i] = false;
+  Positions.Clear();
+  Orientations.Clear();
+  PixelSpacings.Clear();
+  SliceThicknesses.Clear();
+  SpacingBetweenSlices.Clear();
+  InterceptSlopes.Clear();
+  CenterWidths.Clear();
+  DimensionIndices.Clear();
+  StackIDIndices.Clear();
+  StackIDs.clear();
+  StackIDMap.clear();
+  InStackPositionNumbers.Clear();
+  TemporalPositionIndices.Clear();
+}
+
+// n == 1 before the shared item is parsed, then the number of frames
+void FrameGeometryIndexInternals::SetNumberOfFrames(size_t n)
+{
+  Positions.SetNumberOfFrames( n );
+  Orientations.SetNumberOfFrames( n );
+  PixelSpacings.SetNumberOfFrames( n );
+  SliceThicknesses.SetNumberOfFrames( n );
+  SpacingBetweenSlices.SetNumberOfFrames( n );
+  InterceptSlopes.SetNumberOfFrames( n );
+  CenterWidths.SetNumberOfFrames( n );
+  DimensionIndices.SetNumberOfFrames( n );
+  StackIDIndices.SetNumberOfFrames( n );
+  InStackPositionNumbers.SetNumberOfFrames( n );
+  TemporalPositionIndices.SetNumberOfFrames( n );
+}
+
+// Return whether every attribute of fg was found in the shared item, the
+// per-frame items are then not looked at
+bool FrameGeometryIndexInternals::IsComplete(FrameGeometryIndex::FunctionalGroup fg) const
+{
+  switch( fg )
+    {
+  case FrameGeometryIndex::PlanePosition:
+    return Positions.Shared;
+  case FrameGeometryIndex::PlaneOrientation:
+    return Orientations.Shared;
+  case FrameGeometryIndex::PixelMeasures:
+    return PixelSpacings.Shared && SliceThicknesses.Shared && SpacingBetweenSlices.Shared;
+  case FrameGeometryIndex::PixelValueTransformation:
+    return InterceptSlopes.Shared;
+  case FrameGeometryIndex::FrameVOILUT:
+    return CenterWidths.Shared;
+  case FrameGeometryIndex::FrameContent:
+    return DimensionIndices.Shared && StackIDIndices.Shared
+      && InStackPositionNumbers.Shared && TemporalPositionIndices.Shared;
+    }
+  return false;
+}
+
+static const Tag FunctionalGroupTags[] = {
+  Tag(0x0020,0x9113), // Plane Position Sequence
+  Tag(0x0020,0x9116), // Plane Orientation Sequence
+  Tag(0x0028,0x9110), // Pixel Measures Sequence
+  Tag(0x0028,0x9145), // Pixel Value Transformation Sequence
+  Tag(0x0028,0x9132), // Frame VOI LUT Sequence
+  Tag(0x0020,0x9111)  // Frame Content Sequence
+};
+
+// Return the sequence of the functional group fg found in the functional
+// groups item ds, when it has at least one item
+static SmartPointer<SequenceOfItems> GetFunctionalGroupSQ(const DataSet &ds, FrameGeometryIndex::FunctionalGroup fg)
+{
+  const Tag &t = FunctionalGroupTags[fg];
+  if( !ds.FindDataElement( t ) ) return nullptr;
+  SmartPointer<SequenceOfItems> sqi = ds.GetDataElement( t ).GetValueAsSQ();
+  if( !sqi || sqi->GetNumberOfItems() == 0 ) return nullptr;
+  return sqi;
+}
+
+template <uint16_t Group, uint16_t Element>
+static bool GetDoubleValues(const DataSet &ds, double *out, unsigned int n)
+{
+  const Tag t(Group,Element);
+  if( !ds.FindDataElement( t ) ) return false;
+  const DataElement &de = ds.GetDataElement( t );
+  if( de.IsEmpty() ) return false;
+  Attribute<Group,Element> at;
+  at.SetFromDataElement( de );
+  if( at.GetNumberOfValues() < n ) return false;
+  const typename Attribute<Group,Element>::ArrayType *values = at.GetValues();
+  for( unsigned int i = 0; i < n; ++i ) out[i] = values[i];
+  return true;
+}
+
+template <uint16_t Group, uint16_t Element>
+static bool GetUnsignedValue(const DataSet &ds, unsigned int &out)
+{
+  const Tag t(Group,Element);
+  if( !ds.FindDataElement( t ) ) return false;
+  const DataElement &de = ds.GetDataElement( t );
+  if( de.IsEmpty() ) return false;
+  Attribute<Group,Element> at;
+  at.SetFromDataElement( de );
+  out = at.GetValue();
+  return true;
+}
+
+// Store the values of fg found in the functional group item ds for frame i.
+// Return whether at least one value was stored
+bool FrameGeometryIndexInternals::ParseFunctionalGroup(FrameGeometryIndex::FunctionalGroup fg,
+  const DataSet &ds, size_t i)
+{
+  bool stored = false;
+  double v[6];
+  switch( fg )
+    {
+  case FrameGeometryIndex::PlanePosition:
+    if( GetDoubleValues<0x0020,0x0032>( ds, v, 3 ) )
+      stored |= Positions.Set( i, v );
+    break;
+  case FrameGeometryIndex::PlaneOrientation:
+    if( GetDoubleValues<0x0020,0x0037>( ds, v, 6 ) )
+      stored |= Orientations.Set( i, v );
+    break;
+  case FrameGeometryIndex::PixelMeasures:
+    if( GetDoubleValues<0x0028,0x0030>( ds, v, 2 ) )
+      stored |= PixelSpacings.Set( i, v );
+    if( GetDoubleValues<0x0018,0x0050>( ds, v, 1 ) )
+      stored |= SliceThicknesses.Set( i, v );
+    if( GetDoubleValues<0x0018,0x0088>( ds, v, 1 ) )
+      stored |= SpacingBetweenSlices.Set( i, v );
+    break;
+  case FrameGeometryIndex::PixelValueTransformation:
+    if( GetDoubleValues<0x0028,0x1052>( ds, v, 1 )
+      && GetDoubleValues<0x0028,0x1053>( ds, v + 1, 1 ) )
+      stored |= InterceptSlopes.Set( i, v );
+    break;
+  case FrameGeometryIndex::FrameVOILUT:
+    if( GetDoubleValues<0x0028,0x1050>( ds, v, 1 )
+      && GetDoubleValues<0x0028,0x1051>( ds, v + 1, 1 ) )
+      stored |= CenterWidths.Set( i, v );
+    break;
+  case FrameGeometryIndex::FrameContent:
+      {
+      const Tag tdiv(0x0020,0x9157);
+      if( !DimensionIndices.Shared
+        && ds.FindDataElement( tdiv ) && !ds.GetDataElement( tdiv ).IsEmpty() )
+        {
+        Attribute<0x0020,0x9157> at;
+        at.SetFromDataElement( ds.GetDataElement( tdiv ) );
+        std::vector<unsigned int> div( at.GetValues(), at.GetValues() + at.GetNumberOfValues() );
+        stored |= DimensionIndices.Set( i, div );
+        }
+      const Tag tstackid(0x0020,0x9056);
+      if( !StackIDIndices.Shared
+        && ds.FindDataElement( tstackid ) && !ds.GetDataElement( tstackid ).IsEmpty() )
+        {
+        Attribute<0x0020,0x9056> at;
+        at.SetFromDataElement( ds.GetDataElement( tstackid ) );
+        const std::string stackid = at.GetValue().Trim();
+        std::map<std::string, unsigned int>::const_iterator it = StackIDMap.find( stackid );
+        unsigned int idx;
+        if( it == StackIDMap.end() )
+          {
+          idx = (unsigned int)StackIDs.size();
+          StackIDs.push_back( stackid );
+          StackIDMap.insert( std::make_pair( stackid, idx ) );
+          }
+        else
+          {
+          idx = it->second;
+          }
+        stored |= StackIDIndices.Set( i, &idx );
+        }
+      unsigned int u;
+      if( GetUnsignedValue<0x0020,0x9057>( ds, u ) )
+        stored |= InStackPositionNumbers.Set( i, &u );
+      if( GetUnsignedValue<0x0020,0x9128>( ds, u ) )
+        stored |= TemporalPositionIndices.Set( i, &u );
+      }
+    break;
+    }
+  return stored;
+}
+
+FrameGeometryIndex::FrameGeometryIndex():Internals(new FrameGeometryIndexInternals)
+{
+}
+
+FrameGeometryIndex::~FrameGeometryIndex()
+{
+  delete Internals;
+}
+
+bool FrameGeometryIndex::Build(DataSet const &ds, unsigned int nframes)
+{
+  FrameGeometryIndexInternals &in = *Internals;
+  in.Clear();
+
+  const Tag tsfgs(0x5200,0x9229);
+  const Tag tpffgs(0x5200,0x9230);
+  SmartPointer<SequenceOfItems> sharedsq;
+  SmartPointer<SequenceOfItems> perframesq;
+  if( ds.FindDataElement( tsfgs ) )
+    sharedsq = ds.GetDataElement( tsfgs ).GetValueAsSQ();
+  if( ds.FindDataElement( tpffgs ) )
+    perframesq = ds.GetDataElement( tpffgs ).GetValueAsSQ();
+  if( !sharedsq && !perframesq ) return false;
+
+  if( perframesq )
+    {
+    in.NumberOfFrames = (unsigned int)perframesq->GetNumberOfItems();
+    }
+  else
+    {
+    Attribute<0x0028,0x0008> numberofframes = { 1 };
+    numberofframes.SetFromDataSet( ds );
+    in.NumberOfFrames = numberofframes.GetValue() > 0 ? (unsigned int)numberofframes.GetValue() : 1;
+    }
+
+  // Shared functional groups, stored in slot 0:
+  in.SetNumberOfFrames( 1 );
+  if( sharedsq && sharedsq->GetNumberOfItems() )
+    {
+    const DataSet &shared = sharedsq->GetItem(1).GetNestedDataSet();
+    for( int fg = 0; fg < FrameGeometryIndexInternals::NumberOfFunctionalGroups; ++fg )
+      {
+      SmartPointer<SequenceOfItems> sqi = GetFunctionalGroupSQ( shared, (FunctionalGroup)fg );
+      if( sqi )
+        {
+        in.InShared[fg] = true;
+        in.ParseFunctionalGroup( (FunctionalGroup)fg, sqi->GetItem(1).GetNestedDataSet(), 0 );
+        }
+      }
+    }
+  in.SetNumberOfFrames( in.NumberOfFrames );
+
+  // Per-frame functional groups, single pass over the items. An attribute
+  // missing from the shared item is still looked up here, even when its
+  // functional group sequence was found in the shared item:
+  bool complete[FrameGeometryIndexInternals::NumberOfFunctionalGroups];
+  for( int fg = 0; fg < FrameGeometryIndexInternals::NumberOfFunctionalGroups; ++fg )
+    {
+    complete[fg] = in.IsComplete( (FunctionalGroup)fg );
+    }
+  SequenceOfItems::SizeType nitems = perframesq ? perframesq->GetNumberOfItems() : 0;
+  if( nframes && nframes < nitems ) nitems = nframes;
+  for( SequenceOfItems::SizeType i = 1; i <= nitems; ++i )
+    {
+    const DataSet &subds = perframesq->GetItem(i).GetNestedDataSet();
+    for( int fg = 0; fg < FrameGeometryIndexInternals::NumberOfFunctionalGroups; ++fg )
+      {
+      if( complete[fg] ) continue;
+      SmartPointer<SequenceOfItems> sqi = GetFunctionalGroupSQ( subds, (FunctionalGroup)fg );
+      if( sqi && in.ParseFunctionalGroup( (FunctionalGroup)fg,
+          sqi->GetItem(1).GetNestedDataSet(), i - 1 ) )
+        {
+        in.InPerFrame[fg] = true;
+        }
+      }
+    }
+
+  return true;
+}
+
+unsigned int FrameGeometryIndex::GetNumberOfFrames() const
+{
+  return Internals->NumberOfFrames;
+}
+
+bool FrameGeometryIndex::IsShared(FunctionalGroup fg) const
+{
+  return Internals->InShared[fg] && !Internals->InPerFrame[fg];
+}
+
+bool FrameGeometryIndex::GetImagePositionPatient(unsigned int frame, double ipp[3]) const
+{
+  return Internals->Positions.Get( frame, ipp );
+}
+
+bool FrameGeometryIndex::GetImageOrientationPatient(unsigned int frame, double iop[6]) const
+{
+  return Internals->Orientations.Get( frame, iop );
+}
+
+bool FrameGeometryIndex::GetPixelSpacing(unsigned int frame, double ps[2]) const
+{
+  return Internals->PixelSpacings.Get( frame, ps );
+}
+
+bool FrameGeometryIndex::GetSliceThickness(unsigned int frame, double &st) const
+{
+  return Internals->SliceThicknesses.Get( frame, &st );
+}
+
+bool FrameGeometryIndex::GetSpacingBetweenSlices(unsigned int frame, double &sbs) const
+{
+  return Internals->SpacingBetweenSlices.Get( frame, &sbs );
+}
+
+bool FrameGeometryIndex::GetRescaleInterceptSlope(unsigned int frame, double interceptslope[2]) const
+{
+  return Internals->InterceptSlopes.Get( frame, interceptslope );
+}
+
+bool FrameGeometryIndex::GetWindowCenterWidth(unsigned int frame, double centerwidth[2]) const
+{
+  return Internals->CenterWidths.Get( frame, centerwidth );
+}
+
+bool FrameGeometryIndex::GetDimensionIndexValues(unsigned int frame, std::vector<unsigned int> &div) const
+{
+  return Internals->DimensionIndices.Get( frame, div );
+}
+
+bool FrameGeometryIndex::GetStackID(unsigned int frame, std::string &stackid) const
+{
+  unsigned int idx;
+  if( !Internals->StackIDIndices.Get( frame, &idx ) ) return false;
+  stackid = Internals->StackIDs[idx];
+  return true;
+}
+
+bool FrameGeometryIndex::GetInStackPositionNumber(unsigned int frame, unsigned int &pos) const
+{
+  return Internals->InStackPositionNumbers.Get( frame, &pos );
+}
+
+bool FrameGeometryIndex::GetTemporalPositionIndex(unsigned int frame, unsigned int &index) const
+{
+  return Internals->TemporalPositionIndices.Get( frame, &index );
+}
+
+} // end namespace gdcm
@@ -0,0 +1,107 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMFRAMEGEOMETRYINDEX_H
+#define GDCMFRAMEGEOMETRYINDEX_H
+
+#include "gdcmObject.h"
+
+#include <string>
+#include <vector>
+
+namespace gdcm
+{
+class DataSet;
+class FrameGeometryIndexInternals;
+
+/**
+ * \brief FrameGeometryIndex
+ * \details Per-frame view of the functional groups of an enhanced multi-frame
+ * object. The Shared (5200,9229) and Per-frame (5200,9230) Functional Groups
+ * Sequences are walked once, values are then stored in compact per-frame
+ * arrays:
+ * - Plane Position (0020,9113): Image Position (Patient)
+ * - Plane Orientation (0020,9116): Image Orientation (Patient)
+ * - Pixel Measures (0028,9110): Pixel Spacing, Slice Thickness, Spacing Between Slices
+ * - Pixel Value Transformation (0028,9145): Rescale Intercept / Slope
+ * - Frame VOI LUT (0028,9132): (first) Window Center / Width
+ * - Frame Content (0020,9111): Dimension Index Values, Stack ID, In-Stack
+ *   Position Number, Temporal Position Index
+ *
+ * A value found in the Shared Functional Groups Sequence is stored only once
+ * and applies to all frames. Shared values take precedence over per-frame
+ * ones, as in ImageHelper; an attribute missing from the shared item is looked
+ * up in the per-frame items.
+ *
+ * Frames are numbered from 0. All accessors return false when the value is
+ * not available for the requested frame.
+ *
+ * The index is a snapshot of the data set: the caller builds it and keeps it
+ * as long as the functional groups are not modified, it is not updated when
+ * the data set changes. Call Build again after a modification.
+ *
+ * \see ImageHelper
+ */
+class GDCM_EXPORT FrameGeometryIndex : public Object
+{
+public:
+  FrameGeometryIndex();
+  ~FrameGeometryIndex() override;
+  FrameGeometryIndex(const FrameGeometryIndex&) = delete;
+  void operator=(const FrameGeometryIndex&) = delete;
+
+  typedef enum {
+    PlanePosition = 0,
+    PlaneOrientation,
+    PixelMeasures,
+    PixelValueTransformation,
+    FrameVOILUT,
+    FrameContent
+  } FunctionalGroup;
+
+  /// Parse the functional groups of ds. Return false when ds has neither a
+  /// Shared nor a Per-frame Functional Groups Sequence (the index is then empty)
+  /// When nframes is not 0, only the first nframes items of the Per-frame
+  /// Functional Groups Sequence are parsed.
+  bool Build(DataSet const &ds, unsigned int nframes = 0);
+
+  /// Number of items in the Per-frame Functional Groups Sequence. When only
+  /// the Shared Functional Groups Sequence is found, Number of Frames (0028,0008)
+  unsigned int GetNumberOfFrames() const;
+
+  /// Return whether fg was found in the Shared Functional Groups Sequence and
+  /// none of its values were taken from the Per-frame Functional Groups Sequence
+  bool IsShared(FunctionalGroup fg) const;
+
+  bool GetImagePositionPatient(unsigned int frame, double ipp[3]) const;
+  bool GetImageOrientationPatient(unsigned int frame, double iop[6]) const;
+  /// Pixel Spacing as stored: row spacing then column spacing
+  bool GetPixelSpacing(unsigned int frame, double ps[2]) const;
+  bool GetSliceThickness(unsigned int frame, double &st) const;
+  bool GetSpacingBetweenSlices(unsigned int frame, double &sbs) const;
+  /// Rescale Intercept then Rescale Slope
+  bool GetRescaleInterceptSlope(unsigned int frame, double interceptslope[2]) const;
+  /// Window Center then Window Width
+  bool GetWindowCenterWidth(unsigned int frame, double centerwidth[2]) const;
+  bool GetDimensionIndexValues(unsigned int frame, std::vector<unsigned int> &div) const;
+  bool GetStackID(unsigned int frame, std::string &stackid) const;
+  bool GetInStackPositionNumber(unsigned int frame, unsigned int &pos) const;
+  bool GetTemporalPositionIndex(unsigned int frame, unsigned int &index) const;
+
+private:
+  FrameGeometryIndexInternals *Internals;
+};
+
+} // end namespace gdcm
+
+#endif //GDCMFRAMEGEOMETRYINDEX_H
@@ -15,8 +15,11 @@
 #include "gdcmScanner.h"
 #include "gdcmElement.h"
 #include "gdcmDirectionCosines.h"
+#include "gdcmDecimalString.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring> // strlen
 #include <map>
 
 namespace gdcm
@@ -29,6 +32,7 @@ IPPSorter::IPPSorter()
   ZSpacing = 0;
   ZTolerance = 1e-6;
   DirCosTolerance = 0.;
+  PositionTolerance = 1e-3;
 }
 
 
@@ -56,34 +60,14 @@ struct dircos_comp {
   }
 };
 
-bool IPPSorter::Sort(std::vector<std::string> const & filenames)
-{
-  // BUG: I cannot clear Filenames since input filenames could also be the output of ourself...
-  // Filenames.clear();
-  ZSpacing = 0;
-  if( filenames.empty() )
-    {
-    Filenames.clear();
-    return true;
-    }
+static const Tag tipp(0x0020,0x0032); // Image Position (Patient)
+static const Tag tiop(0x0020,0x0037); // Image Orientation (Patient)
+static const Tag tframe(0x0020,0x0052); // Frame of Reference UID
+static const Tag tgantry(0x0018,0x1120); // Gantry/Detector Tilt
 
-  Scanner scanner;
-  const Tag tipp(0x0020,0x0032); // Image Position (Patient)
-  const Tag tiop(0x0020,0x0037); // Image Orientation (Patient)
-  const Tag tframe(0x0020,0x0052); // Frame of Reference UID
-  const Tag tgantry(0x0018,0x1120); // Gantry/Detector Tilt
-  // Temporal Position Identifier (0020,0100) 3 Temporal order of a dynamic or functional set of Images.
-  //const Tag tpi(0x0020,0x0100);
-  scanner.AddTag( tipp );
-  scanner.AddTag( tiop );
-  scanner.AddTag( tframe );
-  scanner.AddTag( tgantry );
-  bool b = scanner.Scan( filenames );
-  if( !b )
-    {
-    gdcmDebugMacro( "Scanner failed" );
-    return false;
-    }
+bool IPPSorter::ComputeNormal(Scanner const & scanner,
+  std::vector<std::string> const & filenames, DirectionCosines & dc, double normal[3]) const
+{
   Scanner::ValuesType gantry = scanner.GetValues(tgantry);
   if( gantry.size() > 1 )
   {
@@ -92,9 +76,9 @@ bool IPPSorter::Sort(std::vector<std::string> const & filenames)
   }
   if( gantry.size() == 1 )
   {
-    std::stringstream ss( *gantry.begin() );
-    double tilt;
-    ss >> tilt;
+    const std::string &value = *gantry.begin();
+    double tilt = 0;
+    DecimalString::Parse( value.c_str(), value.c_str() + value.size(), tilt );
     if( tilt != 0.0 )
     {
       gdcmDebugMacro( "Gantry/Detector Tilt is not 0" );
@@ -177,12 +161,66 @@ bool IPPSorter::Sort(std::vector<std::string> const & filenames)
   // Compute normal:
   // The steps I take when reconstructing a volume are these: First,
   // calculate the slice normal from IOP:
-  double normal[3];
-
-  DirectionCosines dc;
   dc.SetFromString( dircos );
   if( !dc.IsValid() ) return false;
   dc.Cross( normal );
+  return true;
+}
+
+bool IPPSorter::CheckDirectionCosines(Scanner const & scanner,
+  const char *filename, DirectionCosines const & dc) const
+{
+  if( DirCosTolerance == 0. ) return true;
+  DirectionCosines dc2;
+  const char *value2 =  scanner.GetValue(filename, tiop);
+  if( !dc2.SetFromString( value2 ) )
+    {
+    if( value2 ) {
+      gdcmWarningMacro( filename << " cannot read IOP: " << value2 );
+    }
+    return false;
+    }
+  double cd = dc2.CrossDot( dc );
+  // result should be as close to 1 as possible:
+  if( fabs(1 - cd) > DirCosTolerance )
+    {
+    gdcmWarningMacro( filename << " Problem with DirCosTolerance: " );
+    // Cannot print cd since 0.9999 is printed as 1... may confuse user
+    return false;
+    }
+  //dc2.Normalize();
+  //dc2.Print( std::cout << std::endl );
+  return true;
+}
+
+bool IPPSorter::Sort(std::vector<std::string> const & filenames)
+{
+  // BUG: I cannot clear Filenames since input filenames could also be the output of ourself...
+  // Filenames.clear();
+  ZSpacing = 0;
+  Volumes.clear();
+  if( filenames.empty() )
+    {
+    Filenames.clear();
+    return true;
+    }
+
+  Scanner scanner;
+  // Temporal Position Identifier (0020,0100) 3 Temporal order of a dynamic or functional set of Images.
+  //const Tag tpi(0x0020,0x0100);
+  scanner.AddTag( tipp );
+  scanner.AddTag( tiop );
+  scanner.AddTag( tframe );
+  scanner.AddTag( tgantry );
+  bool b = scanner.Scan( filenames );
+  if( !b )
+    {
+    gdcmDebugMacro( "Scanner failed" );
+    return false;
+    }
+  double normal[3];
+  DirectionCosines dc;
+  if( !ComputeNormal( scanner, filenames, dc, normal ) ) return false;
   // You only have to do this once for all slices in the volume. Next, for
   // each slice, calculate the distance along the slice normal using the IPP
   // tag ("dist" is initialized to zero before reading the first slice) :
@@ -191,7 +229,6 @@ bool IPPSorter::Sort(std::vector<std::string> const & filenames)
   SortedFilenames sorted;
 {
   std::vector<std::string>::const_iterator it1 = filenames.begin();
-  DirectionCosines dc2;
   for(; it1 != filenames.end(); ++it1)
     {
     const char *filename = it1->c_str();
@@ -201,32 +238,10 @@ bool IPPSorter::Sort(std::vector<std::string> const & filenames)
       const char *value =  scanner.GetValue(filename, tipp);
       if( value )
         {
-        if( DirCosTolerance != 0. )
-          {
-          const char *value2 =  scanner.GetValue(filename, tiop);
-          if( !dc2.SetFromString( value2 ) )
-            {
-            if( value2 ) {
-              gdcmWarningMacro( filename << " cannot read IOP: " << value2 );
-            }
-            return false;
-            }
-          double cd = dc2.CrossDot( dc );
-          // result should be as close to 1 as possible:
-          if( fabs(1 - cd) > DirCosTolerance )
-            {
-            gdcmWarningMacro( filename << " Problem with DirCosTolerance: " );
-            // Cannot print cd since 0.9999 is printed as 1... may confuse user
-            return false;
-            }
-          //dc2.Normalize();
-          //dc2.Print( std::cout << std::endl );
-          }
+        if( !CheckDirectionCosines( scanner, filename, dc ) ) return false;
         //gdcmDebugMacro( filename << " has " << ipp << " = " << value );
         Element<VR::DS,VM::VM3> ipp;
-        std::stringstream ss;
-        ss.str( value );
-        ipp.Read( ss );
+        ipp.Read( value, strlen( value ) );
         double dist = 0;
         for (int i = 0; i < 3; ++i) dist += normal[i]*ipp[i];
         // FIXME: This test is weak, since implicitly we are doing a != on floating point value
@@ -315,6 +330,203 @@ bool IPPSorter::Sort(std::vector<std::string> const & filenames)
   return true;
 }
 
+namespace {
+// An image of a 4D series: its position along the normal, and its order
+// within the slice
+struct SliceImage
+{
+  double Position;
+  SortKey Key;
+  size_t Index; // in the input filenames
+};
+
+bool ComparePositions(SliceImage const & lhs, SliceImage const & rhs)
+{
+  if( lhs.Position != rhs.Position ) return lhs.Position < rhs.Position;
+  return lhs.Index < rhs.Index;
+}
+
+bool CompareKeys(SliceImage const & lhs, SliceImage const & rhs)
+{
+  if( lhs.Key < rhs.Key ) return true;
+  if( rhs.Key < lhs.Key ) return false;
+  return lhs.Index < rhs.Index;
+}
+
+bool SameKeys(SliceImage const & lhs, SliceImage const & rhs)
+{
+  return !(lhs.Key < rhs.Key) && !(rhs.Key < lhs.Key);
+}
+
+// Numbers (DS, IS, TM...) are compared as numbers, anything else as string.
+// A missing value compares as 0.
+void AppendToKey(SortKey & key, const char *value)
+{
+  if( !value )
+    {
+    key.Append( 0. );
+    return;
+    }
+  const char *end = value + strlen( value );
+  double d;
+  const char *p = DecimalString::Parse( value, end, d );
+  if( p )
+    {
+    while( p != end && *p == ' ' ) ++p;
+    }
+  if( p == end )
+    key.Append( d );
+  else
+    key.Append( std::string( value ) );
+}
+}
+
+bool IPPSorter::Sort4D(std::vector<std::string> const & filenames)
+{
+  ZSpacing = 0;
+  Volumes.clear();
+  if( filenames.empty() )
+    {
+    Filenames.clear();
+    return true;
+    }
+
+  Scanner scanner;
+  scanner.SetNumberOfThreads( NumberOfThreads );
+  scanner.AddTag( tipp );
+  scanner.AddTag( tiop );
+  scanner.AddTag( tframe );
+  scanner.AddTag( tgantry );
+  for( std::vector<Tag>::const_iterator t = SecondaryTags.begin(); t != SecondaryTags.end(); ++t )
+    {
+    scanner.AddTag( *t );
+    }
+  if( !scanner.Scan( filenames ) )
+    {
+    gdcmDebugMacro( "Scanner failed" );
+    return false;
+    }
+  double normal[3];
+  DirectionCosines dc;
+  if( !ComputeNormal( scanner, filenames, dc, normal ) ) return false;
+
+  // Single pass over the scanned values, then a single sort on the position:
+  std::vector<SliceImage> images;
+  images.reserve( filenames.size() );
+  Element<VR::DS,VM::VM3> ipp;
+  for( size_t i = 0; i < filenames.size(); ++i )
+    {
+    const char *filename = filenames[i].c_str();
+    if( !scanner.IsKey(filename) )
+      {
+      gdcmDebugMacro( "File: " << filename << " could not be read. Skipping." );
+      continue;
+      }
+    const char *value = scanner.GetValue(filename, tipp);
+    if( !value )
+      {
+      gdcmDebugMacro( "File: " << filename << " has no Tag" << tipp << ". Skipping." );
+      continue;
+      }
+    if( !CheckDirectionCosines( scanner, filename, dc ) ) return false;
+    ipp.Read( value, strlen( value ) );
+    SliceImage image;
+    image.Position = 0;
+    for (int k = 0; k < 3; ++k) image.Position += normal[k]*ipp[k];
+    image.Index = i;
+    for( std::vector<Tag>::const_iterator t = SecondaryTags.begin(); t != SecondaryTags.end(); ++t )
+      {
+      AppendToKey( image.Key, scanner.GetValue(filename, *t) );
+      }
+    images.push_back( image );
+    }
+  if( images.empty() )
+    {
+    gdcmDebugMacro( "No image with a position" );
+    return false;
+    }
+  std::sort( images.begin(), images.end(), ComparePositions );
+
+  // Group the images into slices, and order each slice:
+  std::vector<double> positions;
+  std::vector< std::vector<SliceImage>::iterator > slices; // begin/end pairs
+  std::vector<SliceImage>::iterator first = images.begin();
+  while( first != images.end() )
+    {
+    std::vector<SliceImage>::iterator last = first + 1;
+    while( last != images.end() && last->Position - first->Position <= PositionTolerance ) ++last;
+    double sum = 0;
+    for( std::vector<SliceImage>::iterator it = first; it != last; ++it ) sum += it->Position;
+    positions.push_back( sum / (double)(last - first) );
+    std::sort( first, last, CompareKeys );
+    if( DropDuplicatePositions )
+      {
+      // keep the first occurrence of each key:
+      std::vector<SliceImage>::iterator end = std::unique( first, last, SameKeys );
+      for( std::vector<SliceImage>::iterator it = end; it != last; ++it )
+        {
+        gdcmWarningMacro( "dropping file " << filenames[it->Index] << " since Z position: "
+          << it->Position << " already found" );
+        }
+      slices.push_back( first );
+      slices.push_back( end );
+      }
+    else
+      {
+      slices.push_back( first );
+      slices.push_back( last );
+      }
+    first = last;
+    }
+  const size_t nslices = positions.size();
+  const size_t nvolumes = (size_t)(slices[1] - slices[0]);
+  for( size_t s = 0; s < nslices; ++s )
+    {
+    if( (size_t)(slices[2*s+1] - slices[2*s]) != nvolumes )
+      {
+      gdcmWarningMacro( "Slice at position " << positions[s] << " has "
+        << (slices[2*s+1] - slices[2*s]) << " images, expected " << nvolumes );
+      return false;
+      }
+    }
+  Volumes.resize( nvolumes );
+  for( size_t v = 0; v < nvolumes; ++v )
+    {
+    Volumes[v].resize( nslices );
+    for( size_t s = 0; s < nslices; ++s )
+      {
+      Volumes[v][s] = filenames[ slices[2*s][v].Index ];
+      }
+    }
+  Filenames.clear();
+  Filenames.reserve( nvolumes * nslices );
+  for( size_t v = 0; v < nvolumes; ++v )
+    {
+    Filenames.insert( Filenames.end(), Volumes[v].begin(), Volumes[v].end() );
+    }
+
+  if( nslices > 1 && ComputeZSpacing )
+    {
+    const double zspacing = positions[1] - positions[0];
+    bool spacingisgood = true;
+    for( size_t s = 2; s < nslices && spacingisgood; ++s )
+      {
+      if( fabs((positions[s] - positions[s-1]) - zspacing) > ZTolerance )
+        {
+        gdcmDebugMacro( "ZTolerance test failed. You need to decrease ZTolerance." );
+        spacingisgood = false;
+        }
+      }
+    if( spacingisgood )
+      {
+      const int l = (int)( -log10(ZTolerance) );
+      ZSpacing = spacing_round(zspacing, l);
+      }
+    }
+
+  return true;
+}
+
 #if !defined(GDCM_LEGACY_REMOVE)
 bool IPPSorter::ComputeSpacing(std::vector<std::string> const & filenames)
 {
@@ -21,6 +21,8 @@
 
 namespace gdcm
 {
+class Scanner;
+class DirectionCosines;
 /**
  * \brief IPPSorter
  * \details Implement a simple Image Position (Patient) sorter, along the Image
@@ -36,6 +38,11 @@ namespace gdcm
  *
  * http://gdcm.sourceforge.net/wiki/index.php/Imager_Pixel_Spacing
  *
+ * Multiple volumes (eg. cardiac phases, perfusion, diffusion or multi-echo
+ * series) can be sorted at once with Sort4D: images are grouped into slices
+ * by position, and the images of a slice are ordered by secondary tags (see
+ * AddSecondaryTag) to form the volumes.
+ *
  * \bug There are currently a couple of bugs in this implementation:
  * \li Gantry Tilt is not considered (always an error)
  * \li Application programmer should only sort valid DataSet (eg. MRImageStorage, CTImageStorage, PETImageStorage)
@@ -93,14 +100,51 @@ public:
   /// \li ZSpacing could not be computed (Z-Spacing is not constant, or ZTolerance is too low)
   double GetZSpacing() const { return ZSpacing; }
 
+  /// Sort images belonging to several volumes acquired at the same positions
+  /// (4D series). Images whose position along the normal differ by at most
+  /// the position tolerance form a slice; within a slice images are ordered
+  /// by the secondary tags (then by their order in \p filenames), the n-th
+  /// image of each slice belonging to the n-th volume. All slices must have
+  /// the same number of images.
+  /// All files are scanned once. On success GetVolumes() gives the filename
+  /// of each (volume, slice), GetFilenames() lists the volumes one after the
+  /// other, and the Z-Spacing is computed from the slice positions as for
+  /// Sort().
+  bool Sort4D(std::vector<std::string> const & filenames);
+
+  /// Maximum distance (in mm, along the normal) in between images belonging
+  /// to the same slice in Sort4D. Default is 1e-3.
+  void SetPositionTolerance(double tol) { PositionTolerance = tol; }
+  double GetPositionTolerance() const { return PositionTolerance; }
+
+  /// Tags ordering the images of a slice in Sort4D (eg. Temporal Position
+  /// Identifier, Trigger Time, Echo Number, Diffusion b-value), compared in
+  /// the order they were added. Values are compared as numbers when they
+  /// are numbers, as strings otherwise.
+  void AddSecondaryTag(Tag const & t) { SecondaryTags.push_back( t ); }
+  void ClearSecondaryTags() { SecondaryTags.clear(); }
+  std::vector<Tag> const & GetSecondaryTags() const { return SecondaryTags; }
+
+  /// Result of Sort4D: GetVolumes()[volume][slice] is a filename
+  std::vector< std::vector<std::string> > const & GetVolumes() const { return Volumes; }
+  size_t GetNumberOfVolumes() const { return Volumes.size(); }
+  size_t GetNumberOfSlices() const { return Volumes.empty() ? 0 : Volumes[0].size(); }
+
 protected:
   bool ComputeZSpacing;
   bool DropDuplicatePositions;
   double ZSpacing;
   double ZTolerance;
   double DirCosTolerance;
+  double PositionTolerance;
+  std::vector<Tag> SecondaryTags;
+  std::vector< std::vector<std::string> > Volumes;
 
 private:
+  bool ComputeNormal(Scanner const & scanner,
+    std::vector<std::string> const & filenames, DirectionCosines & dc, double normal[3]) const;
+  bool CheckDirectionCosines(Scanner const & scanner,
+    const char *filename, DirectionCosines const & dc) const;
   GDCM_LEGACY(bool ComputeSpacing(std::vector<std::string> const & filenames))
 };
 
@@ -22,6 +22,7 @@
 #include "gdcmJPEGLSCodec.h"
 #include "gdcmJPEG2000Codec.h"
 #include "gdcmRLECodec.h"
+#include "gdcmInstrumentation.h"
 
 namespace gdcm
 {
@@ -93,12 +94,15 @@ bool ImageChangeTransferSyntax::TryRAWCodec(const DataElement &pixelde, Bitmap c
     codec.SetPhotometricInterpretation( input.GetPhotometricInterpretation() );
     codec.SetPixelFormat( input.GetPixelFormat() );
     codec.SetNeedOverlayCleanup( input.AreOverlaysInPixelData() || input.UnusedBitsPresentInPixelData() );
+    InstrumentationTimer timer( Instrumentation::EncodeRAW );
+    timer.SetBytes( len );
     DataElement out;
     //bool r = codec.Code(input.GetDataElement(), out);
     bool r = codec.Code(pixelde, out);
 
     if( !r )
       {
+      timer.Cancel();
       return false;
       }
     DataElement &de = output.GetDataElement();
@@ -123,12 +127,15 @@ bool ImageChangeTransferSyntax::TryRLECodec(const DataElement &pixelde, Bitmap c
     codec.SetPhotometricInterpretation( input.GetPhotometricInterpretation() );
     codec.SetPixelFormat( input.GetPixelFormat() );
     codec.SetNeedOverlayCleanup( input.AreOverlaysInPixelData() || input.UnusedBitsPresentInPixelData() );
+    InstrumentationTimer timer( Instrumentation::EncodeRLE );
+    timer.SetBytes( len );
     DataElement out;
     //bool r = codec.Code(input.GetDataElement(), out);
     bool r = codec.Code(pixelde, out);
 
     if( !r )
       {
+      timer.Cancel();
       return false;
       }
     DataElement &de = output.GetDataElement();
@@ -189,6 +196,8 @@ bool ImageChangeTransferSyntax::TryJPEGCodec(const DataElement &pixelde, Bitmap
       gdcmErrorMacro("Pixel Format incompatible with TS" );
       return false;
       }
+    InstrumentationTimer timer( Instrumentation::EncodeJPEG );
+    timer.SetBytes( len );
     DataElement out;
     //bool r = codec.Code(input.GetDataElement(), out);
     bool r = codec->Code(pixelde, out);
@@ -210,6 +219,7 @@ bool ImageChangeTransferSyntax::TryJPEGCodec(const DataElement &pixelde, Bitmap
     // PHILIPS_Gyroscan-12-MONO2-Jpeg_Lossless.dcm
     if( !r )
       {
+      timer.Cancel();
       return false;
       }
     DataElement &de = output.GetDataElement();
@@ -253,6 +263,8 @@ bool ImageChangeTransferSyntax::TryJPEGLSCodec(const DataElement &pixelde, Bitma
     codec->SetPlanarConfiguration( input.GetPlanarConfiguration() );
     codec->SetPhotometricInterpretation( input.GetPhotometricInterpretation() );
     codec->SetNeedOverlayCleanup( input.AreOverlaysInPixelData() || input.UnusedBitsPresentInPixelData() );
+    InstrumentationTimer timer( Instrumentation::EncodeJPEGLS );
+    timer.SetBytes( len );
     DataElement out;
     //bool r = codec.Code(input.GetDataElement(), out);
     bool r;
@@ -264,14 +276,22 @@ bool ImageChangeTransferSyntax::TryJPEGLSCodec(const DataElement &pixelde, Bitma
       tmp.SetByteValue( bv->GetPointer(), bv->GetLength());
       bv = const_cast<ByteValue*>(tmp.GetByteValue());
       r = codec->CleanupUnusedBits((char*)bv->GetVoidPointer(), bv->GetLength());
-      if(!r) return false;
+      if(!r)
+        {
+        timer.Cancel();
+        return false;
+        }
       r = codec->Code(tmp, out);
       }
     else
       {
       r = codec->Code(pixelde, out);
       }
-    if(!r) return false;
+    if(!r)
+      {
+      timer.Cancel();
+      return false;
+      }
 
     DataElement &de = output.GetDataElement();
     de.SetValue( out.GetValue() );
@@ -313,6 +333,8 @@ bool ImageChangeTransferSyntax::TryJPEG2000Codec(const DataElement &pixelde, Bit
     codec->SetPlanarConfiguration( input.GetPlanarConfiguration() );
     codec->SetPhotometricInterpretation( input.GetPhotometricInterpretation() );
     codec->SetNeedOverlayCleanup( input.AreOverlaysInPixelData() || input.UnusedBitsPresentInPixelData() );
+    InstrumentationTimer timer( Instrumentation::EncodeJPEG2000 );
+    timer.SetBytes( len );
     DataElement out;
     //bool r = codec.Code(input.GetDataElement(), out);
     bool r = codec->Code(pixelde, out);
@@ -361,7 +383,11 @@ bool ImageChangeTransferSyntax::TryJPEG2000Codec(const DataElement &pixelde, Bit
       gdcm_assert( input.GetPixelFormat().GetSamplesPerPixel() == 1 );
       }
 
-    if( !r ) return false;
+    if( !r )
+      {
+      timer.Cancel();
+      return false;
+      }
     DataElement &de = output.GetDataElement();
     de.SetValue( out.GetValue() );
     UpdatePhotometricInterpretation( input, output );
@@ -16,6 +16,7 @@
 #include "gdcmByteSwap.txx"
 #include "gdcmImageChangePhotometricInterpretation.h"
 #include "gdcmTrace.h"
+#include "gdcmInstrumentation.h"
 
 #include <iostream>
 #include <iomanip>
@@ -102,6 +103,8 @@ bool ImageCodec::DoByteSwap(std::istream &is, std::ostream &os)
   is.seekg( 0, std::ios::end);
   size_t buf_size = (size_t)is.tellg();
   //gdcm_assert(buf_size < INT_MAX);
+  InstrumentationTimer timer( Instrumentation::ByteSwap );
+  timer.SetBytes( buf_size );
   char *dummy_buffer = new char[(unsigned int)buf_size];
   is.seekg(start, std::ios::beg);
   is.read( dummy_buffer, buf_size);
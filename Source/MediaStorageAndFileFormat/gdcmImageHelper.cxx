@@ -26,7 +26,10 @@
 #include "gdcmDirectionCosines.h"
 #include "gdcmSegmentedPaletteColorLookupTable.h"
 #include "gdcmByteValue.h"
+#include "gdcmDecimalString.h"
+#include "gdcmFrameGeometryIndex.h"
 
+#include <algorithm> // find
 #include <cmath> // fabs
 
   /* TODO:
@@ -51,141 +54,15 @@ bool ImageHelper::ForcePixelSpacing = false;
 // By default, this is off, if you want behavior documented in DICOM CP 2330, turn it on
 bool ImageHelper::SecondaryCaptureImagePlaneModule = false;
 
-static bool GetOriginValueFromSequence(const DataSet& ds, const Tag& tfgs, std::vector<double> &ori)
-{
-  ori.clear();
-  if( !ds.FindDataElement( tfgs ) ) return false;
-  //const SequenceOfItems * sqi = ds.GetDataElement( tfgs ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi = ds.GetDataElement( tfgs ).GetValueAsSQ();
-  if( !(sqi && sqi->GetNumberOfItems() > 0) ) return false;
-  // Get first item:
-  const Item &item = sqi->GetItem(1);
-  const DataSet & subds = item.GetNestedDataSet();
-  // Plane position Sequence
-  const Tag tpms(0x0020,0x9113);
-  if( !subds.FindDataElement(tpms) ) return false;
-  //const SequenceOfItems * sqi2 = subds.GetDataElement( tpms ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi2 = subds.GetDataElement( tpms ).GetValueAsSQ();
-  if( sqi2 && !sqi2->IsEmpty() )
-  {
-  const Item &item2 = sqi2->GetItem(1);
-  const DataSet & subds2 = item2.GetNestedDataSet();
-  //
-  const Tag tps(0x0020,0x0032);
-  if( !subds2.FindDataElement(tps) ) return false;
-  const DataElement &de = subds2.GetDataElement( tps );
-  //gdcm_assert( bv );
-  Attribute<0x0020,0x0032> at;
-  at.SetFromDataElement( de );
-  //at.Print( std::cout );
-  ori.push_back( at.GetValue(0) );
-  ori.push_back( at.GetValue(1) );
-  ori.push_back( at.GetValue(2) );
-
-  return true;
-  }
-  return false;
-}
-
-static bool GetDirectionCosinesValueFromSequence(const DataSet& ds, const Tag& tfgs, std::vector<double> &dircos)
-{
-  dircos.clear();
-  if( !ds.FindDataElement( tfgs ) ) return false;
-  //const SequenceOfItems * sqi = ds.GetDataElement( tfgs ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi = ds.GetDataElement( tfgs ).GetValueAsSQ();
-  if( !(sqi && sqi->GetNumberOfItems() > 0) ) return false;
-  // Get first item:
-  const Item &item = sqi->GetItem(1);
-  const DataSet & subds = item.GetNestedDataSet();
-  // Plane position Sequence
-  const Tag tpms(0x0020,0x9116);
-  if( !subds.FindDataElement(tpms) ) return false;
-  //const SequenceOfItems * sqi2 = subds.GetDataElement( tpms ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi2 = subds.GetDataElement( tpms ).GetValueAsSQ();
-  if( !(sqi2 && sqi2->GetNumberOfItems()) ) return false;
-  gdcm_assert( sqi2 && sqi2->GetNumberOfItems() );
-  // Take it from the first item
-  const Item &item2 = sqi2->GetItem(1);
-  const DataSet & subds2 = item2.GetNestedDataSet();
-  //
-  const Tag tps(0x0020,0x0037);
-  if( !subds2.FindDataElement(tps) ) return false;
-  const DataElement &de = subds2.GetDataElement( tps );
-  //gdcm_assert( bv );
-  Attribute<0x0020,0x0037> at;
-  at.SetFromDataElement( de );
-  dircos.push_back( at.GetValue(0) );
-  dircos.push_back( at.GetValue(1) );
-  dircos.push_back( at.GetValue(2) );
-  dircos.push_back( at.GetValue(3) );
-  dircos.push_back( at.GetValue(4) );
-  dircos.push_back( at.GetValue(5) );
-
-  return true;
-}
-
-static bool GetInterceptSlopeValueFromSequence(const DataSet& ds, const Tag& tfgs, std::vector<double> &intslope)
-{
-  intslope.clear();
-  if( !ds.FindDataElement( tfgs ) ) return false;
-  //const SequenceOfItems * sqi = ds.GetDataElement( tfgs ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi = ds.GetDataElement( tfgs ).GetValueAsSQ();
-  if( !(sqi && sqi->GetNumberOfItems() > 0) ) return false;
-  // Get first item:
-  const Item &item = sqi->GetItem(1);
-  const DataSet & subds = item.GetNestedDataSet();
-  // (0028,9145) SQ (Sequence with undefined length)               # u/l,1 Pixel Value Transformation Sequence
-  const Tag tpms(0x0028,0x9145);
-  if( !subds.FindDataElement(tpms) ) return false;
-  //const SequenceOfItems * sqi2 = subds.GetDataElement( tpms ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi2 = subds.GetDataElement( tpms ).GetValueAsSQ();
-  gdcm_assert( sqi2 );
-  const Item &item2 = sqi2->GetItem(1);
-  const DataSet & subds2 = item2.GetNestedDataSet();
-  double intercept;
-    {
-    //  (0028,1052) DS [0]                                        # 2,1 Rescale Intercept
-    const Tag tps(0x0028,0x1052);
-    if( !subds2.FindDataElement(tps) ) return false;
-    const DataElement &de = subds2.GetDataElement( tps );
-    //gdcm_assert( bv );
-    Attribute<0x0028,0x1052> at;
-    at.SetFromDataElement( de );
-    //at.Print( std::cout );
-    intercept = at.GetValue();
-    }
-  double slope;
-    {
-    // (0028,1053) DS [5.65470085470085]                         # 16,1 Rescale Slope
-    const Tag tps(0x0028,0x1053);
-    if( !subds2.FindDataElement(tps) ) return false;
-    const DataElement &de = subds2.GetDataElement( tps );
-    //gdcm_assert( bv );
-    Attribute<0x0028,0x1053> at;
-    at.SetFromDataElement( de );
-    //at.Print( std::cout );
-    slope = at.GetValue();
-    }
-  intslope.push_back( intercept );
-  intslope.push_back( slope );
-
-  gdcm_assert( intslope.size() == 2 );
-  return true;
-}
-
-static bool ComputeZSpacingFromIPP(const DataSet &ds, double &zspacing)
+static bool ComputeZSpacingFromIPP(const DataSet &ds, const FrameGeometryIndex &index, double &zspacing)
 {
   // first we need to get the direction cosines:
-  const Tag t1(0x5200,0x9229);
-  const Tag t2(0x5200,0x9230);
-  std::vector<double> cosines;
+  std::vector<double> cosines( 6 );
   // For some reason TOSHIBA-EnhancedCT.dcm is storing the direction cosines in the per-frame section
   // and not the shared one... oh well
-  bool b1 = GetDirectionCosinesValueFromSequence(ds, t1, cosines)
-    || GetDirectionCosinesValueFromSequence(ds,t2,cosines);
+  bool b1 = index.GetImageOrientationPatient(0, cosines.data());
   if(!b1)
     {
-    cosines.resize( 6 );
     bool b2 = ImageHelper::GetDirectionCosinesFromDataSet(ds, cosines);
     if( b2 )
       {
@@ -207,44 +84,24 @@ static bool ComputeZSpacingFromIPP(const DataSet &ds, double &zspacing)
 
   const Tag tfgs(0x5200,0x9230);
   if( !ds.FindDataElement( tfgs ) ) return false;
-  //const SequenceOfItems * sqi = ds.GetDataElement( tfgs ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi = ds.GetDataElement( tfgs ).GetValueAsSQ();
-  if( !sqi ) return false;
-  gdcm_assert( sqi );
+  if( !ds.GetDataElement( tfgs ).GetValueAsSQ() ) return false;
   double normal[3];
   DirectionCosines dc( cosines.data() );
   dc.Cross( normal );
   DirectionCosines::Normalize(normal);
 
-  // For each item
-  SequenceOfItems::SizeType nitems = sqi->GetNumberOfItems();
+  // For each frame
+  size_t nitems = index.GetNumberOfFrames();
   if( nitems > 1 ) {
-  std::vector<double> dircos_subds2; dircos_subds2.resize(6);
+  // (0020,9113) PlanePositionSequence is expected in each item of the per-frame sequence
+  if( index.IsShared( FrameGeometryIndex::PlanePosition ) ) return false;
   std::vector<double> distances;
   std::set<double> unique_distances;
-  for(SequenceOfItems::SizeType i0 = 1; i0 <= nitems; ++i0)
+  for(unsigned int i0 = 0; i0 < nitems; ++i0)
     {
-    const Item &item = sqi->GetItem(i0);
-    const DataSet & subds = item.GetNestedDataSet();
-    // (0020,9113) SQ (Sequence with undefined length #=1)     # u/l, 1 PlanePositionSequence
-    const Tag tpms(0x0020,0x9113);
-    if( !subds.FindDataElement(tpms) ) return false;
-    //const SequenceOfItems * sqi2 = subds.GetDataElement( tpms ).GetSequenceOfItems();
-    SmartPointer<SequenceOfItems> sqi2 = subds.GetDataElement( tpms ).GetValueAsSQ();
-    gdcm_assert( sqi2 );
-    const Item &item2 = sqi2->GetItem(1);
-    const DataSet & subds2 = item2.GetNestedDataSet();
-    // Check Image Orientation (Patient)
-    if( ImageHelper::GetDirectionCosinesFromDataSet(subds2, dircos_subds2) )
-      {
-      gdcm_assert( dircos_subds2 == cosines );
-      }
     // (0020,0032) DS [-82.5\-82.5\1153.75]                    #  20, 3 ImagePositionPatient
-    const Tag tps(0x0020,0x0032);
-    if( !subds2.FindDataElement(tps) ) return false;
-    const DataElement &de = subds2.GetDataElement( tps );
-    Attribute<0x0020,0x0032> ipp;
-    ipp.SetFromDataElement(de);
+    double ipp[3];
+    if( !index.GetImagePositionPatient(i0, ipp) ) return false;
     double dist = 0;
     for (int i = 0; i < 3; ++i) dist += normal[i]*ipp[i];
     distances.push_back( dist );
@@ -266,7 +123,7 @@ static bool ComputeZSpacingFromIPP(const DataSet &ds, double &zspacing)
 
   double meanspacing = 0;
   double prev = distances[0];
-  for(unsigned int i = 1; i < nitems; ++i)
+  for(size_t i = 1; i < nitems; ++i)
     {
     const double current = distances[i] - prev;
     meanspacing += current;
@@ -294,7 +151,7 @@ static bool ComputeZSpacingFromIPP(const DataSet &ds, double &zspacing)
     // Check spacing is consistent:
     const double ZTolerance = 1e-3; // ??? FIXME
     prev = distances[0];
-    for(unsigned int i = 1; i < nitems; ++i)
+    for(size_t i = 1; i < nitems; ++i)
       {
       const double current = distances[i] - prev;
       if( fabs(current - zspacing) > ZTolerance )
@@ -310,68 +167,30 @@ static bool ComputeZSpacingFromIPP(const DataSet &ds, double &zspacing)
   } else {
     // single slice, this is not an error to not find the zspacing in this case.
     zspacing = 1.0;
-    const Tag tfgs0(0x5200,0x9229);
-    if( !ds.FindDataElement( tfgs0 ) ) return true;
-    SmartPointer<SequenceOfItems> sqi0 = ds.GetDataElement( tfgs0 ).GetValueAsSQ();
-    if( !(sqi0 && sqi0->GetNumberOfItems() > 0) ) return true;
-    // Get first item:
-    const Item &item = sqi0->GetItem(1);
-    const DataSet & subds = item.GetNestedDataSet();
-    // <entry group="0028" element="9110" vr="SQ" vm="1" name="Pixel Measures Sequence"/>
-    const Tag tpms(0x0028,0x9110);
-    if( !subds.FindDataElement(tpms) ) return true;
-    //const SequenceOfItems * sqi2 = subds.GetDataElement( tpms ).GetSequenceOfItems();
-    SmartPointer<SequenceOfItems> sqi2 = subds.GetDataElement( tpms ).GetValueAsSQ();
-    gdcm_assert( sqi2 );
-    const Item &item2 = sqi2->GetItem(1);
-    const DataSet & subds2 = item2.GetNestedDataSet();
-    // <entry group="0028" element="0030" vr="DS" vm="2" name="Pixel Spacing"/>
-    const Tag tps(0x0018,0x0088);
-    if( !subds2.FindDataElement(tps) ) return true;
-    const DataElement &de = subds2.GetDataElement( tps );
-    Attribute<0x0018,0x0088> at;
-    at.SetFromDataElement( de );
-    zspacing = at.GetValue();
+    // <entry group="0018" element="0088" vr="DS" vm="1" name="Spacing Between Slices"/>
+    // (only looked up in the Shared Functional Groups)
+    double sbs;
+    if( index.IsShared( FrameGeometryIndex::PixelMeasures )
+      && index.GetSpacingBetweenSlices(0, sbs) )
+      {
+      zspacing = sbs;
+      }
   }
   return true;
 }
 
 // EnhancedMRImageStorage & EnhancedCTImageStorage
-static bool GetSpacingValueFromSequence(const DataSet& ds, const Tag& tfgs, std::vector<double> &sp)
+static bool GetSpacingValueFromSequence(const DataSet& ds, const FrameGeometryIndex &index, std::vector<double> &sp)
 {
   //  (0028,9110) SQ (Sequence with undefined length #=1)     # u/l, 1 PixelMeasuresSequence
   //      (fffe,e000) na (Item with undefined length #=2)         # u/l, 1 Item
   //        (0018,0050) DS [0.5]                                    #   4, 1 SliceThickness
   //        (0028,0030) DS [0.322\0.322]                            #  12, 2 PixelSpacing
-  // <entry group="5200" element="9229" vr="SQ" vm="1" name="Shared Functional Groups Sequence"/>
-  //const Tag tfgs(0x5200,0x9229);
-  //const Tag tfgs(0x5200,0x9230);
-  //gdcm_assert( ds.FindDataElement( tfgs ) );
-  if( !ds.FindDataElement( tfgs ) ) return false;
-  //const SequenceOfItems * sqi = ds.GetDataElement( tfgs ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi = ds.GetDataElement( tfgs ).GetValueAsSQ();
-  if( !(sqi && sqi->GetNumberOfItems() > 0) ) return false;
-  // Get first item:
-  const Item &item = sqi->GetItem(1);
-  const DataSet & subds = item.GetNestedDataSet();
-  // <entry group="0028" element="9110" vr="SQ" vm="1" name="Pixel Measures Sequence"/>
-  const Tag tpms(0x0028,0x9110);
-  if( !subds.FindDataElement(tpms) ) return false;
-  //const SequenceOfItems * sqi2 = subds.GetDataElement( tpms ).GetSequenceOfItems();
-  SmartPointer<SequenceOfItems> sqi2 = subds.GetDataElement( tpms ).GetValueAsSQ();
-  gdcm_assert( sqi2 );
-  const Item &item2 = sqi2->GetItem(1);
-  const DataSet & subds2 = item2.GetNestedDataSet();
   // <entry group="0028" element="0030" vr="DS" vm="2" name="Pixel Spacing"/>
-  const Tag tps(0x0028,0x0030);
-  if( !subds2.FindDataElement(tps) ) return false;
-  const DataElement &de = subds2.GetDataElement( tps );
-  //gdcm_assert( bv );
-  Attribute<0x0028,0x0030> at;
-  at.SetFromDataElement( de );
-  //at.Print( std::cout );
-  sp.push_back( at.GetValue(1) );
-  sp.push_back( at.GetValue(0) );
+  double ps[2];
+  if( !index.GetPixelSpacing(0, ps) ) return false;
+  sp.push_back( ps[1] );
+  sp.push_back( ps[0] );
 
   // BUG ! Check for instance:
   // gdcmData/BRTUM001.dcm
@@ -388,7 +207,7 @@ static bool GetSpacingValueFromSequence(const DataSet& ds, const Tag& tfgs, std:
   sp.push_back( at2.GetValue(0) );
 #endif
   double zspacing;
-  bool b = ComputeZSpacingFromIPP(ds, zspacing);
+  bool b = ComputeZSpacingFromIPP(ds, index, zspacing);
   if( !b ) return false;
 
   sp.push_back( zspacing );
@@ -533,6 +352,14 @@ static void SetUltraSoundSpacingValueFromSequence(DataSet& ds, std::vector<doubl
 */
 
 std::vector<double> ImageHelper::GetOriginValue(File const & f)
+{
+  FrameGeometryIndex index;
+  // Only the first frame is needed:
+  index.Build( f.GetDataSet(), 1 );
+  return GetOriginValue( f, index );
+}
+
+std::vector<double> ImageHelper::GetOriginValue(File const & f, FrameGeometryIndex const & index)
 {
   std::vector<double> ori;
   MediaStorage ms;
@@ -560,15 +387,12 @@ std::vector<double> ImageHelper::GetOriginValue(File const & f)
    || ms == MediaStorage::LegacyConvertedEnhancedCTImageStorage
    || ms == MediaStorage::LegacyConvertedEnhancedPETImageStorage )
     {
-    const Tag t1(0x5200,0x9229);
-    const Tag t2(0x5200,0x9230);
-    if( GetOriginValueFromSequence(ds,t1, ori)
-     || GetOriginValueFromSequence(ds, t2, ori) )
+    ori.resize( 3 );
+    if( index.GetImagePositionPatient(0, ori.data()) )
       {
       gdcm_assert( ori.size() == 3 );
       return ori;
       }
-    ori.resize( 3 );
     gdcmWarningMacro( "Could not find Origin" );
     return ori;
     }
@@ -667,6 +491,14 @@ bool ImageHelper::GetDirectionCosinesFromDataSet(DataSet const & ds, std::vector
 }
 
 std::vector<double> ImageHelper::GetDirectionCosinesValue(File const & f)
+{
+  FrameGeometryIndex index;
+  // Only the first frame is needed:
+  index.Build( f.GetDataSet(), 1 );
+  return GetDirectionCosinesValue( f, index );
+}
+
+std::vector<double> ImageHelper::GetDirectionCosinesValue(File const & f, FrameGeometryIndex const & index)
 {
   std::vector<double> dircos;
   MediaStorage ms;
@@ -693,17 +525,13 @@ std::vector<double> ImageHelper::GetDirectionCosinesValue(File const & f)
    || ms == MediaStorage::LegacyConvertedEnhancedCTImageStorage
    || ms == MediaStorage::LegacyConvertedEnhancedPETImageStorage )
     {
-    const Tag t1(0x5200,0x9229);
-    const Tag t2(0x5200,0x9230);
-    if( GetDirectionCosinesValueFromSequence(ds,t1, dircos)
-     || GetDirectionCosinesValueFromSequence(ds, t2, dircos) )
+    dircos.resize( 6 );
+    if( index.GetImageOrientationPatient(0, dircos.data()) )
       {
-      gdcm_assert( dircos.size() == 6 );
       return dircos;
       }
     else
       {
-      dircos.resize( 6 );
       bool b2 = ImageHelper::GetDirectionCosinesFromDataSet(ds, dircos);
       if( b2 )
         {
@@ -1068,14 +896,22 @@ static double fd2ds(const double d)
 {
   Element<VR::DS,VM::VM1> in = {{ 0 }};
   in.SetValue( d );
-  std::stringstream ss;
-  in.Write( ss );
+  char buf[16+1];
+  const unsigned int len = DecimalString::Format( in.GetValue(), buf );
   Element<VR::DS,VM::VM1> out = {{ 0 }};
-  out.Read( ss );
+  out.Read( buf, len );
   return out.GetValue();
 }
 
 std::vector<double> ImageHelper::GetRescaleInterceptSlopeValue(File const & f)
+{
+  FrameGeometryIndex index;
+  // Only the first frame is needed:
+  index.Build( f.GetDataSet(), 1 );
+  return GetRescaleInterceptSlopeValue( f, index );
+}
+
+std::vector<double> ImageHelper::GetRescaleInterceptSlopeValue(File const & f, FrameGeometryIndex const & index)
 {
   std::vector<double> interceptslope;
   MediaStorage ms;
@@ -1096,12 +932,11 @@ std::vector<double> ImageHelper::GetRescaleInterceptSlopeValue(File const & f)
    || ms == MediaStorage::LegacyConvertedEnhancedCTImageStorage
    || ms == MediaStorage::LegacyConvertedEnhancedPETImageStorage )
     {
-    const Tag t1(0x5200,0x9229);
-    const Tag t2(0x5200,0x9230);
-    if( GetInterceptSlopeValueFromSequence(ds,t1, interceptslope)
-     || GetInterceptSlopeValueFromSequence(ds,t2, interceptslope) )
+    double is[2];
+    if( index.GetRescaleInterceptSlope(0, is) )
       {
-      gdcm_assert( interceptslope.size() == 2 );
+      interceptslope.push_back( is[0] );
+      interceptslope.push_back( is[1] );
       return interceptslope;
       }
 
@@ -1478,6 +1313,13 @@ Warning - Dicom dataset contains attributes not present in standard DICOM IOD -
 }
 
 std::vector<double> ImageHelper::GetSpacingValue(File const & f)
+{
+  FrameGeometryIndex index;
+  index.Build( f.GetDataSet() );
+  return GetSpacingValue( f, index );
+}
+
+std::vector<double> ImageHelper::GetSpacingValue(File const & f, FrameGeometryIndex const & index)
 {
   std::vector<double> sp;
   sp.reserve(3);
@@ -1507,10 +1349,7 @@ std::vector<double> ImageHelper::GetSpacingValue(File const & f)
     || ms == MediaStorage::LegacyConvertedEnhancedPETImageStorage)
     {
     // <entry group="5200" element="9230" vr="SQ" vm="1" name="Per-frame Functional Groups Sequence"/>
-    const Tag t1(0x5200,0x9229);
-    const Tag t2(0x5200,0x9230);
-    if( GetSpacingValueFromSequence(ds,t1, sp)
-      || GetSpacingValueFromSequence(ds, t2, sp) )
+    if( GetSpacingValueFromSequence(ds, index, sp) )
       {
       gdcm_assert( sp.size() == 3 );
       return sp;
@@ -1579,19 +1418,17 @@ std::vector<double> ImageHelper::GetSpacingValue(File const & f)
     case VR::DS:
         {
         Element<VR::DS,VM::VM1_n> el;
-        std::stringstream ss;
         const ByteValue *bv = de.GetByteValue();
         gdcm_assert( bv );
-        std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-        ss.str( s );
+        const char *s = bv->GetPointer();
+        const size_t len = bv->GetLength();
         // Stupid file: CT-MONO2-8-abdo.dcm
         // The spacing is something like that: [0.2\0\0.200000]
         // I would need to throw an exception that VM is not compatible
         el.SetLength( entry.GetVM().GetLength() * entry.GetVR().GetSizeof() );
-        std::string::size_type found = s.find('\\');
-        if( found != std::string::npos )
+        if( std::find( s, s + len, '\\' ) != s + len )
           {
-          el.Read( ss );
+          el.Read( s, len );
           gdcm_assert( el.GetLength() == 2 );
           for(unsigned int i = 0; i < el.GetLength(); ++i)
             {
@@ -1609,8 +1446,8 @@ std::vector<double> ImageHelper::GetSpacingValue(File const & f)
           }
         else
           {
-          double singleval;
-          ss >> singleval;
+          double singleval = 0;
+          DecimalString::Parse( s, s + len, singleval );
           if( singleval == 0.0 )
             {
             singleval = 1.0;
@@ -1624,13 +1461,10 @@ std::vector<double> ImageHelper::GetSpacingValue(File const & f)
     case VR::IS:
         {
         Element<VR::IS,VM::VM1_n> el;
-        std::stringstream ss;
         const ByteValue *bv = de.GetByteValue();
         gdcm_assert( bv );
-        std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-        ss.str( s );
         el.SetLength( entry.GetVM().GetLength() * entry.GetVR().GetSizeof() );
-        el.Read( ss );
+        el.Read( bv->GetPointer(), bv->GetLength() );
         for(unsigned int i = 0; i < el.GetLength(); ++i)
         {
           if( el.GetValue(i) )
@@ -1682,13 +1516,10 @@ std::vector<double> ImageHelper::GetSpacingValue(File const & f)
         case VR::DS:
             {
             Element<VR::DS,VM::VM1_n> el;
-            std::stringstream ss;
             const ByteValue *bv = de.GetByteValue();
             gdcm_assert( bv );
-            std::string s = std::string( bv->GetPointer(), bv->GetLength() );
-            ss.str( s );
             el.SetLength( entry.GetVM().GetLength() * entry.GetVR().GetSizeof() );
-            el.Read( ss );
+            el.Read( bv->GetPointer(), bv->GetLength() );
             for(unsigned int i = 0; i < el.GetLength(); ++i)
               {
               const double value = el.GetValue(i);
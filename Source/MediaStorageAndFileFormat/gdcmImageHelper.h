@@ -30,6 +30,7 @@ class DataSet;
 class File;
 class Image;
 class Pixmap;
+class FrameGeometryIndex;
 class ByteValue;
 
 // minimal struct:
@@ -107,6 +108,10 @@ public:
   /// class storage, but also Grid Scaling in RT Dose Storage
   /// Can't take a dataset because the mediastorage of the file must be known
   static std::vector<double> GetRescaleInterceptSlopeValue(File const & f);
+  /// Same, with the functional groups of f already indexed, so that the
+  /// getters of an Enhanced object share a single walk of the functional
+  /// groups. The index must have been built from f.GetDataSet().
+  static std::vector<double> GetRescaleInterceptSlopeValue(File const & f, FrameGeometryIndex const & index);
   static void SetRescaleInterceptSlopeValue(File & f, const Image & img);
 
   // read only for now
@@ -114,11 +119,15 @@ public:
 
   /// Set/Get Origin (IPP) from/to a file
   static std::vector<double> GetOriginValue(File const & f);
+  /// Same, reusing the FrameGeometryIndex of f
+  static std::vector<double> GetOriginValue(File const & f, FrameGeometryIndex const & index);
   static void SetOriginValue(DataSet & ds, const Image & img);
 
   /// Get Direction Cosines (IOP) from/to a file
   /// Requires a file because mediastorage must be known
   static std::vector<double> GetDirectionCosinesValue(File const & f);
+  /// Same, reusing the FrameGeometryIndex of f
+  static std::vector<double> GetDirectionCosinesValue(File const & f, FrameGeometryIndex const & index);
   /// Set Direction Cosines (IOP) from/to a file
   /// When IOD does not defines what is IOP (eg. typically Secondary Capture Image Storage)
   /// this call will simply remove the IOP attribute.
@@ -129,6 +138,8 @@ public:
 
   /// Set/Get Spacing from/to a File
   static std::vector<double> GetSpacingValue(File const & f);
+  /// Same, reusing the FrameGeometryIndex of f
+  static std::vector<double> GetSpacingValue(File const & f, FrameGeometryIndex const & index);
   /// \warning You need to call SetSpacingValue after SetOriginValue / SetDirectionCosinesValue
   static void SetSpacingValue(DataSet & ds, const std::vector<double> & spacing);
 
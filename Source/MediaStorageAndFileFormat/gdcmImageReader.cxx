@@ -21,6 +21,7 @@
 #include "gdcmTransferSyntax.h"
 #include "gdcmAttribute.h"
 #include "gdcmImageHelper.h"
+#include "gdcmFrameGeometryIndex.h"
 #include "gdcmPrivateTag.h"
 #include "gdcmJPEGCodec.h"
 
@@ -62,8 +63,12 @@ bool ImageReader::ReadImage(MediaStorage const &ms)
   //const DataSet &ds = F->GetDataSet();
   Image& pixeldata = GetImage();
 
+  // Functional groups (Enhanced objects) are walked once for all the getters:
+  FrameGeometryIndex index;
+  index.Build( F->GetDataSet() );
+
   // 4 1/2 Let's do Pixel Spacing
-  std::vector<double> spacing = ImageHelper::GetSpacingValue(*F);
+  std::vector<double> spacing = ImageHelper::GetSpacingValue(*F, index);
   // FIXME: Only SC is allowed not to have spacing:
   if( !spacing.empty() )
     {
@@ -75,7 +80,7 @@ bool ImageReader::ReadImage(MediaStorage const &ms)
       }
     }
   // 4 2/3 Let's do Origin
-  std::vector<double> origin = ImageHelper::GetOriginValue(*F);
+  std::vector<double> origin = ImageHelper::GetOriginValue(*F, index);
   if( !origin.empty() )
     {
     pixeldata.SetOrigin( origin.data() );
@@ -85,14 +90,14 @@ bool ImageReader::ReadImage(MediaStorage const &ms)
       }
     }
 
-  std::vector<double> dircos = ImageHelper::GetDirectionCosinesValue(*F);
+  std::vector<double> dircos = ImageHelper::GetDirectionCosinesValue(*F, index);
   if( !dircos.empty() )
     {
     pixeldata.SetDirectionCosines( dircos.data() );
     }
 
   // Do the Rescale Intercept & Slope
-  std::vector<double> is = ImageHelper::GetRescaleInterceptSlopeValue(*F);
+  std::vector<double> is = ImageHelper::GetRescaleInterceptSlopeValue(*F, index);
   pixeldata.SetIntercept( is[0] );
   pixeldata.SetSlope( is[1] );
 
@@ -13,6 +13,7 @@
 =========================================================================*/
 #include "gdcmImageRegionReader.h"
 #include "gdcmImageHelper.h"
+#include "gdcmFrameGeometryIndex.h"
 #include "gdcmBoxRegion.h"
 
 #include "gdcmRAWCodec.h"
@@ -32,6 +33,7 @@ public:
     TheRegion = nullptr;
     Modified = false;
     FileOffset = -1;
+    ResolutionReduction = 0;
     }
   ~ImageRegionReaderInternals()
     {
@@ -56,12 +58,28 @@ public:
     {
     FileOffset = f;
     }
+  unsigned int GetResolutionReduction() const
+    {
+    return ResolutionReduction;
+    }
+  void SetResolutionReduction( unsigned int r )
+    {
+    ResolutionReduction = r;
+    }
 private:
   Region *TheRegion;
   bool Modified;
   std::streamoff FileOffset;
+  unsigned int ResolutionReduction;
 };
 
+// Number of samples of [min,max] once r resolution levels are discarded
+static inline size_t ReducedLength(unsigned int min, unsigned int max, unsigned int r)
+{
+  const size_t f = (size_t)1 << r;
+  return ((size_t)max + f) / f - ((size_t)min + f - 1) / f;
+}
+
 ImageRegionReader::ImageRegionReader()
 {
   Internals = new ImageRegionReaderInternals;
@@ -94,10 +112,21 @@ Region const &ImageRegionReader::GetRegion() const
     }
 }
 
+void ImageRegionReader::SetResolutionReduction(unsigned int r)
+{
+  Internals->SetResolutionReduction( r );
+}
+
+unsigned int ImageRegionReader::GetResolutionReduction() const
+{
+  return Internals->GetResolutionReduction();
+}
+
 size_t ImageRegionReader::ComputeBufferLength() const
 {
   // Is this a legal extent:
   size_t npixels = 0;
+  BoxRegion boundingbox;
   if( Internals->GetRegion() )
     {
     if( !Internals->GetRegion()->IsValid() )
@@ -106,6 +135,7 @@ size_t ImageRegionReader::ComputeBufferLength() const
       return 0;
       }
     npixels = this->Internals->GetRegion()->Area();
+    boundingbox = this->Internals->GetRegion()->ComputeBoundingBox();
     }
   else
     {
@@ -121,6 +151,15 @@ size_t ImageRegionReader::ComputeBufferLength() const
       return 0;
      }
     npixels = full.Area();
+    boundingbox = full;
+    }
+  const unsigned int r = Internals->GetResolutionReduction();
+  if( r )
+    {
+    if( r >= 32 ) return 0;
+    npixels = ReducedLength( boundingbox.GetXMin(), boundingbox.GetXMax(), r )
+      * ReducedLength( boundingbox.GetYMin(), boundingbox.GetYMax(), r )
+      * ( boundingbox.GetZMax() - boundingbox.GetZMin() + 1 );
     }
   const PixelFormat pixelInfo = ImageHelper::GetPixelFormatValue(GetFile());
   const size_t bytesPerPixel = pixelInfo.GetPixelSize();
@@ -168,8 +207,12 @@ bool ImageRegionReader::ReadInformation()
   // FIXME Copy/paste from ImageReader::ReadImage
   Image& pixeldata = GetImage();
 
+  // Functional groups (Enhanced objects) are walked once for all the getters:
+  FrameGeometryIndex index;
+  index.Build( F->GetDataSet() );
+
   // 4 1/2 Let's do Pixel Spacing
-  std::vector<double> spacing = ImageHelper::GetSpacingValue(*F);
+  std::vector<double> spacing = ImageHelper::GetSpacingValue(*F, index);
   // FIXME: Only SC is allowed not to have spacing:
   if( !spacing.empty() )
     {
@@ -181,7 +224,7 @@ bool ImageRegionReader::ReadInformation()
       }
     }
   // 4 2/3 Let's do Origin
-  std::vector<double> origin = ImageHelper::GetOriginValue(*F);
+  std::vector<double> origin = ImageHelper::GetOriginValue(*F, index);
   if( !origin.empty() )
     {
     pixeldata.SetOrigin( origin.data() );
@@ -191,14 +234,14 @@ bool ImageRegionReader::ReadInformation()
       }
     }
 
-  std::vector<double> dircos = ImageHelper::GetDirectionCosinesValue(*F);
+  std::vector<double> dircos = ImageHelper::GetDirectionCosinesValue(*F, index);
   if( !dircos.empty() )
     {
     pixeldata.SetDirectionCosines( dircos.data() );
     }
 
   // Do the Rescale Intercept & Slope
-  std::vector<double> is = ImageHelper::GetRescaleInterceptSlopeValue(*F);
+  std::vector<double> is = ImageHelper::GetRescaleInterceptSlopeValue(*F, index);
   pixeldata.SetIntercept( is[0] );
   pixeldata.SetSlope( is[1] );
 
@@ -365,6 +408,7 @@ bool ImageRegionReader::ReadJPEG2000IntoBuffer(char *buffer, size_t buflen)
   theCodec.SetNumberOfDimensions( 2 );
   if( d[2] > 1 )
     theCodec.SetNumberOfDimensions( 3 );
+  theCodec.SetResolutionReduction( Internals->GetResolutionReduction() );
 
   std::istream* theStream = GetStreamPtr();
   BoxRegion boundingbox = ComputeBoundingBox();
@@ -505,8 +549,16 @@ bool ImageRegionReader::ReadIntoBuffer(char *buffer, size_t buflen)
   gdcm_assert( Internals->GetFileOffset() != std::streampos(-1) );
   gdcmDebugMacro( "Using FileOffset: " << Internals->GetFileOffset() );
   std::istream* theStream = GetStreamPtr();
+  // a previous call may have left the stream in eof/fail state, this allows
+  // calling ReadIntoBuffer again with another region:
+  theStream->clear();
   theStream->seekg( Internals->GetFileOffset() );
 
+  if( Internals->GetResolutionReduction() )
+    {
+    // Only JPEG 2000 can discard resolution levels
+    return ReadJPEG2000IntoBuffer(buffer, buflen);
+    }
   bool success = false;
   if( !success ) success = ReadRAWIntoBuffer(buffer, buflen);
   if( !success ) success = ReadRLEIntoBuffer(buffer, buflen);
@@ -41,8 +41,19 @@ public:
   void SetRegion(Region const & region);
   Region const &GetRegion() const;
 
+  /// Set/Get the number of resolution levels to discard: the region is then
+  /// read at 1/2^r of the full resolution, its extent along x (resp. y)
+  /// being [ceil(xmin/2^r), ceil((xmax+1)/2^r)). Only JPEG 2000 Transfer
+  /// Syntaxes support r > 0, r must be lower than the number of resolution
+  /// levels of the codestream. Default is 0.
+  /// For tiled JPEG 2000 codestreams only the tiles intersecting the region
+  /// are read from the file.
+  void SetResolutionReduction(unsigned int r);
+  unsigned int GetResolutionReduction() const;
+
   /// Explicit call which will compute the minimal buffer length that can hold the whole
-  /// uncompressed image as defined by Region `region`.
+  /// uncompressed image as defined by Region `region` (and the resolution
+  /// reduction).
   /// \return 0 upon error
   size_t ComputeBufferLength() const;
 
@@ -21,6 +21,8 @@
 #include <cstring>
 #include <cstdio> // snprintf
 #include <numeric>
+#include <algorithm>
+#include <sstream>
 #if defined(_MSC_VER) && (_MSC_VER < 1900)
 #define snprintf _snprintf
 #endif
@@ -173,9 +175,12 @@ static bool parsej2k_imp( const char * const stream, const size_t file_size, boo
       if( !r || l < 2 )
         break;
       lenmarker = (size_t)l - 2;
+      if( lenmarker > cur_size )
+        break;
 
       if( marker == COD )
         {
+        if( lenmarker < 10 ) return false;
         const uint8_t MCTransformation = *(cur+4);
         if( MCTransformation == 0x0 ) *mct = false;
         else if( MCTransformation == 0x1 ) *mct = true;
@@ -220,10 +225,12 @@ static bool parsejp2_imp( const char * const stream, const size_t file_size, boo
         len64 = (size_t)(file_size - start + 8);
         }
       gdcm_assert( len64 >= 8 );
-      return parsej2k_imp( cur, (size_t)(len64 - 8), lossless, mct );
+      const size_t j2klen = (size_t)(len64 - 8);
+      return parsej2k_imp( cur, j2klen < cur_size ? j2klen : cur_size, lossless, mct );
       }
+      if( len64 < 8 || len64 - 8 > cur_size ) break;
       const size_t lenmarker = (size_t)(len64 - 8);
-      cur += lenmarker;
+      cur += lenmarker; cur_size -= lenmarker;
     }
 
   return false;
@@ -381,6 +388,64 @@ opj_stream_t* OPJ_CALLCONV opj_stream_create_memory_stream (myfile* p_mem,OPJ_SI
 }
 
 
+// Codestream read directly from a std::istream: the bytes OpenJPEG does not
+// need for the decoded area (tile-parts outside of it) are skipped, never read
+struct myistream
+{
+  std::istream *is;
+  std::streamoff start; // first byte of the codestream in is
+  size_t len;
+  size_t cur;
+};
+
+static OPJ_SIZE_T opj_read_from_istream(void * p_buffer, OPJ_SIZE_T p_nb_bytes, myistream* p_file)
+{
+  if( p_file->cur >= p_file->len ) return (OPJ_SIZE_T)-1;
+  const OPJ_SIZE_T left = (OPJ_SIZE_T)(p_file->len - p_file->cur);
+  p_file->is->read( (char*)p_buffer, (std::streamsize)std::min( p_nb_bytes, left ) );
+  const OPJ_SIZE_T l_nb_read = (OPJ_SIZE_T)p_file->is->gcount();
+  p_file->cur += l_nb_read;
+  return l_nb_read ? l_nb_read : ((OPJ_SIZE_T)-1);
+}
+
+static OPJ_BOOL opj_seek_from_istream(OPJ_OFF_T p_nb_bytes, myistream * p_file)
+{
+  if( p_nb_bytes < 0 || (size_t)p_nb_bytes > p_file->len )
+    {
+    return OPJ_FALSE;
+    }
+  p_file->cur = (size_t)p_nb_bytes;
+  p_file->is->clear();
+  p_file->is->seekg( p_file->start + (std::streamoff)p_file->cur, std::ios::beg );
+  return OPJ_TRUE;
+}
+
+static OPJ_OFF_T opj_skip_from_istream(OPJ_OFF_T p_nb_bytes, myistream * p_file)
+{
+  const OPJ_OFF_T pos = (OPJ_OFF_T)p_file->cur + p_nb_bytes;
+  if( !opj_seek_from_istream( pos, p_file ) )
+    {
+    opj_seek_from_istream( (OPJ_OFF_T)p_file->len, p_file );
+    return -1;
+    }
+  return p_nb_bytes;
+}
+
+static opj_stream_t* opj_stream_create_istream(myistream* p_is, OPJ_SIZE_T p_size)
+{
+  opj_stream_t* l_stream = opj_stream_create(p_size, OPJ_TRUE);
+  if( !l_stream )
+    {
+    return nullptr;
+    }
+  opj_stream_set_user_data(l_stream, p_is, nullptr);
+  opj_stream_set_read_function(l_stream, (opj_stream_read_fn) opj_read_from_istream);
+  opj_stream_set_skip_function(l_stream, (opj_stream_skip_fn) opj_skip_from_istream);
+  opj_stream_set_seek_function(l_stream, (opj_stream_seek_fn) opj_seek_from_istream);
+  opj_stream_set_user_data_length(l_stream, p_is->len);
+  return l_stream;
+}
+
 /*
  * Divide an integer by a power of 2 and round upwards.
  *
@@ -402,6 +467,7 @@ public:
 
   opj_cparameters coder_param;
   int nNumberOfThreadsForDecompression{ -1 };
+  unsigned int nResolutionReduction{ 0 };
 };
 
 void JPEG2000Codec::SetRate(unsigned int idx, double rate)
@@ -477,6 +543,16 @@ void JPEG2000Codec::SetMCT(unsigned int mct)
     Internals->coder_param.tcp_mct = mct;
 }
 
+void JPEG2000Codec::SetResolutionReduction(unsigned int r)
+{
+  Internals->nResolutionReduction = r;
+}
+
+unsigned int JPEG2000Codec::GetResolutionReduction() const
+{
+  return Internals->nResolutionReduction;
+}
+
 JPEG2000Codec::JPEG2000Codec()
 {
   Internals = new JPEG2000Internals;
@@ -627,6 +703,52 @@ static inline bool check_comp_valid(opj_image_t *image)
     return !invalid;
 }
 
+// Warn when the MCT flag of the codestream does not match the
+// PhotometricInterpretation
+static void check_mct(PhotometricInterpretation const &pi, bool mct)
+{
+  if( pi == PhotometricInterpretation::RGB
+   || pi == PhotometricInterpretation::YBR_FULL )
+  {
+    if( mct ) { gdcmWarningMacro("Invalid PhotometricInterpretation, should be YBR_RCT"); }
+  }
+  else if( pi == PhotometricInterpretation::YBR_RCT
+        || pi == PhotometricInterpretation::YBR_ICT )
+  {
+    if( !mct ) { gdcmWarningMacro("Invalid PhotometricInterpretation, should be RGB"); }
+  }
+  else
+  {
+    if( mct ) { gdcmWarningMacro("MCT flag was set in SamplesPerPixel = 1 image. corrupt j2k ?"); }
+  }
+}
+
+// The J2K component wins over the DICOM PixelFormat (sign and precision)
+static void reconcile_pixel_format(PixelFormat &pf, const opj_image_comp_t &comp)
+{
+  if( comp.sgnd != pf.GetPixelRepresentation() )
+    {
+    pf.SetPixelRepresentation( (uint16_t)comp.sgnd );
+    }
+#ifndef GDCM_SUPPORT_BROKEN_IMPLEMENTATION
+  gdcm_assert( comp.prec == pf.GetBitsStored()); // D_CLUNIE_RG3_JPLY.dcm
+  gdcm_assert( comp.prec - 1 == pf.GetHighBit());
+#endif
+  //gdcm_assert( comp.prec >= pf.GetBitsStored());
+  if( comp.prec != pf.GetBitsStored() )
+    {
+    if( comp.prec <= 8 )
+      pf.SetBitsAllocated( 8 );
+    else if( comp.prec <= 16 )
+      pf.SetBitsAllocated( 16 );
+    else if( comp.prec <= 32 )
+      pf.SetBitsAllocated( 32 );
+    pf.SetBitsStored( (unsigned short)comp.prec );
+    pf.SetHighBit( (unsigned short)(comp.prec - 1) ); // ??
+    }
+  gdcm_assert( pf.IsValid() );
+}
+
 std::pair<char *, size_t> JPEG2000Codec::DecodeByStreamsCommon(char *dummy_buffer, size_t buf_size)
 {
   opj_dparameters_t parameters;  /* decompression parameters */
@@ -794,20 +916,7 @@ std::pair<char *, size_t> JPEG2000Codec::DecodeByStreamsCommon(char *dummy_buffe
 
   gdcm_assert( image->numcomps == this->GetPixelFormat().GetSamplesPerPixel() );
   gdcm_assert( image->numcomps == this->GetPhotometricInterpretation().GetSamplesPerPixel() );
-  if( this->GetPhotometricInterpretation() == PhotometricInterpretation::RGB
-   || this->GetPhotometricInterpretation() == PhotometricInterpretation::YBR_FULL )
-  {
-    if( mct ) { gdcmWarningMacro("Invalid PhotometricInterpretation, should be YBR_RCT"); }
-  }
-  else if( this->GetPhotometricInterpretation() == PhotometricInterpretation::YBR_RCT
-        || this->GetPhotometricInterpretation() == PhotometricInterpretation::YBR_ICT )
-  {
-    if( !mct ) { gdcmWarningMacro("Invalid PhotometricInterpretation, should be RGB"); }
-  }
-  else
-  {
-    if( mct ) { gdcmWarningMacro("MCT flag was set in SamplesPerPixel = 1 image. corrupt j2k ?"); }
-  }
+  check_mct( this->GetPhotometricInterpretation(), mct );
 
   /* close the byte stream */
   opj_stream_destroy(cio);
@@ -836,27 +945,7 @@ std::pair<char *, size_t> JPEG2000Codec::DecodeByStreamsCommon(char *dummy_buffe
   opj_image_destroy(image);
     return std::pair<char*,size_t>(nullptr,0);
     }
-    if( comp->sgnd != PF.GetPixelRepresentation() )
-      {
-      PF.SetPixelRepresentation( (uint16_t)comp->sgnd );
-      }
-#ifndef GDCM_SUPPORT_BROKEN_IMPLEMENTATION
-    gdcm_assert( comp->prec == PF.GetBitsStored()); // D_CLUNIE_RG3_JPLY.dcm
-    gdcm_assert( comp->prec - 1 == PF.GetHighBit());
-#endif
-    //gdcm_assert( comp->prec >= PF.GetBitsStored());
-    if( comp->prec != PF.GetBitsStored() )
-      {
-      if( comp->prec <= 8 )
-        PF.SetBitsAllocated( 8 );
-      else if( comp->prec <= 16 )
-        PF.SetBitsAllocated( 16 );
-      else if( comp->prec <= 32 )
-        PF.SetBitsAllocated( 32 );
-      PF.SetBitsStored( (unsigned short)comp->prec );
-      PF.SetHighBit( (unsigned short)(comp->prec - 1) ); // ??
-      }
-    gdcm_assert( PF.IsValid() );
+    reconcile_pixel_format( PF, *comp );
     gdcm_assert( comp->prec <= 32 );
 
     if (comp->prec <= 8)
@@ -1688,6 +1777,154 @@ bool JPEG2000Codec::GetHeaderInfo(const char * dummy_buffer, size_t buf_size, Tr
   return true;
 }
 
+template <typename T>
+static void CopyComponent(const opj_image_comp_t &comp, unsigned int compno, unsigned int numcomps, char *buffer)
+{
+  T *data = (T*)(void*)buffer + compno;
+  const size_t n = (size_t)comp.w * comp.h;
+  for( size_t i = 0; i < n; ++i )
+    {
+    *data = (T)comp.data[i];
+    data += numcomps;
+    }
+}
+
+// Decode [xmin,xmax]x[ymin,ymax] (full resolution) of the codestream of len
+// bytes starting at the current position of is, directly into buffer.
+bool JPEG2000Codec::DecodeRegion(std::istream &is, size_t len,
+  unsigned int xmin, unsigned int xmax,
+  unsigned int ymin, unsigned int ymax,
+  char *buffer, size_t buflen)
+{
+  const std::streamoff start = is.tellg();
+  if( start < 0 || len == 0 ) return false;
+
+  // Remove trailing padding after EOC, see DecodeByStreamsCommon
+  size_t file_length = len;
+    {
+    const size_t taillen = std::min( len, (size_t)4096 );
+    std::vector<char> tail( taillen );
+    is.seekg( start + (std::streamoff)(len - taillen), std::ios::beg );
+    if( !is.read( tail.data(), (std::streamsize)taillen ) ) return false;
+    size_t n = taillen;
+    while( n > 0 && (unsigned char)tail[n-1] != 0xd9 ) --n;
+    if( n == 0 )
+      {
+      gdcmErrorMacro( "No EOC marker found" );
+      return false;
+      }
+    file_length = len - taillen + n;
+    }
+
+  // Only the main header is needed to find out about lossless / mct:
+  const char jp2magic[] = "\x00\x00\x00\x0C\x6A\x50\x20\x20\x0D\x0A\x87\x0A";
+  std::vector<char> header;
+  bool isjp2 = false;
+  bool lossless = false;
+  bool mct = false;
+  bool b = false;
+  for( size_t hlen = std::min( file_length, (size_t)4096 ); ;
+    hlen = std::min( file_length, 4 * hlen ) )
+    {
+    header.resize( hlen );
+    is.seekg( start, std::ios::beg );
+    if( !is.read( header.data(), (std::streamsize)hlen ) ) return false;
+    isjp2 = hlen >= 12 && memcmp( header.data(), jp2magic, 12 ) == 0;
+    if( isjp2 )
+      b = parsejp2_imp( header.data(), hlen, &lossless, &mct );
+    else
+      b = parsej2k_imp( header.data(), hlen, &lossless, &mct );
+    if( b || hlen == file_length ) break;
+    }
+  LossyFlag = !( b && lossless );
+
+  opj_dparameters_t parameters;
+  opj_set_default_decoder_parameters(&parameters);
+  parameters.cp_reduce = Internals->nResolutionReduction;
+  opj_codec_t* dinfo = opj_create_decompress( isjp2 ? CODEC_JP2 : CODEC_J2K );
+#if ((OPJ_VERSION_MAJOR == 2 && OPJ_VERSION_MINOR >= 3) || (OPJ_VERSION_MAJOR > 2))
+  opj_codec_set_threads(dinfo, Internals->nNumberOfThreadsForDecompression);
+#endif
+  opj_set_error_handler(dinfo, gdcm_error_callback, nullptr);
+  if( !opj_setup_decoder(dinfo, &parameters) )
+    {
+    opj_destroy_codec(dinfo);
+    gdcmErrorMacro( "opj_setup_decoder failure" );
+    return false;
+    }
+
+  myistream mysrc;
+  mysrc.is = &is;
+  mysrc.start = start;
+  mysrc.len = file_length;
+  mysrc.cur = 0;
+  is.seekg( start, std::ios::beg );
+  // Use a small chunk size, so that OpenJPEG does not read ahead the
+  // tile-parts it is about to skip
+  opj_stream_t *cio = opj_stream_create_istream(&mysrc, 0x10000);
+  opj_image_t *image = nullptr;
+  bool ret = cio && opj_read_header(cio, dinfo, &image);
+  if( ret )
+    {
+    const OPJ_UINT32 x0 = image->x0;
+    const OPJ_UINT32 y0 = image->y0;
+    if( xmax >= image->x1 - x0 || ymax >= image->y1 - y0 )
+      {
+      gdcmErrorMacro( "Region is outside of the J2K image" );
+      ret = false;
+      }
+    // TLM markers, when present, are used to seek to the tile-parts of the
+    // tiles intersecting the area. Others are skipped using their Psot.
+    ret = ret && opj_set_decode_area(dinfo, image,
+      (OPJ_INT32)(x0 + xmin), (OPJ_INT32)(y0 + ymin),
+      (OPJ_INT32)(x0 + xmax + 1), (OPJ_INT32)(y0 + ymax + 1));
+    ret = ret && opj_decode(dinfo, cio, image);
+    ret = ret && opj_end_decompress(dinfo, cio);
+    if( !ret ) gdcmErrorMacro( "opj_decode failed" );
+    }
+  if( cio ) opj_stream_destroy(cio);
+  opj_destroy_codec(dinfo);
+  if( !ret || !check_comp_valid(image) )
+    {
+    if( image ) opj_image_destroy(image);
+    return false;
+    }
+
+  const unsigned int numcomps = image->numcomps;
+  const opj_image_comp_t &comp0 = image->comps[0];
+  // buffer was allocated by the caller for the DICOM PixelFormat:
+  const unsigned int bitsallocated = PF.GetBitsAllocated();
+  // SC16BitsAllocated_8BitsStoredJ2K.dcm
+  if( numcomps != PF.GetSamplesPerPixel() || comp0.prec > bitsallocated
+    || ( bitsallocated != 8 && bitsallocated != 16 && bitsallocated != 32 ) )
+    {
+    gdcmErrorMacro( "Invalid PixelFormat found (mismatch DICOM vs J2K)" );
+    opj_image_destroy(image);
+    return false;
+    }
+  check_mct( this->GetPhotometricInterpretation(), mct );
+  // same adjustments as a full decode, reported by GetPixelFormat
+  // (components share sgnd and prec):
+  reconcile_pixel_format( PF, comp0 );
+  if( (size_t)comp0.w * comp0.h * numcomps * (bitsallocated / 8) != buflen )
+    {
+    gdcmErrorMacro( "Invalid decoded dimension: " << comp0.w << "x" << comp0.h );
+    opj_image_destroy(image);
+    return false;
+    }
+  for( unsigned int compno = 0; compno < numcomps; ++compno )
+    {
+    if( bitsallocated == 8 )
+      CopyComponent<uint8_t>( image->comps[compno], compno, numcomps, buffer );
+    else if( bitsallocated == 16 )
+      CopyComponent<uint16_t>( image->comps[compno], compno, numcomps, buffer );
+    else
+      CopyComponent<uint32_t>( image->comps[compno], compno, numcomps, buffer );
+    }
+  opj_image_destroy(image);
+  return true;
+}
+
 bool JPEG2000Codec::DecodeExtent(
   char *buffer,
   unsigned int xmin, unsigned int xmax,
@@ -1699,135 +1936,71 @@ bool JPEG2000Codec::DecodeExtent(
   BasicOffsetTable bot;
   bot.Read<SwapperNoOp>( is );
 
-  const unsigned int * dimensions = this->GetDimensions();
-  // retrieve pixel format *after* DecodeByStreamsCommon !
-  const PixelFormat pf = this->GetPixelFormat(); // make a copy !
+  const PixelFormat &pf = this->GetPixelFormat();
   gdcm_assert( pf.GetBitsAllocated() % 8 == 0 );
   gdcm_assert( pf != PixelFormat::SINGLEBIT );
   gdcm_assert( pf != PixelFormat::UINT12 && pf != PixelFormat::INT12 );
 
-  if( NumberOfDimensions == 2 )
+  // Size of the region once the resolution levels are discarded:
+  const int r = (int)Internals->nResolutionReduction;
+  const size_t rowsize = (size_t)( int_ceildivpow2( (int)xmax + 1, r ) - int_ceildivpow2( (int)xmin, r ) );
+  const size_t colsize = (size_t)( int_ceildivpow2( (int)ymax + 1, r ) - int_ceildivpow2( (int)ymin, r ) );
+  const size_t framelen = rowsize * colsize * pf.GetPixelSize();
+
+  // Locate the fragments, their value is only read by DecodeRegion:
+  const Tag seqDelItem(0xfffe,0xe0dd);
+  Fragment frag;
+  std::vector< std::streamoff > starts;
+  std::vector< size_t > lengths;
+  while( frag.ReadPreValue<SwapperNoOp>(is) && frag.GetTag() != seqDelItem )
     {
-    char *dummy_buffer = nullptr;
-    std::vector<char> vdummybuffer;
-    size_t buf_size = 0;
+    const size_t fraglen = frag.GetVL();
+    starts.push_back( is.tellg() );
+    lengths.push_back( fraglen );
+    is.seekg( (std::streamoff)fraglen, std::ios::cur );
+    }
+  gdcm_assert( frag.GetTag() == seqDelItem && frag.GetVL() == 0 );
 
-    const Tag seqDelItem(0xfffe,0xe0dd);
-    Fragment frag;
-    while( frag.ReadPreValue<SwapperNoOp>(is) && frag.GetTag() != seqDelItem )
-      {
-      size_t fraglen = frag.GetVL();
-      size_t oldlen = vdummybuffer.size();
-      if( fraglen == 0 && oldlen == 0 )
-        break;
-      // update
-      buf_size = fraglen + oldlen;
-      vdummybuffer.resize( buf_size );
-      dummy_buffer = vdummybuffer.data();
-      // read J2K
-      is.read( &vdummybuffer[oldlen], fraglen );
-      }
-    gdcm_assert( frag.GetTag() == seqDelItem && frag.GetVL() == 0 );
+  if( NumberOfDimensions == 2 )
+    {
     gdcm_assert( zmin == zmax );
     gdcm_assert( zmin == 0 );
-
-    std::pair<char*,size_t> raw_len = this->DecodeByStreamsCommon(dummy_buffer, buf_size);
-    if( !raw_len.first || !raw_len.second ) return false;
-    // check pixel format *after* DecodeByStreamsCommon !
-    const PixelFormat & pf2 = this->GetPixelFormat();
-    // SC16BitsAllocated_8BitsStoredJ2K.dcm
-    if( pf.GetSamplesPerPixel() != pf2.GetSamplesPerPixel()
-     || pf.GetBitsAllocated() != pf2.GetBitsAllocated()
-/*
-     || pf.GetPixelRepresentation() != pf2.GetPixelRepresentation() // TODO, we are a bit too aggressive here
-*/
-    )
+    (void)zmax;
+    if( lengths.empty() ) return false;
+    if( lengths.size() == 1 )
       {
-      gdcmErrorMacro( "Invalid PixelFormat found (mismatch DICOM vs J2K)" );
-      return false;
+      is.clear();
+      is.seekg( starts[0], std::ios::beg );
+      return DecodeRegion( is, lengths[0], xmin, xmax, ymin, ymax, buffer, framelen );
       }
-
-    char *raw = raw_len.first;
-    const unsigned int rowsize = xmax - xmin + 1;
-    const unsigned int colsize = ymax - ymin + 1;
-    const unsigned int bytesPerPixel = pf.GetPixelSize();
-
-    const char *tmpBuffer1 = raw;
-    unsigned int z = 0;
-    for (unsigned int y = ymin; y <= ymax; ++y)
+    // Frame split over several fragments, assemble the codestream:
+    std::string codestream;
+    codestream.resize( std::accumulate( lengths.begin(), lengths.end(), size_t(0) ) );
+    size_t pos = 0;
+    for( size_t i = 0; i < lengths.size(); ++i )
       {
-      size_t theOffset = 0 + (z*dimensions[1]*dimensions[0] + y*dimensions[0] + xmin)*bytesPerPixel;
-      tmpBuffer1 = raw + theOffset;
-      memcpy(&(buffer[((z-zmin)*rowsize*colsize +
-            (y-ymin)*rowsize)*bytesPerPixel]),
-        tmpBuffer1, rowsize*bytesPerPixel);
+      is.clear();
+      is.seekg( starts[i], std::ios::beg );
+      if( !is.read( &codestream[pos], (std::streamsize)lengths[i] ) ) return false;
+      pos += lengths[i];
       }
-    delete[] raw_len.first;
-
+    std::istringstream iss( codestream );
+    return DecodeRegion( iss, codestream.size(), xmin, xmax, ymin, ymax, buffer, framelen );
     }
   else if ( NumberOfDimensions == 3 )
     {
-    const Tag seqDelItem(0xfffe,0xe0dd);
-    Fragment frag;
-    std::streamoff thestart = is.tellg();
-    unsigned int numfrags = 0;
-    std::vector< size_t > offsets;
-    while( frag.ReadPreValue<SwapperNoOp>(is) && frag.GetTag() != seqDelItem )
-      {
-      //std::streamoff relstart = is.tellg();
-      //gdcm_assert( relstart - thestart == 8 );
-      std::streamoff off = frag.GetVL();
-      offsets.push_back( (size_t)off );
-      is.seekg( off, std::ios::cur );
-      ++numfrags;
-      }
-    gdcm_assert( frag.GetTag() == seqDelItem && frag.GetVL() == 0 );
-    gdcm_assert( numfrags == offsets.size() );
-    if( numfrags != Dimensions[2] )
+    if( lengths.size() != Dimensions[2] )
       {
       gdcmErrorMacro( "Not handled" );
       return false;
       }
-
     for( unsigned int z = zmin; z <= zmax; ++z )
       {
-      size_t curoffset = std::accumulate( offsets.begin(), offsets.begin() + z, size_t(0) );
-      is.seekg( thestart + curoffset + 8 * z, std::ios::beg );
-      is.seekg( 8, std::ios::cur );
-
-      const size_t buf_size = offsets[z];
-      char *dummy_buffer = new char[ buf_size ];
-      is.read( dummy_buffer, buf_size );
-      std::pair<char*,size_t> raw_len = this->DecodeByStreamsCommon(dummy_buffer, buf_size);
-      /* free the memory containing the code-stream */
-      delete[] dummy_buffer;
-      if( !raw_len.first || !raw_len.second ) return false;
-      // check pixel format *after* DecodeByStreamsCommon !
-      const PixelFormat & pf2 = this->GetPixelFormat();
-      if( pf.GetSamplesPerPixel() != pf2.GetSamplesPerPixel()
-       || pf.GetBitsAllocated() != pf2.GetBitsAllocated()
-      )
-        {
-        gdcmErrorMacro( "Invalid PixelFormat found (mismatch DICOM vs J2K)" );
+      is.clear();
+      is.seekg( starts[z], std::ios::beg );
+      if( !DecodeRegion( is, lengths[z], xmin, xmax, ymin, ymax,
+          buffer + (z - zmin) * framelen, framelen ) )
         return false;
-        }
-
-
-      char *raw = raw_len.first;
-      const unsigned int rowsize = xmax - xmin + 1;
-      const unsigned int colsize = ymax - ymin + 1;
-      const unsigned int bytesPerPixel = pf.GetPixelSize();
-
-      const char *tmpBuffer1 = raw;
-      for (unsigned int y = ymin; y <= ymax; ++y)
-        {
-        size_t theOffset = 0 + (0*dimensions[1]*dimensions[0] + y*dimensions[0] + xmin)*bytesPerPixel;
-        tmpBuffer1 = raw + theOffset;
-        memcpy(&(buffer[((z-zmin)*rowsize*colsize +
-              (y-ymin)*rowsize)*bytesPerPixel]),
-          tmpBuffer1, rowsize*bytesPerPixel);
-        }
-      delete[] raw_len.first;
       }
     }
   return true;
@@ -1836,6 +2009,7 @@ bool JPEG2000Codec::DecodeExtent(
 ImageCodec * JPEG2000Codec::Clone() const
 {
   JPEG2000Codec * copy = new JPEG2000Codec;
+  copy->Internals->nResolutionReduction = Internals->nResolutionReduction;
   return copy;
 }
 
@@ -63,6 +63,12 @@ public:
   void SetReversible(bool res);
   void SetMCT(unsigned int mct);
 
+  /// Set/Get the number of highest resolution levels to discard when decoding
+  /// a region (see ImageRegionReader::SetResolutionReduction). The region is
+  /// then decoded at 1/2^r of the full resolution. Default is 0.
+  void SetResolutionReduction(unsigned int r);
+  unsigned int GetResolutionReduction() const;
+
 protected:
   bool DecodeExtent(
     char *buffer,
@@ -83,6 +89,10 @@ protected:
 
 private:
   std::pair<char *, size_t> DecodeByStreamsCommon(char *dummy_buffer, size_t buf_size);
+  bool DecodeRegion(std::istream &is, size_t len,
+    unsigned int xmin, unsigned int xmax,
+    unsigned int ymin, unsigned int ymax,
+    char *buffer, size_t buflen);
   bool CodeFrameIntoBuffer(char * outdata, size_t outlen, size_t & complen, const char * indata, size_t inlen );
   bool GetHeaderInfo(const char * dummy_buffer, size_t len, TransferSyntax &ts);
   JPEG2000Internals *Internals;
@@ -32,6 +32,7 @@ public:
   ~JPEG8Codec() override;
 
   bool DecodeByStreams(std::istream &is, std::ostream &os) override;
+  bool DecodeFrameBuffer(const char *in, size_t inlen, char *out, size_t outlen) override;
   bool InternalCode(const char *input, unsigned long len, std::ostream &os) override;
 
   bool GetHeaderInfo(std::istream &is, TransferSyntax &ts) override;
@@ -15,6 +15,7 @@
 #include "gdcmTransferSyntax.h"
 
 #include <limits.h>
+#include <algorithm>
 
 /*
  * jdatasrc.c
@@ -254,6 +255,60 @@ jpeg_stdio_src (j_decompress_ptr cinfo, std::istream & infile, bool flag)
     }
 }
 
+/*
+ * Memory source: the whole compressed stream (eg. a fragment) is handed to
+ * the library at once, no copy and no suspension. Running out of data is
+ * dealt with the same way as a truncated file (fake EOI marker).
+ */
+
+METHODDEF(void)
+init_memory_source (j_decompress_ptr cinfo)
+{
+  (void)cinfo;
+}
+
+METHODDEF(boolean)
+fill_memory_input_buffer (j_decompress_ptr cinfo)
+{
+  static const JOCTET fake_eoi[2] = { (JOCTET) 0xFF, (JOCTET) JPEG_EOI };
+  WARNMS(cinfo, JWRN_JPEG_EOF);
+  cinfo->src->next_input_byte = fake_eoi;
+  cinfo->src->bytes_in_buffer = 2;
+  return TRUE;
+}
+
+METHODDEF(void)
+skip_memory_input_data (j_decompress_ptr cinfo, long num_bytes)
+{
+  struct jpeg_source_mgr * src = cinfo->src;
+  if (num_bytes > 0) {
+    while (num_bytes > (long) src->bytes_in_buffer) {
+      num_bytes -= (long) src->bytes_in_buffer;
+      (void) fill_memory_input_buffer(cinfo);
+    }
+    src->next_input_byte += (size_t) num_bytes;
+    src->bytes_in_buffer -= (size_t) num_bytes;
+  }
+}
+
+static void
+jpeg_memory_src (j_decompress_ptr cinfo, const char * buffer, size_t len)
+{
+  if (cinfo->src == nullptr) {
+    cinfo->src = (struct jpeg_source_mgr *)
+      (*cinfo->mem->alloc_small) ((j_common_ptr) cinfo, JPOOL_PERMANENT,
+          SIZEOF(struct jpeg_source_mgr));
+  }
+  struct jpeg_source_mgr * src = cinfo->src;
+  src->init_source = init_memory_source;
+  src->fill_input_buffer = fill_memory_input_buffer;
+  src->skip_input_data = skip_memory_input_data;
+  src->resync_to_restart = jpeg_resync_to_restart; /* use default method */
+  src->term_source = term_source;
+  src->next_input_byte = (const JOCTET *) buffer;
+  src->bytes_in_buffer = len;
+}
+
 } // end namespace gdcm
 
 
@@ -695,6 +750,110 @@ UINT16 Y_density
 
 }
 
+/*
+ * Check the JPEG header against the DICOM attributes and set up the color
+ * space conversion (none for lossless and YBR). pi is updated when the
+ * DICOM header is obviously wrong.
+ */
+static bool ConfigureDecompression(jpeg_decompress_struct &cinfo,
+  const unsigned int *dims, PhotometricInterpretation &pi)
+{
+  // Sanity checks:
+  if( cinfo.image_width != dims[0]
+    || cinfo.image_height != dims[1] )
+    {
+    gdcmWarningMacro( "dimension mismatch. JPEG is " <<
+      cinfo.image_width << "," << cinfo.image_height << " while DICOM " << dims[0] <<
+      "," << dims[1]  ); 
+    //this->Dimensions[0] = cinfo.image_width;
+    //this->Dimensions[1] = cinfo.image_height;
+    /*
+     * Long story short, the real issue is that class such as ImageRegionReader expect to read the
+     * image information without ever touching the JPEG codestream...
+     */
+    return false;
+    }
+  gdcm_assert( cinfo.image_width == dims[0] );
+  gdcm_assert( cinfo.image_height == dims[1] );
+
+  switch ( cinfo.jpeg_color_space )
+    {
+  case JCS_GRAYSCALE:
+    if( pi != PhotometricInterpretation::MONOCHROME1
+      && pi != PhotometricInterpretation::MONOCHROME2 )
+      {
+      gdcmWarningMacro( "Wrong PhotometricInterpretation. DICOM says: " <<
+        pi << " but JPEG says: "
+        << (int)cinfo.jpeg_color_space );
+      //Internals->SetPhotometricInterpretation( PhotometricInterpretation::MONOCHROME2 );
+      pi = PhotometricInterpretation::MONOCHROME2;
+      }
+    break;
+  case JCS_RGB:
+    //gdcm_assert( pi == PhotometricInterpretation::RGB );
+      if ( cinfo.process == JPROC_LOSSLESS )
+        {
+        cinfo.jpeg_color_space = JCS_UNKNOWN;
+        cinfo.out_color_space = JCS_UNKNOWN;
+        }
+      if( pi == PhotometricInterpretation::YBR_RCT
+       || pi == PhotometricInterpretation::YBR_ICT )
+        pi = PhotometricInterpretation::RGB;
+    break;
+  case JCS_YCbCr:
+    if( pi != PhotometricInterpretation::YBR_FULL &&
+        pi != PhotometricInterpretation::YBR_PARTIAL_422 &&
+        pi != PhotometricInterpretation::YBR_FULL_422 )
+      {
+      // DermaColorLossLess.dcm (lossless)
+      // LEADTOOLS_FLOWERS-24-RGB-JpegLossy.dcm (lossy)
+      gdcmWarningMacro( "Wrong PhotometricInterpretation. DICOM says: " <<
+        pi << " but JPEG says: "
+        << (int)cinfo.jpeg_color_space );
+      // Here it gets nasty since apparently when this occurs lossless means
+      // we should not do any color conversion, but we *might* be breaking
+      // correct DICOM file.
+      // FIXME FIXME
+      /* prevent the library from performing any color space conversion */
+      cinfo.jpeg_color_space = JCS_UNKNOWN;
+      cinfo.out_color_space = JCS_UNKNOWN;
+      }
+    if ( cinfo.process == JPROC_LOSSLESS )
+      {
+      //cinfo.jpeg_color_space = JCS_UNKNOWN;
+      //cinfo.out_color_space = JCS_UNKNOWN;
+      }
+    if( pi == PhotometricInterpretation::YBR_FULL
+    || pi == PhotometricInterpretation::YBR_PARTIAL_422
+    || pi == PhotometricInterpretation::YBR_FULL_422 )
+      {
+      cinfo.jpeg_color_space = JCS_UNKNOWN;
+      cinfo.out_color_space = JCS_UNKNOWN;
+      //this->PlanarConfiguration = 1;
+      }
+    break;
+  case JCS_CMYK:
+    gdcm_assert( pi == PhotometricInterpretation::CMYK );
+    if ( cinfo.process == JPROC_LOSSLESS )
+      {
+      cinfo.jpeg_color_space = JCS_UNKNOWN;
+      cinfo.out_color_space = JCS_UNKNOWN;
+      }
+    break;
+  case JCS_UNKNOWN:
+    if ( cinfo.process == JPROC_LOSSLESS )
+      {
+      cinfo.jpeg_color_space = JCS_UNKNOWN;
+      cinfo.out_color_space = JCS_UNKNOWN;
+      }
+    break;
+  default:
+    gdcm_assert(0);
+    return false;
+    }
+  return true;
+}
+
 /*
  * Note: see dcmdjpeg +cn option to avoid the YBR => RGB loss
  */
@@ -790,98 +949,8 @@ bool JPEGBITSCodec::DecodeByStreams(std::istream &is, std::ostream &os)
     // JCS_CMYK
     // JCS_YCCK
 
-    // Sanity checks:
-    const unsigned int * dims = this->GetDimensions();
-    if( cinfo.image_width != dims[0]
-      || cinfo.image_height != dims[1] )
+    if( !ConfigureDecompression( cinfo, this->GetDimensions(), this->PI ) )
       {
-      gdcmWarningMacro( "dimension mismatch. JPEG is " <<
-        cinfo.image_width << "," << cinfo.image_height << " while DICOM " << dims[0] <<
-        "," << dims[1]  ); 
-      //this->Dimensions[0] = cinfo.image_width;
-      //this->Dimensions[1] = cinfo.image_height;
-      /*
-       * Long story short, the real issue is that class such as ImageRegionReader expect to read the
-       * image information without ever touching the JPEG codestream...
-       */
-      return false;
-      }
-    gdcm_assert( cinfo.image_width == dims[0] );
-    gdcm_assert( cinfo.image_height == dims[1] );
-
-    switch ( cinfo.jpeg_color_space )
-      {
-    case JCS_GRAYSCALE:
-      if( GetPhotometricInterpretation() != PhotometricInterpretation::MONOCHROME1
-        && GetPhotometricInterpretation() != PhotometricInterpretation::MONOCHROME2 )
-        {
-        gdcmWarningMacro( "Wrong PhotometricInterpretation. DICOM says: " <<
-          GetPhotometricInterpretation() << " but JPEG says: "
-          << (int)cinfo.jpeg_color_space );
-        //Internals->SetPhotometricInterpretation( PhotometricInterpretation::MONOCHROME2 );
-        this->PI = PhotometricInterpretation::MONOCHROME2;
-        }
-      break;
-    case JCS_RGB:
-      //gdcm_assert( GetPhotometricInterpretation() == PhotometricInterpretation::RGB );
-        if ( cinfo.process == JPROC_LOSSLESS )
-          {
-          cinfo.jpeg_color_space = JCS_UNKNOWN;
-          cinfo.out_color_space = JCS_UNKNOWN;
-          }
-        if( GetPhotometricInterpretation() == PhotometricInterpretation::YBR_RCT
-         || GetPhotometricInterpretation() == PhotometricInterpretation::YBR_ICT )
-          this->PI = PhotometricInterpretation::RGB;
-      break;
-    case JCS_YCbCr:
-      if( GetPhotometricInterpretation() != PhotometricInterpretation::YBR_FULL &&
-          GetPhotometricInterpretation() != PhotometricInterpretation::YBR_PARTIAL_422 &&
-          GetPhotometricInterpretation() != PhotometricInterpretation::YBR_FULL_422 )
-        {
-        // DermaColorLossLess.dcm (lossless)
-        // LEADTOOLS_FLOWERS-24-RGB-JpegLossy.dcm (lossy)
-        gdcmWarningMacro( "Wrong PhotometricInterpretation. DICOM says: " <<
-          GetPhotometricInterpretation() << " but JPEG says: "
-          << (int)cinfo.jpeg_color_space );
-        // Here it gets nasty since apparently when this occurs lossless means
-        // we should not do any color conversion, but we *might* be breaking
-        // correct DICOM file.
-        // FIXME FIXME
-        /* prevent the library from performing any color space conversion */
-        cinfo.jpeg_color_space = JCS_UNKNOWN;
-        cinfo.out_color_space = JCS_UNKNOWN;
-        }
-      if ( cinfo.process == JPROC_LOSSLESS )
-        {
-        //cinfo.jpeg_color_space = JCS_UNKNOWN;
-        //cinfo.out_color_space = JCS_UNKNOWN;
-        }
-      if( GetPhotometricInterpretation() == PhotometricInterpretation::YBR_FULL
-      || GetPhotometricInterpretation() == PhotometricInterpretation::YBR_PARTIAL_422
-      || GetPhotometricInterpretation() == PhotometricInterpretation::YBR_FULL_422 )
-        {
-        cinfo.jpeg_color_space = JCS_UNKNOWN;
-        cinfo.out_color_space = JCS_UNKNOWN;
-        //this->PlanarConfiguration = 1;
-        }
-      break;
-    case JCS_CMYK:
-      gdcm_assert( GetPhotometricInterpretation() == PhotometricInterpretation::CMYK );
-      if ( cinfo.process == JPROC_LOSSLESS )
-        {
-        cinfo.jpeg_color_space = JCS_UNKNOWN;
-        cinfo.out_color_space = JCS_UNKNOWN;
-        }
-      break;
-    case JCS_UNKNOWN:
-      if ( cinfo.process == JPROC_LOSSLESS )
-        {
-        cinfo.jpeg_color_space = JCS_UNKNOWN;
-        cinfo.out_color_space = JCS_UNKNOWN;
-        }
-      break;
-    default:
-      gdcm_assert(0);
       return false;
       }
     //gdcm_assert( cinfo.data_precision == BITS_IN_JSAMPLE );
@@ -998,6 +1067,88 @@ bool JPEGBITSCodec::DecodeByStreams(std::istream &is, std::ostream &os)
   return true;
 }
 
+/*
+ * Same as DecodeByStreams for a complete JPEG stream in memory: the scanlines
+ * are written straight into out, which must be exactly the size of the
+ * decoded image. The internal state (suspension) is left untouched.
+ */
+bool JPEGBITSCodec::DecodeFrameBuffer(const char *in, size_t inlen, char *out, size_t outlen)
+{
+  jpeg_decompress_struct cinfo;
+  my_error_mgr jerr;
+  cinfo.err = jpeg_std_error(&jerr.pub);
+  jerr.pub.error_exit = my_error_exit;
+  if (setjmp(jerr.setjmp_buffer))
+    {
+    if ( jerr.pub.msg_code == JERR_BAD_PRECISION /* 18 */ )
+      {
+      this->BitSample = jerr.pub.msg_parm.i[0];
+      }
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+    }
+  jpeg_create_decompress(&cinfo);
+  jpeg_memory_src(&cinfo, in, inlen);
+
+  if( jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK )
+    {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+    }
+  if( jerr.pub.num_warnings )
+    {
+    if ( jerr.pub.msg_code == JWRN_MUST_DOWNSCALE )
+      {
+      // Wrong bit sample, see DecodeByStreams
+      this->BitSample = jerr.pub.msg_parm.i[0];
+      }
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+    }
+  if( !ConfigureDecompression( cinfo, this->GetDimensions(), this->PI ) )
+    {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+    }
+
+  jpeg_start_decompress(&cinfo);
+  const size_t row_stride =
+    (size_t)cinfo.output_width * cinfo.output_components * sizeof(JSAMPLE);
+  if( row_stride * cinfo.output_height != outlen )
+    {
+    jpeg_destroy_decompress(&cinfo);
+    return false;
+    }
+
+  /* Decode straight into the output rows, as many as the library can: */
+  JSAMPROW rows[16];
+  while (cinfo.output_scanline < cinfo.output_height) {
+    const JDIMENSION n = std::min( (JDIMENSION)16,
+      (JDIMENSION)(cinfo.output_height - cinfo.output_scanline) );
+    for( JDIMENSION i = 0; i < n; ++i )
+      {
+      rows[i] = (JSAMPROW)(out + (cinfo.output_scanline + i) * row_stride);
+      }
+    if( jpeg_read_scanlines(&cinfo, rows, n) == 0 )
+      {
+      jpeg_destroy_decompress(&cinfo);
+      return false;
+      }
+  }
+
+  jpeg_finish_decompress(&cinfo);
+  LossyFlag = cinfo.process != JPROC_LOSSLESS;
+  jpeg_destroy_decompress(&cinfo);
+
+  /* gdcmData/D_CLUNIE_MR4_JPLY.dcm produces a single warning */
+  if( jerr.pub.num_warnings > 1 )
+    {
+    gdcmErrorMacro( "Too many warning during decompression of JPEG stream: " << jerr.pub.num_warnings );
+    return false;
+    }
+  return true;
+}
+
 /*
  * jdatadst.c
  *
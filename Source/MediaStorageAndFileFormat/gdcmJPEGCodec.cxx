@@ -23,6 +23,7 @@
 
 #include <cstring>
 #include <numeric>
+#include <vector>
 
 namespace gdcm
 {
@@ -147,6 +148,22 @@ Interchange Format shall be used (the table specification shall be included).
 bool JPEGCodec::Decode(DataElement const &in, DataElement &out)
 {
   gdcm_assert( Internal );
+    {
+    // Fast path, decode straight into the final Pixel Data:
+    const size_t nframes = NumberOfDimensions == 3 ? Dimensions[2] : 1;
+    const size_t len = (size_t)Dimensions[0] * Dimensions[1] * nframes * PF.GetPixelSize();
+    if( len && len <= 0xfffffffe && in.GetSequenceOfFragments() )
+      {
+      SmartPointer<ByteValue> bv = new ByteValue( nullptr, (uint32_t)len );
+      if( DecodeToBuffer(in, (char*)bv->GetVoidPointer(), len) )
+        {
+        out = in;
+        out.SetValue( *bv );
+        return true;
+        }
+      }
+    // else use the stream decoder, which deals with the broken encoders
+    }
   out = in;
   // Fragments...
   const SequenceOfFragments *sf0 = in.GetSequenceOfFragments();
@@ -246,6 +263,90 @@ bool JPEGCodec::Decode(DataElement const &in, DataElement &out)
   return true;
 }
 
+bool JPEGCodec::DecodeToBuffer(DataElement const &in, char *buffer, size_t len)
+{
+  const SequenceOfFragments *sf = in.GetSequenceOfFragments();
+  if( !sf || !buffer || !Internal ) return false;
+  const unsigned int nframes = NumberOfDimensions == 3 ? Dimensions[2] : 1;
+  if( nframes == 0 || len % nframes != 0 ) return false;
+  const size_t framelen = len / nframes;
+
+  if( nframes == 1 && sf->GetNumberOfFragments() > 1 )
+    {
+    // A frame spanning multiple fragments needs to be made contiguous:
+    std::vector<char> stream( sf->ComputeByteLength() );
+    if( stream.empty() || !sf->GetBuffer(stream.data(), (unsigned long)stream.size()) ) return false;
+    return DecodeFrameBuffer(stream.data(), stream.size(), buffer, framelen);
+    }
+
+  if( sf->GetNumberOfFragments() != nframes ) return false;
+  for( unsigned int i = 0; i < nframes; ++i )
+    {
+    // Hand libjpeg the fragment bytes directly:
+    const Fragment &frag = sf->GetFragment(i);
+    const ByteValue *bv = frag.GetByteValue();
+    if( frag.IsEmpty() || !bv ) return false;
+    if( !DecodeFrameBuffer(bv->GetPointer(), bv->GetLength(), buffer + i * framelen, framelen) )
+      {
+      return false;
+      }
+    }
+  return true;
+}
+
+bool JPEGCodec::DecodeFrameBuffer(const char *in, size_t inlen, char *out, size_t outlen)
+{
+  if( !Internal ) return false;
+  // Only a plain copy is done by ImageCodec::DecodeByStreams for JPEG, with
+  // the exception of the unused bits cleanup:
+  if( NeedByteSwap || RequestPaddedCompositePixelCode || RequestPlanarConfiguration )
+    {
+    return false;
+    }
+  if( !Internal->DecodeFrameBuffer(in, inlen, out, outlen) )
+    {
+    return false;
+    }
+  // Same fixups as DecodeByStreams:
+  if( this->PlanarConfiguration != Internal->PlanarConfiguration )
+    {
+    gdcmWarningMacro( "PlanarConfiguration issue" );
+    this->PlanarConfiguration = Internal->PlanarConfiguration;
+    }
+  if( this->PI != Internal->PI )
+    {
+    gdcmWarningMacro( "PhotometricInterpretation issue" );
+    this->PI = Internal->PI;
+    }
+  if( this->PF == PixelFormat::UINT12
+   || this->PF == PixelFormat::INT12 )
+    {
+    this->PF.SetBitsAllocated( 16 );
+    }
+  switch(PI)
+    {
+  case PhotometricInterpretation::MONOCHROME1:
+  case PhotometricInterpretation::MONOCHROME2:
+  case PhotometricInterpretation::PALETTE_COLOR:
+  case PhotometricInterpretation::RGB:
+  case PhotometricInterpretation::ARGB:
+  case PhotometricInterpretation::YBR_FULL:
+  case PhotometricInterpretation::YBR_FULL_422:
+  case PhotometricInterpretation::YBR_PARTIAL_422:
+  case PhotometricInterpretation::YBR_ICT:
+  case PhotometricInterpretation::YBR_RCT:
+    break;
+  default:
+    gdcmErrorMacro( "Unhandled PhotometricInterpretation: " << PI );
+    return false;
+    }
+  if( PF.GetBitsAllocated() != PF.GetBitsStored() && PF.GetBitsAllocated() != 8 )
+    {
+    return CleanupUnusedBits(out, outlen);
+    }
+  return true;
+}
+
 void JPEGCodec::ComputeOffsetTable(bool b)
 {
   (void)b;
@@ -443,6 +544,20 @@ bool JPEGCodec::IsValid(PhotometricInterpretation const &pi)
   return ret;
 }
 
+bool JPEGCodec::DecodeFrame(const char *in, size_t inlen, std::vector<char> &frame)
+{
+  frame.resize( (size_t)Dimensions[0] * Dimensions[1] * PF.GetPixelSize() );
+  if( DecodeFrameBuffer( in, inlen, frame.data(), frame.size() ) ) return true;
+  // Broken streams, or decoded size not matching the header:
+  std::stringstream is;
+  is.write( in, (std::streamsize)inlen );
+  std::stringstream os;
+  if( !DecodeByStreams( is, os ) ) return false;
+  const std::string str = os.str();
+  frame.assign( str.begin(), str.end() );
+  return true;
+}
+
 bool JPEGCodec::DecodeExtent(
     char *buffer,
     unsigned int xmin, unsigned int xmax,
@@ -526,36 +641,17 @@ bool JPEGCodec::DecodeExtent(
     gdcm_assert( zmin == zmax );
     gdcm_assert( zmin == 0 );
 
-    std::stringstream iis;
-    iis.write( vdummybuffer.data(), vdummybuffer.size() );
-    std::stringstream os;
-    bool b = DecodeByStreams(iis,os);
-    if(!b) return false;
-    gdcm_assert(b);
+    std::vector<char> frame;
+    if( !DecodeFrame( vdummybuffer.data(), vdummybuffer.size(), frame ) ) return false;
 
     const unsigned int rowsize = xmax - xmin + 1;
-    const unsigned int colsize = ymax - ymin + 1;
     const unsigned int bytesPerPixel = pf.GetPixelSize();
-    os.seekg(0, std::ios::beg );
-    gdcm_assert( os.good() );
-    std::istream *theStream = &os;
-    std::vector<char> buffer1;
-    buffer1.resize( rowsize*bytesPerPixel );
-    char *tmpBuffer1 = buffer1.data();
-    unsigned int y, z;
-    std::streamoff theOffset;
-    for (z = zmin; z <= zmax; ++z)
+    for (unsigned int y = ymin; y <= ymax; ++y)
       {
-      for (y = ymin; y <= ymax; ++y)
-        {
-        theStream->seekg(std::ios::beg);
-        theOffset = 0 + (z*dimensions[1]*dimensions[0] + y*dimensions[0] + xmin)*bytesPerPixel;
-        theStream->seekg(theOffset);
-        theStream->read(tmpBuffer1, rowsize*bytesPerPixel);
-        memcpy(&(buffer[((z-zmin)*rowsize*colsize +
-              (y-ymin)*rowsize)*bytesPerPixel]),
-          tmpBuffer1, rowsize*bytesPerPixel);
-        }
+      const size_t theOffset = ((size_t)y*dimensions[0] + xmin)*bytesPerPixel;
+      if( theOffset + rowsize*bytesPerPixel > frame.size() ) return false;
+      memcpy(&(buffer[((size_t)(y-ymin)*rowsize)*bytesPerPixel]),
+        frame.data() + theOffset, rowsize*bytesPerPixel);
       }
     }
   else if ( NumberOfDimensions == 3 )
@@ -582,44 +678,28 @@ bool JPEGCodec::DecodeExtent(
       return false;
       }
 
+    std::vector<char> codestream;
+    std::vector<char> frame;
     for( unsigned int z = zmin; z <= zmax; ++z )
       {
       size_t curoffset = std::accumulate( offsets.begin(), offsets.begin() + z, size_t(0) );
       is.seekg( thestart + curoffset + 8 * z, std::ios::beg );
       is.seekg( 8, std::ios::cur );
 
-      //const size_t buf_size = offsets[z];
-      //char *dummy_buffer = new char[ buf_size ];
-      //is.read( dummy_buffer, buf_size );
-
-      std::stringstream os;
-      const bool b = DecodeByStreams(is, os); (void)b;
-      gdcm_assert(b);
-      /* free the memory containing the code-stream */
-      //delete[] dummy_buffer;
-
-      os.seekg(0, std::ios::beg );
-      gdcm_assert( os.good() );
-      std::istream *theStream = &os;
-
-      unsigned int rowsize = xmax - xmin + 1;
-      unsigned int colsize = ymax - ymin + 1;
-      unsigned int bytesPerPixel = pf.GetPixelSize();
-
-      std::vector<char> buffer1;
-      buffer1.resize( rowsize*bytesPerPixel );
-      char *tmpBuffer1 = buffer1.data();
-      unsigned int y;
-      std::streamoff theOffset;
-      for (y = ymin; y <= ymax; ++y)
+      codestream.resize( offsets[z] );
+      if( !is.read( codestream.data(), codestream.size() ) ) return false;
+      if( !DecodeFrame( codestream.data(), codestream.size(), frame ) ) return false;
+
+      const unsigned int rowsize = xmax - xmin + 1;
+      const unsigned int colsize = ymax - ymin + 1;
+      const unsigned int bytesPerPixel = pf.GetPixelSize();
+      for (unsigned int y = ymin; y <= ymax; ++y)
         {
-        theStream->seekg(std::ios::beg);
-        theOffset = 0 + (0*dimensions[1]*dimensions[0] + y*dimensions[0] + xmin)*bytesPerPixel;
-        theStream->seekg(theOffset);
-        theStream->read(tmpBuffer1, rowsize*bytesPerPixel);
-        memcpy(&(buffer[((z-zmin)*rowsize*colsize +
+        const size_t theOffset = ((size_t)y*dimensions[0] + xmin)*bytesPerPixel;
+        if( theOffset + rowsize*bytesPerPixel > frame.size() ) return false;
+        memcpy(&(buffer[((size_t)(z-zmin)*rowsize*colsize +
               (y-ymin)*rowsize)*bytesPerPixel]),
-          tmpBuffer1, rowsize*bytesPerPixel);
+          frame.data() + theOffset, rowsize*bytesPerPixel);
         }
       }
     }
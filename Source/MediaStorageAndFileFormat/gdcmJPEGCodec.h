@@ -16,6 +16,8 @@
 
 #include "gdcmImageCodec.h"
 
+#include <vector>
+
 namespace gdcm
 {
 
@@ -48,6 +50,13 @@ public:
   bool Decode(DataElement const &is, DataElement &os) override;
   void SetPixelFormat(PixelFormat const &pf) override;
 
+  /// Decode the encapsulated Pixel Data directly into buffer (of len bytes):
+  /// libjpeg reads the fragment bytes in place and writes the scanlines at
+  /// their final offset. Return false when the fragments do not hold one
+  /// JPEG stream per frame decoding to exactly len bytes, use Decode in
+  /// this case.
+  bool DecodeToBuffer(DataElement const &in, char *buffer, size_t len);
+
   /// Compute the offset table:
   void ComputeOffsetTable(bool b);
 
@@ -78,6 +87,11 @@ protected:
   );
 
   bool DecodeByStreams(std::istream &is, std::ostream &os) override;
+  /// Decode a single JPEG stream of inlen bytes into out (outlen bytes)
+  virtual bool DecodeFrameBuffer(const char *in, size_t inlen, char *out, size_t outlen);
+  /// Decode a single JPEG stream into frame, using DecodeFrameBuffer when
+  /// possible and DecodeByStreams otherwise
+  bool DecodeFrame(const char *in, size_t inlen, std::vector<char> &frame);
   bool IsValid(PhotometricInterpretation const &pi) override;
 
   bool StartEncode( std::ostream & ) override;
@@ -16,9 +16,11 @@
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmDataElement.h"
 #include "gdcmSwapper.h"
+#include "gdcmParallelFor.h"
 
 #include <numeric>
 #include <cstring> // memcpy
+#include <atomic>
 
 // CharLS includes
 #include "gdcm_charls.h"
@@ -31,7 +33,7 @@
 namespace gdcm
 {
 
-JPEGLSCodec::JPEGLSCodec():BufferLength(0)/*,Lossless(true)*/,LossyError(0)
+JPEGLSCodec::JPEGLSCodec():BufferLength(0)/*,Lossless(true)*/,LossyError(0),NumberOfThreads(1)
 {
 }
 
@@ -152,14 +154,13 @@ bool JPEGLSCodec::CanCode(TransferSyntax const &ts) const
 }
 
 template<typename T>
-static void ConvPlanar(std::vector<unsigned char> &input)
+static void ConvPlanar(char *input, size_t buf_size)
 {
-  size_t buf_size = input.size();
   gdcm_assert( buf_size % sizeof(T) == 0 );
   size_t npixels = buf_size / sizeof( T );
   gdcm_assert( npixels % 3 == 0 );
   size_t size = npixels / 3;
-  T* buffer = (T*)input.data();
+  T* buffer = (T*)input;
 
   const T *r = buffer;
   const T *g = buffer + size;
@@ -173,10 +174,66 @@ static void ConvPlanar(std::vector<unsigned char> &input)
     *(p++) = *(g++);
     *(p++) = *(b++);
     }
-  std::memcpy(input.data(), copy, input.size() );
+  std::memcpy(input, copy, buf_size );
   delete[] copy;
 }
 
+template<typename T>
+static void ConvPlanar(std::vector<unsigned char> &input)
+{
+  ConvPlanar<T>( (char*)input.data(), input.size() );
+}
+
+#ifdef GDCM_USE_JPEGLS
+// Decode a single JPEG-LS stream into out, which must be exactly the size of
+// the decoded frame.
+static bool DecodeFrameIntoBuffer(const char *in, size_t inlen, char *out, size_t outlen, bool &lossy)
+{
+  using namespace charls;
+  const unsigned char* pbyteCompressed = (const unsigned char*)in;
+  // skip trailing padding after EOI:
+  while( inlen > 0 && pbyteCompressed[inlen-1] != 0xd9 )
+    {
+    inlen--;
+    }
+  JlsParameters params = {};
+  if( JpegLsReadHeader(pbyteCompressed, inlen, &params, nullptr) != ApiResult::OK )
+    {
+    gdcmDebugMacro( "Could not parse JPEG-LS header" );
+    return false;
+    }
+  if( params.colorTransformation != charls::ColorTransformation::None )
+    {
+    gdcmWarningMacro( "APP8 marker found to contains a color transformation. This is an HP extension" );
+    }
+  const unsigned int nBytes = (params.bitsPerSample + 7) / 8;
+  const size_t framelen = (size_t)params.height * params.width * nBytes * params.components;
+  if( framelen != outlen )
+    {
+    gdcmDebugMacro( "JPEG-LS stream decodes to " << framelen << " bytes, expected " << outlen );
+    return false;
+    }
+  // allowedlossyerror == 0 => Lossless
+  lossy = params.allowedLossyError != 0;
+
+  if( JpegLsDecode(out, outlen, pbyteCompressed, inlen, &params, nullptr) != ApiResult::OK )
+    {
+    gdcmErrorMacro( "Could not decode JPEG-LS stream" );
+    return false;
+    }
+  if( params.components == 3 && params.interleaveMode == InterleaveMode::None )
+    {
+    if( nBytes == 1 )
+      ConvPlanar<unsigned char>(out, outlen);
+    else if( nBytes == 2 )
+      ConvPlanar<unsigned short>(out, outlen);
+    else
+      return false;
+    }
+  return true;
+}
+#endif
+
 bool JPEGLSCodec::DecodeByStreamsCommon(const char *buffer, size_t totalLen, std::vector<unsigned char> &rgbyteOut)
 {
   using namespace charls;
@@ -224,12 +281,88 @@ bool JPEGLSCodec::DecodeByStreamsCommon(const char *buffer, size_t totalLen, std
   return true;
 }
 
+bool JPEGLSCodec::DecodeToBuffer(DataElement const &in, char *buffer, size_t len)
+{
+#ifndef GDCM_USE_JPEGLS
+  (void)in; (void)buffer; (void)len;
+  return false;
+#else
+  const SequenceOfFragments *sf = in.GetSequenceOfFragments();
+  if( !sf || !buffer ) return false;
+  const unsigned int nframes = NumberOfDimensions == 3 ? Dimensions[2] : 1;
+  if( nframes == 0 || len % nframes != 0 ) return false;
+  const size_t framelen = len / nframes;
+
+  if( nframes == 1 )
+    {
+    bool lossy = false;
+    bool b;
+    if( sf->GetNumberOfFragments() == 1 )
+      {
+      // Hand CharLS the fragment bytes directly:
+      const ByteValue *bv = sf->GetFragment(0).GetByteValue();
+      if( !bv ) return false;
+      b = DecodeFrameIntoBuffer(bv->GetPointer(), bv->GetLength(), buffer, framelen, lossy);
+      }
+    else
+      {
+      // A frame spanning multiple fragments needs to be made contiguous:
+      std::vector<char> stream( sf->ComputeByteLength() );
+      if( stream.empty() || !sf->GetBuffer(stream.data(), stream.size()) ) return false;
+      b = DecodeFrameIntoBuffer(stream.data(), stream.size(), buffer, framelen, lossy);
+      }
+    if( b ) LossyFlag = lossy;
+    return b;
+    }
+
+  if( sf->GetNumberOfFragments() != nframes ) return false;
+  for( unsigned int i = 0; i < nframes; ++i )
+    {
+    const Fragment &frag = sf->GetFragment(i);
+    if( frag.IsEmpty() || !frag.GetByteValue() ) return false;
+    }
+
+  // Frames are independent, hand them out one at a time to the threads:
+  std::atomic<bool> anylossy( false );
+  const bool b = ParallelFor::Run( nframes, NumberOfThreads, [&](size_t i, unsigned int) {
+    const ByteValue *bv = sf->GetFragment(i).GetByteValue();
+    bool lossy = false;
+    if( !DecodeFrameIntoBuffer(bv->GetPointer(), bv->GetLength(),
+        buffer + i * framelen, framelen, lossy) )
+      {
+      return false;
+      }
+    if( lossy ) anylossy = true;
+    return true;
+  } );
+  if( !b ) return false;
+  LossyFlag = anylossy;
+  return true;
+#endif
+}
+
 bool JPEGLSCodec::Decode(DataElement const &in, DataElement &out)
 {
 #ifndef GDCM_USE_JPEGLS
   return false;
 #else
   using namespace charls;
+    {
+    // Fast path, decode straight into the final Pixel Data:
+    const size_t nframes = NumberOfDimensions == 3 ? Dimensions[2] : 1;
+    const size_t len = (size_t)Dimensions[0] * Dimensions[1] * nframes * PF.GetPixelSize();
+    if( len && len <= 0xfffffffe && in.GetSequenceOfFragments() )
+      {
+      SmartPointer<ByteValue> bv = new ByteValue( nullptr, (uint32_t)len );
+      if( DecodeToBuffer(in, (char*)bv->GetVoidPointer(), len) )
+        {
+        if( NumberOfDimensions == 2 ) out = in;
+        out.SetValue( *bv );
+        return true;
+        }
+      }
+    // else the codestream does not match the header, decode frame by frame
+    }
   if( NumberOfDimensions == 2 )
     {
     const SequenceOfFragments *sf = in.GetSequenceOfFragments();
@@ -296,6 +429,17 @@ bool JPEGLSCodec::Decode(DataElement const &in, DataElement &out)
         {
         return false;
         }
+      // pixel interleaved output, same as for a single frame:
+      if( params.components == 3 && params.interleaveMode == InterleaveMode::None )
+        {
+        const unsigned int nBytes = (params.bitsPerSample + 7) / 8;
+        if( nBytes == 1 )
+          ConvPlanar<unsigned char>(rgbyteOut);
+        else if( nBytes == 2 )
+          ConvPlanar<unsigned short>(rgbyteOut);
+        else
+          return false;
+        }
       os.write( (const char*)rgbyteOut.data(), rgbyteOut.size() );
 
       if(!r) return false;
@@ -594,6 +738,7 @@ bool JPEGLSCodec::DecodeExtent(
 ImageCodec * JPEGLSCodec::Clone() const
 {
   JPEGLSCodec * copy = new JPEGLSCodec;
+  copy->NumberOfThreads = NumberOfThreads;
   return copy;
 }
 
@@ -45,6 +45,17 @@ public:
               uint32_t inYMax, uint32_t inZMin, uint32_t inZMax);
   bool Code(DataElement const &in, DataElement &out) override;
 
+  /// Decode the encapsulated Pixel Data in directly into buffer (of len
+  /// bytes): each frame is decoded at its final offset, without intermediate
+  /// copies. Return false when the JPEG-LS streams do not decode to exactly
+  /// len bytes (e.g. header and codestream disagree), use Decode in this case.
+  bool DecodeToBuffer(DataElement const &in, char *buffer, size_t len);
+
+  /// Set the number of threads used to decode multi-frame objects (default:
+  /// 1). 0 means use the number of hardware threads.
+  void SetNumberOfThreads(unsigned int nthreads) { NumberOfThreads = nthreads; }
+  unsigned int GetNumberOfThreads() const { return NumberOfThreads; }
+
   bool GetHeaderInfo(std::istream &is, TransferSyntax &ts) override;
   ImageCodec * Clone() const override;
 
@@ -86,6 +97,7 @@ private:
 
   unsigned long BufferLength;
   int LossyError;
+  unsigned int NumberOfThreads;
 };
 
 } // end namespace gdcm
@@ -13,6 +13,7 @@
 =========================================================================*/
 #include "gdcmLookupTable.h"
 #include "gdcmSwapper.h"
+#include "gdcmInstrumentation.h"
 #include <vector>
 #include <set>
 #include <iomanip>
@@ -459,6 +460,7 @@ void LookupTable::Encode(std::istream &is, std::ostream &os)
 void LookupTable::Decode(std::istream &is, std::ostream &os) const
 {
   gdcm_assert( Initialized() );
+  InstrumentationTimer timer( Instrumentation::LookupTable );
   if ( BitSample == 8 )
     {
     unsigned char idx;
@@ -516,6 +518,8 @@ bool LookupTable::Decode(char *output, size_t outlen, const char *input, size_t
     gdcmDebugMacro( "Not Initialized" );
     return false;
     }
+  InstrumentationTimer timer( Instrumentation::LookupTable );
+  timer.SetBytes( inlen );
   if ( BitSample == 8 )
     {
     const unsigned char * end = (const unsigned char*)input + inlen;
@@ -572,6 +576,8 @@ bool LookupTable::Decode8(char *output, size_t outlen, const char *input, size_t
     gdcmDebugMacro( "Not Initialized" );
     return false;
     }
+  InstrumentationTimer timer( Instrumentation::LookupTable );
+  timer.SetBytes( inlen );
   if ( BitSample == 8 )
     {
     const unsigned char * end = (const unsigned char*)input + inlen;
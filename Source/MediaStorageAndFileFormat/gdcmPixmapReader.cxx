@@ -45,6 +45,16 @@ Pixmap& PixmapReader::GetPixmap()
   return *PixelData;
 }
 
+void PixmapReader::SetNumberOfThreads(unsigned int nthreads)
+{
+  PixelData->SetNumberOfThreads( nthreads );
+}
+
+unsigned int PixmapReader::GetNumberOfThreads() const
+{
+  return PixelData->GetNumberOfThreads();
+}
+
 //void PixmapReader::SetPixmap(Pixmap const &img)
 //{
 //  PixelData = img;
@@ -55,6 +55,11 @@ public:
   Pixmap& GetPixmap();
   //void SetPixamp(Pixmap const &pix);
 
+  /// Number of threads used to decode the frames, see
+  /// Bitmap::SetNumberOfThreads. Can be set before or after Read.
+  void SetNumberOfThreads(unsigned int nthreads);
+  unsigned int GetNumberOfThreads() const;
+
 protected:
   bool ReadImageInternal(MediaStorage const &ms, bool handlepixeldata = true);
   virtual bool ReadImage(MediaStorage const &ms);
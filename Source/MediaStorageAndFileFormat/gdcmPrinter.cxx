@@ -878,8 +878,8 @@ VR Printer::PrintDataElement(std::ostringstream &os, const Dicts &dicts, const D
 void Printer::PrintSQ(const SequenceOfItems *sqi, std::ostream & os, std::string const & indent)
 {
   if( !sqi ) return;
-  SequenceOfItems::ItemVector::const_iterator it = sqi->Items.begin();
-  for(; it != sqi->Items.end(); ++it)
+  SequenceOfItems::ItemVector::const_iterator it = sqi->Begin();
+  for(; it != sqi->End(); ++it)
     {
     const Item &item = *it;
     const DataSet &ds = item.GetNestedDataSet();
@@ -19,6 +19,7 @@
 #include "gdcmSequenceOfFragments.h"
 #include "gdcmSmartPointer.h"
 #include "gdcmSwapper.h"
+#include "gdcmParallelFor.h"
 
 #include <algorithm> // req C++11
 #include <cstddef> // ptrdiff_t fix
@@ -86,6 +87,7 @@ RLECodec::RLECodec()
   Internals = new RLEInternals;
   Length = 0;
   BufferLength = 0;
+  NumberOfThreads = 1;
 }
 
 RLECodec::~RLECodec()
@@ -263,6 +265,200 @@ ptrdiff_t rle_encode(char *output, size_t outputlength, const char *input, size_
   return pout - output;
 }
 
+// Same runs as rle_encode, but the run detection looks at 8 bytes at once
+// (SWAR: a 64 bits word holds 8 bytes) and the row is trusted to fit in out
+static inline uint64_t LoadRLEWord(const unsigned char *p)
+{
+  uint64_t w;
+  memcpy( &w, p, sizeof(w) );
+  return w;
+}
+
+static inline bool HasZeroByte(uint64_t x)
+{
+  return ((x - 0x0101010101010101ULL) & ~x & 0x8080808080808080ULL) != 0;
+}
+
+static inline size_t CountReplicateRun(const unsigned char *start, size_t len)
+{
+  const size_t cmin = std::min((size_t)128,len);
+  const uint64_t ref = 0x0101010101010101ULL * start[0];
+  size_t count = 1;
+  while( count + 8 <= cmin && LoadRLEWord(start + count) == ref )
+    {
+    count += 8;
+    }
+  while( count < cmin && start[count] == start[0] )
+    {
+    ++count;
+    }
+  return count;
+}
+
+static inline size_t CountLiteralRun(const unsigned char *start, size_t len)
+{
+  const size_t cmin = std::min((size_t)128,len);
+  size_t count = 1;
+  while( count < cmin )
+    {
+    // skip 8 bytes at a time as long as no two neighbours are equal:
+    if( count + 8 <= cmin
+      && !HasZeroByte( LoadRLEWord(start + count) ^ LoadRLEWord(start + count - 1) ) )
+      {
+      count += 8;
+      continue;
+      }
+    if( start[count] == start[count-1] )
+      {
+      // a 2-byte repeat in between two literal runs is merged:
+      if( count + 1 < cmin && start[count] != start[count+1] )
+        {
+        ++count;
+        continue;
+        }
+      --count;
+      break;
+      }
+    ++count;
+    }
+  return count;
+}
+
+// out must be able to hold 2 * len bytes
+static size_t EncodeRLERow(const unsigned char *in, size_t len, char *out)
+{
+  char *pout = out;
+  const unsigned char *pin = in;
+  const unsigned char *const pend = in + len;
+  while( pin != pend )
+    {
+    size_t count = CountReplicateRun(pin, (size_t)(pend - pin));
+    if( count > 1 )
+      {
+      *pout++ = (char)(1 - (int)count);
+      *pout++ = (char)*pin;
+      }
+    else
+      {
+      count = CountLiteralRun(pin, (size_t)(pend - pin));
+      *pout++ = (char)(count - 1);
+      memcpy( pout, pin, count );
+      pout += count;
+      }
+    pin += count;
+    }
+  return (size_t)(pout - out);
+}
+
+// Encode nframes frames (dims[0] x dims[1] pixels, bps bytes per sample) as
+// one RLE stream (header + segments) each. The work is split in bands of rows
+// of a byte plane, encoded by nthreads threads into their own buffer; the
+// streams are assembled once all the bands are done. The output does not
+// depend on the number of threads.
+static bool EncodeRLEFrames(const char *input, unsigned int nframes,
+  const unsigned int dims[2], unsigned int bps, unsigned int spp, bool planar,
+  unsigned int nthreads, std::vector< std::vector<char> > &frames)
+{
+  const unsigned int nsegments = bps * spp;
+  if( !nframes || !dims[0] || !dims[1] || nsegments > 15 ) return false;
+  const size_t npixels = (size_t)dims[0] * dims[1];
+  const size_t framelen = npixels * nsegments;
+
+  // a few bands per thread, for the load to be balanced:
+  const size_t nsegs = (size_t)nframes * nsegments;
+  nthreads = ParallelFor::GetNumberOfThreads( nthreads, nsegs * dims[1] );
+  size_t nbands = 1;
+  if( nthreads > 1 && nsegs < 4 * (size_t)nthreads )
+    {
+    nbands = std::min( (size_t)dims[1], (4 * (size_t)nthreads + nsegs - 1) / nsegs );
+    }
+  const size_t rowsperband = (dims[1] + nbands - 1) / nbands;
+  nbands = (dims[1] + rowsperband - 1) / rowsperband;
+  const size_t ntasks = nsegs * nbands;
+
+  std::vector< std::vector<char> > bands( ntasks );
+  // scratch buffers of each thread:
+  nthreads = ParallelFor::GetNumberOfThreads( nthreads, ntasks );
+  std::vector< std::vector<unsigned char> > planes( nthreads );
+  std::vector< std::vector<char> > scratches( nthreads );
+  ParallelFor::Run( ntasks, nthreads, [&](size_t task, unsigned int t) {
+    std::vector<unsigned char> &plane = planes[t];
+    std::vector<char> &scratch = scratches[t];
+    const size_t frame = task / (nsegments * nbands);
+    const unsigned int segment = (unsigned int)(task / nbands % nsegments);
+    const size_t y0 = task % nbands * rowsperband;
+    const size_t y1 = std::min( (size_t)dims[1], y0 + rowsperband );
+    const size_t first = y0 * dims[0];
+    const size_t count = (y1 - y0) * dims[0];
+    const char *ptr = input + frame * framelen;
+
+    // Segments are the bytes of each sample, most significant first:
+    const unsigned int s = segment / bps;
+    const unsigned int b = segment % bps;
+    const unsigned char *src;
+    if( bps == 1 && ( spp == 1 || planar ) )
+      {
+      src = (const unsigned char*)ptr + s * npixels + first;
+      }
+    else
+      {
+#ifdef GDCM_WORDS_BIGENDIAN
+      const unsigned int byte = b;
+#else
+      const unsigned int byte = bps - 1 - b;
+#endif
+      plane.resize( count );
+      const unsigned char *uptr = (const unsigned char*)ptr;
+      for( size_t p = 0; p < count; ++p )
+        {
+        const size_t index = planar ? s * npixels + first + p : (first + p) * spp + s;
+        plane[p] = uptr[index * bps + byte];
+        }
+      src = plane.data();
+      }
+
+    scratch.resize( 2 * count );
+    char *out = scratch.data();
+    for( size_t y = 0; y < y1 - y0; ++y )
+      {
+      // Each row is encoded separately:
+      out += EncodeRLERow( src + y * dims[0], dims[0], out );
+      }
+    bands[task].assign( scratch.data(), out );
+    return true;
+  } );
+
+  // Assemble header + segments:
+  frames.resize( nframes );
+  for( size_t frame = 0; frame < nframes; ++frame )
+    {
+    RLEHeader header = {};
+    header.NumSegments = nsegments;
+    size_t offset = 64;
+    for( unsigned int segment = 0; segment < nsegments; ++segment )
+      {
+      header.Offset[segment] = (uint32_t)offset;
+      for( size_t band = 0; band < nbands; ++band )
+        {
+        offset += bands[(frame * nsegments + segment) * nbands + band].size();
+        }
+      }
+    if( offset > 0xfffffffe ) return false;
+    std::vector<char> &stream = frames[frame];
+    stream.resize( offset );
+    memcpy( stream.data(), &header, sizeof(header) );
+    char *out = stream.data() + 64;
+    for( size_t band = 0; band < nsegments * nbands; ++band )
+      {
+      std::vector<char> &encoded = bands[frame * nsegments * nbands + band];
+      if( !encoded.empty() ) memcpy( out, encoded.data(), encoded.size() );
+      out += encoded.size();
+      std::vector<char>().swap( encoded );
+      }
+    }
+  return true;
+}
+
 template <typename T>
 bool DoInvertPlanarConfiguration(T *output, const T *input, uint32_t inputlength)
 {
@@ -305,6 +501,37 @@ bool DoInvertPlanarConfiguration(T *output, const T *input, uint32_t inputlength
 bool RLECodec::Code(DataElement const &in, DataElement &out)
 {
   const unsigned int *dims = this->GetDimensions();
+  const ByteValue *inbv = in.GetByteValue();
+  const unsigned int spp = GetPixelFormat().GetSamplesPerPixel();
+  const unsigned int ba = GetPixelFormat().GetBitsAllocated();
+  const bool color = PI == PhotometricInterpretation::RGB
+    || PI == PhotometricInterpretation::YBR_FULL
+    || PI == PhotometricInterpretation::YBR_RCT
+    || PI == PhotometricInterpretation::YBR_FULL_422;
+  // As below, one fragment per frame along dims[2]:
+  const unsigned int nframes = dims[2];
+  if( inbv && (ba == 8 || ba == 16 || ba == 32) && (spp == 3) == color
+    && (spp == 1 || spp == 3)
+    && (size_t)dims[0] * dims[1] * nframes * GetPixelFormat().GetPixelSize() <= inbv->GetLength() )
+    {
+    std::vector< std::vector<char> > frames;
+    if( !EncodeRLEFrames( inbv->GetPointer(), nframes, dims, ba / 8, spp,
+        spp == 3 && GetPlanarConfiguration() == 1, NumberOfThreads, frames ) )
+      {
+      gdcmErrorMacro( "RLE compressor error" );
+      return false;
+      }
+    SmartPointer<SequenceOfFragments> sq = new SequenceOfFragments;
+    for( size_t i = 0; i < frames.size(); ++i )
+      {
+      Fragment frag;
+      frag.SetByteValue( frames[i].data(), (VL::Type)frames[i].size() );
+      sq->AddFragment( frag );
+      std::vector<char>().swap( frames[i] );
+      }
+    out.SetValue( *sq );
+    return true;
+    }
   const unsigned int n = 256*256;
   char *outbuf;
   // At most we are encoding a single row at a time, so we would be very unlucky
@@ -559,6 +786,193 @@ bool RLECodec::Code(DataElement const &in, DataElement &out)
 // Endif
 // Endloop
 
+// Expand a PackBits segment into exactly outlen bytes. Runs are written 16
+// bytes at a time as long as the output has room for it (the extra bytes are
+// overwritten by the next runs). Any inconsistency (truncated stream, run
+// crossing the end of the segment) is reported, the stream decoder knows how
+// to deal with the broken encoders.
+static bool DecodeRLESegment(const char *in, size_t inlen, char *out, size_t outlen)
+{
+  const signed char *p = (const signed char*)in;
+  const signed char *const pend = p + inlen;
+  char *o = out;
+  char *const oend = out + outlen;
+  while( o != oend )
+    {
+    if( p == pend ) return false;
+    const int n = *p++;
+    if( n >= 0 )
+      {
+      // literal run of n+1 bytes:
+      const size_t count = (size_t)n + 1;
+      if( count > (size_t)(oend - o) || count > (size_t)(pend - p) ) return false;
+      if( (size_t)(oend - o) >= 128 && (size_t)(pend - p) >= 128 )
+        {
+        for( size_t i = 0; i < count; i += 16 ) memcpy( o + i, p + i, 16 );
+        }
+      else
+        {
+        memcpy( o, p, count );
+        }
+      o += count;
+      p += count;
+      }
+    else if( n != -128 )
+      {
+      // replicate run, next byte 1-n times:
+      const size_t count = (size_t)(1 - n);
+      if( count > (size_t)(oend - o) || p == pend ) return false;
+      if( (size_t)(oend - o) >= 128 )
+        {
+        char pattern[16];
+        memset( pattern, *p, sizeof(pattern) );
+        for( size_t i = 0; i < count; i += 16 ) memcpy( o + i, pattern, 16 );
+        }
+      else
+        {
+        memset( o, *p, count );
+        }
+      o += count;
+      ++p;
+      }
+    // else -128: no-op
+    }
+  return true;
+}
+
+// Interleave the byte planes of a frame (one plane per byte of each sample,
+// most significant byte first) into native pixels, in a single pass
+template <typename T>
+static void InterleaveRLEPlanes(const unsigned char *planes, size_t npixels,
+  unsigned int spp, bool planar, char *out)
+{
+  const unsigned int bps = sizeof(T);
+  for( size_t p = 0; p < npixels; ++p )
+    {
+    for( unsigned int s = 0; s < spp; ++s )
+      {
+      const unsigned char *plane = planes + (size_t)s * bps * npixels + p;
+      T v = 0;
+      for( unsigned int b = 0; b < bps; ++b )
+        {
+        v = (T)((v << 8) | plane[b * npixels]);
+        }
+      const size_t index = planar ? s * npixels + p : p * spp + s;
+      memcpy( out + index * bps, &v, bps );
+      }
+    }
+}
+
+// Decode one RLE frame (header and segments) into out. The segments are
+// decoded by up to nthreads threads, planes is the scratch buffer for the
+// byte planes when they need to be interleaved.
+static bool DecodeRLEFrame(const char *in, size_t inlen, char *out, size_t outlen,
+  unsigned int bps, unsigned int spp, bool planar, unsigned int nthreads,
+  std::vector<char> &planes)
+{
+  if( inlen < 64 ) return false;
+  RLEHeader header;
+  memcpy( &header, in, sizeof(header) );
+  SwapperNoOp::SwapArray((uint32_t*)&header,16);
+  const unsigned int nsegments = bps * spp;
+  if( header.NumSegments != nsegments || header.Offset[0] != 64 ) return false;
+  const size_t npixels = outlen / nsegments;
+  if( npixels * nsegments != outlen ) return false;
+  for( unsigned int i = 0; i < nsegments; ++i )
+    {
+    if( header.Offset[i] >= inlen ) return false;
+    }
+
+  // Byte planes are the final layout of 8 bits planar data:
+  const bool inplace = bps == 1 && ( spp == 1 || planar );
+  char *dest = out;
+  if( !inplace )
+    {
+    planes.resize( outlen );
+    dest = planes.data();
+    }
+  const bool b = ParallelFor::Run( nsegments, nthreads, [&](size_t i, unsigned int) {
+    // the segment may run past the next offset (odd padding):
+    return DecodeRLESegment( in + header.Offset[i], inlen - header.Offset[i],
+      dest + i * npixels, npixels );
+  } );
+  if( !b ) return false;
+
+  if( inplace ) return true;
+  const unsigned char *uplanes = (const unsigned char*)planes.data();
+  switch( bps )
+    {
+  case 1:
+    InterleaveRLEPlanes<uint8_t>( uplanes, npixels, spp, planar, out );
+    break;
+  case 2:
+    InterleaveRLEPlanes<uint16_t>( uplanes, npixels, spp, planar, out );
+    break;
+  case 4:
+    InterleaveRLEPlanes<uint32_t>( uplanes, npixels, spp, planar, out );
+    break;
+  default:
+    return false;
+    }
+  return true;
+}
+
+bool RLECodec::DecodeToBuffer(DataElement const &in, char *buffer, size_t len)
+{
+  const SequenceOfFragments *sf = in.GetSequenceOfFragments();
+  if( !sf || !buffer ) return false;
+  // Only the plain cases, anything else goes through DecodeByStreams:
+  const PixelFormat &pf = GetPixelFormat();
+  const unsigned int spp = pf.GetSamplesPerPixel();
+  const unsigned int ba = pf.GetBitsAllocated();
+  if( (spp != 1 && spp != 3) || (ba != 8 && ba != 16 && ba != 32) ) return false;
+  if( NeedByteSwap
+    || PI == PhotometricInterpretation::YBR_FULL_422
+    || PI == PhotometricInterpretation::YBR_PARTIAL_422 ) return false;
+  if( ba != pf.GetBitsStored() && ba != 8 && NeedOverlayCleanup ) return false;
+  const bool planar = spp == 3 && PlanarConfiguration == 1;
+
+  const unsigned int nframes = NumberOfDimensions == 3 ? Dimensions[2] : 1;
+  if( nframes == 0 || len % nframes != 0 ) return false;
+  const size_t framelen = len / nframes;
+  if( framelen != (size_t)Dimensions[0] * Dimensions[1] * pf.GetPixelSize() ) return false;
+
+  std::vector<char> planes;
+  if( nframes == 1 )
+    {
+    // Threads are only worth starting for large frames:
+    const unsigned int nsegthreads = framelen >= (1u << 18) ? NumberOfThreads : 1;
+    if( sf->GetNumberOfFragments() == 1 )
+      {
+      const ByteValue *bv = sf->GetFragment(0).GetByteValue();
+      if( !bv ) return false;
+      return DecodeRLEFrame( bv->GetPointer(), bv->GetLength(), buffer, framelen,
+        ba / 8, spp, planar, nsegthreads, planes );
+      }
+    // A frame spanning multiple fragments needs to be made contiguous:
+    std::vector<char> stream( sf->ComputeByteLength() );
+    if( stream.empty() || !sf->GetBuffer(stream.data(), (unsigned long)stream.size()) ) return false;
+    return DecodeRLEFrame( stream.data(), stream.size(), buffer, framelen,
+      ba / 8, spp, planar, nsegthreads, planes );
+    }
+
+  if( sf->GetNumberOfFragments() != nframes ) return false;
+  for( unsigned int i = 0; i < nframes; ++i )
+    {
+    const Fragment &frag = sf->GetFragment(i);
+    if( frag.IsEmpty() || !frag.GetByteValue() ) return false;
+    }
+
+  // Frames are independent, hand them out one at a time to the threads:
+  const unsigned int nthreads = ParallelFor::GetNumberOfThreads( NumberOfThreads, nframes );
+  std::vector< std::vector<char> > scratches( nthreads );
+  return ParallelFor::Run( nframes, nthreads, [&](size_t i, unsigned int t) {
+    const ByteValue *bv = sf->GetFragment(i).GetByteValue();
+    return DecodeRLEFrame( bv->GetPointer(), bv->GetLength(), buffer + i * framelen,
+      framelen, ba / 8, spp, planar, 1, scratches[t] );
+  } );
+}
+
 size_t RLECodec::DecodeFragment(Fragment const & frag, char *buffer, size_t llen)
 {
 
@@ -604,6 +1018,22 @@ size_t RLECodec::DecodeFragment(Fragment const & frag, char *buffer, size_t llen
 
 bool RLECodec::Decode(DataElement const &in, DataElement &out)
 {
+    {
+    // Fast path, decode straight into the final Pixel Data:
+    const size_t nframes = NumberOfDimensions == 3 ? Dimensions[2] : 1;
+    const size_t len = (size_t)Dimensions[0] * Dimensions[1] * nframes * PF.GetPixelSize();
+    if( len && len <= 0xfffffffe && in.GetSequenceOfFragments() )
+      {
+      SmartPointer<ByteValue> bv = new ByteValue( nullptr, (uint32_t)len );
+      if( DecodeToBuffer(in, (char*)bv->GetVoidPointer(), len) )
+        {
+        if( NumberOfDimensions == 2 ) out = in;
+        out.SetValue( *bv );
+        return true;
+        }
+      }
+    // else use the stream decoder, which deals with the broken encoders
+    }
   if( NumberOfDimensions == 2 )
     {
     out = in;
@@ -885,7 +1315,9 @@ bool RLECodec::GetHeaderInfo(std::istream &is, TransferSyntax &ts)
 
 ImageCodec * RLECodec::Clone() const
 {
-  return new RLECodec;
+  RLECodec * copy = new RLECodec;
+  copy->NumberOfThreads = NumberOfThreads;
+  return copy;
 }
 
 bool RLECodec::StartEncode( std::ostream & )
@@ -973,8 +1405,24 @@ private:
 
 bool RLECodec::AppendFrameEncode( std::ostream & out, const char * data, size_t datalen )
 {
-  try {
   const PixelFormat & pf = this->GetPixelFormat();
+  const unsigned int ba = pf.GetBitsAllocated();
+  const unsigned int spp = pf.GetSamplesPerPixel();
+  if( !GetNeedByteSwap() && (ba == 8 || ba == 16 || ba == 32) && (spp == 1 || spp == 3)
+    && (size_t)Dimensions[0] * Dimensions[1] * pf.GetPixelSize() == datalen )
+    {
+    std::vector< std::vector<char> > frames;
+    if( !EncodeRLEFrames( data, 1, Dimensions, ba / 8, spp,
+        spp == 3 && GetPlanarConfiguration() == 1, NumberOfThreads, frames ) )
+      {
+      gdcmErrorMacro( "could not encode frame" );
+      return false;
+      }
+    out.write( frames[0].data(), (std::streamsize)frames[0].size() );
+    return !out.fail();
+    }
+
+  try {
   unsigned int pc = this->GetPlanarConfiguration();
   bool isLittleEndian = !this->GetNeedByteSwap();
   rle::pixel_info pi((unsigned char)pf.GetSamplesPerPixel(), (unsigned char)(pf.GetBitsAllocated()));
@@ -45,6 +45,19 @@ public:
   unsigned long GetBufferLength() const { return BufferLength; }
   void SetBufferLength(unsigned long l) { BufferLength = l; }
 
+  /// Decode the encapsulated Pixel Data directly into buffer (of len bytes):
+  /// the segments are expanded from the fragment bytes and interleaved at
+  /// their final offset. Return false when the fragments are not plain RLE
+  /// frames of len bytes (or need a conversion, eg. overlay cleanup), use
+  /// Decode in this case.
+  bool DecodeToBuffer(DataElement const &in, char *buffer, size_t len);
+
+  /// Set the number of threads used to encode and decode the frames (or the
+  /// segments of a single large frame), 1 by default. 0 means use the number
+  /// of hardware threads. The encoded stream does not depend on it.
+  void SetNumberOfThreads(unsigned int nthreads) { NumberOfThreads = nthreads; }
+  unsigned int GetNumberOfThreads() const { return NumberOfThreads; }
+
   bool Code(DataElement const &in, DataElement &out) override;
   bool GetHeaderInfo(std::istream &is, TransferSyntax &ts) override;
   ImageCodec * Clone() const override;
@@ -79,6 +92,7 @@ private:
   RLEInternals *Internals;
   unsigned long Length;
   unsigned long BufferLength;
+  unsigned int NumberOfThreads;
   size_t DecodeFragment(Fragment const & frag, char *buffer, size_t llen);
 };
 
@@ -12,6 +12,7 @@
 
 =========================================================================*/
 #include "gdcmRescaler.h"
+#include "gdcmInstrumentation.h"
 #include <algorithm> // std::max
 #include <cmath> // std::lround
 #include <cstdlib> // abort
@@ -303,6 +304,8 @@ void Rescaler::InverseRescaleFunctionIntoBestFit(char *out8, const TIn *in, size
 
 bool Rescaler::InverseRescale(char *out, const char *in8, size_t n)
 {
+  InstrumentationTimer timer( Instrumentation::Rescale );
+  timer.SetBytes( n );
   bool fastpath = true;
   const void* in = in8;
   switch(PF)
@@ -366,6 +369,8 @@ bool Rescaler::InverseRescale(char *out, const char *in8, size_t n)
 
 bool Rescaler::Rescale(char *out, const char *in8, size_t n)
 {
+  InstrumentationTimer timer( Instrumentation::Rescale );
+  timer.SetBytes( n );
   const void *in = in8;
   if( UseTargetPixelType == false )
     {
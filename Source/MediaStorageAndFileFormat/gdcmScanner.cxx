@@ -20,8 +20,10 @@
 #include "gdcmStringFilter.h"
 #include "gdcmProgressEvent.h"
 #include "gdcmFileNameEvent.h"
+#include "gdcmParallelFor.h"
 
 #include <algorithm> // std::find
+#include <vector>
 
 namespace gdcm
 {
@@ -92,6 +94,32 @@ void Scanner::AddTag( Tag const & t )
     }
 }
 
+// Read all tags up to 'last' (included). Return nullptr when the file could not be read.
+// Can be called from multiple threads.
+static SmartPointer<File> ReadFile( const char *filename, Tag const & last, std::set<Tag> const & skiptags )
+{
+  gdcm_assert( filename );
+  Reader reader;
+  reader.SetFileName( filename );
+  bool read = false;
+  try
+    {
+    // Start reading all tags, including the 'last' one:
+    read = reader.ReadUpToTag(last, skiptags);
+    }
+  catch(std::exception & ex)
+    {
+    (void)ex;
+    gdcmWarningMacro( "Failed to read:" << filename << " with ex:" << ex.what() );
+    }
+  catch(...)
+    {
+    gdcmWarningMacro( "Failed to read:" << filename  << " with unknown error" );
+    }
+  if( !read ) return nullptr;
+  return &reader.GetFile();
+}
+
 bool Scanner::Scan( Directory::FilenamesType const & filenames )
 {
   this->InvokeEvent( StartEvent() );
@@ -109,60 +137,59 @@ bool Scanner::Scan( Directory::FilenamesType const & filenames )
     Filenames = filenames;
 
     // Find the tag with the highest value (get the one from the end of the std::set)
-    Tag last;
+    Tag lastTag;
     if( !Tags.empty() )
       {
       TagsType::const_reverse_iterator it1 = Tags.rbegin();
       const Tag & publiclast = *it1;
-      last = publiclast;
+      lastTag = publiclast;
       }
     if( !PrivateTags.empty() )
       {
       PrivateTagsType::const_reverse_iterator pit1 = PrivateTags.rbegin();
       Tag privatelast = *pit1;
-      if( last < privatelast ) last = privatelast;
+      if( lastTag < privatelast ) lastTag = privatelast;
       }
 
+    const unsigned int nthreads = ParallelFor::GetNumberOfThreads( NumberOfThreads, Filenames.size() );
+
     StringFilter sf;
-    Directory::FilenamesType::const_iterator it = Filenames.begin();
     const double progresstick = 1. / (double)Filenames.size();
     Progress = 0;
-    for(; it != Filenames.end(); ++it)
+    // Files are read by blocks, so that memory stays bounded no matter the
+    // number of input files:
+    const size_t blocksize = nthreads > 1 ? 64 * (size_t)nthreads : 1;
+    std::vector< SmartPointer<File> > files;
+    for( size_t first = 0; first < Filenames.size(); first += blocksize )
       {
-      Reader reader;
-      const char *filename = it->c_str();
-      gdcm_assert( filename );
-      reader.SetFileName( filename );
-      bool read = false;
-      try
-        {
-        // Start reading all tags, including the 'last' one:
-        read = reader.ReadUpToTag(last, SkipTags);
-        }
-      catch(std::exception & ex)
-        {
-        (void)ex;
-        gdcmWarningMacro( "Failed to read:" << filename << " with ex:" << ex.what() );
-        }
-      catch(...)
-        {
-        gdcmWarningMacro( "Failed to read:" << filename  << " with unknown error" );
-        }
-      if( read )
+      const size_t last = std::min( first + blocksize, Filenames.size() );
+      files.assign( last - first, SmartPointer<File>() );
+      ParallelFor::Run( last - first, nthreads, [&](size_t i, unsigned int) {
+        files[i] = ReadFile( Filenames[first + i].c_str(), lastTag, SkipTags );
+        return true;
+      } );
+
+      // Merge results in order:
+      for( size_t i = first; i < last; ++i )
         {
-        // Keep the mapping:
-        sf.SetFile( reader.GetFile() );
-        Scanner::ProcessPublicTag(sf, filename);
-        //Scanner::ProcessPrivateTag(sf, filename);
+        const char *filename = Filenames[i].c_str();
+        if( files[i - first] )
+          {
+          // Keep the mapping:
+          sf.SetFile( *files[i - first] );
+          Scanner::ProcessPublicTag(sf, filename);
+          //Scanner::ProcessPrivateTag(sf, filename);
+          files[i - first] = nullptr;
+          }
+        // Update progress
+        Progress += progresstick;
+        ProgressEvent pe;
+        pe.SetProgress( Progress );
+        this->InvokeEvent( pe );
+        // For outside application tell which file is being processed:
+        FileNameEvent fe( filename );
+        this->InvokeEvent( fe );
         }
-      // Update progress
-      Progress += progresstick;
-      ProgressEvent pe;
-      pe.SetProgress( Progress );
-      this->InvokeEvent( pe );
-      // For outside application tell which file is being processed:
-      FileNameEvent fe( filename );
-      this->InvokeEvent( fe );
       }
     }
 
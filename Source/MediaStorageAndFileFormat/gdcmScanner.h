@@ -56,7 +56,7 @@ class GDCM_EXPORT Scanner : public Subject
 {
   friend std::ostream& operator<<(std::ostream &_os, const Scanner &s);
 public:
-  Scanner():Values(),Filenames(),Mappings(),Progress(0.0) {}
+  Scanner():Values(),Filenames(),Mappings(),Progress(0.0),NumberOfThreads(1) {}
   ~Scanner() override;
 
   /// struct to map a filename to a value
@@ -81,6 +81,13 @@ public:
   void AddSkipTag( Tag const & t );
   void ClearSkipTags();
 
+  /// Set/Get the number of threads used to read the files (default: 1).
+  /// 0 means use the number of hardware threads. Files are read in parallel,
+  /// while the results are still merged (and events invoked) in the order of
+  /// the input filenames, from the calling thread.
+  void SetNumberOfThreads( unsigned int nthreads ) { NumberOfThreads = nthreads; }
+  unsigned int GetNumberOfThreads() const { return NumberOfThreads; }
+
   /// Start the scan !
   bool Scan( Directory::FilenamesType const & filenames );
 
@@ -172,6 +179,7 @@ private:
   MappingType Mappings;
 
   double Progress;
+  unsigned int NumberOfThreads;
 };
 //-----------------------------------------------------------------------------
 inline std::ostream& operator<<(std::ostream &os, const Scanner &s)
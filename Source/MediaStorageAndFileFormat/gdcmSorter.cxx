@@ -16,6 +16,7 @@
 #include "gdcmSerieHelper.h"
 #include "gdcmFile.h"
 #include "gdcmReader.h"
+#include "gdcmParallelFor.h"
 
 #include <map>
 #include <algorithm>
@@ -28,6 +29,9 @@ Sorter::Sorter()
 {
   SortFunc = nullptr;
   TagsToRead = std::set<Tag>();
+  KeyFunc = nullptr;
+  KeyUserData = nullptr;
+  NumberOfThreads = 1;
 }
 
 Sorter::~Sorter()
@@ -43,6 +47,80 @@ void Sorter::SetSortFunction( SortFunction f )
   SortFunc = f;
 }
 
+void Sorter::SetKeyFunction( KeyFunction f, void *userdata )
+{
+  KeyFunc = f;
+  KeyUserData = userdata;
+}
+
+namespace {
+typedef std::pair<SortKey,size_t> IndexedKey;
+struct IndexedKeyLess
+{
+  bool operator() (IndexedKey const &k1, IndexedKey const &k2) const
+    {
+    return k1.first < k2.first;
+    }
+};
+}
+
+bool Sorter::SortKeys(std::vector<std::string> const & filenames, bool stable)
+{
+  const size_t n = filenames.size();
+  // Only what the key function needs is read, never the Pixel Data:
+  const Tag pixeldata(0x7fe0,0x0010);
+  std::set<Tag> skiptags;
+  skiptags.insert( pixeldata );
+
+  std::vector<IndexedKey> keys( n );
+  // 0: not read, 1: key extracted, 2: unreadable, 3: no key
+  std::vector<char> status( n, 0 );
+  ParallelFor::Run( n, NumberOfThreads, [&](size_t i, unsigned int) {
+    Reader reader;
+    reader.SetFileName( filenames[i].c_str() );
+    const bool read = TagsToRead.empty()
+      ? reader.ReadUpToTag( pixeldata, skiptags )
+      : reader.ReadSelectedTags( TagsToRead );
+    if( !read )
+      status[i] = 2;
+    else if( !KeyFunc( reader.GetFile().GetDataSet(), keys[i].first, KeyUserData ) )
+      status[i] = 3;
+    else
+      status[i] = 1;
+    keys[i].second = i;
+    return status[i] == 1;
+  } );
+
+  for( size_t i = 0; i < n; ++i )
+    {
+    if( status[i] == 2 )
+      {
+      gdcmErrorMacro( "File could not be read: " << filenames[i].c_str() );
+      return false;
+      }
+    if( status[i] == 3 )
+      {
+      gdcmErrorMacro( "No sort key for: " << filenames[i].c_str() );
+      return false;
+      }
+    }
+
+  if( stable )
+    std::stable_sort( keys.begin(), keys.end(), IndexedKeyLess() );
+  else
+    std::sort( keys.begin(), keys.end(), IndexedKeyLess() );
+
+  // filenames could be Filenames itself:
+  std::vector<std::string> sorted;
+  sorted.reserve( n );
+  for( std::vector<IndexedKey>::const_iterator it = keys.begin(); it != keys.end(); ++it )
+    {
+    sorted.push_back( filenames[it->second] );
+    }
+  Filenames.swap( sorted );
+  return true;
+}
+
 
 namespace {
 class SortFunctor
@@ -72,6 +150,10 @@ bool Sorter::StableSort(std::vector<std::string> const & filenames)
 {
   // BUG: I cannot clear Filenames since input filenames could also be the output of ourself...
   // Filenames.clear();
+  if( !filenames.empty() && KeyFunc )
+    {
+    return SortKeys( filenames, true );
+    }
   if( filenames.empty() || !SortFunc )
     {
     Filenames.clear();
@@ -118,6 +200,10 @@ bool Sorter::StableSort(std::vector<std::string> const & filenames)
 bool Sorter::Sort(std::vector<std::string> const & filenames)
 {
   (void)filenames;
+  if( !filenames.empty() && KeyFunc )
+    {
+    return SortKeys( filenames, false );
+    }
   Filenames.clear();
 
   if( filenames.empty() || !SortFunc ) return true;
@@ -26,11 +26,40 @@ namespace gdcm
 {
 class DataSet;
 
+/**
+ * \brief SortKey
+ * \details Compact sort key of a file, as extracted by a Sorter::KeyFunction:
+ * a tuple of numbers and strings, compared lexicographically.
+ */
+class GDCM_EXPORT SortKey
+{
+public:
+  void Clear() { Components.clear(); }
+
+  /// Append a number (eg. Instance Number, position along the normal)
+  void Append(double value) { Components.push_back( Component( value, std::string() ) ); }
+  /// Append a string (eg. Series Instance UID)
+  void Append(std::string const & value) { Components.push_back( Component( 0., value ) ); }
+
+  size_t GetNumberOfComponents() const { return Components.size(); }
+
+  bool operator<(SortKey const & key) const { return Components < key.Components; }
+
+private:
+  typedef std::pair<double,std::string> Component;
+  std::vector<Component> Components;
+};
+
 /**
  * \brief Sorter
  * \details General class to do sorting using a custom function
  * You simply need to provide a function of type: Sorter::SortFunction
  *
+ * Alternatively a function of type Sorter::KeyFunction extracts a SortKey
+ * from each file. Files are then read only once, without their Pixel Data
+ * (or only the tags given to SetTagsToRead), possibly in parallel (see
+ * SetNumberOfThreads), and only the keys are kept in memory while sorting.
+ *
  * \warning implementation details. For now there is no cache mechanism. Which means
  * that every time you call Sort, all files specified as input parameter are *read*
  *
@@ -58,13 +87,28 @@ public:
 
   /// Specify a set of tags to be read in during the sort procedure.
   /// By default this set is empty, in which case the entire image,
-  /// including pixel data, is read in.
+  /// including pixel data, is read in (everything but the pixel data
+  /// when a key function is set).
   void SetTagsToRead( std::set<Tag> const & tags );
 
   /// Set the sort function which compares one dataset to the other
   typedef bool (*SortFunction)(DataSet const &, DataSet const &);
   void SetSortFunction( SortFunction f );
 
+  /// Set the function which extracts the sort key of a dataset. When set,
+  /// it is used instead of the sort function. It should return false when
+  /// the key cannot be computed (the sort then fails). userdata is passed
+  /// as is to every call, for the function to carry its own parameters.
+  /// \warning the function is called concurrently when more than one
+  /// thread is used
+  typedef bool (*KeyFunction)(DataSet const &, SortKey &, void *userdata);
+  void SetKeyFunction( KeyFunction f, void *userdata = nullptr );
+
+  /// Number of threads reading the files when a key function is set.
+  /// Default is 1, 0 means one per core.
+  void SetNumberOfThreads( unsigned int nthreads ) { NumberOfThreads = nthreads; }
+  unsigned int GetNumberOfThreads() const { return NumberOfThreads; }
+
   virtual bool StableSort(std::vector<std::string> const & filenames);
 
 protected:
@@ -73,6 +117,12 @@ protected:
   std::map<Tag,std::string> Selection;
   SortFunction SortFunc;
   std::set<Tag> TagsToRead;
+  KeyFunction KeyFunc;
+  void *KeyUserData;
+  unsigned int NumberOfThreads;
+
+private:
+  bool SortKeys(std::vector<std::string> const & filenames, bool stable);
 };
 //-----------------------------------------------------------------------------
 inline std::ostream& operator<<(std::ostream &os, const Sorter &s)
@@ -19,56 +19,47 @@
 #include "gdcmEquipmentManufacturer.h"
 
 #include <cmath>
+#include <cstring> // memcpy
 
 namespace gdcm
 {
-SplitMosaicFilter::SplitMosaicFilter():F(new File),I(new Image) {}
+SplitMosaicFilter::SplitMosaicFilter():F(new File),I(new Image),HasSliceArray(false) {}
 SplitMosaicFilter::~SplitMosaicFilter() = default;
 
-namespace details {
 /*
  *  gdcmDataExtra/gdcmSampleData/images_of_interest/MR-sonata-3D-as-Tile.dcm
  */
-static bool reorganize_mosaic(const unsigned short *input, const unsigned int *inputdims,
-  unsigned int square, const unsigned int *outputdims, unsigned short *output )
+bool SplitMosaicFilter::ExtractTile(const char *input, const unsigned int inputdims[2],
+  const unsigned int dims[3], unsigned int pixelsize, unsigned int z, char *output)
 {
-  for(unsigned int z = 0; z < outputdims[2]; ++z)
+  if( !input || !output || !dims[2] || z >= dims[2] ) return false;
+  const unsigned int square = (unsigned int)ceil(sqrt( (double)dims[2] ) );
+  const unsigned int x0 = (z % square) * dims[0];
+  const unsigned int y0 = (z / square) * dims[1];
+  if( x0 + dims[0] > inputdims[0] || y0 + dims[1] > inputdims[1] ) return false;
+  const size_t rowlen = (size_t)dims[0] * pixelsize;
+  const size_t inputrowlen = (size_t)inputdims[0] * pixelsize;
+  const char *in = input + (size_t)y0 * inputrowlen + (size_t)x0 * pixelsize;
+  for(unsigned int y = 0; y < dims[1]; ++y)
     {
-    for(unsigned int y = 0; y < outputdims[1]; ++y)
-      {
-      for(unsigned int x = 0; x < outputdims[0]; ++x)
-        {
-        const size_t outputidx = x + y*outputdims[0] + z*outputdims[0]*outputdims[1];
-        const size_t inputidx = (x + (z%square)*outputdims[0]) +
-          (y + (z/square)*outputdims[1])*inputdims[0];
-        output[ outputidx ] = input[ inputidx ];
-        }
-      }
+    memcpy( output + y * rowlen, in + y * inputrowlen, rowlen );
     }
   return true;
 }
 
-static bool reorganize_mosaic_invert(const unsigned short *input, const unsigned int *inputdims,
-  unsigned int square, const unsigned int *outputdims, unsigned short *output )
+bool SplitMosaicFilter::ReorganizeMosaic(const char *input, const unsigned int inputdims[2],
+  const unsigned int dims[3], unsigned int pixelsize, bool inverted, char *output)
 {
-  for(unsigned int z = 0; z < outputdims[2]; ++z)
+  const size_t slicelen = (size_t)dims[0] * dims[1] * pixelsize;
+  for(unsigned int z = 0; z < dims[2]; ++z)
     {
-    for(unsigned int y = 0; y < outputdims[1]; ++y)
-      {
-      for(unsigned int x = 0; x < outputdims[0]; ++x)
-        {
-        const size_t outputidx = x + y*outputdims[0] + (outputdims[2]-1-z)*outputdims[0]*outputdims[1];
-        const size_t inputidx = (x + (z%square)*outputdims[0]) +
-          (y + (z/square)*outputdims[1])*inputdims[0];
-        output[ outputidx ] = input[ inputidx ];
-        }
-      }
+    const unsigned int slice = inverted ? dims[2] - 1 - z : z;
+    if( !ExtractTile( input, inputdims, dims, pixelsize, z, output + slice * slicelen ) )
+      return false;
     }
   return true;
 }
 
-}
-
 void SplitMosaicFilter::SetImage(const Image& image)
 {
   I = image;
@@ -338,8 +329,6 @@ bool SplitMosaicFilter::ComputeMOSAICImagePositionPatient( double ret[3],
     const unsigned int image_dims[3] ,
     const unsigned int mosaic_dims[3] , bool inverted)
 {
-  CSAHeader csa;
-  DataSet& ds = GetFile().GetDataSet();
   DirectionCosines dc( dircos );
   dc.Normalize();
   double z[3]={};
@@ -352,21 +341,20 @@ bool SplitMosaicFilter::ComputeMOSAICImagePositionPatient( double ret[3],
 
   double ipp_csa[3] = {};
   bool hasIppCsa = false;
-  MrProtocol mrprot;
+  const MrProtocol::SliceArray *psa = GetMrProtocolSliceArray();
   // https://www.nmr.mgh.harvard.edu/~greve/dicom-unpack
-  if( csa.GetMrProtocol(ds, mrprot) ) 
+  if( psa )
   {
-    MrProtocol::SliceArray sa;
-    bool b = mrprot.GetSliceArray(sa);
-    if( b ) {
+    const MrProtocol::SliceArray &sa = *psa;
+    {
       size_t size = sa.Slices.size();
       if( size ) {
         // two cases:
         if( size == mosaic_dims[2] ) {
           // all mosaic have there own slice position, always pick the first one for computation:
           size_t index = 0;
-          MrProtocol::Slice & slice = sa.Slices[index];
-          MrProtocol::Vector3 & p = slice.Position;
+          const MrProtocol::Slice & slice = sa.Slices[index];
+          const MrProtocol::Vector3 & p = slice.Position;
           double pos[3];
           pos[0] = p.dSag;
           pos[1] = p.dCor;
@@ -382,8 +370,8 @@ bool SplitMosaicFilter::ComputeMOSAICImagePositionPatient( double ret[3],
         } else if( size == 1 /*&& mosaic_dims[2] % 2 == 0*/) {
           // there is a single SliceArray but multiple mosaics, assume this is exactly the center one
           size_t index = 0;
-          MrProtocol::Slice & slice = sa.Slices[index];
-          MrProtocol::Vector3 & p = slice.Position;
+          const MrProtocol::Slice & slice = sa.Slices[index];
+          const MrProtocol::Vector3 & p = slice.Position;
           double pos[3];
           pos[0] = p.dSag;
           pos[1] = p.dCor;
@@ -431,24 +419,37 @@ bool SplitMosaicFilter::ComputeMOSAICImagePositionPatient( double ret[3],
   return true;
 }
 
-bool SplitMosaicFilter::ComputeMOSAICSlicePosition( double pos[3], bool )
+const MrProtocol::SliceArray *SplitMosaicFilter::GetMrProtocolSliceArray()
 {
-  CSAHeader csa;
   DataSet& ds = GetFile().GetDataSet();
+  const DataElement &csaEl = ComputeCSASeriesHeaderInfo( ds );
+  const ByteValue *bv = csaEl.GetByteValue();
+  if( !bv || !bv->GetLength() ) return nullptr;
+  // Parse the MrProtocol only when the CSA Series Header changed:
+  if( CSASeriesHeader.size() != bv->GetLength()
+    || memcmp( CSASeriesHeader.data(), bv->GetPointer(), bv->GetLength() ) != 0 )
+    {
+    CSASeriesHeader.assign( bv->GetPointer(), bv->GetLength() );
+    SliceArray.Slices.clear();
+    CSAHeader csa;
+    MrProtocol mrprot;
+    HasSliceArray = csa.GetMrProtocol(ds, mrprot) && mrprot.GetSliceArray(SliceArray);
+    }
+  return HasSliceArray ? &SliceArray : nullptr;
+}
 
-  MrProtocol mrprot;
-  if( !csa.GetMrProtocol(ds, mrprot) ) return false;
-
-  MrProtocol::SliceArray sa;
-  bool b = mrprot.GetSliceArray(sa);
-  if( !b ) return false;
+bool SplitMosaicFilter::ComputeMOSAICSlicePosition( double pos[3], bool )
+{
+  const MrProtocol::SliceArray *psa = GetMrProtocolSliceArray();
+  if( !psa ) return false;
+  const MrProtocol::SliceArray &sa = *psa;
 
   size_t size = sa.Slices.size();
   if( !size ) return false;
 
   size_t index = 0;
-  MrProtocol::Slice & slice = sa.Slices[index];
-  MrProtocol::Vector3 & p = slice.Position;
+  const MrProtocol::Slice & slice = sa.Slices[index];
+  const MrProtocol::Vector3 & p = slice.Position;
   pos[0] = p.dSag;
   pos[1] = p.dCor;
   pos[2] = p.dTra;
@@ -466,7 +467,6 @@ bool SplitMosaicFilter::Split()
     {
     return false;
     }
-  const unsigned int div = (unsigned int )ceil(sqrt( (double)dims[2]) );
   bool inverted = false;
   double normal[3];
   bool hasOriginCSA = true;
@@ -501,29 +501,19 @@ bool SplitMosaicFilter::Split()
   unsigned long l = inputimage.GetBufferLength();
   std::vector<char> buf;
   buf.resize(l);
-  inputimage.GetBuffer( buf.data() );
+  if( !inputimage.GetBuffer( buf.data() ) ) return false;
   DataElement pixeldata( Tag(0x7fe0,0x0010) );
 
-  std::vector<char> outbuf;
-  outbuf.resize(l);
-
-  bool b;
-  if( inverted )
-  {
-    b = details::reorganize_mosaic_invert(
-        (unsigned short*)(void*)buf.data(), inputimage.GetDimensions(), div, dims,
-        (unsigned short*)(void*)outbuf.data() );
-  }
-  else
-  {
-    b = details::reorganize_mosaic(
-        (unsigned short*)(void*)buf.data(), inputimage.GetDimensions(), div, dims,
-        (unsigned short*)(void*)outbuf.data() );
-  }
-  if( !b ) return false;
-
-  VL::Type outbufSize = (VL::Type)outbuf.size();
-  pixeldata.SetByteValue( outbuf.data(), outbufSize );
+  // The tiles are copied straight into the new Pixel Data:
+  const unsigned int pixelsize = inputimage.GetPixelFormat().GetPixelSize();
+  const size_t outlen = (size_t)dims[0] * dims[1] * dims[2] * pixelsize;
+  if( outlen > l ) return false;
+  SmartPointer<ByteValue> outbv = new ByteValue;
+  outbv->SetLength( (uint32_t)outlen );
+  if( !ReorganizeMosaic( buf.data(), inputimage.GetDimensions(), dims, pixelsize,
+      inverted, (char*)outbv->GetVoidPointer() ) )
+    return false;
+  pixeldata.SetValue( *outbv );
 
   Image &image = GetImage();
   const TransferSyntax &ts = image.GetTransferSyntax();
@@ -16,6 +16,7 @@
 
 #include "gdcmFile.h"
 #include "gdcmImage.h"
+#include "gdcmMrProtocol.h"
 
 namespace gdcm
 {
@@ -39,6 +40,10 @@ namespace gdcm
  * CSA 0029,1010 is needed for correct NumberOfImagesInMosaic
  * CSA 0029,1020 is needed to compute the correct origin
  * without above info default are taken (may not be accurate).
+ *
+ * The slice array of the MrProtocol (CSA Series Header) is kept in between
+ * calls, so that a single filter splitting all the mosaics of a series only
+ * parses it once.
  */
 class GDCM_EXPORT SplitMosaicFilter
 {
@@ -49,6 +54,17 @@ public:
   /// Split the SIEMENS MOSAIC image
   bool Split();
 
+  /// Copy tile \p z of a mosaic of \p inputdims[0] x \p inputdims[1] pixels
+  /// into \p output: a slice of \p dims[0] x \p dims[1] pixels of \p pixelsize
+  /// bytes (one memcpy per row). \p dims[2] is the number of tiles.
+  static bool ExtractTile(const char *input, const unsigned int inputdims[2],
+    const unsigned int dims[3], unsigned int pixelsize, unsigned int z, char *output);
+  /// Copy all tiles of a mosaic into dims[2] consecutive slices (eg. the
+  /// frames of a multi-frame image). When \p inverted is true, the last tile
+  /// is the first slice.
+  static bool ReorganizeMosaic(const char *input, const unsigned int inputdims[2],
+    const unsigned int dims[3], unsigned int pixelsize, bool inverted, char *output);
+
   /// Compute the new dimensions according to private information
   /// stored in the MOSAIC header.
   bool ComputeMOSAICDimensions(unsigned int dims[3]);
@@ -68,6 +84,11 @@ public:
     const unsigned int image_dims[3] ,
     const unsigned int mosaic_dims[3], bool inverted );
 
+  /// Slice array of the MrProtocol (CSA Series Header) of the file, nullptr
+  /// when there is none. It is only parsed when the CSA Series Header differs
+  /// from the one of the previous call.
+  const MrProtocol::SliceArray *GetMrProtocolSliceArray();
+
   void SetImage(const Image& image);
   const Image &GetImage() const { return *I; }
   Image &GetImage() { return *I; }
@@ -93,6 +114,10 @@ protected:
 private:
   SmartPointer<File> F;
   SmartPointer<Image> I;
+  // Cache of the slice array, for the CSA Series Header it was read from:
+  std::string CSASeriesHeader;
+  bool HasSliceArray;
+  MrProtocol::SliceArray SliceArray;
 };
 
 } // end namespace gdcm
@@ -15,8 +15,10 @@
 #include "gdcmTrace.h"
 #include "gdcmSystem.h"
 
-#include <bitset>
+#include <atomic>
 #include <cstring>
+#include <mutex>
+#include <set>
 
 // FIXME...
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -51,14 +53,41 @@ namespace gdcm
  *
  */
 const char UIDGenerator::GDCM_UID[] = "1.2.826.0.1.3680043.2.1143";
-std::string UIDGenerator::Root = GetGDCMUID();
-// The following contains the *encoded* hardware address (not the raw as in ipconfig/ifconfig)
-std::string UIDGenerator::EncodedHardwareAddress; // = System::GetHardwareAddress();
 
-const char *UIDGenerator::GetRoot() { return Root.c_str(); }
+/*
+ * The current root is published through an atomic pointer, nullptr meaning
+ * the GDCM root (constant initialized, so usable from other static
+ * initializers). Every root ever
+ * set is kept in a node based container and never freed, so that a pointer
+ * returned by GetRoot() can never dangle, even when another thread calls
+ * SetRoot() concurrently.
+ */
+static std::atomic<const char*> CurrentRoot( nullptr );
+
+static std::mutex &GetRootsLock()
+{
+  static std::mutex lock;
+  return lock;
+}
+
+static std::set<std::string> &GetRoots()
+{
+  static std::set<std::string> *roots = new std::set<std::string>;
+  return *roots;
+}
+
+const char *UIDGenerator::GetRoot()
+{
+  const char *root = CurrentRoot.load( std::memory_order_acquire );
+  return root ? root : GDCM_UID;
+}
+
 void UIDGenerator::SetRoot(const char * root) {
   gdcm_assert( IsValid( root ) );
-  Root = root;
+  if( !root ) return;
+  std::lock_guard<std::mutex> lock( GetRootsLock() );
+  const std::string &r = *GetRoots().insert( root ).first;
+  CurrentRoot.store( r.c_str(), std::memory_order_release );
 }
 
 const char *UIDGenerator::GetGDCMUID()
@@ -91,6 +120,108 @@ struct fnv_hash
     }
 };
 
+/*
+ * 128bits unsigned integer as four 32bits limbs, most significant first
+ * (same order as the bytes of the UUID).
+ */
+static void LoadUInt128(const unsigned char uuid[16], uint32_t limbs[4])
+{
+  for( int i = 0; i < 4; ++i )
+    {
+    limbs[i] = (uint32_t)uuid[4*i] << 24 | (uint32_t)uuid[4*i+1] << 16
+      | (uint32_t)uuid[4*i+2] << 8 | (uint32_t)uuid[4*i+3];
+    }
+}
+
+static bool LessUInt128(const uint32_t a[4], const uint32_t b[4])
+{
+  for( int i = 0; i < 4; ++i )
+    {
+    if( a[i] != b[i] ) return a[i] < b[i];
+    }
+  return false;
+}
+
+/*
+ * Same output as System::EncodeBytes(out, uuid, 16), but dividing by 10^9
+ * instead of 10 at each step.
+ */
+static size_t EncodeUInt128(const uint32_t value[4], char *out)
+{
+  uint32_t limbs[4] = { value[0], value[1], value[2], value[3] };
+  uint32_t chunks[5]; // 10^45 > 2^128
+  int nchunks = 0;
+  bool zero;
+  do
+    {
+    uint64_t rem = 0;
+    zero = true;
+    for( int i = 0; i < 4; ++i )
+      {
+      const uint64_t cur = rem << 32 | limbs[i];
+      limbs[i] = (uint32_t)(cur / 1000000000u);
+      rem = cur % 1000000000u;
+      zero = zero && limbs[i] == 0;
+      }
+    chunks[nchunks++] = (uint32_t)rem;
+    } while( !zero );
+  // most significant chunk without leading zeros, the others on 9 digits:
+  char *p = out;
+  char tmp[10];
+  int n = 0;
+  uint32_t c = chunks[nchunks-1];
+  do { tmp[n++] = (char)('0' + c % 10); c /= 10; } while( c );
+  while( n ) *p++ = tmp[--n];
+  for( int k = nchunks - 2; k >= 0; --k )
+    {
+    c = chunks[k];
+    for( int d = 8; d >= 0; --d )
+      {
+      p[d] = (char)('0' + c % 10);
+      c /= 10;
+      }
+    p += 9;
+    }
+  *p = 0;
+  return (size_t)(p - out);
+}
+
+/*
+ * Encode the 128bits number \p uuid in base 10 into \p suffix. If it has
+ * more than \p maxlen digits, truncate the high bits of the number until it
+ * fits. Return the number of digits, 0 when no truncation was enough.
+ */
+static size_t EncodeUIDSuffix(unsigned char uuid[16], size_t maxlen, char *suffix)
+{
+  if( maxlen == 0 ) return 0;
+  uint32_t value[4];
+  LoadUInt128(uuid, value);
+  // 2^128 - 1 has 39 digits, a shorter suffix requires value < 10^maxlen:
+  if( maxlen < 39 )
+    {
+    uint32_t limit[4] = { 0, 0, 0, 1 };
+    for( size_t d = 0; d < maxlen; ++d )
+      {
+      uint64_t carry = 0;
+      for( int i = 3; i >= 0; --i )
+        {
+        const uint64_t cur = (uint64_t)limit[i] * 10 + carry;
+        limit[i] = (uint32_t)cur;
+        carry = cur >> 32;
+        }
+      }
+    // too bad ! suffix is too long, let's truncate the high bits, one at a
+    // time, until it fits:
+    for( int bit = 127; bit >= 0 && !LessUInt128(value, limit); --bit )
+      {
+      value[3 - bit / 32] &= ~((uint32_t)1 << (bit % 32));
+      }
+    }
+  const size_t len = EncodeUInt128(value, suffix);
+  gdcm_assert( len < 64 ); // programmer error
+  return len > maxlen ? 0 : len;
+}
+
 /*
 Implementation note: You cannot set a root of more than 26 bytes (which should already
 enough for most people).
@@ -112,45 +243,14 @@ const char* UIDGenerator::Generate()
   // I should try to go any further and make sure the user's computer crash and burn
   // right away
   if( !r ) return nullptr;
-  char randbytesbuf[64];
-  size_t len = System::EncodeBytes(randbytesbuf, uuid, sizeof(uuid));
-  gdcm_assert( len < 64 ); // programmer error
   Unique += "."; // This dot is compulsory to separate root from suffix
-  if( Unique.size() + len > 64 )
+  char randbytesbuf[64];
+  if( !EncodeUIDSuffix(uuid, 64 - Unique.size(), randbytesbuf) )
     {
-    int idx = 0;
-    bool found = false;
-    while( !found && idx < 16 ) /* 16 is insane ... oh well */
-      {
-      // too bad ! randbytesbuf is too long, let's try to truncate the high bits a little
-      std::bitset<8> x = uuid[idx];
-      unsigned int i = 0;
-      while( ( Unique.size() + len > 64 ) && i < 8 )
-        {
-        x[7-i] = false;
-        uuid[idx] = (unsigned char)x.to_ulong();
-        len = System::EncodeBytes(randbytesbuf, uuid, sizeof(uuid));
-        ++i;
-        }
-      if( ( Unique.size() + len > 64 ) && i == 8 )
-        {
-        // too bad only reducing the 8 bits from uuid[idx] was not enough,
-        // let's set to zero the following bits...
-        idx++;
-        }
-      else
-        {
-        // cool we found enough to stop
-        found = true;
-        }
-      }
-    if( !found )
-      {
-      // Technically this could only happen when root has a length >= 64 ... is it
-      // even remotely possible ?
-      gdcmWarningMacro( "Root is too long for current implementation" );
-      return nullptr;
-      }
+    // Technically this could only happen when root has a length >= 64 ... is it
+    // even remotely possible ?
+    gdcmWarningMacro( "Root is too long for current implementation" );
+    return nullptr;
     }
   // can now safely use randbytesbuf as is, no need to truncate any more:
   Unique += randbytesbuf;
@@ -160,6 +260,42 @@ const char* UIDGenerator::Generate()
   return Unique.c_str();
 }
 
+bool UIDGenerator::Generate(char uids[][65], size_t count)
+{
+  // the root is only read once, so that a concurrent SetRoot cannot split a batch:
+  const char *root = GetRoot();
+  const size_t rootlen = strlen(root);
+  if( rootlen == 0 || rootlen > 62 ) return false;
+  const size_t maxlen = 64 - (rootlen + 1);
+  for( size_t i = 0; i < count; ++i )
+    {
+    unsigned char uuid[16];
+    if( !UIDGenerator::GenerateUUID(uuid) ) return false;
+    char *uid = uids[i];
+    memcpy(uid, root, rootlen);
+    uid[rootlen] = '.';
+    if( !EncodeUIDSuffix(uuid, maxlen, uid + rootlen + 1) )
+      {
+      gdcmWarningMacro( "Root is too long for current implementation" );
+      return false;
+      }
+    gdcm_assert( IsValid( uid ) );
+    }
+  return true;
+}
+
+bool UIDGenerator::Generate(std::vector<std::string> &uids, size_t count)
+{
+  std::vector<char> buffer( count * 65 + 1 );
+  char (*batch)[65] = reinterpret_cast<char (*)[65]>( &buffer[0] );
+  if( !Generate(batch, count) ) return false;
+  uids.resize( count );
+  for( size_t i = 0; i < count; ++i )
+    {
+    uids[i] = batch[i];
+    }
+  return true;
+}
 
 /* return true on success */
 bool UIDGenerator::GenerateUUID(unsigned char *uuid_data)
@@ -16,6 +16,9 @@
 
 #include "gdcmTypes.h"
 
+#include <string>
+#include <vector>
+
 namespace gdcm
 {
 
@@ -23,6 +26,11 @@ namespace gdcm
  * \brief Class for generating unique UID
  * \details When constructing a Series or Study UID, user *has* to keep around the UID,
  * otherwise the UID Generator will simply forget the value and create a new UID.
+ *
+ * Thread safety: Generate() only touches the instance buffer, use one
+ * UIDGenerator per thread and UIDs can be generated concurrently without any
+ * lock. The root is shared by all instances: reading it is lock free, SetRoot
+ * can be called at any time and only affects UIDs generated afterwards.
  */
 class GDCM_EXPORT UIDGenerator
 {
@@ -51,6 +59,7 @@ public:
   /// function will return a string), but will truncate the high bits of the 128bits UUID until the
   /// generated string fits on 64 bits. The authors disclaims any
   /// responsabitlity for guaranteeing uniqueness of UIDs when the root is longer than 26 bytes.
+  /// The pointer returned by GetRoot remains valid for the life of the process.
   static void SetRoot(const char * root);
   static const char *GetRoot();
 
@@ -62,6 +71,17 @@ public:
   /// since uid1 == uid2
   const char* Generate();
 
+#ifndef SWIG
+  /// Generate \p count UIDs at once into \p uids, an array of \p count
+  /// NUL terminated strings (a UID is at most 64 characters long).
+  /// Each UID of the batch is generated independently, just as with
+  /// Generate(); the root is only read once for the whole batch.
+  /// Return false on error.
+  bool Generate(char uids[][65], size_t count);
+#endif
+  /// Same as above, \p uids is resized to \p count
+  bool Generate(std::vector<std::string> &uids, size_t count);
+
   /// Find out if the string is a valid UID or not
   /// \todo: Move that in DataStructureAndEncoding (see FileMetaInformation::CheckFileMetaInformation)
   static bool IsValid(const char *uid);
@@ -74,8 +94,6 @@ protected:
 
 private:
   static const char GDCM_UID[];
-  static std::string Root;
-  static std::string EncodedHardwareAddress;
   std::string Unique; // Buffer
 };
 
@@ -0,0 +1,177 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmUIDMappingTable.h"
+#include "gdcmUIDGenerator.h"
+#include "gdcmTrace.h"
+
+#include <fstream>
+#include <sstream>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <functional>
+
+namespace gdcm
+{
+
+class UIDMappingTableInternals
+{
+public:
+  // Must be a power of two
+  static const size_t NumberOfBuckets = 64;
+
+  struct Bucket
+  {
+    mutable std::mutex Lock;
+    std::unordered_map<std::string, std::string> Map;
+  };
+  Bucket Buckets[NumberOfBuckets];
+
+  Bucket &GetBucket(const std::string &uid)
+    {
+    return Buckets[ std::hash<std::string>()(uid) & (NumberOfBuckets - 1) ];
+    }
+  const Bucket &GetBucket(const std::string &uid) const
+    {
+    return Buckets[ std::hash<std::string>()(uid) & (NumberOfBuckets - 1) ];
+    }
+};
+
+UIDMappingTable::UIDMappingTable():Internals(new UIDMappingTableInternals)
+{
+}
+
+UIDMappingTable::~UIDMappingTable()
+{
+  delete Internals;
+}
+
+std::string UIDMappingTable::GetOrCreate(const char *olduid)
+{
+  const std::string key = olduid ? olduid : "";
+  UIDMappingTableInternals::Bucket &b = Internals->GetBucket( key );
+  std::lock_guard<std::mutex> lock( b.Lock );
+  std::unordered_map<std::string, std::string>::const_iterator it = b.Map.find( key );
+  if( it != b.Map.end() )
+    {
+    return it->second;
+    }
+  // Generate while holding the bucket lock, so that two threads asking for
+  // the same olduid can never end up with two different replacements
+  UIDGenerator uid;
+  const std::string newuid = uid.Generate();
+  b.Map.insert( std::make_pair( key, newuid ) );
+  return newuid;
+}
+
+bool UIDMappingTable::Find(const char *olduid, std::string &newuid) const
+{
+  const std::string key = olduid ? olduid : "";
+  const UIDMappingTableInternals::Bucket &b = Internals->GetBucket( key );
+  std::lock_guard<std::mutex> lock( b.Lock );
+  std::unordered_map<std::string, std::string>::const_iterator it = b.Map.find( key );
+  if( it == b.Map.end() ) return false;
+  newuid = it->second;
+  return true;
+}
+
+bool UIDMappingTable::Insert(const char *olduid, const char *newuid)
+{
+  if( !olduid || !newuid ) return false;
+  const std::string key = olduid;
+  UIDMappingTableInternals::Bucket &b = Internals->GetBucket( key );
+  std::lock_guard<std::mutex> lock( b.Lock );
+  std::unordered_map<std::string, std::string>::const_iterator it = b.Map.find( key );
+  if( it != b.Map.end() )
+    {
+    return it->second == newuid;
+    }
+  b.Map.insert( std::make_pair( key, std::string(newuid) ) );
+  return true;
+}
+
+size_t UIDMappingTable::GetNumberOfEntries() const
+{
+  size_t n = 0;
+  for( size_t i = 0; i < UIDMappingTableInternals::NumberOfBuckets; ++i )
+    {
+    const UIDMappingTableInternals::Bucket &b = Internals->Buckets[i];
+    std::lock_guard<std::mutex> lock( b.Lock );
+    n += b.Map.size();
+    }
+  return n;
+}
+
+void UIDMappingTable::Clear()
+{
+  for( size_t i = 0; i < UIDMappingTableInternals::NumberOfBuckets; ++i )
+    {
+    UIDMappingTableInternals::Bucket &b = Internals->Buckets[i];
+    std::lock_guard<std::mutex> lock( b.Lock );
+    b.Map.clear();
+    }
+}
+
+bool UIDMappingTable::Load(const char *filename)
+{
+  if( !filename ) return false;
+  std::ifstream is( filename );
+  if( !is ) return false;
+  std::string line;
+  unsigned int lineno = 0;
+  while( std::getline( is, line ) )
+    {
+    ++lineno;
+    if( line.empty() || line[0] == '#' ) continue;
+    std::istringstream iss( line );
+    std::string olduid, newuid;
+    if( !(iss >> olduid >> newuid) )
+      {
+      gdcmErrorMacro( "Invalid line " << lineno << " in: " << filename );
+      return false;
+      }
+    if( !Insert( olduid.c_str(), newuid.c_str() ) )
+      {
+      gdcmErrorMacro( "Conflicting mapping for " << olduid << " at line " << lineno );
+      return false;
+      }
+    }
+  return true;
+}
+
+bool UIDMappingTable::Save(const char *filename) const
+{
+  if( !filename ) return false;
+  // Sort entries so that output is stable from one run to another:
+  std::map<std::string, std::string> sorted;
+  for( size_t i = 0; i < UIDMappingTableInternals::NumberOfBuckets; ++i )
+    {
+    const UIDMappingTableInternals::Bucket &b = Internals->Buckets[i];
+    std::lock_guard<std::mutex> lock( b.Lock );
+    sorted.insert( b.Map.begin(), b.Map.end() );
+    }
+  std::ofstream os( filename );
+  if( !os ) return false;
+  std::map<std::string, std::string>::const_iterator it = sorted.begin();
+  for( ; it != sorted.end(); ++it )
+    {
+    // empty UID cannot be represented, it is never shared anyway
+    if( it->first.empty() ) continue;
+    os << it->first << ' ' << it->second << '\n';
+    }
+  os.close();
+  return !os.fail();
+}
+
+} // end namespace gdcm
@@ -0,0 +1,86 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#ifndef GDCMUIDMAPPINGTABLE_H
+#define GDCMUIDMAPPINGTABLE_H
+
+#include "gdcmTypes.h"
+
+#include <string>
+
+namespace gdcm
+{
+class UIDMappingTableInternals;
+
+/**
+ * \brief UIDMappingTable
+ * \details Thread safe table mapping an original UID to its generated
+ * replacement. This is the 'memory' used by Anonymizer so that attributes such
+ * as Study Instance UID or Frame of Reference UID are consistently remapped
+ * across all the instances of a FileSet.
+ *
+ * The table is split into a fixed number of independently locked buckets, so
+ * that many Anonymizer (one per thread) can share a single table with very
+ * little contention. The first thread to request a given UID generates its
+ * replacement, all others will see that same value.
+ *
+ * The table can be saved to / loaded from a plain text file (one "original
+ * replacement" pair per line), which makes the remapping consistent across
+ * independent runs.
+ *
+ * \warning the saved file contains original UIDs, it should be handled with
+ * the same care as the original (identified) data.
+ *
+ * \see Anonymizer BatchAnonymizer
+ */
+class GDCM_EXPORT UIDMappingTable
+{
+public:
+  UIDMappingTable();
+  ~UIDMappingTable();
+  UIDMappingTable(const UIDMappingTable&) = delete;
+  void operator=(const UIDMappingTable&) = delete;
+
+  /// Return the replacement of UID olduid. A new UID is generated (using
+  /// UIDGenerator) when olduid has never been seen before.
+  /// Safe to call concurrently.
+  std::string GetOrCreate(const char *olduid);
+
+  /// Lookup an existing mapping, return false if olduid is unknown.
+  bool Find(const char *olduid, std::string &newuid) const;
+
+  /// Explicitly insert a mapping. Return false (and does nothing) when olduid
+  /// is already mapped to a different value.
+  bool Insert(const char *olduid, const char *newuid);
+
+  /// Number of mapped UIDs
+  size_t GetNumberOfEntries() const;
+
+  /// Remove all mappings
+  /// \warning the mapping is definitely lost
+  void Clear();
+
+  /// Load mapping from filename. Existing entries are kept, entries from file
+  /// are merged in.
+  bool Load(const char *filename);
+
+  /// Save mapping into filename (overwrite)
+  bool Save(const char *filename) const;
+
+private:
+  UIDMappingTableInternals *Internals;
+};
+
+} // end namespace gdcm
+
+#endif //GDCMUIDMAPPINGTABLE_H
@@ -420,8 +420,8 @@ void XMLPrinter::PrintSQ(const SequenceOfItems *sqi, const TransferSyntax & ts,
   
   int noItems = 1;
 
-  SequenceOfItems::ItemVector::const_iterator it = sqi->Items.begin();
-  for(; it != sqi->Items.end(); ++it)
+  SequenceOfItems::ItemVector::const_iterator it = sqi->Begin();
+  for(; it != sqi->End(); ++it)
     {
     const Item &item = *it;
     const DataSet &ds = item.GetNestedDataSet();
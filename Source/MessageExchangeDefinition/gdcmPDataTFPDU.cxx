@@ -13,6 +13,7 @@
 =========================================================================*/
 #include "gdcmPDataTFPDU.h"
 #include "gdcmSwapper.h"
+#include "gdcmInstrumentation.h"
 
 namespace gdcm
 {
@@ -30,6 +31,7 @@ PDataTFPDU::PDataTFPDU()
 
 std::istream &PDataTFPDU::Read(std::istream &is)
 {
+  InstrumentationTimer timer( Instrumentation::PDUReceive );
   //uint8_t itemtype = 0;
   //is.read( (char*)&itemtype, sizeof(ItemType) );
   //gdcm_assert( itemtype == ItemType );
@@ -50,12 +52,14 @@ std::istream &PDataTFPDU::Read(std::istream &is)
     }
   gdcm_assert( curlen == ItemLength );
   gdcm_assert( (ItemLength + 4 + 1 + 1) == Size() );
+  timer.SetBytes( ItemLength + 6 );
 
   return is;
 }
 
 std::istream &PDataTFPDU::ReadInto(std::istream &is, std::ostream &os)
 {
+  InstrumentationTimer timer( Instrumentation::PDUReceive );
   uint8_t itemtype = 0;
   is.read( (char*)&itemtype, sizeof(ItemType) );
   gdcm_assert( itemtype == ItemType );
@@ -76,12 +80,15 @@ std::istream &PDataTFPDU::ReadInto(std::istream &is, std::ostream &os)
     }
   gdcm_assert( curlen == ItemLength );
   gdcm_assert( (ItemLength + 4 + 1 + 1) == Size() );
+  timer.SetBytes( ItemLength + 6 );
 
   return is;
 }
 
 const std::ostream &PDataTFPDU::Write(std::ostream &os) const
 {
+  InstrumentationTimer timer( Instrumentation::PDUSend );
+  timer.SetBytes( ItemLength + 6 );
   gdcm_assert( (ItemLength + 4 + 1 + 1) == Size() );
   os.write( (const char*)&ItemType, sizeof(ItemType) );
   os.write( (const char*)&Reserved2, sizeof(Reserved2) );
@@ -0,0 +1,608 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+/*
+ * Performance benchmarks on synthetic data sets.
+ * Usage:
+ *
+ * $ gdcmbench [--filter read/] [--min-time 0.5] [--output results.json]
+ *
+ * Options:
+ * --filter   : only run the benchmarks whose name contains the string
+ * --min-time : minimum time (in seconds) spent in each benchmark
+ * --output   : write the JSON results to a file instead of stdout
+ * --tmpdir   : directory used for the on-disk benchmarks (scan/)
+ * --list     : list the benchmarks and exit
+ * --quick    : run each benchmark once (smoke test)
+ *
+ * For each benchmark the throughput is reported in MB/s (of encoded bytes
+ * for read/scan/write, of decoded bytes for decode/code/rescale/lut), in
+ * files/s and as the number of operator new calls per file.
+ */
+#include "gdcmReader.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+#include "gdcmImageReader.h"
+#include "gdcmImageWriter.h"
+#include "gdcmImageChangeTransferSyntax.h"
+#include "gdcmScanner.h"
+#include "gdcmRescaler.h"
+#include "gdcmLookupTable.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmSystem.h"
+#include "gdcmTrace.h"
+#include "gdcmVersion.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Count every allocation done through operator new:
+static std::atomic<size_t> AllocationCount( 0 );
+
+void *operator new(std::size_t n)
+{
+  ++AllocationCount;
+  if( void *p = std::malloc( n ? n : 1 ) ) return p;
+  throw std::bad_alloc();
+}
+void *operator new[](std::size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+
+struct Benchmark
+{
+  std::string Name;
+  // Run one iteration, return false on error:
+  std::function<bool()> Run;
+  size_t BytesPerIteration;
+  size_t FilesPerIteration;
+};
+
+struct Result
+{
+  std::string Name;
+  bool Success;
+  size_t Iterations;
+  double Seconds;
+  double MBPerSecond;
+  double FilesPerSecond;
+  double AllocationsPerFile;
+};
+
+// Synthetic data sets
+
+void InsertValue(gdcm::DataSet &ds, const gdcm::Tag &t, const gdcm::VR &vr, const void *p, uint32_t len)
+{
+  gdcm::DataElement de( t );
+  de.SetVR( vr );
+  de.SetByteValue( (const char*)p, len );
+  ds.Replace( de );
+}
+
+void InsertHeader(gdcm::DataSet &ds, const char *sopclass, unsigned int index)
+{
+  std::ostringstream uid;
+  uid << "1.2.826.0.1.3680043.2.1125.1." << index;
+  gdcm::Attribute<0x0008,0x0016> sopclassuid = { sopclass };
+  ds.Replace( sopclassuid.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0018> sopinstanceuid = { uid.str() };
+  ds.Replace( sopinstanceuid.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0060> modality = { "OT" };
+  ds.Replace( modality.GetAsDataElement() );
+  gdcm::Attribute<0x0010,0x0010> patientname = { "Bench^Patient" };
+  ds.Replace( patientname.GetAsDataElement() );
+  gdcm::Attribute<0x0010,0x0020> patientid = { "BENCH0001" };
+  ds.Replace( patientid.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x000d> studyuid = { "1.2.826.0.1.3680043.2.1125.2" };
+  ds.Replace( studyuid.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x000e> seriesuid = { "1.2.826.0.1.3680043.2.1125.3" };
+  ds.Replace( seriesuid.GetAsDataElement() );
+}
+
+// Many short attributes of various VR
+void GenerateSmallAttributes(gdcm::DataSet &ds, unsigned int n)
+{
+  // even length values, no padding needed:
+  static const char *const strings[] = { "VALUE1", "1.2345", "42", "Some text values", "20240101" };
+  static const gdcm::VR::VRType vrs[] = { gdcm::VR::CS, gdcm::VR::DS, gdcm::VR::IS, gdcm::VR::LO, gdcm::VR::DA };
+  for( unsigned int i = 0; i < n; ++i )
+    {
+    const gdcm::Tag t( (uint16_t)(0x0100 + 2 * (i / 1000)), (uint16_t)(0x1000 + i % 1000) );
+    const unsigned int k = i % 7;
+    if( k < 5 )
+      {
+      InsertValue( ds, t, vrs[k], strings[k], (uint32_t)strlen( strings[k] ) );
+      }
+    else if( k == 5 )
+      {
+      const uint16_t v = (uint16_t)i;
+      InsertValue( ds, t, gdcm::VR::US, &v, 2 );
+      }
+    else
+      {
+      const float v[2] = { (float)i, 0.5f };
+      InsertValue( ds, t, gdcm::VR::FL, v, 8 );
+      }
+    }
+}
+
+// Nested sequences (undefined length), fanout^depth items at the bottom
+void GenerateDeepSequences(gdcm::DataSet &ds, unsigned int depth, unsigned int fanout)
+{
+  gdcm::Attribute<0x0008,0x0100> codevalue = { "CODE" };
+  ds.Replace( codevalue.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0102> scheme = { "DCM" };
+  ds.Replace( scheme.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0104> meaning = { "Code Meaning" };
+  ds.Replace( meaning.GetAsDataElement() );
+  gdcm::Attribute<0x0040,0xa160> text = { "Some finding text in a container" };
+  ds.Replace( text.GetAsDataElement() );
+  if( !depth ) return;
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+  sq->SetLengthToUndefined();
+  for( unsigned int i = 0; i < fanout; ++i )
+    {
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    GenerateDeepSequences( item.GetNestedDataSet(), depth - 1, fanout );
+    sq->AddItem( item );
+    }
+  gdcm::DataElement de( gdcm::Tag(0x0040,0xa730) );
+  de.SetVR( gdcm::VR::SQ );
+  de.SetValue( *sq );
+  de.SetVLToUndefined();
+  ds.Replace( de );
+}
+
+std::string WriteDataSet(const gdcm::DataSet &ds, const gdcm::TransferSyntax &ts)
+{
+  gdcm::Writer w;
+  w.GetFile().GetDataSet() = ds;
+  w.GetFile().GetHeader().SetDataSetTransferSyntax( ts );
+  std::ostringstream os;
+  w.SetStream( os );
+  if( !w.Write() ) return std::string();
+  return os.str();
+}
+
+// Multi-frame 16 bits image, smooth content with some noise. Filters keep a
+// reference on their input, do not allocate on the stack.
+gdcm::SmartPointer<gdcm::Image> CreateImage(unsigned int x, unsigned int y, unsigned int z)
+{
+  const unsigned int dims[3] = { x, y, z };
+  gdcm::SmartPointer<gdcm::Image> ptr = new gdcm::Image;
+  gdcm::Image &image = *ptr;
+  image.SetNumberOfDimensions( z > 1 ? 3 : 2 );
+  image.SetDimensions( dims );
+  gdcm::PixelFormat pf( gdcm::PixelFormat::UINT16 );
+  pf.SetBitsStored( 12 );
+  pf.SetHighBit( 11 );
+  image.SetPixelFormat( pf );
+  image.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::MONOCHROME2 );
+  image.SetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  std::vector<uint16_t> pixels( (size_t)x * y * z );
+  unsigned int seed = 1234;
+  size_t idx = 0;
+  for( unsigned int k = 0; k < z; ++k )
+    for( unsigned int j = 0; j < y; ++j )
+      for( unsigned int i = 0; i < x; ++i )
+        {
+        seed = seed * 1103515245 + 12345;
+        pixels[idx++] = (uint16_t)( (2 * i + 3 * j + 50 * k + ((seed >> 16) & 0x7)) & 0xfff );
+        }
+  gdcm::DataElement pixeldata( gdcm::Tag(0x7fe0,0x0010) );
+  pixeldata.SetVR( gdcm::VR::OW );
+  pixeldata.SetByteValue( (const char*)pixels.data(), (uint32_t)(pixels.size() * 2) );
+  image.SetDataElement( pixeldata );
+  return ptr;
+}
+
+std::string WriteImage(const gdcm::Image &input, const gdcm::TransferSyntax &ts)
+{
+  gdcm::ImageWriter writer;
+  if( ts == input.GetTransferSyntax() )
+    {
+    writer.GetImage() = input;
+    }
+  else
+    {
+    // the filter modifies its input, work on a (shallow) copy:
+    gdcm::SmartPointer<gdcm::Image> copy = new gdcm::Image( input );
+    gdcm::ImageChangeTransferSyntax change;
+    change.SetTransferSyntax( ts );
+    change.SetInput( *copy );
+    if( !change.Change() ) return std::string();
+    writer.GetImage() = change.GetOutput();
+    }
+  InsertHeader( writer.GetFile().GetDataSet(), "1.2.840.10008.5.1.4.1.1.7", 0 );
+  std::ostringstream os;
+  writer.SetStream( os );
+  if( !writer.Write() ) return std::string();
+  return os.str();
+}
+
+// Benchmarks
+
+Benchmark MakeRead(const std::string &name, const std::string &blob, bool lazy)
+{
+  Benchmark b;
+  b.Name = (lazy ? "read-lazy/" : "read/") + name;
+  b.Run = [&blob,lazy]() {
+    std::istringstream is( blob );
+    gdcm::Reader reader;
+    reader.SetStream( is );
+    reader.SetLazySequenceParsing( lazy );
+    return reader.Read();
+  };
+  b.BytesPerIteration = blob.size();
+  b.FilesPerIteration = 1;
+  return b;
+}
+
+Benchmark MakeReadArena(const std::string &name, const std::string &blob)
+{
+  Benchmark b;
+  b.Name = "read-arena/" + name;
+  b.Run = [&blob]() {
+    std::istringstream is( blob );
+    gdcm::Reader reader;
+    reader.SetStream( is );
+    reader.SetUseMemoryArena( true );
+    return reader.Read();
+  };
+  b.BytesPerIteration = blob.size();
+  b.FilesPerIteration = 1;
+  return b;
+}
+
+Benchmark MakeReadUpToTag(const std::string &name, const std::string &blob, const gdcm::Tag &t)
+{
+  Benchmark b;
+  b.Name = "read-up-to-tag/" + name;
+  b.Run = [&blob,t]() {
+    std::istringstream is( blob );
+    gdcm::Reader reader;
+    reader.SetStream( is );
+    return reader.ReadUpToTag( t );
+  };
+  b.BytesPerIteration = blob.size();
+  b.FilesPerIteration = 1;
+  return b;
+}
+
+Benchmark MakeWrite(const std::string &name, const gdcm::DataSet &ds, const gdcm::TransferSyntax &ts, size_t len)
+{
+  Benchmark b;
+  b.Name = "write/" + name;
+  b.Run = [&ds,ts]() {
+    return !WriteDataSet( ds, ts ).empty();
+  };
+  b.BytesPerIteration = len;
+  b.FilesPerIteration = 1;
+  return b;
+}
+
+Benchmark MakeDecode(const std::string &name, const gdcm::Image &image, std::vector<char> &buffer)
+{
+  Benchmark b;
+  b.Name = "decode/" + name;
+  b.Run = [&image,&buffer]() {
+    return image.GetBuffer( buffer.data() );
+  };
+  b.BytesPerIteration = buffer.size();
+  b.FilesPerIteration = 1;
+  return b;
+}
+
+Benchmark MakeCode(const std::string &name, const gdcm::Image &raw, const gdcm::TransferSyntax &ts)
+{
+  Benchmark b;
+  b.Name = "code/" + name;
+  b.Run = [&raw,ts]() {
+    gdcm::SmartPointer<gdcm::Image> copy = new gdcm::Image( raw );
+    gdcm::ImageChangeTransferSyntax change;
+    change.SetTransferSyntax( ts );
+    change.SetInput( *copy );
+    return change.Change();
+  };
+  b.BytesPerIteration = raw.GetBufferLength();
+  b.FilesPerIteration = 1;
+  return b;
+}
+
+Result RunBenchmark(const Benchmark &b, double mintime, bool quick)
+{
+  Result r;
+  r.Name = b.Name;
+  r.Success = b.Run(); // warm up
+  r.Iterations = 0;
+  r.Seconds = 0;
+  const size_t alloc0 = AllocationCount;
+  const auto start = std::chrono::steady_clock::now();
+  while( r.Success && (r.Iterations < 3 || r.Seconds < mintime) )
+    {
+    r.Success = b.Run();
+    ++r.Iterations;
+    r.Seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+    if( quick ) break;
+    }
+  const size_t allocs = AllocationCount - alloc0;
+  const double files = (double)r.Iterations * (double)b.FilesPerIteration;
+  const double secs = r.Seconds > 0 ? r.Seconds : 1e-9;
+  r.MBPerSecond = (double)r.Iterations * (double)b.BytesPerIteration / secs / (1024. * 1024.);
+  r.FilesPerSecond = files / secs;
+  r.AllocationsPerFile = files > 0 ? (double)allocs / files : 0;
+  return r;
+}
+
+void PrintJSON(std::ostream &os, const std::vector<Result> &results)
+{
+  os << "{\n";
+  os << "  \"gdcm_version\": \"" << gdcm::Version::GetVersion() << "\",\n";
+  os << "  \"benchmarks\": [";
+  for( size_t i = 0; i < results.size(); ++i )
+    {
+    const Result &r = results[i];
+    os << (i ? ",\n" : "\n");
+    os << "    { \"name\": \"" << r.Name << "\""
+      << ", \"status\": \"" << (r.Success ? "ok" : "error") << "\""
+      << ", \"iterations\": " << r.Iterations
+      << std::fixed << std::setprecision(6)
+      << ", \"seconds\": " << r.Seconds
+      << std::setprecision(3)
+      << ", \"mb_per_s\": " << r.MBPerSecond
+      << ", \"files_per_s\": " << r.FilesPerSecond
+      << ", \"allocations_per_file\": " << r.AllocationsPerFile
+      << " }";
+    os.unsetf( std::ios::fixed );
+    }
+  os << "\n  ]\n}\n";
+}
+
+void PrintHelp()
+{
+  std::cout << "gdcmbench: gdcm " << gdcm::Version::GetVersion() << "\n";
+  std::cout << "Usage: gdcmbench [OPTION]\n";
+  std::cout << "Run performance benchmarks on synthetic data sets, print JSON results.\n";
+  std::cout << "  --filter <str>    only run benchmarks whose name contains str\n";
+  std::cout << "  --min-time <sec>  minimum time spent in each benchmark (default 0.5)\n";
+  std::cout << "  --output <file>   write the JSON results to file\n";
+  std::cout << "  --tmpdir <dir>    directory for the on-disk benchmarks (default: gdcmbench.tmp)\n";
+  std::cout << "  --list            list the benchmarks and exit\n";
+  std::cout << "  --quick           run each benchmark once\n";
+}
+
+} // end anonymous namespace
+
+int main(int argc, char *argv[])
+{
+  std::string filter, output, tmpdir = "gdcmbench.tmp";
+  double mintime = 0.5;
+  bool list = false, quick = false;
+  for( int i = 1; i < argc; ++i )
+    {
+    const std::string arg = argv[i];
+    const bool hasvalue = i + 1 < argc;
+    if( arg == "--filter" && hasvalue ) filter = argv[++i];
+    else if( arg == "--min-time" && hasvalue ) mintime = atof( argv[++i] );
+    else if( arg == "--output" && hasvalue ) output = argv[++i];
+    else if( arg == "--tmpdir" && hasvalue ) tmpdir = argv[++i];
+    else if( arg == "--list" ) list = true;
+    else if( arg == "--quick" ) quick = true;
+    else
+      {
+      PrintHelp();
+      return arg == "--help" ? 0 : 1;
+      }
+    }
+  gdcm::Trace::WarningOff();
+
+  // Data sets:
+  gdcm::DataSet small;
+  InsertHeader( small, "1.2.840.10008.5.1.4.1.1.7", 1 );
+  GenerateSmallAttributes( small, 3000 );
+  gdcm::DataSet deep;
+  InsertHeader( deep, "1.2.840.10008.5.1.4.1.1.88.33", 2 );
+  GenerateDeepSequences( deep, 6, 3 );
+  const std::string smallblob = WriteDataSet( small, gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  const std::string smallimplicitblob = WriteDataSet( small, gdcm::TransferSyntax::ImplicitVRLittleEndian );
+  const std::string smallbeblob = WriteDataSet( small, gdcm::TransferSyntax::ExplicitVRBigEndian );
+  const std::string deepblob = WriteDataSet( deep, gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  const std::string deflatedblob = WriteDataSet( deep, gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian );
+
+  // Images:
+  gdcm::SmartPointer<gdcm::Image> rawimage = CreateImage( 512, 512, 8 );
+  const gdcm::Image &raw = *rawimage;
+  struct Encoding { const char *Name; gdcm::TransferSyntax::TSType TS; };
+  const Encoding encodings[] = {
+    { "raw-multiframe", gdcm::TransferSyntax::ExplicitVRLittleEndian },
+    { "raw-big-endian", gdcm::TransferSyntax::ExplicitVRBigEndian },
+    { "rle-multiframe", gdcm::TransferSyntax::RLELossless },
+    { "jpegls-multiframe", gdcm::TransferSyntax::JPEGLSLossless },
+    { "j2k-multiframe", gdcm::TransferSyntax::JPEG2000Lossless },
+  };
+  const size_t nencodings = sizeof(encodings) / sizeof(*encodings);
+  std::vector<std::string> imageblobs( nencodings );
+  std::vector<gdcm::Image> images( nencodings );
+  std::vector< std::vector<char> > buffers( nencodings );
+  for( size_t i = 0; i < nencodings; ++i )
+    {
+    imageblobs[i] = WriteImage( raw, encodings[i].TS );
+    std::istringstream is( imageblobs[i] );
+    gdcm::ImageReader reader;
+    reader.SetStream( is );
+    if( imageblobs[i].empty() || !reader.Read() )
+      {
+      std::cerr << "Could not generate: " << encodings[i].Name << std::endl;
+      return 1;
+      }
+    images[i] = reader.GetImage();
+    buffers[i].resize( images[i].GetBufferLength() );
+    }
+
+  // Rescale / LUT inputs:
+  std::vector<char> rawbuffer( raw.GetBufferLength() );
+  raw.GetBuffer( rawbuffer.data() );
+  gdcm::Rescaler rescaler;
+  rescaler.SetIntercept( -1024 );
+  rescaler.SetSlope( 2 );
+  rescaler.SetPixelFormat( raw.GetPixelFormat() );
+  const gdcm::PixelFormat rescaledpf = rescaler.ComputeInterceptSlopePixelType();
+  std::vector<char> rescaled( rawbuffer.size() / 2 * rescaledpf.GetPixelSize() );
+  gdcm::LookupTable lut;
+  lut.Allocate( 8 );
+  std::vector<unsigned char> ramp( 256 );
+  for( unsigned int i = 0; i < 256; ++i ) ramp[i] = (unsigned char)i;
+  lut.InitializeRedLUT( 256, 0, 8 );
+  lut.InitializeGreenLUT( 256, 0, 8 );
+  lut.InitializeBlueLUT( 256, 0, 8 );
+  lut.SetRedLUT( ramp.data(), 256 );
+  lut.SetGreenLUT( ramp.data(), 256 );
+  lut.SetBlueLUT( ramp.data(), 256 );
+  const std::vector<char> palette( rawbuffer.begin(), rawbuffer.begin() + rawbuffer.size() / 2 );
+  std::vector<char> rgb( palette.size() * 3 );
+
+  // Scanner input, written on demand:
+  const unsigned int nfiles = 200;
+  gdcm::Directory::FilenamesType filenames;
+
+  std::vector<Benchmark> benchmarks;
+  benchmarks.push_back( MakeRead( "small-attributes", smallblob, false ) );
+  benchmarks.push_back( MakeRead( "small-attributes-implicit", smallimplicitblob, false ) );
+  benchmarks.push_back( MakeRead( "small-attributes-big-endian", smallbeblob, false ) );
+  benchmarks.push_back( MakeRead( "deep-sequences", deepblob, false ) );
+  benchmarks.push_back( MakeRead( "deep-sequences", deepblob, true ) );
+  benchmarks.push_back( MakeReadArena( "small-attributes", smallblob ) );
+  benchmarks.push_back( MakeReadArena( "deep-sequences", deepblob ) );
+  benchmarks.push_back( MakeRead( "deep-sequences-deflated", deflatedblob, false ) );
+  for( size_t i = 0; i < nencodings; ++i )
+    {
+    benchmarks.push_back( MakeRead( encodings[i].Name, imageblobs[i], false ) );
+    }
+  benchmarks.push_back( MakeReadUpToTag( "small-attributes", smallblob, gdcm::Tag(0x0020,0x000d) ) );
+  benchmarks.push_back( MakeReadUpToTag( "raw-multiframe", imageblobs[0], gdcm::Tag(0x0028,0xffff) ) );
+    {
+    Benchmark b;
+    b.Name = "scan/small-files";
+    b.Run = [&]() {
+      if( filenames.empty() )
+        {
+        if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+          gdcm::System::MakeDirectory( tmpdir.c_str() );
+        for( unsigned int i = 0; i < nfiles; ++i )
+          {
+          std::ostringstream fn;
+          fn << tmpdir << "/file" << i << ".dcm";
+          gdcm::DataSet ds = small;
+          InsertHeader( ds, "1.2.840.10008.5.1.4.1.1.7", 100 + i );
+          const std::string blob = WriteDataSet( ds, gdcm::TransferSyntax::ExplicitVRLittleEndian );
+          std::ofstream of( fn.str().c_str(), std::ios::binary );
+          of.write( blob.data(), blob.size() );
+          if( !of ) return false;
+          filenames.push_back( fn.str() );
+          }
+        }
+      gdcm::Scanner scanner;
+      scanner.AddTag( gdcm::Tag(0x0008,0x0018) );
+      scanner.AddTag( gdcm::Tag(0x0010,0x0010) );
+      scanner.AddTag( gdcm::Tag(0x0020,0x000e) );
+      return scanner.Scan( filenames );
+    };
+    b.BytesPerIteration = nfiles * smallblob.size();
+    b.FilesPerIteration = nfiles;
+    benchmarks.push_back( b );
+    }
+  for( size_t i = 0; i < nencodings; ++i )
+    {
+    benchmarks.push_back( MakeDecode( encodings[i].Name, images[i], buffers[i] ) );
+    }
+  for( size_t i = 2; i < nencodings; ++i )
+    {
+    benchmarks.push_back( MakeCode( encodings[i].Name, raw, encodings[i].TS ) );
+    }
+    {
+    Benchmark b;
+    b.Name = "rescale/uint12-to-" + std::string( rescaledpf.GetScalarTypeAsString() );
+    b.Run = [&]() {
+      return rescaler.Rescale( rescaled.data(), rawbuffer.data(), rawbuffer.size() );
+    };
+    b.BytesPerIteration = rawbuffer.size();
+    b.FilesPerIteration = 1;
+    benchmarks.push_back( b );
+    }
+    {
+    Benchmark b;
+    b.Name = "lut/palette8";
+    b.Run = [&]() {
+      return lut.Decode( rgb.data(), rgb.size(), palette.data(), palette.size() );
+    };
+    b.BytesPerIteration = palette.size();
+    b.FilesPerIteration = 1;
+    benchmarks.push_back( b );
+    }
+  benchmarks.push_back( MakeWrite( "small-attributes", small, gdcm::TransferSyntax::ExplicitVRLittleEndian, smallblob.size() ) );
+  benchmarks.push_back( MakeWrite( "deep-sequences", deep, gdcm::TransferSyntax::ExplicitVRLittleEndian, deepblob.size() ) );
+  benchmarks.push_back( MakeWrite( "deep-sequences-deflated", deep, gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian, deepblob.size() ) );
+
+  std::vector<Result> results;
+  for( size_t i = 0; i < benchmarks.size(); ++i )
+    {
+    const Benchmark &b = benchmarks[i];
+    if( !filter.empty() && b.Name.find( filter ) == std::string::npos ) continue;
+    if( list )
+      {
+      std::cout << b.Name << std::endl;
+      continue;
+      }
+    results.push_back( RunBenchmark( b, mintime, quick ) );
+    }
+
+  for( size_t i = 0; i < filenames.size(); ++i )
+    gdcm::System::RemoveFile( filenames[i].c_str() );
+  if( !filenames.empty() )
+    gdcm::System::DeleteDirectory( tmpdir.c_str() );
+  if( list ) return 0;
+
+  if( output.empty() )
+    {
+    PrintJSON( std::cout, results );
+    }
+  else
+    {
+    std::ofstream os( output.c_str() );
+    PrintJSON( os, results );
+    if( !os )
+      {
+      std::cerr << "Could not write: " << output << std::endl;
+      return 1;
+      }
+    }
+  for( size_t i = 0; i < results.size(); ++i )
+    if( !results[i].Success ) return 1;
+  return 0;
+}
@@ -0,0 +1,171 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmDecimalString.h"
+
+#include <iostream>
+#include <clocale>
+#include <cstring>
+#include <cstdlib>
+#include <limits>
+#include <cmath>
+
+static int TestParse(const char *s, double ref, size_t consumed)
+{
+  double v = -1;
+  const char *end = s + strlen(s);
+  const char *p = gdcm::DecimalString::Parse( s, end, v );
+  if( !p || v != ref || (size_t)(p - s) != consumed )
+    {
+    std::cerr << "Parse: " << s << " -> " << v << std::endl;
+    return 1;
+    }
+  return 0;
+}
+
+static int TestFormat(double d, const char *ref)
+{
+  char buf[16+1];
+  const unsigned int len = gdcm::DecimalString::Format( d, buf );
+  if( len != strlen(buf) || (ref && strcmp( buf, ref ) != 0) )
+    {
+    std::cerr << "Format: " << d << " -> " << buf << std::endl;
+    return 1;
+    }
+  if( len > 16 ) return 1;
+  return 0;
+}
+
+static int TestRoundTrip(double d)
+{
+  char buf[16+1];
+  const unsigned int len = gdcm::DecimalString::Format( d, buf );
+  double v;
+  if( len > 16 || !gdcm::DecimalString::Parse( buf, buf + len, v ) )
+    {
+    std::cerr << "RoundTrip: " << d << " -> " << buf << std::endl;
+    return 1;
+    }
+  // 16 characters cannot always hold the 17 digits of a double, there are
+  // at least 9 significant digits (eg. "-1.23456789e-100"):
+  if( v != d && std::abs( v - d ) > 1e-8 * std::abs( d ) )
+    {
+    std::cerr << "RoundTrip: " << d << " -> " << buf << std::endl;
+    return 1;
+    }
+  return 0;
+}
+
+static int TestAll()
+{
+  int ret = 0;
+  // fast path
+  ret += TestParse( "1.5", 1.5, 3 );
+  ret += TestParse( "  -0.25\\2", -0.25, 7 );
+  ret += TestParse( "+12", 12, 3 );
+  ret += TestParse( ".5 ", 0.5, 2 );
+  ret += TestParse( "5.", 5, 2 );
+  ret += TestParse( "1e3", 1000, 3 );
+  ret += TestParse( "2.5E-2", 0.025, 6 );
+  ret += TestParse( "0.1", 0.1, 3 );
+  ret += TestParse( "-0", 0, 2 );
+  // more than 15 significant digits, large exponent
+  ret += TestParse( "0.30000000000000004", 0.30000000000000004, 19 );
+  ret += TestParse( "123456789012345678901234", 123456789012345678901234., 24 );
+  ret += TestParse( "1.7976931348623157e308", std::numeric_limits<double>::max(), 22 );
+  ret += TestParse( "2.2250738585072014e-308", std::numeric_limits<double>::min(), 23 );
+  ret += TestParse( "1e-30", 1e-30, 5 );
+
+  // not a number
+  const char *invalid[] = { "", "  ", "abc", "-", ".", "1e", "1e+", "\\1" };
+  for( size_t i = 0; i < sizeof(invalid) / sizeof(*invalid); ++i )
+    {
+    double v = -1;
+    const char *s = invalid[i];
+    if( gdcm::DecimalString::Parse( s, s + strlen(s), v ) || v != 0 )
+      {
+      std::cerr << "Invalid: " << s << std::endl;
+      ++ret;
+      }
+    }
+  // the range is honored:
+  double v = 0;
+  const char str[] = "12345";
+  if( gdcm::DecimalString::Parse( str, str + 2, v ) != str + 2 || v != 12 ) ++ret;
+
+  // IS
+  int32_t i = 0;
+  const char is1[] = " -2147483648\\7";
+  if( gdcm::DecimalString::Parse( is1, is1 + sizeof(is1) - 1, i ) != is1 + 12
+    || i != std::numeric_limits<int32_t>::min() ) ++ret;
+  const char is2[] = "2147483648";
+  if( gdcm::DecimalString::Parse( is2, is2 + sizeof(is2) - 1, i )
+    || i != std::numeric_limits<int32_t>::max() ) ++ret;
+  const char is3[] = "1.5";
+  if( gdcm::DecimalString::Parse( is3, is3 + sizeof(is3) - 1, i ) != is3 + 1
+    || i != 1 ) ++ret;
+  char buf[12];
+  if( gdcm::DecimalString::Format( std::numeric_limits<int32_t>::min(), buf ) != 11
+    || strcmp( buf, "-2147483648" ) != 0 ) ++ret;
+  if( gdcm::DecimalString::Format( (int32_t)0, buf ) != 1
+    || strcmp( buf, "0" ) != 0 ) ++ret;
+
+  // DS layout
+  ret += TestFormat( 0, "0" );
+  ret += TestFormat( -0.0, "-0" );
+  ret += TestFormat( 0.5, ".5" );
+  ret += TestFormat( -0.5, "-.5" );
+  ret += TestFormat( 1.1, "1.1" );
+  ret += TestFormat( 100, "100" );
+  ret += TestFormat( 0.001, ".001" );
+  ret += TestFormat( 1.5e-5, "1.5e-5" );
+  ret += TestFormat( 1e20, "1e20" );
+  ret += TestFormat( 0.1 + 0.2, ".3" );
+  ret += TestFormat( 1234567890123456., "1234567890123456" );
+  ret += TestFormat( 12345678901234567., "1.23456789012e16" );
+  ret += TestFormat( -std::numeric_limits<double>::max(), nullptr );
+  ret += TestFormat( std::numeric_limits<double>::denorm_min(), nullptr );
+
+  const double values[] = { 1. / 3, -2. / 3, 3.14159265358979, 1e-7 / 3,
+    123456.789, -0.000123456789, 6.02214076e23, 0.7071067811865476,
+    std::numeric_limits<double>::max(), std::numeric_limits<double>::min() };
+  for( size_t k = 0; k < sizeof(values) / sizeof(*values); ++k )
+    {
+    ret += TestRoundTrip( values[k] );
+    }
+  srand( 42 );
+  for( int k = 0; k < 10000; ++k )
+    {
+    const double d = ((double)rand() / RAND_MAX - 0.5) * pow( 10., rand() % 40 - 20 );
+    ret += TestRoundTrip( d );
+    }
+  return ret;
+}
+
+int TestDecimalString(int, char *[])
+{
+  int ret = TestAll();
+  // Same results with a locale using ',' as decimal separator, when there is
+  // one on the system:
+  const char *locales[] = { "fr_FR.UTF-8", "de_DE.UTF-8", "fr_FR", "de_DE", "French", "German" };
+  for( size_t i = 0; i < sizeof(locales) / sizeof(*locales); ++i )
+    {
+    if( setlocale( LC_ALL, locales[i] ) )
+      {
+      ret += TestAll();
+      setlocale( LC_ALL, "C" );
+      break;
+      }
+    }
+  return ret;
+}
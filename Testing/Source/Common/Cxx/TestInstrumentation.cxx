@@ -0,0 +1,94 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmInstrumentation.h"
+
+#include <iostream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstring>
+
+int TestInstrumentation(int, char *[])
+{
+  gdcm::Instrumentation::EnabledOff();
+  gdcm::Instrumentation::Reset();
+
+  // disabled: nothing is recorded
+    {
+    gdcm::InstrumentationTimer timer( gdcm::Instrumentation::DecodeRLE );
+    if( timer.IsActive() ) return 1;
+    timer.SetBytes( 42 );
+    }
+  gdcm::Instrumentation::Add( gdcm::Instrumentation::Read, 10, 10 );
+  if( gdcm::Instrumentation::GetCount( gdcm::Instrumentation::DecodeRLE ) != 0 ) return 1;
+  if( gdcm::Instrumentation::GetCount( gdcm::Instrumentation::Read ) != 0 ) return 1;
+
+  gdcm::Instrumentation::EnabledOn();
+  if( !gdcm::Instrumentation::GetEnabled() ) return 1;
+    {
+    gdcm::InstrumentationTimer timer( gdcm::Instrumentation::DecodeRLE );
+    if( !timer.IsActive() ) return 1;
+    timer.SetBytes( 42 );
+    std::this_thread::sleep_for( std::chrono::milliseconds(2) );
+    }
+    {
+    gdcm::InstrumentationTimer timer( gdcm::Instrumentation::DecodeRLE );
+    timer.Cancel();
+    }
+  if( gdcm::Instrumentation::GetCount( gdcm::Instrumentation::DecodeRLE ) != 1 ) return 1;
+  if( gdcm::Instrumentation::GetBytes( gdcm::Instrumentation::DecodeRLE ) != 42 ) return 1;
+  if( gdcm::Instrumentation::GetSeconds( gdcm::Instrumentation::DecodeRLE ) < 0.001 ) return 1;
+
+  // counters are shared by all threads:
+  std::vector<std::thread> threads;
+  for( int t = 0; t < 4; ++t )
+    {
+    threads.emplace_back( []() {
+      for( int i = 0; i < 1000; ++i )
+        {
+        gdcm::Instrumentation::Add( gdcm::Instrumentation::PDUSend, 1, 3 );
+        }
+    } );
+    }
+  for( size_t t = 0; t < threads.size(); ++t ) threads[t].join();
+  if( gdcm::Instrumentation::GetCount( gdcm::Instrumentation::PDUSend ) != 4000 ) return 1;
+  if( gdcm::Instrumentation::GetBytes( gdcm::Instrumentation::PDUSend ) != 12000 ) return 1;
+
+  // only the probes which recorded something are dumped:
+  std::ostringstream os;
+  gdcm::Instrumentation::PrintJSON( os );
+  const std::string json = os.str();
+  if( json.find( "\"decode/rle\": { \"count\": 1," ) == std::string::npos
+    || json.find( "\"pdu/send\": { \"count\": 4000," ) == std::string::npos
+    || json.find( "\"read\"" ) != std::string::npos )
+    {
+    std::cerr << json << std::endl;
+    return 1;
+    }
+
+  for( int i = 0; i < gdcm::Instrumentation::NumberOfProbes; ++i )
+    {
+    if( !gdcm::Instrumentation::GetProbeName( (gdcm::Instrumentation::ProbeType)i ) ) return 1;
+    }
+
+  gdcm::Instrumentation::Reset();
+  if( gdcm::Instrumentation::GetCount( gdcm::Instrumentation::PDUSend ) != 0 ) return 1;
+  std::ostringstream empty;
+  gdcm::Instrumentation::PrintJSON( empty );
+  if( empty.str() != "{}\n" ) return 1;
+  gdcm::Instrumentation::EnabledOff();
+
+  return 0;
+}
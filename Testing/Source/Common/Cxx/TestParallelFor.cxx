@@ -0,0 +1,88 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmParallelFor.h"
+
+#include <atomic>
+#include <iostream>
+#include <vector>
+
+static int TestParallelForRun(size_t n, unsigned int nthreads)
+{
+  const unsigned int nt = gdcm::ParallelFor::GetNumberOfThreads( nthreads, n );
+  std::vector< std::atomic<int> > count( n );
+  for( size_t i = 0; i < n; ++i ) count[i] = 0;
+  std::atomic<bool> badthread( false );
+  if( !gdcm::ParallelFor::Run( n, nthreads, [&](size_t i, unsigned int t) {
+      if( t >= nt ) badthread = true;
+      ++count[i];
+      return true;
+    } ) )
+    {
+    return 1;
+    }
+  if( badthread ) return 1;
+  // every item is processed once:
+  for( size_t i = 0; i < n; ++i )
+    {
+    if( count[i] != 1 )
+      {
+      std::cerr << "Item " << i << " processed " << count[i] << " times with "
+        << nthreads << " threads" << std::endl;
+      return 1;
+      }
+    }
+
+  // a failure stops the loop:
+  std::atomic<size_t> processed( 0 );
+  if( n && gdcm::ParallelFor::Run( n, nthreads, [&](size_t i, unsigned int) {
+      ++processed;
+      return i != 0;
+    } ) )
+    {
+    return 1;
+    }
+  if( nt == 1 && processed != (n ? 1 : 0) ) return 1;
+  return 0;
+}
+
+int TestParallelFor(int, char *[])
+{
+  if( gdcm::ParallelFor::GetNumberOfThreads( 1, 100 ) != 1 ) return 1;
+  if( gdcm::ParallelFor::GetNumberOfThreads( 8, 3 ) != 3 ) return 1;
+  if( gdcm::ParallelFor::GetNumberOfThreads( 8, 0 ) != 1 ) return 1;
+  if( gdcm::ParallelFor::GetNumberOfThreads( 0, 1 ) != 1 ) return 1;
+  if( gdcm::ParallelFor::GetNumberOfThreads( 0, 1000 ) < 1 ) return 1;
+
+  const unsigned int nthreads[] = { 1, 2, 4, 0 };
+  const size_t sizes[] = { 0, 1, 7, 1000 };
+  for( int t = 0; t < 4; ++t )
+    {
+    for( int s = 0; s < 4; ++s )
+      {
+      if( TestParallelForRun( sizes[s], nthreads[t] ) ) return 1;
+      }
+    }
+
+  // single thread: items are processed in order, on the calling thread
+  std::vector<size_t> order;
+  gdcm::ParallelFor::Run( 5, 1, [&](size_t i, unsigned int) {
+    order.push_back( i );
+    return true;
+  } );
+  for( size_t i = 0; i < order.size(); ++i )
+    {
+    if( order[i] != i ) return 1;
+    }
+  return order.size() == 5 ? 0 : 1;
+}
@@ -15,6 +15,9 @@
 
 #include "gdcmSwapper.h"
 
+#include <sstream>
+#include <cstring>
+
 int TestByteValue(int, char *[])
 {
   const char array[] = "GDCM";
@@ -63,5 +66,42 @@ int TestByteValue(int, char *[])
     return 1;
     }
 
+  // Short values are stored within the ByteValue itself:
+  const char *bv1p = bv1.GetPointer();
+  if( bv1p < (const char*)&bv1 || bv1p >= (const char*)(&bv1 + 1) )
+    {
+    return 1;
+    }
+  // and keep their content when growing out of it:
+  const char longer[] = "1.2.840.10008.1.2.4.50";
+  gdcm::ByteValue bv6( "1.2.840", 8 );
+  bv6.SetLength( 22 );
+  if( memcmp(bv6.GetPointer(), "1.2.840\0\0\0\0\0\0\0\0\0\0\0\0\0\0\0", 22 ) != 0 )
+    {
+    return 1;
+    }
+  memcpy( bv6.GetVoidPointer(), longer, 22 );
+  gdcm::ByteValue bv7( longer, 22 );
+  if( !(bv6 == bv7) )
+    {
+    return 1;
+    }
+  bv6.SetLength( 4 );
+  bv6.Append( bv1 );
+  if( bv6.GetLength() != 8 || memcmp(bv6.GetPointer(), "1.2.GDCM", 8 ) != 0 )
+    {
+    return 1;
+    }
+  bv7 = bv1;
+  if( !(bv7 == bv1) || bv7.GetPointer() == bv1.GetPointer() )
+    {
+    return 1;
+    }
+  bv7.Clear();
+  if( bv7.GetPointer() )
+    {
+    return 1;
+    }
+
   return 0;
 }
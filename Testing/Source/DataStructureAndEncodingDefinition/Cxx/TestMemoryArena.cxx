@@ -0,0 +1,152 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmMemoryArena.h"
+#include "gdcmWriter.h"
+#include "gdcmReader.h"
+#include "gdcmFile.h"
+#include "gdcmDataElement.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmTransferSyntax.h"
+
+#include <sstream>
+#include <vector>
+#include <cstring>
+
+static void Insert(gdcm::DataSet &ds, uint16_t g, uint16_t e, gdcm::VR const &vr, const std::string &value)
+{
+  gdcm::DataElement de( gdcm::Tag(g,e), 0, vr );
+  de.SetByteValue( value.c_str(), (uint32_t)value.size() );
+  ds.Insert( de );
+}
+
+static bool IsEqual(const gdcm::DataSet &ds1, const gdcm::DataSet &ds2)
+{
+  if( ds1.Size() != ds2.Size() ) return false;
+  gdcm::DataSet::ConstIterator it1 = ds1.Begin();
+  gdcm::DataSet::ConstIterator it2 = ds2.Begin();
+  for( ; it1 != ds1.End(); ++it1, ++it2 )
+    {
+    if( !(*it1 == *it2) ) return false;
+    }
+  return true;
+}
+
+static std::string Write(const gdcm::File &file, gdcm::TransferSyntax::TSType ts)
+{
+  gdcm::SmartPointer<gdcm::File> copy = new gdcm::File( file );
+  copy->GetHeader().SetDataSetTransferSyntax( ts );
+  std::ostringstream os;
+  gdcm::Writer w;
+  w.SetStream( os );
+  w.SetFile( *copy );
+  if( !w.Write() ) return std::string();
+  return os.str();
+}
+
+int TestMemoryArena(int, char *[])
+{
+  // Allocations are aligned and come from as few blocks as possible:
+    {
+    gdcm::SmartPointer<gdcm::MemoryArena> arena = new gdcm::MemoryArena( 4096 );
+    if( arena->GetMaximumAllocationSize() != 1024 ) return 1;
+    for( size_t i = 1; i <= 64; ++i )
+      {
+      void *p = arena->Allocate( i );
+      if( (size_t)p % 16 ) return 1;
+      memset( p, 0xff, i );
+      }
+    if( arena->GetNumberOfBlocks() != 1 ) return 1;
+    if( arena->GetAllocatedSize() != 16 * (16 + 32 + 48 + 64) ) return 1;
+    arena->Allocate( 2048 );
+    if( arena->GetNumberOfBlocks() != 2 ) return 1;
+    }
+
+  gdcm::File file;
+  gdcm::DataSet &ds = file.GetDataSet();
+  Insert(ds, 0x0008, 0x0016, gdcm::VR::UI, "1.2.840.10008.5.1.4.1.1.7");
+  Insert(ds, 0x0008, 0x0018, gdcm::VR::UI, "1.2.3.4.5.6.7.8.9");
+  Insert(ds, 0x0010, 0x0010, gdcm::VR::PN, "Doe^John");
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+  for( unsigned int i = 0; i < 500; ++i )
+    {
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    std::ostringstream text;
+    text << "Item " << i;
+    std::string value = text.str();
+    if( value.size() % 2 ) value.push_back( ' ' );
+    Insert(item.GetNestedDataSet(), 0x0008, 0x0104, gdcm::VR::LO, value);
+    sq->AddItem( item );
+    }
+  gdcm::DataElement sqde( gdcm::Tag(0x0040,0xa730) );
+  sqde.SetVR( gdcm::VR::SQ );
+  sqde.SetValue( *sq );
+  sqde.SetVLToUndefined();
+  ds.Insert( sqde );
+  // too large for the arena:
+  std::string pixels( 512 * 512, 'x' );
+  Insert(ds, 0x7fe0, 0x0010, gdcm::VR::OB, pixels);
+
+  const gdcm::TransferSyntax::TSType tss[] = {
+    gdcm::TransferSyntax::ExplicitVRLittleEndian,
+    gdcm::TransferSyntax::ImplicitVRLittleEndian,
+    gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian,
+  };
+  for( size_t t = 0; t < sizeof(tss) / sizeof(*tss); ++t )
+    {
+    const std::string buffer = Write( file, tss[t] );
+    if( buffer.empty() ) return 1;
+
+    std::istringstream is1( buffer );
+    gdcm::Reader ref;
+    ref.SetStream( is1 );
+    if( !ref.Read() ) return 1;
+    if( ref.GetFile().GetMemoryArena() ) return 1;
+
+    gdcm::DataElement kept;
+    gdcm::ByteValue copy;
+      {
+      std::istringstream is2( buffer );
+      gdcm::Reader reader;
+      reader.SetStream( is2 );
+      reader.SetUseMemoryArena( true );
+      if( !reader.Read() ) return 1;
+      const gdcm::MemoryArena *arena = reader.GetFile().GetMemoryArena();
+      if( !arena || !arena->GetAllocatedSize() ) return 1;
+      const gdcm::DataSet &ads = reader.GetFile().GetDataSet();
+      if( !IsEqual( ads, ref.GetFile().GetDataSet() ) )
+        {
+        std::cerr << "Data sets differ: " << t << std::endl;
+        return 1;
+        }
+      kept = ads.GetDataElement( gdcm::Tag(0x0010,0x0010) );
+      copy = *ads.GetDataElement( gdcm::Tag(0x0008,0x0018) ).GetByteValue();
+      const gdcm::ByteValue *pixeldata = ads.GetDataElement( gdcm::Tag(0x7fe0,0x0010) ).GetByteValue();
+      if( !pixeldata || pixeldata->GetLength() != pixels.size()
+        || memcmp( pixeldata->GetPointer(), pixels.data(), pixels.size() ) != 0 ) return 1;
+      }
+    // values outlive the File they were read into:
+    const gdcm::ByteValue *bv = kept.GetByteValue();
+    if( !bv || bv->GetLength() != 8 || memcmp( bv->GetPointer(), "Doe^John", 8 ) != 0 ) return 1;
+    if( copy.GetLength() != 18 || memcmp( copy.GetPointer(), "1.2.3.4.5.6.7.8.9", 18 ) != 0 ) return 1;
+    // and can still be modified:
+    gdcm::ByteValue *mbv = const_cast<gdcm::ByteValue*>( bv );
+    mbv->SetLength( 16 );
+    if( memcmp( mbv->GetPointer(), "Doe^John\0\0\0\0\0\0\0\0", 16 ) != 0 ) return 1;
+    mbv->Append( *mbv );
+    if( mbv->GetLength() != 32 || memcmp( mbv->GetPointer() + 16, "Doe^John", 8 ) != 0 ) return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,187 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmSequenceOfItems.h"
+#include "gdcmReader.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+#include "gdcmExplicitDataElement.h"
+#include "gdcmImplicitDataElement.h"
+
+#include <sstream>
+#include <cstring>
+
+// Lazy sequence parsing (Reader::SetLazySequenceParsing)
+static gdcm::DataElement CreateSequence(const gdcm::Tag &t, unsigned int nitems,
+  bool undefined, unsigned int depth, bool explicitvr)
+{
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+  for( unsigned int i = 0; i < nitems; ++i )
+    {
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    gdcm::DataSet &nested = item.GetNestedDataSet();
+    gdcm::Attribute<0x0008,0x1150> refclass = { "1.2.840.10008.5.1.4.1.1.2" };
+    nested.Insert( refclass.GetAsDataElement() );
+    gdcm::Attribute<0x0008,0x1155> refinstance = { i % 2 ? "1.2.34" : "1.2.3.45" };
+    nested.Insert( refinstance.GetAsDataElement() );
+    if( depth )
+      {
+      nested.Insert( CreateSequence( gdcm::Tag(0x0008,0x1140), 2, !undefined, depth - 1, explicitvr ) );
+      }
+    sq->AddItem( item );
+    }
+  gdcm::DataElement de( t );
+  de.SetVR( gdcm::VR::SQ );
+  de.SetValue( *sq );
+  de.SetVLToUndefined();
+  if( !undefined )
+    {
+    sq->SetLength( 0 );
+    sq->SetLength( explicitvr ? sq->ComputeLength<gdcm::ExplicitDataElement>()
+      : sq->ComputeLength<gdcm::ImplicitDataElement>() );
+    de.SetVL( sq->GetLength() );
+    }
+  return de;
+}
+
+static bool Write(const gdcm::TransferSyntax &ts, std::string &out)
+{
+  gdcm::Writer w;
+  gdcm::File &file = w.GetFile();
+  gdcm::DataSet &ds = file.GetDataSet();
+  gdcm::Attribute<0x0008,0x0016> sopclass = { "1.2.840.10008.5.1.4.1.1.7" };
+  ds.Insert( sopclass.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0018> sopinstance = { "1.2.3.4.5.6" };
+  ds.Insert( sopinstance.GetAsDataElement() );
+  const bool explicitvr = ts.IsExplicit();
+  ds.Insert( CreateSequence( gdcm::Tag(0x0008,0x1115), 3, true, 2, explicitvr ) );
+  ds.Insert( CreateSequence( gdcm::Tag(0x0008,0x1120), 2, false, 0, explicitvr ) );
+  gdcm::Attribute<0x0010,0x0010> patientname = { "Lazy^Patient" };
+  ds.Insert( patientname.GetAsDataElement() );
+  file.GetHeader().SetDataSetTransferSyntax( ts );
+  std::ostringstream os;
+  w.SetStream( os );
+  if( !w.Write() ) return false;
+  out = os.str();
+  return true;
+}
+
+static int TestLazy(const gdcm::TransferSyntax &ts)
+{
+  std::string input;
+  if( !Write( ts, input ) )
+    {
+    std::cerr << "Could not write" << std::endl;
+    return 1;
+    }
+
+  std::istringstream is1( input );
+  gdcm::Reader eager;
+  eager.SetStream( is1 );
+  if( !eager.Read() ) return 1;
+
+  std::istringstream is2( input );
+  gdcm::Reader lazy;
+  lazy.SetStream( is2 );
+  lazy.SetLazySequenceParsing( true );
+  if( !lazy.Read() ) return 1;
+  if( gdcm::SequenceOfItems::GetLazyParsing( is2 ) ) return 1;
+
+  const gdcm::DataSet &ds = lazy.GetFile().GetDataSet();
+  const gdcm::Tag tsq(0x0008,0x1115);
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = ds.GetDataElement( tsq ).GetValueAsSQ();
+  if( !sq || !sq->IsDeferred() )
+    {
+    std::cerr << "Sequence was parsed" << std::endl;
+    return 1;
+    }
+  // Attributes after the sequences were read:
+  gdcm::Attribute<0x0010,0x0010> pn;
+  pn.SetFromDataSet( ds );
+  if( pn.GetValue() != "Lazy^Patient" ) return 1;
+
+  // Unparsed sequences are written back as read:
+  std::ostringstream os;
+  gdcm::Writer w;
+  w.SetFile( lazy.GetFile() );
+  w.SetStream( os );
+  if( !w.Write() || os.str() != input )
+    {
+    std::cerr << "Could not write back unparsed sequences" << std::endl;
+    return 1;
+    }
+  if( !sq->IsDeferred() ) return 1;
+
+  // First access parses the items:
+  if( sq->GetNumberOfItems() != 3 || sq->IsDeferred() ) return 1;
+  const gdcm::DataSet &nested = sq->GetItem( 2 ).GetNestedDataSet();
+  gdcm::Attribute<0x0008,0x1155> uid;
+  uid.SetFromDataSet( nested );
+  if( uid.GetValue() != "1.2.34" ) return 1;
+  // nested sequences are parsed on demand too (defined length sequences
+  // are already read as bytes in Implicit VR):
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq2 =
+    nested.GetDataElement( gdcm::Tag(0x0008,0x1140) ).GetValueAsSQ();
+  if( !sq2 || sq2->IsDeferred() != ts.IsExplicit() ) return 1;
+  if( sq2->GetNumberOfItems() != 2 ) return 1;
+
+  // Same content as an eager read:
+  const gdcm::DataSet &eagerds = eager.GetFile().GetDataSet();
+  gdcm::DataSet::ConstIterator it1 = eagerds.Begin(), it2 = ds.Begin();
+  for( ; it1 != eagerds.End() && it2 != ds.End(); ++it1, ++it2 )
+    {
+    if( !(*it1 == *it2) )
+      {
+      std::cerr << "Lazy read differs for " << it1->GetTag() << std::endl;
+      return 1;
+      }
+    }
+  if( it1 != eagerds.End() || it2 != ds.End() ) return 1;
+
+  return 0;
+}
+
+// A Sequence Delimitation Item in a defined length Sequence fails the
+// structure check, the sequence is parsed right away by the regular code:
+static int TestBrokenSequence()
+{
+  const char item[] = {
+    '\xfe', '\xff', '\x00', '\xe0', 10, 0, 0, 0, // Item, length 10
+    0x08, 0x00, 0x50, 0x11, 'U', 'I', 2, 0, '1', 0, // (0008,1150) UI "1"
+    '\xfe', '\xff', '\xdd', '\xe0', 0, 0, 0, 0 // Sequence Delimitation Item
+  };
+  std::string bytes( item, sizeof(item) );
+  std::istringstream is( bytes );
+  gdcm::SequenceOfItems::SetLazyParsing( is, true );
+  gdcm::SequenceOfItems sq;
+  sq.SetLength( (uint32_t)bytes.size() );
+  sq.Read<gdcm::ExplicitDataElement,gdcm::SwapperNoOp>( is );
+  if( sq.IsDeferred() )
+    {
+    std::cerr << "Broken sequence was not parsed" << std::endl;
+    return 1;
+    }
+  if( sq.GetNumberOfItems() != 1 || is.tellg() != (std::streamoff)bytes.size() ) return 1;
+  return 0;
+}
+
+int TestSequenceOfItems4(int, char *[])
+{
+  int ret = 0;
+  ret += TestBrokenSequence();
+  ret += TestLazy( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  ret += TestLazy( gdcm::TransferSyntax::ImplicitVRLittleEndian );
+  ret += TestLazy( gdcm::TransferSyntax::ExplicitVRBigEndian );
+  return ret;
+}
@@ -0,0 +1,120 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmWriter.h"
+#include "gdcmFile.h"
+#include "gdcmDataElement.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmTransferSyntax.h"
+
+#include <sstream>
+#include <vector>
+#include <cstring>
+
+// Writing with SetPixelDataBuffer should produce the exact same file as
+// when Pixel Data is stored in the DataSet
+static void Insert(gdcm::DataSet &ds, uint16_t g, uint16_t e, gdcm::VR const &vr, const char *value)
+{
+  gdcm::DataElement de( gdcm::Tag(g,e), 0, vr );
+  de.SetByteValue( value, (uint32_t)strlen(value) );
+  ds.Insert( de );
+}
+
+static int TestWriter3Impl(gdcm::TransferSyntax::TSType tstype, size_t pixellen)
+{
+  // Writer keeps a reference on the File, do not allocate on the stack
+  gdcm::SmartPointer<gdcm::File> file = new gdcm::File;
+  gdcm::DataSet &ds = file->GetDataSet();
+  Insert(ds, 0x0008, 0x0016, gdcm::VR::UI, "1.2.840.10008.5.1.4.1.1.7");
+  Insert(ds, 0x0008, 0x0018, gdcm::VR::UI, "1.2.3.4.5.6.7.8.9");
+  Insert(ds, 0x0010, 0x0010, gdcm::VR::PN, "Doe^John");
+    {
+    gdcm::Item item;
+    gdcm::DataElement de( gdcm::Tag(0x0008,0x0100), 0, gdcm::VR::SH );
+    de.SetByteValue( "CODE", 4 );
+    item.GetNestedDataSet().Insert( de );
+    gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+    sq->AddItem( item );
+    gdcm::DataElement sqde( gdcm::Tag(0x0008,0x1032) );
+    sqde.SetVR( gdcm::VR::SQ );
+    sqde.SetValue( *sq );
+    sqde.SetVLToUndefined();
+    ds.Insert( sqde );
+    }
+  Insert(ds, 0xfffc, 0xfffc, gdcm::VR::OB, "PADDING!");
+  file->GetHeader().SetDataSetTransferSyntax( tstype );
+
+  std::vector<char> pixels( pixellen );
+  for( size_t i = 0; i < pixellen; ++i ) pixels[i] = (char)(i * 13);
+
+  // reference: regular code path
+  gdcm::SmartPointer<gdcm::File> ref = new gdcm::File( *file );
+  gdcm::DataElement pixeldata( gdcm::Tag(0x7fe0,0x0010), 0, gdcm::VR::OW );
+  pixeldata.SetByteValue( pixels.data(), (uint32_t)pixellen );
+  ref->GetDataSet().Insert( pixeldata );
+  std::ostringstream os1;
+  gdcm::Writer w1;
+  w1.SetStream( os1 );
+  w1.SetFile( *ref );
+  if( !w1.Write() ) return 1;
+
+  // fast path, any Pixel Data found in the DataSet must be ignored:
+  gdcm::DataElement dummy( gdcm::Tag(0x7fe0,0x0010), 0, gdcm::VR::OW );
+  dummy.SetByteValue( "XX", 2 );
+  file->GetDataSet().Insert( dummy );
+  std::ostringstream os2;
+  gdcm::Writer w2;
+  w2.SetStream( os2 );
+  w2.SetFile( *file );
+  w2.SetPixelDataBuffer( pixels.data(), pixellen );
+  if( !w2.Write() ) return 1;
+
+  if( os1.str() != os2.str() )
+    {
+    std::cerr << "Output differs for: " << gdcm::TransferSyntax(tstype)
+      << " with length " << pixellen << std::endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestWriter3(int, char *[])
+{
+  const gdcm::TransferSyntax::TSType tstypes[] = {
+    gdcm::TransferSyntax::ImplicitVRLittleEndian,
+    gdcm::TransferSyntax::ExplicitVRLittleEndian,
+    gdcm::TransferSyntax::ExplicitVRBigEndian,
+    gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian,
+  };
+  int ret = 0;
+  for( size_t i = 0; i < sizeof(tstypes) / sizeof(*tstypes); ++i )
+    {
+    ret += TestWriter3Impl( tstypes[i], 512 * 512 * 2 );
+    ret += TestWriter3Impl( tstypes[i], 101 ); // odd length
+    }
+
+  // encapsulated syntax cannot take a native buffer:
+  gdcm::SmartPointer<gdcm::File> file = new gdcm::File;
+  Insert(file->GetDataSet(), 0x0008, 0x0018, gdcm::VR::UI, "1.2.3");
+  file->GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::JPEGBaselineProcess1 );
+  std::ostringstream os;
+  gdcm::Writer w;
+  w.SetStream( os );
+  w.SetFile( *file );
+  w.SetCheckFileMetaInformation( false );
+  const char buffer[4] = {};
+  w.SetPixelDataBuffer( buffer, sizeof(buffer) );
+  if( w.Write() ) ++ret;
+
+  return ret;
+}
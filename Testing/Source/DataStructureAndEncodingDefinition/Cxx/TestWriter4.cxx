@@ -0,0 +1,113 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmWriter.h"
+#include "gdcmReader.h"
+#include "gdcmFile.h"
+#include "gdcmDataElement.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmTransferSyntax.h"
+
+#include <sstream>
+#include <vector>
+#include <cstring>
+
+// Deflated Explicit VR Little Endian: chunked / multi-threaded compression
+// and in memory decompression
+static void Insert(gdcm::DataSet &ds, uint16_t g, uint16_t e, gdcm::VR const &vr, const std::string &value)
+{
+  gdcm::DataElement de( gdcm::Tag(g,e), 0, vr );
+  de.SetByteValue( value.c_str(), (uint32_t)value.size() );
+  ds.Insert( de );
+}
+
+static bool Read(std::istream &is, bool lazy, gdcm::DataSet &ds)
+{
+  gdcm::Reader reader;
+  reader.SetStream( is );
+  reader.SetLazySequenceParsing( lazy );
+  if( !reader.Read() ) return false;
+  ds = reader.GetFile().GetDataSet();
+  return true;
+}
+
+int TestWriter4(int, char *[])
+{
+  gdcm::SmartPointer<gdcm::File> file = new gdcm::File;
+  gdcm::DataSet &ds = file->GetDataSet();
+  Insert(ds, 0x0008, 0x0016, gdcm::VR::UI, "1.2.840.10008.5.1.4.1.1.88.33");
+  Insert(ds, 0x0008, 0x0018, gdcm::VR::UI, "1.2.3.4.5.6.7.8.9");
+  // a content sequence large enough to span many compression chunks:
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+  for( unsigned int i = 0; i < 2000; ++i )
+    {
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    std::ostringstream text;
+    text << "Finding " << i << ": ";
+    for( unsigned int j = 0; j < 40 + i % 17; ++j ) text << (char)('a' + (i * j) % 26);
+    std::string value = text.str();
+    if( value.size() % 2 ) value.push_back( ' ' );
+    Insert(item.GetNestedDataSet(), 0x0040, 0xa160, gdcm::VR::UT, value);
+    sq->AddItem( item );
+    }
+  gdcm::DataElement sqde( gdcm::Tag(0x0040,0xa730) );
+  sqde.SetVR( gdcm::VR::SQ );
+  sqde.SetValue( *sq );
+  sqde.SetVLToUndefined();
+  ds.Insert( sqde );
+  Insert(ds, 0x0040, 0xa493, gdcm::VR::CS, "VERIFIED");
+  file->GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::DeflatedExplicitVRLittleEndian );
+
+  std::string outputs[2];
+  const unsigned int nthreads[2] = { 1, 4 };
+  for( int i = 0; i < 2; ++i )
+    {
+    std::ostringstream os;
+    gdcm::Writer w;
+    w.SetStream( os );
+    w.SetFile( *file );
+    w.SetNumberOfThreads( nthreads[i] );
+    if( !w.Write() ) return 1;
+    outputs[i] = os.str();
+    if( outputs[i].size() % 2 )
+      {
+      std::cerr << "Odd length" << std::endl;
+      return 1;
+      }
+    }
+  // the compression does not depend on the number of threads:
+  if( outputs[0] != outputs[1] ) return 1;
+
+  gdcm::DataSet ref;
+  std::istringstream is( outputs[0] );
+  if( !Read( is, false, ref ) ) return 1;
+  if( !(ref.GetDataElement( gdcm::Tag(0x0040,0xa730) ) == sqde)
+    || ref.Size() != ds.Size() )
+    {
+    std::cerr << "Could not read back deflated data set" << std::endl;
+    return 1;
+    }
+
+  // Lazy sequences from an inflated buffer:
+  gdcm::DataSet lazy;
+  std::istringstream is2( outputs[0] );
+  if( !Read( is2, true, lazy ) ) return 1;
+  gdcm::SmartPointer<gdcm::SequenceOfItems> lazysq =
+    lazy.GetDataElement( gdcm::Tag(0x0040,0xa730) ).GetValueAsSQ();
+  if( !lazysq || !lazysq->IsDeferred() ) return 1;
+  if( lazysq->GetNumberOfItems() != 2000 ) return 1;
+  if( !(lazy.GetDataElement( gdcm::Tag(0x0040,0xa730) ) == sqde) ) return 1;
+
+  return 0;
+}
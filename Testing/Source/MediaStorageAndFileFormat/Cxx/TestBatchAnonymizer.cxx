@@ -0,0 +1,229 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmBatchAnonymizer.h"
+#include "gdcmUIDMappingTable.h"
+#include "gdcmCryptographicMessageSyntax.h"
+#include "gdcmGlobal.h"
+#include "gdcmReader.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+namespace
+{
+// No cipher available in every build: the "encrypted" content is a copy
+class CopyCryptographicMessageSyntax : public gdcm::CryptographicMessageSyntax
+{
+public:
+  bool ParseCertificateFile( const char * ) override { return true; }
+  bool ParseKeyFile( const char * ) override { return true; }
+  bool SetPassword( const char *, size_t ) override { return true; }
+  bool Encrypt(char *output, size_t &outlen, const char *array, size_t len) const override
+    {
+    if( outlen < len ) return false;
+    memcpy( output, array, len );
+    outlen = len;
+    return true;
+    }
+  bool Decrypt(char *output, size_t &outlen, const char *array, size_t len) const override
+    {
+    return Encrypt( output, outlen, array, len );
+    }
+  void SetCipherType( CipherTypes ) override {}
+  CipherTypes GetCipherType() const override { return AES256_CIPHER; }
+};
+}
+
+static const int nseries = 3;
+static const int ninstances = 4;
+
+// All files belong to the same study
+static bool WriteFile(const std::string &filename, int series, int instance)
+{
+  gdcm::Writer w;
+  gdcm::DataSet &ds = w.GetFile().GetDataSet();
+  gdcm::Attribute<0x0008,0x0016> sopclass = { "1.2.840.10008.5.1.4.1.1.7" };
+  ds.Insert( sopclass.GetAsDataElement() );
+  std::ostringstream uid;
+  uid << "1.2.3.4.5.1." << series << "." << instance;
+  gdcm::Attribute<0x0008,0x0018> sopinstance = { uid.str() };
+  ds.Insert( sopinstance.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0060> modality = { "OT" };
+  ds.Insert( modality.GetAsDataElement() );
+  gdcm::Attribute<0x0010,0x0010> patientname = { "Batch^Patient" };
+  ds.Insert( patientname.GetAsDataElement() );
+  gdcm::Attribute<0x0010,0x0020> patientid = { "BATCH01" };
+  ds.Insert( patientid.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x000d> study = { "1.2.3.4.5.2" };
+  ds.Insert( study.GetAsDataElement() );
+  std::ostringstream seriesuid;
+  seriesuid << "1.2.3.4.5.3." << series;
+  gdcm::Attribute<0x0020,0x000e> seriesinstance = { seriesuid.str() };
+  ds.Insert( seriesinstance.GetAsDataElement() );
+  w.GetFile().GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  w.SetFileName( filename.c_str() );
+  return w.Write();
+}
+
+template <uint16_t Group, uint16_t Element>
+static std::string GetUID(const std::string &filename)
+{
+  gdcm::Reader reader;
+  reader.SetFileName( filename.c_str() );
+  if( !reader.Read() ) return std::string();
+  gdcm::Attribute<Group,Element> at;
+  at.SetFromDataSet( reader.GetFile().GetDataSet() );
+  // strip the trailing padding:
+  return std::string( at.GetValue().c_str() );
+}
+
+// Every UID of outfilenames[i] is the mapping of the UID of filenames[i]
+static bool CheckMapping(gdcm::UIDMappingTable const &table,
+  gdcm::Directory::FilenamesType const &filenames,
+  gdcm::Directory::FilenamesType const &outfilenames)
+{
+  std::set<std::string> instances;
+  for( size_t i = 0; i < filenames.size(); ++i )
+    {
+    const std::string olduids[] = {
+      GetUID<0x0008,0x0018>( filenames[i] ),
+      GetUID<0x0020,0x000d>( filenames[i] ),
+      GetUID<0x0020,0x000e>( filenames[i] ) };
+    const std::string newuids[] = {
+      GetUID<0x0008,0x0018>( outfilenames[i] ),
+      GetUID<0x0020,0x000d>( outfilenames[i] ),
+      GetUID<0x0020,0x000e>( outfilenames[i] ) };
+    for( int k = 0; k < 3; ++k )
+      {
+      std::string mapped;
+      if( !table.Find( olduids[k].c_str(), mapped ) || mapped != newuids[k]
+        || newuids[k] == olduids[k] )
+        {
+        std::cerr << "Wrong mapping for " << olduids[k] << " in " << outfilenames[i] << std::endl;
+        return false;
+        }
+      }
+    instances.insert( newuids[0] );
+    }
+  return instances.size() == filenames.size();
+}
+
+int TestBatchAnonymizer(int, char *[])
+{
+  if( !gdcm::Global::GetInstance().LoadResourcesFiles() ) return 1;
+
+  const char subdir[] = "TestBatchAnonymizer";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+
+  gdcm::Directory::FilenamesType filenames, outfilenames, outfilenames2, reidfilenames;
+  for( int s = 0; s < nseries; ++s )
+    {
+    for( int i = 0; i < ninstances; ++i )
+      {
+      std::ostringstream name;
+      name << "input" << s << "_" << i << ".dcm";
+      const std::string filename = gdcm::Testing::GetTempFilename( name.str().c_str(), subdir );
+      if( !WriteFile( filename, s, i ) ) return 1;
+      filenames.push_back( filename );
+      outfilenames.push_back( gdcm::Testing::GetTempFilename( ("anon_" + name.str()).c_str(), subdir ) );
+      outfilenames2.push_back( gdcm::Testing::GetTempFilename( ("anon2_" + name.str()).c_str(), subdir ) );
+      reidfilenames.push_back( gdcm::Testing::GetTempFilename( ("reid_" + name.str()).c_str(), subdir ) );
+      }
+    }
+  const size_t nfiles = filenames.size();
+
+  CopyCryptographicMessageSyntax cms;
+  gdcm::UIDMappingTable table;
+  gdcm::BatchAnonymizer batch;
+  batch.SetNumberOfThreads( 4 );
+  batch.SetCryptographicMessageSyntax( &cms );
+  batch.SetUIDMappingTable( &table );
+  if( !batch.Anonymize( filenames, outfilenames ) )
+    {
+    std::cerr << "Could not anonymize" << std::endl;
+    return 1;
+    }
+  // one study, nseries series, one UID per instance:
+  if( table.GetNumberOfEntries() != 1 + nseries + nfiles )
+    {
+    std::cerr << "Wrong number of UIDs: " << table.GetNumberOfEntries() << std::endl;
+    return 1;
+    }
+  if( !CheckMapping( table, filenames, outfilenames ) ) return 1;
+
+  // A later run, with the saved table, gives the same UIDs:
+  const std::string mapfile = gdcm::Testing::GetTempFilename( "uidmap.txt", subdir );
+  if( !table.Save( mapfile.c_str() ) ) return 1;
+  gdcm::UIDMappingTable loaded;
+  if( !loaded.Load( mapfile.c_str() ) || loaded.GetNumberOfEntries() != table.GetNumberOfEntries() )
+    {
+    std::cerr << "Could not load " << mapfile << std::endl;
+    return 1;
+    }
+  gdcm::BatchAnonymizer batch2;
+  batch2.SetNumberOfThreads( 3 );
+  batch2.SetCryptographicMessageSyntax( &cms );
+  batch2.SetUIDMappingTable( &loaded );
+  if( !batch2.Anonymize( filenames, outfilenames2 ) ) return 1;
+  if( loaded.GetNumberOfEntries() != table.GetNumberOfEntries() ) return 1;
+  if( !CheckMapping( table, filenames, outfilenames2 ) ) return 1;
+
+  // Re-identification gives back the original UIDs:
+  gdcm::BatchAnonymizer reid;
+  reid.SetNumberOfThreads( 2 );
+  reid.SetDeidentify( false );
+  reid.SetCryptographicMessageSyntax( &cms );
+  if( !reid.Anonymize( outfilenames, reidfilenames ) ) return 1;
+  for( size_t i = 0; i < nfiles; ++i )
+    {
+    if( GetUID<0x0008,0x0018>( reidfilenames[i] ) != GetUID<0x0008,0x0018>( filenames[i] )
+      || GetUID<0x0020,0x000d>( reidfilenames[i] ) != "1.2.3.4.5.2" )
+      {
+      std::cerr << "Could not re-identify " << outfilenames[i] << std::endl;
+      return 1;
+      }
+    }
+
+  // Missing input: the other files are still processed
+  gdcm::Directory::FilenamesType missing = filenames;
+  gdcm::Directory::FilenamesType missingout = outfilenames2;
+  missing[1] = gdcm::Testing::GetTempFilename( "missing.dcm", subdir );
+  gdcm::BatchAnonymizer batch3;
+  batch3.SetNumberOfThreads( 4 );
+  batch3.SetCryptographicMessageSyntax( &cms );
+  if( batch3.Anonymize( missing, missingout ) ) return 1;
+  if( batch3.GetFailedFilenames().size() != 1 || batch3.GetFailedFilenames()[0] != missing[1] )
+    {
+    return 1;
+    }
+  if( batch3.GetUIDMappingTable().GetNumberOfEntries() != 1 + nseries + nfiles - 1 ) return 1;
+  batch3.SetSkipUnreadableFiles( true );
+  if( !batch3.Anonymize( missing, missingout ) ) return 1;
+
+  // A certificate is required:
+  gdcm::BatchAnonymizer nocms;
+  if( nocms.Anonymize( filenames, outfilenames ) ) return 1;
+
+  return 0;
+}
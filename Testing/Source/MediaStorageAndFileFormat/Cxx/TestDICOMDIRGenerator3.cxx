@@ -0,0 +1,262 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmDICOMDIRGenerator.h"
+#include "gdcmReader.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+#include "gdcmItem.h"
+#include "gdcmExplicitDataElement.h"
+#include "gdcmSwapper.h"
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+// Directory records of a generated DICOMDIR are read back at the offsets
+// the generator computed, and the hierarchy is walked through the links.
+namespace
+{
+struct Instance
+{
+  std::string PatientID;
+  std::string StudyUID;
+  std::string SeriesUID;
+  std::string SOPInstanceUID;
+};
+}
+
+// 2 patients, 3 studies (one study UID is a prefix of another one), 5 series
+static const Instance Instances[] = {
+  { "PAT1", "1.2.826.1.1",  "1.2.826.2.1",  "1.2.826.3.1" },
+  { "PAT1", "1.2.826.1.1",  "1.2.826.2.1",  "1.2.826.3.2" },
+  { "PAT1", "1.2.826.1.1",  "1.2.826.2.11", "1.2.826.3.3" },
+  { "PAT1", "1.2.826.1.11", "1.2.826.2.2",  "1.2.826.3.4" },
+  { "PAT2", "1.2.826.1.2",  "1.2.826.2.3",  "1.2.826.3.5" },
+  { "PAT2", "1.2.826.1.2",  "1.2.826.2.3",  "1.2.826.3.6" },
+  { "PAT2", "1.2.826.1.2",  "1.2.826.2.3",  "1.2.826.3.7" },
+  { "PAT2", "1.2.826.1.2",  "1.2.826.2.4",  "1.2.826.3.8" },
+  { "PAT1", "1.2.826.1.11", "1.2.826.2.2",  "1.2.826.3.9" },
+};
+static const size_t NumberOfInstances = sizeof(Instances) / sizeof(Instances[0]);
+
+static bool WriteFile(const std::string &filename, const Instance &inst, int number)
+{
+  gdcm::Writer w;
+  gdcm::DataSet &ds = w.GetFile().GetDataSet();
+  gdcm::Attribute<0x0008,0x0016> sopclass = { "1.2.840.10008.5.1.4.1.1.7" };
+  ds.Insert( sopclass.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0018> sopinstance = { inst.SOPInstanceUID };
+  ds.Insert( sopinstance.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0020> studydate = { "20240101" };
+  ds.Insert( studydate.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0060> modality = { "OT" };
+  ds.Insert( modality.GetAsDataElement() );
+  gdcm::Attribute<0x0010,0x0010> patientname = { inst.PatientID + "^NAME" };
+  ds.Insert( patientname.GetAsDataElement() );
+  gdcm::Attribute<0x0010,0x0020> patientid = { inst.PatientID };
+  ds.Insert( patientid.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x000d> study = { inst.StudyUID };
+  ds.Insert( study.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x000e> series = { inst.SeriesUID };
+  ds.Insert( series.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x0013> instancenumber = { number };
+  ds.Insert( instancenumber.GetAsDataElement() );
+  w.GetFile().GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  w.SetFileName( filename.c_str() );
+  return w.Write();
+}
+
+static std::string Trim(const std::string &s)
+{
+  std::string r = s.c_str(); // UI padding
+  while( !r.empty() && r[r.size() - 1] == ' ' ) r.erase( r.size() - 1 );
+  return r;
+}
+
+// Read the Directory Record starting at offset in the DICOMDIR file
+static bool ReadRecord(std::ifstream &is, uint32_t offset, const char *type,
+  gdcm::DataSet &record)
+{
+  is.clear();
+  is.seekg( offset, std::ios::beg );
+  gdcm::Item item;
+  if( !item.Read<gdcm::ExplicitDataElement,gdcm::SwapperNoOp>( is ) )
+    {
+    std::cerr << "No item at offset " << offset << std::endl;
+    return false;
+    }
+  record = item.GetNestedDataSet();
+  gdcm::Attribute<0x0004,0x1430> recordtype;
+  recordtype.SetFromDataSet( record );
+  if( Trim( recordtype.GetValue() ) != type )
+    {
+    std::cerr << "Expected " << type << " record at offset " << offset
+      << ", found " << recordtype.GetValue() << std::endl;
+    return false;
+    }
+  return true;
+}
+
+static uint32_t GetNext(gdcm::DataSet const &record)
+{
+  gdcm::Attribute<0x0004,0x1400> next;
+  next.SetFromDataSet( record );
+  return next.GetValue();
+}
+
+static uint32_t GetLower(gdcm::DataSet const &record)
+{
+  gdcm::Attribute<0x0004,0x1420> lower;
+  lower.SetFromDataSet( record );
+  return lower.GetValue();
+}
+
+template <uint16_t Group, uint16_t Element>
+static std::string GetString(gdcm::DataSet const &ds)
+{
+  gdcm::Attribute<Group,Element> at;
+  at.SetFromDataSet( ds );
+  return Trim( at.GetValue() );
+}
+
+static int CheckDICOMDIR(const std::string &dicomdir,
+  std::map<std::string, Instance> const &fileids)
+{
+  gdcm::Reader reader;
+  reader.SetFileName( dicomdir.c_str() );
+  if( !reader.Read() ) return 1;
+  const gdcm::DataSet &root = reader.GetFile().GetDataSet();
+  gdcm::Attribute<0x0004,0x1200> first;
+  first.SetFromDataSet( root );
+  gdcm::Attribute<0x0004,0x1202> last;
+  last.SetFromDataSet( root );
+
+  std::ifstream is( dicomdir.c_str(), std::ios::binary );
+  std::set<std::string> seen;
+  std::set<std::string> patients, studies, series;
+  uint32_t lastpatient = 0;
+  for( uint32_t p = first.GetValue(); p; )
+    {
+    gdcm::DataSet patient;
+    if( !ReadRecord( is, p, "PATIENT", patient ) ) return 1;
+    const std::string patientid = GetString<0x0010,0x0020>( patient );
+    if( !patients.insert( patientid ).second ) return 1;
+    for( uint32_t st = GetLower( patient ); st; )
+      {
+      gdcm::DataSet study;
+      if( !ReadRecord( is, st, "STUDY", study ) ) return 1;
+      const std::string studyuid = GetString<0x0020,0x000d>( study );
+      if( !studies.insert( studyuid ).second ) return 1;
+      for( uint32_t se = GetLower( study ); se; )
+        {
+        gdcm::DataSet serie;
+        if( !ReadRecord( is, se, "SERIES", serie ) ) return 1;
+        const std::string seriesuid = GetString<0x0020,0x000e>( serie );
+        if( !series.insert( seriesuid ).second ) return 1;
+        for( uint32_t im = GetLower( serie ); im; )
+          {
+          gdcm::DataSet image;
+          if( !ReadRecord( is, im, "IMAGE", image ) ) return 1;
+          if( GetLower( image ) != 0 ) return 1;
+          const std::string fileid = GetString<0x0004,0x1500>( image );
+          std::map<std::string, Instance>::const_iterator it = fileids.find( fileid );
+          if( it == fileids.end() || !seen.insert( fileid ).second )
+            {
+            std::cerr << "Unexpected file: " << fileid << std::endl;
+            return 1;
+            }
+          // the image is linked under its own patient, study and series:
+          const Instance &inst = it->second;
+          if( inst.PatientID != patientid || inst.StudyUID != studyuid
+            || inst.SeriesUID != seriesuid
+            || GetString<0x0004,0x1511>( image ) != inst.SOPInstanceUID )
+            {
+            std::cerr << "Wrong hierarchy for " << fileid << std::endl;
+            return 1;
+            }
+          im = GetNext( image );
+          }
+        se = GetNext( serie );
+        }
+      st = GetNext( study );
+      }
+    lastpatient = p;
+    p = GetNext( patient );
+    }
+  if( lastpatient != last.GetValue() )
+    {
+    std::cerr << "Wrong offset of the last root record" << std::endl;
+    return 1;
+    }
+  if( seen.size() != fileids.size() || patients.size() != 2
+    || studies.size() != 3 || series.size() != 5 )
+    {
+    std::cerr << "Missing records" << std::endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestDICOMDIRGenerator3(int, char *[])
+{
+  const char subdir[] = "TestDICOMDIRGenerator3";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+
+  gdcm::Directory::FilenamesType filenames;
+  std::map<std::string, Instance> fileids;
+  for( size_t i = 0; i < NumberOfInstances; ++i )
+    {
+    std::ostringstream name;
+    name << "IMG" << (i + 1);
+    const std::string filename = tmpdir + "/" + name.str();
+    if( !WriteFile( filename, Instances[i], (int)i + 1 ) ) return 1;
+    filenames.push_back( filename );
+    fileids[ name.str() ] = Instances[i];
+    }
+
+  const unsigned int nthreads[] = { 1, 3 };
+  for( int t = 0; t < 2; ++t )
+    {
+    gdcm::DICOMDIRGenerator gen;
+    gen.SetFilenames( filenames );
+    gen.SetRootDirectory( tmpdir );
+    gen.SetDescriptor( "TESTDIR" );
+    gen.SetNumberOfThreads( nthreads[t] );
+    if( !gen.Generate() )
+      {
+      std::cerr << "Could not generate" << std::endl;
+      return 1;
+      }
+    gdcm::Writer writer;
+    writer.SetFile( gen.GetFile() );
+    const std::string dicomdir = tmpdir + "/DICOMDIR";
+    writer.SetFileName( dicomdir.c_str() );
+    if( !writer.Write() ) return 1;
+    if( CheckDICOMDIR( dicomdir, fileids ) )
+      {
+      std::cerr << "Invalid DICOMDIR with " << nthreads[t] << " threads" << std::endl;
+      return 1;
+      }
+    }
+
+  return 0;
+}
@@ -0,0 +1,172 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmDPathQuery.h"
+#include "gdcmDataSet.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmReader.h"
+#include "gdcmWriter.h"
+
+#include <sstream>
+#include <cstring>
+
+static void InsertString(gdcm::DataSet &ds, const gdcm::Tag &t,
+                         const gdcm::VR &vr, const char *s) {
+  std::string value = s;
+  if (value.size() % 2) value.push_back(vr == gdcm::VR::UI ? '\0' : ' ');
+  gdcm::DataElement de(t);
+  de.SetVR(vr);
+  de.SetByteValue(value.c_str(), (uint32_t)value.size());
+  ds.Insert(de);
+}
+
+static void InsertSequence(gdcm::DataSet &ds, const gdcm::Tag &t,
+                           const std::vector<gdcm::DataSet> &items) {
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+  sq->SetLengthToUndefined();
+  for (size_t i = 0; i < items.size(); ++i) {
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    item.SetNestedDataSet(items[i]);
+    sq->AddItem(item);
+  }
+  gdcm::DataElement de(t);
+  de.SetVR(gdcm::VR::SQ);
+  de.SetValue(*sq);
+  de.SetVLToUndefined();
+  ds.Insert(de);
+}
+
+static std::string GetString(const gdcm::DataElement &de) {
+  const gdcm::ByteValue *bv = de.GetByteValue();
+  if (!bv) return "";
+  return std::string(bv->GetPointer(), bv->GetLength()).c_str();
+}
+
+static void CreateDataSet(gdcm::DataSet &ds) {
+  InsertString(ds, gdcm::Tag(0x0008, 0x0016), gdcm::VR::UI,
+               "1.2.840.10008.5.1.4.1.1.7");
+  InsertString(ds, gdcm::Tag(0x0008, 0x0018), gdcm::VR::UI, "1.2.3.4");
+  std::vector<gdcm::DataSet> items(3);
+  for (size_t i = 0; i < items.size(); ++i) {
+    const std::string uid = "1.2.3." + std::string(1, (char)('1' + i));
+    InsertString(items[i], gdcm::Tag(0x0008, 0x1155), gdcm::VR::UI,
+                 uid.c_str());
+    std::vector<gdcm::DataSet> nested(2);
+    InsertString(nested[0], gdcm::Tag(0x0008, 0x0100), gdcm::VR::SH, "A");
+    InsertString(nested[1], gdcm::Tag(0x0008, 0x0100), gdcm::VR::SH, "B");
+    InsertSequence(items[i], gdcm::Tag(0x0040, 0xa043), nested);
+  }
+  InsertSequence(ds, gdcm::Tag(0x0008, 0x1115), items);
+  InsertString(ds, gdcm::Tag(0x0010, 0x0010), gdcm::VR::PN, "Query^Patient");
+  // two private blocks in the same group:
+  InsertString(ds, gdcm::Tag(0x0029, 0x0010), gdcm::VR::LO, "CREATOR A");
+  InsertString(ds, gdcm::Tag(0x0029, 0x0011), gdcm::VR::LO, "CREATOR B ");
+  InsertString(ds, gdcm::Tag(0x0029, 0x1008), gdcm::VR::LO, "a8");
+  InsertString(ds, gdcm::Tag(0x0029, 0x1108), gdcm::VR::LO, "b8");
+  InsertString(ds, gdcm::Tag(0x0029, 0x1109), gdcm::VR::LO, "b9");
+}
+
+static const char *const paths[] = {
+    "/0010,0010",                 // 0
+    "/0008,1115/*/0008,1155",     // 1
+    "/0008,1115/2/0008,1155",     // 2
+    "/0008,1115/*/0040,a043/2/0008,0100",  // 3
+    "/0008,1115",                 // 4
+    "/0029,08,CREATOR B",         // 5
+    "/0029,08,*",                 // 6
+    "/0029,09,CREATOR A",         // 7 (no match)
+    "/0008,1115/4/0008,1155",     // 8 (no match)
+};
+static const size_t npaths = sizeof(paths) / sizeof(*paths);
+
+static int CheckResults(const gdcm::DPathQuery::ResultsType &results) {
+  if (results.size() != npaths) return 1;
+  if (results[0].size() != 1 || GetString(results[0][0]) != "Query^Patient ")
+    return 1;
+  if (results[1].size() != 3 || GetString(results[1][0]) != "1.2.3.1" ||
+      GetString(results[1][2]) != "1.2.3.3")
+    return 1;
+  if (results[2].size() != 1 || GetString(results[2][0]) != "1.2.3.2")
+    return 1;
+  if (results[3].size() != 3 || GetString(results[3][1]) != "B ") return 1;
+  if (results[4].size() != 1 || !results[4][0].GetValueAsSQ()) return 1;
+  if (results[5].size() != 1 || GetString(results[5][0]) != "b8") return 1;
+  if (results[6].size() != 2 || GetString(results[6][0]) != "a8" ||
+      GetString(results[6][1]) != "b8")
+    return 1;
+  if (!results[7].empty() || !results[8].empty()) return 1;
+  return 0;
+}
+
+int TestDPathQuery(int, char *[]) {
+  gdcm::DPathQuery query;
+  for (size_t i = 0; i < npaths; ++i) {
+    if (query.AddPath(paths[i]) != (int)i) {
+      std::cerr << "Could not add: " << paths[i] << std::endl;
+      return 1;
+    }
+  }
+  if (query.GetNumberOfPaths() != npaths) return 1;
+  // item or invalid paths:
+  gdcm::Trace::ErrorOff();
+  const int b1 = query.AddPath("/0008,1115/*");
+  const int b2 = query.AddPath("/0008,1115/0/0008,1155");
+  const int b3 = query.AddPath("0010,0010");
+  gdcm::Trace::ErrorOn();
+  if (b1 != -1 || b2 != -1 || b3 != -1) return 1;
+  if (query.GetNumberOfPaths() != npaths) return 1;
+
+  gdcm::DataSet ds;
+  CreateDataSet(ds);
+  gdcm::DPathQuery::ResultsType results;
+  if (!query.Execute(ds, results)) return 1;
+  if (CheckResults(results)) {
+    std::cerr << "Wrong results from data set" << std::endl;
+    return 1;
+  }
+
+  // Same query from a stream:
+  gdcm::Writer w;
+  w.GetFile().GetDataSet() = ds;
+  w.GetFile().GetHeader().SetDataSetTransferSyntax(
+      gdcm::TransferSyntax::ExplicitVRLittleEndian);
+  std::ostringstream os;
+  w.SetStream(os);
+  if (!w.Write()) return 1;
+  std::istringstream is(os.str());
+  gdcm::Reader reader;
+  reader.SetStream(is);
+  reader.SetLazySequenceParsing(true);
+  if (!query.Read(reader, results)) return 1;
+  if (CheckResults(results)) {
+    std::cerr << "Wrong results from stream" << std::endl;
+    return 1;
+  }
+
+  // Only public attributes, the stream is not read past the last one:
+  gdcm::DPathQuery query2;
+  if (query2.AddPath("/0008,1115/*/0008,1155") != 0) return 1;
+  std::istringstream is2(os.str());
+  gdcm::Reader reader2;
+  reader2.SetStream(is2);
+  if (!query2.Read(reader2, results)) return 1;
+  if (results.size() != 1 || results[0].size() != 3) return 1;
+  if (reader2.GetFile().GetDataSet().FindDataElement(gdcm::Tag(0x0010, 0x0010)))
+    return 1;
+
+  query.Clear();
+  if (query.GetNumberOfPaths() != 0 || query.Execute(ds, results)) return 1;
+
+  return 0;
+}
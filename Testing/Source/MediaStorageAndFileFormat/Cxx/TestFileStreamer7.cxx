@@ -0,0 +1,108 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmFileStreamer.h"
+
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+#include "gdcmImageWriter.h"
+#include "gdcmImageReader.h"
+#include "gdcmTransferSyntax.h"
+
+#include <vector>
+
+/*
+ * Write a multi-frame header once, then append the frames one at a time (the
+ * way gdcmtar builds an enhanced object):
+ */
+int TestFileStreamer7(int, char *[])
+{
+  using namespace gdcm;
+  const char subdir[] = "TestFileStreamer7";
+  std::string tmpdir = Testing::GetTempDirectory( subdir );
+  if( !System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    System::MakeDirectory( tmpdir.c_str() );
+    }
+  const std::string outfilename = tmpdir + "/frames.dcm";
+
+  const unsigned int dims[3] = { 5, 3, 4 };
+  const size_t framelen = dims[0] * dims[1] * sizeof(unsigned short);
+  std::vector<unsigned short> frames( dims[0] * dims[1] * dims[2] );
+  for( size_t i = 0; i < frames.size(); ++i )
+    {
+    frames[i] = (unsigned short)(i * 7);
+    }
+
+    {
+    ImageWriter w;
+    Image &image = w.GetImage();
+    image.SetNumberOfDimensions( 3 );
+    image.SetDimensions( dims );
+    image.SetPixelFormat( PixelFormat::UINT16 );
+    image.SetPhotometricInterpretation( PhotometricInterpretation::MONOCHROME2 );
+    image.SetTransferSyntax( TransferSyntax::ExplicitVRLittleEndian );
+    // no Pixel Data value yet:
+    image.SetDataElement( DataElement( Tag(0x7fe0,0x0010) ) );
+    w.SetFileName( outfilename.c_str() );
+    if( !w.Write() )
+      {
+      std::cerr << "Could not write: " << outfilename << std::endl;
+      return 1;
+      }
+    }
+
+  const Tag pixeldata(0x7fe0,0x0010);
+  FileStreamer fs;
+  fs.SetTemplateFileName( outfilename.c_str() );
+  fs.SetOutputFileName( outfilename.c_str() );
+  fs.CheckDataElement( pixeldata );
+  fs.ReserveDataElement( framelen * dims[2] );
+  if( !fs.StartDataElement( pixeldata ) ) return 1;
+  for( unsigned int z = 0; z < dims[2]; ++z )
+    {
+    const char *frame = (const char*)frames.data() + z * framelen;
+    if( !fs.AppendToDataElement( pixeldata, frame, framelen ) ) return 1;
+    }
+  if( !fs.StopDataElement( pixeldata ) )
+    {
+    std::cerr << "Invalid Pixel Data length" << std::endl;
+    return 1;
+    }
+
+  ImageReader r;
+  r.SetFileName( outfilename.c_str() );
+  if( !r.Read() )
+    {
+    std::cerr << "Failed to read: " << outfilename << std::endl;
+    return 1;
+    }
+  const Image &image = r.GetImage();
+  if( image.GetDimension(2) != dims[2] ) return 1;
+  // the VR of the template is kept:
+  const DataElement &de = r.GetFile().GetDataSet().GetDataElement( pixeldata );
+  if( de.GetVR() != VR::OW )
+    {
+    std::cerr << "Wrong VR: " << de.GetVR() << std::endl;
+    return 1;
+    }
+  std::vector<unsigned short> buffer( frames.size() );
+  if( !image.GetBuffer( (char*)buffer.data() ) ) return 1;
+  if( buffer != frames )
+    {
+    std::cerr << "Pixel Data differs" << std::endl;
+    return 1;
+    }
+
+  return 0;
+}
@@ -0,0 +1,238 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmFrameGeometryIndex.h"
+#include "gdcmImageHelper.h"
+#include "gdcmFile.h"
+#include "gdcmAttribute.h"
+#include "gdcmSequenceOfItems.h"
+#include "gdcmMediaStorage.h"
+
+#include <iostream>
+#include <cstring>
+#include <cmath>
+
+static const unsigned int nframes = 5;
+
+static void InsertSequence(gdcm::DataSet &ds, const gdcm::Tag &t,
+  const gdcm::DataSet *items, unsigned int nitems)
+{
+  gdcm::SmartPointer<gdcm::SequenceOfItems> sq = new gdcm::SequenceOfItems;
+  sq->SetLengthToUndefined();
+  for( unsigned int i = 0; i < nitems; ++i )
+    {
+    gdcm::Item item;
+    item.SetVLToUndefined();
+    item.SetNestedDataSet( items[i] );
+    sq->AddItem( item );
+    }
+  gdcm::DataElement de( t );
+  de.SetVR( gdcm::VR::SQ );
+  de.SetValue( *sq );
+  de.SetVLToUndefined();
+  ds.Replace( de );
+}
+
+static void InsertSequence(gdcm::DataSet &ds, const gdcm::Tag &t, const gdcm::DataSet &item)
+{
+  InsertSequence( ds, t, &item, 1 );
+}
+
+// Enhanced CT with orientation / pixel measures shared, position / rescale /
+// frame content per-frame
+static void CreateEnhancedCT(gdcm::File &file)
+{
+  gdcm::DataSet &ds = file.GetDataSet();
+  const char *msstr = gdcm::MediaStorage::GetMSString( gdcm::MediaStorage::EnhancedCTImageStorage );
+  gdcm::DataElement de( gdcm::Tag(0x0008,0x0016) );
+  de.SetByteValue( msstr, (uint32_t)strlen(msstr) );
+  de.SetVR( gdcm::Attribute<0x0008, 0x0016>::GetVR() );
+  ds.Insert( de );
+  gdcm::Attribute<0x0028,0x0008> numberofframes = { nframes };
+  ds.Insert( numberofframes.GetAsDataElement() );
+
+  gdcm::DataSet shared;
+    {
+    gdcm::DataSet pm;
+    gdcm::Attribute<0x0028,0x0030> ps = {{ 0.5, 0.25 }};
+    pm.Insert( ps.GetAsDataElement() );
+    gdcm::Attribute<0x0018,0x0050> st = { 2.5 };
+    pm.Insert( st.GetAsDataElement() );
+    InsertSequence( shared, gdcm::Tag(0x0028,0x9110), pm );
+    gdcm::DataSet po;
+    gdcm::Attribute<0x0020,0x0037> iop = {{ 1, 0, 0, 0, 1, 0 }};
+    po.Insert( iop.GetAsDataElement() );
+    InsertSequence( shared, gdcm::Tag(0x0020,0x9116), po );
+    // Rescale Intercept / Slope are missing from the shared item, they are
+    // found in the per-frame items:
+    gdcm::DataSet pvt;
+    gdcm::Attribute<0x0028,0x1054> rescaletype = { "HU" };
+    pvt.Insert( rescaletype.GetAsDataElement() );
+    InsertSequence( shared, gdcm::Tag(0x0028,0x9145), pvt );
+    }
+  InsertSequence( ds, gdcm::Tag(0x5200,0x9229), shared );
+
+  gdcm::DataSet perframe[nframes];
+  for( unsigned int i = 0; i < nframes; ++i )
+    {
+    gdcm::DataSet pp;
+    gdcm::Attribute<0x0020,0x0032> ipp = {{ -10., 20., 3. * i }};
+    pp.Insert( ipp.GetAsDataElement() );
+    InsertSequence( perframe[i], gdcm::Tag(0x0020,0x9113), pp );
+    gdcm::DataSet pvt;
+    gdcm::Attribute<0x0028,0x1052> intercept = { -1024. + i };
+    pvt.Insert( intercept.GetAsDataElement() );
+    gdcm::Attribute<0x0028,0x1053> slope = { 2. };
+    pvt.Insert( slope.GetAsDataElement() );
+    InsertSequence( perframe[i], gdcm::Tag(0x0028,0x9145), pvt );
+    gdcm::DataSet voi;
+    gdcm::Attribute<0x0028,0x1050> center;
+    const double c[] = { 40., 400. };
+    center.SetValues( c, 2 );
+    voi.Insert( center.GetAsDataElement() );
+    gdcm::Attribute<0x0028,0x1051> width;
+    const double w[] = { 350., 2000. };
+    width.SetValues( w, 2 );
+    voi.Insert( width.GetAsDataElement() );
+    InsertSequence( perframe[i], gdcm::Tag(0x0028,0x9132), voi );
+    gdcm::DataSet fc;
+    gdcm::Attribute<0x0020,0x9157> div;
+    const unsigned int v[] = { 1, i + 1 };
+    div.SetValues( v, 2 );
+    fc.Insert( div.GetAsDataElement() );
+    gdcm::Attribute<0x0020,0x9056> stackid;
+    stackid.SetValue( "1" );
+    fc.Insert( stackid.GetAsDataElement() );
+    gdcm::Attribute<0x0020,0x9057> instack = { i + 1 };
+    fc.Insert( instack.GetAsDataElement() );
+    InsertSequence( perframe[i], gdcm::Tag(0x0020,0x9111), fc );
+    }
+  InsertSequence( ds, gdcm::Tag(0x5200,0x9230), perframe, nframes );
+}
+
+// Set the Image Position (Patient) of the first frame, in place
+static void SetFirstPosition(gdcm::DataSet &ds, double z)
+{
+  gdcm::SmartPointer<gdcm::SequenceOfItems> perframe =
+    ds.GetDataElement( gdcm::Tag(0x5200,0x9230) ).GetValueAsSQ();
+  gdcm::DataSet &item = perframe->GetItem(1).GetNestedDataSet();
+  gdcm::SmartPointer<gdcm::SequenceOfItems> pp =
+    item.GetDataElement( gdcm::Tag(0x0020,0x9113) ).GetValueAsSQ();
+  gdcm::Attribute<0x0020,0x0032> ipp = {{ -10., 20., z }};
+  pp->GetItem(1).GetNestedDataSet().Replace( ipp.GetAsDataElement() );
+}
+
+int TestFrameGeometryIndex(int, char *[])
+{
+  gdcm::SmartPointer<gdcm::File> file = new gdcm::File;
+  CreateEnhancedCT( *file );
+  gdcm::DataSet &ds = file->GetDataSet();
+
+  gdcm::FrameGeometryIndex index;
+  if( !index.Build( ds ) ) return 1;
+  if( index.GetNumberOfFrames() != nframes ) return 1;
+  if( !index.IsShared( gdcm::FrameGeometryIndex::PixelMeasures )
+   || !index.IsShared( gdcm::FrameGeometryIndex::PlaneOrientation )
+   || index.IsShared( gdcm::FrameGeometryIndex::PlanePosition )
+   || index.IsShared( gdcm::FrameGeometryIndex::PixelValueTransformation ) )
+    {
+    std::cerr << "Wrong shared functional groups" << std::endl;
+    return 1;
+    }
+  for( unsigned int i = 0; i < nframes; ++i )
+    {
+    double ipp[3], iop[6], ps[2], is[2], cw[2], st;
+    if( !index.GetImagePositionPatient( i, ipp ) || ipp[2] != 3. * i ) return 1;
+    if( !index.GetImageOrientationPatient( i, iop ) || iop[0] != 1 || iop[4] != 1 ) return 1;
+    if( !index.GetPixelSpacing( i, ps ) || ps[0] != 0.5 || ps[1] != 0.25 ) return 1;
+    if( !index.GetSliceThickness( i, st ) || st != 2.5 ) return 1;
+    if( !index.GetRescaleInterceptSlope( i, is ) || is[0] != -1024. + i || is[1] != 2. )
+      {
+      std::cerr << "Per-frame Rescale Intercept / Slope not found" << std::endl;
+      return 1;
+      }
+    if( !index.GetWindowCenterWidth( i, cw ) || cw[0] != 40. || cw[1] != 350. ) return 1;
+    std::vector<unsigned int> div;
+    if( !index.GetDimensionIndexValues( i, div )
+      || div.size() != 2 || div[0] != 1 || div[1] != i + 1 ) return 1;
+    std::string stackid;
+    if( !index.GetStackID( i, stackid ) || stackid != "1" ) return 1;
+    unsigned int pos;
+    if( !index.GetInStackPositionNumber( i, pos ) || pos != i + 1 ) return 1;
+    // not in the dataset:
+    double sbs;
+    if( index.GetSpacingBetweenSlices( i, sbs ) ) return 1;
+    if( index.GetTemporalPositionIndex( i, pos ) ) return 1;
+    }
+  double ipp[3];
+  if( index.GetImagePositionPatient( nframes, ipp ) ) return 1;
+
+  // Only the first frame:
+  gdcm::FrameGeometryIndex first;
+  if( !first.Build( ds, 1 ) || first.GetNumberOfFrames() != nframes ) return 1;
+  if( !first.GetImagePositionPatient( 0, ipp ) || ipp[2] != 0. ) return 1;
+  if( first.GetImagePositionPatient( 1, ipp ) ) return 1;
+  double iop[6];
+  if( !first.GetImageOrientationPatient( 3, iop ) ) return 1; // shared
+
+  // ImageHelper:
+  std::vector<double> ori = gdcm::ImageHelper::GetOriginValue( *file );
+  if( ori.size() != 3 || ori[0] != -10. || ori[1] != 20. || ori[2] != 0. ) return 1;
+  std::vector<double> sp = gdcm::ImageHelper::GetSpacingValue( *file );
+  if( sp.size() != 3 || sp[0] != 0.25 || sp[1] != 0.5 || std::fabs(sp[2] - 3.) > 1e-6 )
+    {
+    std::cerr << "Wrong spacing: " << sp[0] << "," << sp[1] << "," << sp[2] << std::endl;
+    return 1;
+    }
+  std::vector<double> is = gdcm::ImageHelper::GetRescaleInterceptSlopeValue( *file );
+  if( is.size() != 2 || is[0] != -1024. || is[1] != 2. ) return 1;
+  // same values from a shared index:
+  if( gdcm::ImageHelper::GetOriginValue( *file, index ) != ori
+    || gdcm::ImageHelper::GetSpacingValue( *file, index ) != sp
+    || gdcm::ImageHelper::GetRescaleInterceptSlopeValue( *file, index ) != is
+    || gdcm::ImageHelper::GetDirectionCosinesValue( *file, index )
+    != gdcm::ImageHelper::GetDirectionCosinesValue( *file ) )
+    {
+    std::cerr << "ImageHelper differs with a shared index" << std::endl;
+    return 1;
+    }
+
+  // Values modified in place: the index is a snapshot, ImageHelper is not
+  // affected
+  SetFirstPosition( ds, -3. );
+  if( !index.GetImagePositionPatient( 0, ipp ) || ipp[2] != 0. ) return 1;
+  ori = gdcm::ImageHelper::GetOriginValue( *file );
+  if( ori[2] != -3. ) return 1;
+  sp = gdcm::ImageHelper::GetSpacingValue( *file );
+  if( sp[2] != 1. ) return 1; // not regularly spaced anymore
+  if( !index.Build( ds ) || !index.GetImagePositionPatient( 0, ipp ) || ipp[2] != -3. ) return 1;
+
+  // Replacing the per-frame sequence:
+  gdcm::DataSet perframe;
+  gdcm::DataSet pp;
+  gdcm::Attribute<0x0020,0x0032> newipp = {{ 1., 2., 3. }};
+  pp.Insert( newipp.GetAsDataElement() );
+  InsertSequence( perframe, gdcm::Tag(0x0020,0x9113), pp );
+  InsertSequence( ds, gdcm::Tag(0x5200,0x9230), perframe );
+  ori = gdcm::ImageHelper::GetOriginValue( *file );
+  if( ori[0] != 1. || ori[1] != 2. || ori[2] != 3. ) return 1;
+  if( !index.Build( ds ) || index.GetNumberOfFrames() != 1 ) return 1;
+  if( index.GetRescaleInterceptSlope( 0, is.data() ) ) return 1;
+
+  // Not an enhanced object:
+  gdcm::FrameGeometryIndex empty;
+  if( empty.Build( gdcm::DataSet() ) ) return 1;
+  if( empty.GetNumberOfFrames() != 0 ) return 1;
+
+  return 0;
+}
@@ -0,0 +1,127 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmIPPSorter.h"
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+
+#include <sstream>
+
+static bool WriteFile(const std::string &filename, int slice, int phase)
+{
+  gdcm::Writer w;
+  gdcm::DataSet &ds = w.GetFile().GetDataSet();
+  std::ostringstream uid;
+  uid << "1.2.3.4." << slice << "." << phase;
+  gdcm::Attribute<0x0008,0x0016> sopclass = { "1.2.840.10008.5.1.4.1.1.4" };
+  ds.Insert( sopclass.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0018> sopinstance = { uid.str() };
+  ds.Insert( sopinstance.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x0052> frameofref = { "1.2.3.4" };
+  ds.Insert( frameofref.GetAsDataElement() );
+  // positions are not exactly the same from one phase to the other:
+  gdcm::Attribute<0x0020,0x0032> ipp = {{ -10, 20.5, 2.5 * slice + 1e-5 * phase }};
+  ds.Insert( ipp.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x0037> iop = {{ 1, 0, 0, 0, 1, 0 }};
+  ds.Insert( iop.GetAsDataElement() );
+  // Temporal Position Identifier, 1 2 10 (not in string order)
+  gdcm::Attribute<0x0020,0x0100> tpi = { phase == 2 ? 10 : phase + 1 };
+  ds.Insert( tpi.GetAsDataElement() );
+  w.GetFile().GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  w.SetFileName( filename.c_str() );
+  return w.Write();
+}
+
+int TestIPPSorter4(int, char *[])
+{
+  const char subdir[] = "TestIPPSorter4";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+
+  // 3 phases of 6 slices, in a shuffled order:
+  const int nslices = 6;
+  const int nphases = 3;
+  const int nfiles = nslices * nphases;
+  std::vector<std::string> filenames;
+  std::vector< std::vector<std::string> > expected( nphases, std::vector<std::string>( nslices ) );
+  for( int i = 0; i < nfiles; ++i )
+    {
+    const int k = (i * 7) % nfiles;
+    const int slice = k % nslices;
+    const int phase = k / nslices;
+    std::ostringstream name;
+    name << "file" << i << ".dcm";
+    const std::string filename = gdcm::Testing::GetTempFilename( name.str().c_str(), subdir );
+    if( !WriteFile( filename, slice, phase ) ) return 1;
+    filenames.push_back( filename );
+    expected[phase][slice] = filename;
+    }
+
+  gdcm::IPPSorter s;
+  s.AddSecondaryTag( gdcm::Tag(0x0020,0x0100) );
+  s.SetNumberOfThreads( 4 );
+  if( !s.Sort4D( filenames ) )
+    {
+    std::cerr << "Could not sort" << std::endl;
+    return 1;
+    }
+  if( s.GetNumberOfVolumes() != nphases || s.GetNumberOfSlices() != nslices
+    || s.GetVolumes() != expected )
+    {
+    std::cerr << "Wrong volumes" << std::endl;
+    return 1;
+    }
+  if( s.GetFilenames().size() != (size_t)nfiles
+    || s.GetFilenames()[nslices] != expected[1][0] ) return 1;
+  if( s.GetZSpacing() != 2.5 )
+    {
+    std::cerr << "Wrong spacing: " << s.GetZSpacing() << std::endl;
+    return 1;
+    }
+
+  // With a tolerance lower than the jitter every image is its own slice:
+  s.SetPositionTolerance( 0 );
+  if( !s.Sort4D( filenames ) || s.GetNumberOfVolumes() != 1
+    || s.GetNumberOfSlices() != (size_t)nfiles || s.GetZSpacing() != 0 ) return 1;
+  s.SetPositionTolerance( 1e-3 );
+
+  // A missing image:
+  std::vector<std::string> missing( filenames.begin() + 1, filenames.end() );
+  if( s.Sort4D( missing ) ) return 1;
+  if( s.GetNumberOfVolumes() != 0 ) return 1;
+
+  // Without secondary tag, the duplicates are dropped (3D volume):
+  gdcm::IPPSorter s3d;
+  s3d.SetDropDuplicatePositions( true );
+  if( !s3d.Sort4D( filenames ) || s3d.GetNumberOfVolumes() != 1
+    || s3d.GetNumberOfSlices() != nslices ) return 1;
+  for( int slice = 0; slice < nslices; ++slice )
+    {
+    // the first file in the input order is kept
+    for( int i = 0; i < nfiles; ++i )
+      {
+      if( (i * 7) % nfiles % nslices == slice )
+        {
+        if( s3d.GetVolumes()[0][slice] != filenames[i] ) return 1;
+        break;
+        }
+      }
+    }
+
+  return 0;
+}
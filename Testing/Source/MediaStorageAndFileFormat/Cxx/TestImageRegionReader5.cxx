@@ -0,0 +1,158 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmImageRegionReader.h"
+#include "gdcmImageWriter.h"
+#include "gdcmJPEG2000Codec.h"
+#include "gdcmBoxRegion.h"
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+// Reduced / region reads of a tiled JPEG 2000 image
+static const unsigned int dims[3] = { 203, 150, 3 };
+
+static bool WriteTiledJ2K(const char *filename, std::vector<char> &input)
+{
+  const gdcm::PixelFormat pf( gdcm::PixelFormat::UINT16 );
+  const size_t len = (size_t)dims[0] * dims[1] * dims[2] * pf.GetPixelSize();
+  input.resize( len );
+  unsigned short *p = (unsigned short*)(void*)input.data();
+  for( unsigned int z = 0; z < dims[2]; ++z )
+    for( unsigned int y = 0; y < dims[1]; ++y )
+      for( unsigned int x = 0; x < dims[0]; ++x )
+        *p++ = (unsigned short)( 1000 * z + 3 * x + 7 * y + ((x * y) % 13) );
+
+  gdcm::JPEG2000Codec codec;
+  codec.SetNumberOfDimensions( 3 );
+  codec.SetDimensions( dims );
+  codec.SetPixelFormat( pf );
+  codec.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::MONOCHROME2 );
+  codec.SetTileSize( 64, 64 );
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( input.data(), (uint32_t)len );
+  gdcm::DataElement compressed;
+  if( !codec.Code( raw, compressed ) ) return false;
+
+  gdcm::ImageWriter writer;
+  gdcm::Image &image = writer.GetImage();
+  image.SetNumberOfDimensions( 3 );
+  image.SetDimensions( dims );
+  image.SetPixelFormat( pf );
+  image.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::MONOCHROME2 );
+  image.SetTransferSyntax( gdcm::TransferSyntax::JPEG2000Lossless );
+  image.SetDataElement( compressed );
+  writer.SetFileName( filename );
+  return writer.Write();
+}
+
+static bool ReadRegion(gdcm::ImageRegionReader &reader, const gdcm::BoxRegion &box,
+  unsigned int r, std::vector<char> &buffer)
+{
+  reader.SetRegion( box );
+  reader.SetResolutionReduction( r );
+  const size_t len = reader.ComputeBufferLength();
+  if( !len ) return false;
+  buffer.resize( len );
+  return reader.ReadIntoBuffer( buffer.data(), len );
+}
+
+int TestImageRegionReader5(int, char *[])
+{
+  const char subdir[] = "TestImageRegionReader5";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+  std::string filename = gdcm::Testing::GetTempFilename( "tiled_j2k.dcm", subdir );
+  std::vector<char> input;
+  if( !WriteTiledJ2K( filename.c_str(), input ) )
+    {
+    std::cerr << "Could not write: " << filename << std::endl;
+    return 1;
+    }
+
+  gdcm::ImageRegionReader reader;
+  reader.SetFileName( filename.c_str() );
+  if( !reader.ReadInformation() ) return 1;
+
+  // Full resolution, region across tile boundaries:
+  const unsigned int xmin = 50, xmax = 140, ymin = 60, ymax = 129;
+  gdcm::BoxRegion box;
+  box.SetDomain( xmin, xmax, ymin, ymax, 1, 2 );
+  std::vector<char> buffer;
+  if( !ReadRegion( reader, box, 0, buffer ) )
+    {
+    std::cerr << "Could not read region" << std::endl;
+    return 1;
+    }
+  const size_t rowlen = (xmax - xmin + 1) * 2;
+  const char *out = buffer.data();
+  for( unsigned int z = 1; z <= 2; ++z )
+    for( unsigned int y = ymin; y <= ymax; ++y, out += rowlen )
+      {
+      const char *in = input.data() + ((z * dims[1] + y) * dims[0] + xmin) * 2;
+      if( memcmp( in, out, rowlen ) != 0 )
+        {
+        std::cerr << "Region differs at z=" << z << " y=" << y << std::endl;
+        return 1;
+        }
+      }
+
+  // Whole image at half resolution:
+  const unsigned int r = 1;
+  box.SetDomain( 0, dims[0] - 1, 0, dims[1] - 1, 0, dims[2] - 1 );
+  std::vector<char> reduced;
+  if( !ReadRegion( reader, box, r, reduced ) )
+    {
+    std::cerr << "Could not read reduced image" << std::endl;
+    return 1;
+    }
+  const unsigned int rdims[2] = { (dims[0] + 1) / 2, (dims[1] + 1) / 2 };
+  if( reduced.size() != (size_t)rdims[0] * rdims[1] * dims[2] * 2 ) return 1;
+
+  // Same region at half resolution, only the needed tiles are decoded:
+  box.SetDomain( xmin, xmax, ymin, ymax, 1, 2 );
+  if( !ReadRegion( reader, box, r, buffer ) )
+    {
+    std::cerr << "Could not read reduced region" << std::endl;
+    return 1;
+    }
+  const unsigned int rxmin = (xmin + 1) / 2, rxmax = xmax / 2;
+  const unsigned int rymin = (ymin + 1) / 2, rymax = ymax / 2;
+  const size_t rrowlen = (rxmax - rxmin + 1) * 2;
+  if( buffer.size() != rrowlen * (rymax - rymin + 1) * 2 ) return 1;
+  out = buffer.data();
+  for( unsigned int z = 1; z <= 2; ++z )
+    for( unsigned int y = rymin; y <= rymax; ++y, out += rrowlen )
+      {
+      const char *in = reduced.data() + ((z * rdims[1] + y) * rdims[0] + rxmin) * 2;
+      if( memcmp( in, out, rrowlen ) != 0 )
+        {
+        std::cerr << "Reduced region differs at z=" << z << " y=" << y << std::endl;
+        return 1;
+        }
+      }
+
+  // Cannot discard more resolution levels than found in the codestream:
+  gdcm::Trace::ErrorOff();
+  const bool b = ReadRegion( reader, box, 10, buffer );
+  gdcm::Trace::ErrorOn();
+  if( b ) return 1;
+
+  return 0;
+}
@@ -0,0 +1,156 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmJPEGCodec.h"
+#include "gdcmDataElement.h"
+#include "gdcmByteValue.h"
+#include "gdcmSequenceOfFragments.h"
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <cstring>
+
+namespace
+{
+// Give access to the stream based decoder, as reference:
+class StreamJPEGCodec : public gdcm::JPEGCodec
+{
+public:
+  using gdcm::JPEGCodec::DecodeByStreams;
+};
+}
+
+static void SetupCodec(gdcm::JPEGCodec &codec, const gdcm::PixelFormat &pf,
+  const gdcm::PhotometricInterpretation &pi, const unsigned int dims[3])
+{
+  codec.SetNumberOfDimensions( dims[2] > 1 ? 3 : 2 );
+  codec.SetDimensions( dims );
+  codec.SetPhotometricInterpretation( pi );
+  codec.SetPixelFormat( pf );
+}
+
+static int TestJPEGCodecRoundTrip(const gdcm::PixelFormat &pf,
+  const gdcm::PhotometricInterpretation &pi, unsigned int nframes, bool lossless)
+{
+  const unsigned int dims[3] = { 67, 45, nframes };
+  const size_t len = (size_t)dims[0] * dims[1] * dims[2] * pf.GetPixelSize();
+  std::vector<char> input( len );
+  if( pf.GetBitsAllocated() == 16 )
+    {
+    unsigned short *p = (unsigned short*)input.data();
+    const unsigned short mask = (unsigned short)((1 << pf.GetBitsStored()) - 1);
+    for( size_t i = 0; i < len / 2; ++i ) p[i] = (unsigned short)((i * 37 + i / 67) & mask);
+    }
+  else
+    {
+    for( size_t i = 0; i < len; ++i ) input[i] = (char)(i % 67 + i / 201);
+    }
+
+  gdcm::JPEGCodec codec;
+  codec.SetLossless( lossless );
+  codec.SetQuality( lossless ? 100 : 90 );
+  SetupCodec( codec, pf, pi, dims );
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( input.data(), (uint32_t)len );
+  gdcm::DataElement compressed;
+  if( !codec.Code( raw, compressed ) )
+    {
+    std::cerr << "Could not encode" << std::endl;
+    return 1;
+    }
+  const gdcm::SequenceOfFragments *sf = compressed.GetSequenceOfFragments();
+  if( !sf || sf->GetNumberOfFragments() != nframes ) return 1;
+
+  // Decode directly into a caller buffer:
+  gdcm::JPEGCodec decoder;
+  SetupCodec( decoder, pf, pi, dims );
+  std::vector<char> output( len );
+  if( !decoder.DecodeToBuffer( compressed, output.data(), output.size() ) )
+    {
+    std::cerr << "Could not decode to buffer" << std::endl;
+    return 1;
+    }
+  if( lossless && output != input )
+    {
+    std::cerr << "Decoded buffer differs" << std::endl;
+    return 1;
+    }
+
+  // Same result as the stream decoder, frame by frame:
+  StreamJPEGCodec reference;
+  SetupCodec( reference, pf, pi, dims );
+  const size_t framelen = len / nframes;
+  for( unsigned int i = 0; i < nframes; ++i )
+    {
+    const gdcm::ByteValue *bv = sf->GetFragment(i).GetByteValue();
+    std::stringstream is;
+    is.write( bv->GetPointer(), bv->GetLength() );
+    std::stringstream os;
+    if( !reference.DecodeByStreams( is, os ) ) return 1;
+    const std::string str = os.str();
+    if( str.size() != framelen
+      || memcmp( str.data(), output.data() + i * framelen, framelen ) != 0 )
+      {
+      std::cerr << "Stream decoder differs at frame " << i << std::endl;
+      return 1;
+      }
+    }
+
+  // Wrong size is refused:
+  if( decoder.DecodeToBuffer( compressed, output.data(), output.size() - nframes ) )
+    {
+    return 1;
+    }
+
+  // Decode into a DataElement:
+  gdcm::DataElement decompressed;
+  if( !decoder.Decode( compressed, decompressed ) )
+    {
+    std::cerr << "Could not decode" << std::endl;
+    return 1;
+    }
+  const gdcm::ByteValue *bv = decompressed.GetByteValue();
+  if( !bv || bv->GetLength() < len || memcmp( bv->GetPointer(), output.data(), len ) != 0 )
+    {
+    std::cerr << "Decoded value differs" << std::endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+int TestJPEGCodec2(int , char *[])
+{
+  int ret = 0;
+  const gdcm::PixelFormat mono8( gdcm::PixelFormat::UINT8 );
+  const gdcm::PixelFormat mono16( gdcm::PixelFormat::UINT16 );
+  gdcm::PixelFormat mono12( gdcm::PixelFormat::UINT16 );
+  mono12.SetBitsStored( 12 );
+  gdcm::PixelFormat rgb( gdcm::PixelFormat::UINT8 );
+  rgb.SetSamplesPerPixel( 3 );
+  const gdcm::PhotometricInterpretation mono2 = gdcm::PhotometricInterpretation::MONOCHROME2;
+  const gdcm::PhotometricInterpretation rgbpi = gdcm::PhotometricInterpretation::RGB;
+  const gdcm::PhotometricInterpretation ybrpi = gdcm::PhotometricInterpretation::YBR_FULL;
+
+  // Lossless (process 14):
+  ret += TestJPEGCodecRoundTrip( mono8, mono2, 1, true );
+  ret += TestJPEGCodecRoundTrip( mono16, mono2, 1, true );
+  ret += TestJPEGCodecRoundTrip( mono12, mono2, 3, true );
+  ret += TestJPEGCodecRoundTrip( rgb, rgbpi, 1, true );
+  // Lossy baseline, multi-frame:
+  ret += TestJPEGCodecRoundTrip( mono8, mono2, 4, false );
+  ret += TestJPEGCodecRoundTrip( rgb, ybrpi, 2, false );
+
+  return ret;
+}
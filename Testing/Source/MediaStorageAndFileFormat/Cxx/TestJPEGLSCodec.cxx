@@ -0,0 +1,202 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmJPEGLSCodec.h"
+#include "gdcmDataElement.h"
+#include "gdcmByteValue.h"
+#include "gdcmSequenceOfFragments.h"
+#include "gdcmImage.h"
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <algorithm>
+
+static int TestJPEGLSCodecRoundTrip(const gdcm::PixelFormat &pf,
+  const gdcm::PhotometricInterpretation &pi, unsigned int nframes,
+  unsigned int nthreads)
+{
+  const unsigned int dims[3] = { 67, 45, nframes };
+  const size_t len = (size_t)dims[0] * dims[1] * dims[2] * pf.GetPixelSize();
+  std::vector<char> input( len );
+  unsigned int seed = 1234;
+  for( size_t i = 0; i < len; ++i )
+    {
+    seed = seed * 1103515245 + 12345;
+    input[i] = (char)( (i / 7) + ((seed >> 16) & 0x3) );
+    }
+  if( pf.GetBitsAllocated() == 16 )
+    {
+    // keep the values within Bits Stored:
+    unsigned short *p = (unsigned short*)input.data();
+    const unsigned short mask = (unsigned short)((1 << pf.GetBitsStored()) - 1);
+    for( size_t i = 0; i < len / 2; ++i ) p[i] &= mask;
+    }
+
+  gdcm::JPEGLSCodec codec;
+  codec.SetNumberOfDimensions( nframes > 1 ? 3 : 2 );
+  codec.SetDimensions( dims );
+  codec.SetPixelFormat( pf );
+  codec.SetPhotometricInterpretation( pi );
+  codec.SetNumberOfThreads( nthreads );
+
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( input.data(), (uint32_t)len );
+  gdcm::DataElement compressed;
+  if( !codec.Code( raw, compressed ) )
+    {
+    std::cerr << "Could not encode" << std::endl;
+    return 1;
+    }
+  if( !compressed.GetSequenceOfFragments()
+    || compressed.GetSequenceOfFragments()->GetNumberOfFragments() != nframes )
+    {
+    return 1;
+    }
+
+  // Decode directly into a caller buffer:
+  std::vector<char> output( len );
+  if( !codec.DecodeToBuffer( compressed, output.data(), output.size() ) )
+    {
+    std::cerr << "Could not decode to buffer" << std::endl;
+    return 1;
+    }
+  if( output != input )
+    {
+    std::cerr << "Decoded buffer differs" << std::endl;
+    return 1;
+    }
+  if( codec.IsLossy() ) return 1;
+
+  // Wrong size is refused:
+  if( codec.DecodeToBuffer( compressed, output.data(), output.size() - nframes ) )
+    {
+    return 1;
+    }
+
+  // Decode into a DataElement:
+  gdcm::DataElement decompressed;
+  if( !codec.Decode( compressed, decompressed ) )
+    {
+    std::cerr << "Could not decode" << std::endl;
+    return 1;
+    }
+  const gdcm::ByteValue *bv = decompressed.GetByteValue();
+  if( !bv || bv->GetLength() < len || memcmp( bv->GetPointer(), input.data(), len ) != 0 )
+    {
+    std::cerr << "Decoded value differs" << std::endl;
+    return 1;
+    }
+
+  // Decode through Bitmap::GetBuffer, which passes on its number of threads:
+  gdcm::Image image;
+  image.SetNumberOfDimensions( nframes > 1 ? 3 : 2 );
+  image.SetDimensions( dims );
+  image.SetPixelFormat( pf );
+  image.SetPhotometricInterpretation( pi );
+  image.SetTransferSyntax( gdcm::TransferSyntax::JPEGLSLossless );
+  image.SetDataElement( compressed );
+  image.SetNumberOfThreads( nthreads );
+  std::fill( output.begin(), output.end(), 0 );
+  if( !image.GetBuffer( output.data() ) || output != input )
+    {
+    std::cerr << "Could not decode through Bitmap" << std::endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+// Planar Configuration = 1 input is encoded without interleaving (ILV none),
+// every frame is decoded back pixel interleaved (CP-1843)
+static int TestJPEGLSCodecPlanar(unsigned int nframes, unsigned int nthreads)
+{
+  gdcm::PixelFormat rgb( gdcm::PixelFormat::UINT8 );
+  rgb.SetSamplesPerPixel( 3 );
+  const unsigned int dims[3] = { 31, 17, nframes };
+  const size_t npixels = (size_t)dims[0] * dims[1];
+  const size_t len = npixels * 3 * nframes;
+  std::vector<char> planar( len );
+  std::vector<char> interleaved( len );
+  for( unsigned int f = 0; f < nframes; ++f )
+    {
+    for( size_t i = 0; i < npixels; ++i )
+      {
+      for( int c = 0; c < 3; ++c )
+        {
+        const char v = (char)(i * (c + 1) + 50 * f + 80 * c);
+        planar[ f * npixels * 3 + c * npixels + i ] = v;
+        interleaved[ f * npixels * 3 + 3 * i + c ] = v;
+        }
+      }
+    }
+
+  gdcm::JPEGLSCodec codec;
+  codec.SetNumberOfDimensions( nframes > 1 ? 3 : 2 );
+  codec.SetDimensions( dims );
+  codec.SetPixelFormat( rgb );
+  codec.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::RGB );
+  codec.SetPlanarConfiguration( 1 );
+  codec.SetNumberOfThreads( nthreads );
+
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( planar.data(), (uint32_t)len );
+  gdcm::DataElement compressed;
+  if( !codec.Code( raw, compressed ) )
+    {
+    std::cerr << "Could not encode planar" << std::endl;
+    return 1;
+    }
+
+  std::vector<char> output( len );
+  if( !codec.DecodeToBuffer( compressed, output.data(), output.size() )
+    || output != interleaved )
+    {
+    std::cerr << "Planar frames not interleaved (" << nframes << " frames)" << std::endl;
+    return 1;
+    }
+  gdcm::DataElement decompressed;
+  if( !codec.Decode( compressed, decompressed ) ) return 1;
+  const gdcm::ByteValue *bv = decompressed.GetByteValue();
+  if( !bv || bv->GetLength() < len || memcmp( bv->GetPointer(), interleaved.data(), len ) != 0 )
+    {
+    std::cerr << "Planar value not interleaved (" << nframes << " frames)" << std::endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+int TestJPEGLSCodec(int , char *[])
+{
+  int ret = 0;
+  const gdcm::PixelFormat mono16( gdcm::PixelFormat::UINT16 );
+  gdcm::PixelFormat mono12( gdcm::PixelFormat::UINT16 );
+  mono12.SetBitsStored( 12 );
+  gdcm::PixelFormat rgb( gdcm::PixelFormat::UINT8 );
+  rgb.SetSamplesPerPixel( 3 );
+  const gdcm::PhotometricInterpretation mono2 = gdcm::PhotometricInterpretation::MONOCHROME2;
+  const gdcm::PhotometricInterpretation rgbpi = gdcm::PhotometricInterpretation::RGB;
+
+  ret += TestJPEGLSCodecRoundTrip( mono16, mono2, 1, 1 );
+  ret += TestJPEGLSCodecRoundTrip( mono12, mono2, 7, 1 );
+  ret += TestJPEGLSCodecRoundTrip( mono12, mono2, 7, 3 );
+  ret += TestJPEGLSCodecRoundTrip( mono16, mono2, 5, 0 );
+  ret += TestJPEGLSCodecRoundTrip( rgb, rgbpi, 1, 1 );
+  ret += TestJPEGLSCodecRoundTrip( rgb, rgbpi, 4, 2 );
+  ret += TestJPEGLSCodecPlanar( 1, 1 );
+  ret += TestJPEGLSCodecPlanar( 5, 1 );
+  ret += TestJPEGLSCodecPlanar( 5, 3 );
+
+  return ret;
+}
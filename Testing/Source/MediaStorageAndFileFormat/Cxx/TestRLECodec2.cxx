@@ -0,0 +1,250 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmRLECodec.h"
+#include "gdcmDataElement.h"
+#include "gdcmByteValue.h"
+#include "gdcmSequenceOfFragments.h"
+#include "gdcmImage.h"
+#include "gdcmInstrumentation.h"
+
+#include <iostream>
+#include <vector>
+#include <cstring>
+
+static int TestRLECodecRoundTrip(const gdcm::PixelFormat &pf,
+  const gdcm::PhotometricInterpretation &pi, unsigned int planarconf,
+  const unsigned int dims[3], unsigned int nthreads)
+{
+  const unsigned int nframes = dims[2];
+  const size_t len = (size_t)dims[0] * dims[1] * dims[2] * pf.GetPixelSize();
+  std::vector<char> input( len );
+  unsigned int seed = 1234;
+  for( size_t i = 0; i < len; ++i )
+    {
+    seed = seed * 1103515245 + 12345;
+    // long runs as well as literal runs:
+    input[i] = (i / 300) % 2 ? (char)(i / 1000) : (char)(seed >> 16);
+    }
+
+  gdcm::RLECodec codec;
+  codec.SetNumberOfDimensions( nframes > 1 ? 3 : 2 );
+  codec.SetDimensions( dims );
+  codec.SetPixelFormat( pf );
+  codec.SetPhotometricInterpretation( pi );
+  codec.SetPlanarConfiguration( planarconf );
+  codec.SetBufferLength( (unsigned long)len );
+  codec.SetNumberOfThreads( nthreads );
+
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( input.data(), (uint32_t)len );
+  gdcm::DataElement compressed;
+  if( !codec.Code( raw, compressed ) )
+    {
+    std::cerr << "Could not encode" << std::endl;
+    return 1;
+    }
+  const gdcm::SequenceOfFragments *sf = compressed.GetSequenceOfFragments();
+  if( !sf || sf->GetNumberOfFragments() != nframes )
+    {
+    return 1;
+    }
+
+  // The encoded stream does not depend on the number of threads:
+  gdcm::RLECodec single;
+  single.SetNumberOfDimensions( nframes > 1 ? 3 : 2 );
+  single.SetDimensions( dims );
+  single.SetPixelFormat( pf );
+  single.SetPhotometricInterpretation( pi );
+  single.SetPlanarConfiguration( planarconf );
+  single.SetNumberOfThreads( 1 );
+  gdcm::DataElement reference;
+  if( !single.Code( raw, reference )
+    || !(*reference.GetSequenceOfFragments() == *sf) )
+    {
+    std::cerr << "Encoding depends on the number of threads" << std::endl;
+    return 1;
+    }
+
+  // Decode directly into a caller buffer:
+  std::vector<char> output( len );
+  if( !codec.DecodeToBuffer( compressed, output.data(), output.size() ) )
+    {
+    std::cerr << "Could not decode to buffer" << std::endl;
+    return 1;
+    }
+  if( output != input )
+    {
+    std::cerr << "Decoded buffer differs" << std::endl;
+    return 1;
+    }
+
+  // Wrong size is refused:
+  if( codec.DecodeToBuffer( compressed, output.data(), output.size() - nframes ) )
+    {
+    return 1;
+    }
+
+  // Decode into a DataElement:
+  gdcm::DataElement decompressed;
+  if( !codec.Decode( compressed, decompressed ) )
+    {
+    std::cerr << "Could not decode" << std::endl;
+    return 1;
+    }
+  const gdcm::ByteValue *bv = decompressed.GetByteValue();
+  if( !bv || bv->GetLength() < len || memcmp( bv->GetPointer(), input.data(), len ) != 0 )
+    {
+    std::cerr << "Decoded value differs" << std::endl;
+    return 1;
+    }
+
+  // A truncated segment is an error, not a partial image:
+  const gdcm::ByteValue *frag = sf->GetFragment(0).GetByteValue();
+  gdcm::SmartPointer<gdcm::SequenceOfFragments> truncated = new gdcm::SequenceOfFragments;
+  gdcm::Fragment f;
+  f.SetByteValue( frag->GetPointer(), frag->GetLength() - 16 );
+  truncated->AddFragment( f );
+  for( unsigned int i = 1; i < nframes; ++i )
+    {
+    truncated->AddFragment( sf->GetFragment(i) );
+    }
+  gdcm::DataElement broken( gdcm::Tag(0x7fe0,0x0010) );
+  broken.SetValue( *truncated );
+  if( codec.DecodeToBuffer( broken, output.data(), output.size() ) )
+    {
+    std::cerr << "Truncated stream was decoded" << std::endl;
+    return 1;
+    }
+
+  return 0;
+}
+
+// Runs as specified in PS 3.5 G.3.1
+static int TestRLECodecRuns()
+{
+  const char row[] = { 0, 1, 1, 0, 5, 5, 5, 5, 7, 8, 8 };
+  const unsigned int dims[3] = { sizeof(row), 1, 1 };
+  gdcm::RLECodec codec;
+  codec.SetNumberOfDimensions( 2 );
+  codec.SetDimensions( dims );
+  codec.SetPixelFormat( gdcm::PixelFormat::UINT8 );
+  codec.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::MONOCHROME2 );
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( row, sizeof(row) );
+  gdcm::DataElement compressed;
+  if( !codec.Code( raw, compressed ) ) return 1;
+  const gdcm::ByteValue *bv =
+    compressed.GetSequenceOfFragments()->GetFragment(0).GetByteValue();
+  // 2-byte repeat merged within a literal run, replicate runs otherwise:
+  const char segment[] = { 3, 0, 1, 1, 0, -3, 5, 0, 7, -1, 8 };
+  if( !bv || bv->GetLength() < 64 + sizeof(segment)
+    || memcmp( bv->GetPointer() + 64, segment, sizeof(segment) ) != 0 )
+    {
+    std::cerr << "Wrong RLE segment" << std::endl;
+    return 1;
+    }
+  return 0;
+}
+
+// Only the decodes which succeeded are accounted for:
+static int TestRLECodecInstrumentation()
+{
+  const unsigned int dims[3] = { 64, 32, 1 };
+  std::vector<char> input( dims[0] * dims[1] );
+  for( size_t i = 0; i < input.size(); ++i )
+    {
+    input[i] = (char)(i / 7);
+    }
+  gdcm::RLECodec codec;
+  codec.SetNumberOfDimensions( 2 );
+  codec.SetDimensions( dims );
+  codec.SetPixelFormat( gdcm::PixelFormat::UINT8 );
+  codec.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::MONOCHROME2 );
+  gdcm::DataElement raw( gdcm::Tag(0x7fe0,0x0010) );
+  raw.SetByteValue( input.data(), (uint32_t)input.size() );
+  gdcm::DataElement compressed( gdcm::Tag(0x7fe0,0x0010) );
+  if( !codec.Code( raw, compressed ) ) return 1;
+  const gdcm::ByteValue *frag =
+    compressed.GetSequenceOfFragments()->GetFragment(0).GetByteValue();
+  gdcm::SmartPointer<gdcm::SequenceOfFragments> truncated = new gdcm::SequenceOfFragments;
+  gdcm::Fragment f;
+  f.SetByteValue( frag->GetPointer(), frag->GetLength() - 16 );
+  truncated->AddFragment( f );
+  gdcm::DataElement broken( gdcm::Tag(0x7fe0,0x0010) );
+  broken.SetValue( *truncated );
+
+  gdcm::Image image;
+  image.SetNumberOfDimensions( 2 );
+  image.SetDimensions( dims );
+  image.SetPixelFormat( gdcm::PixelFormat::UINT8 );
+  image.SetPhotometricInterpretation( gdcm::PhotometricInterpretation::MONOCHROME2 );
+  image.SetTransferSyntax( gdcm::TransferSyntax::RLELossless );
+  std::vector<char> output( input.size() );
+
+  gdcm::Instrumentation::Reset();
+  gdcm::Instrumentation::EnabledOn();
+  image.SetDataElement( broken );
+  const bool brokenok = image.GetBuffer( output.data() );
+  image.SetDataElement( compressed );
+  const bool ok = image.GetBuffer( output.data() );
+  const uint64_t count = gdcm::Instrumentation::GetCount( gdcm::Instrumentation::DecodeRLE );
+  gdcm::Instrumentation::EnabledOff();
+  gdcm::Instrumentation::Reset();
+  if( brokenok || !ok || output != input )
+    {
+    std::cerr << "Unexpected decode result" << std::endl;
+    return 1;
+    }
+  if( count != 1 )
+    {
+    std::cerr << "Failed decode was recorded: " << count << std::endl;
+    return 1;
+    }
+  return 0;
+}
+
+int TestRLECodec2(int , char *[])
+{
+  int ret = TestRLECodecRuns();
+  ret += TestRLECodecInstrumentation();
+  const gdcm::PixelFormat mono8( gdcm::PixelFormat::UINT8 );
+  const gdcm::PixelFormat mono16( gdcm::PixelFormat::UINT16 );
+  const gdcm::PixelFormat mono32( gdcm::PixelFormat::UINT32 );
+  gdcm::PixelFormat rgb( gdcm::PixelFormat::UINT8 );
+  rgb.SetSamplesPerPixel( 3 );
+  gdcm::PixelFormat rgb16( gdcm::PixelFormat::UINT16 );
+  rgb16.SetSamplesPerPixel( 3 );
+  const gdcm::PhotometricInterpretation mono2 = gdcm::PhotometricInterpretation::MONOCHROME2;
+  const gdcm::PhotometricInterpretation rgbpi = gdcm::PhotometricInterpretation::RGB;
+
+  const unsigned int small[3] = { 68, 45, 1 };
+  const unsigned int multi[3] = { 68, 45, 7 };
+  // large enough for the segments to be decoded in parallel:
+  const unsigned int large[3] = { 512, 300, 1 };
+
+  ret += TestRLECodecRoundTrip( mono8, mono2, 0, small, 1 );
+  ret += TestRLECodecRoundTrip( mono16, mono2, 0, small, 1 );
+  ret += TestRLECodecRoundTrip( mono32, mono2, 0, small, 1 );
+  ret += TestRLECodecRoundTrip( mono16, mono2, 0, multi, 3 );
+  ret += TestRLECodecRoundTrip( mono8, mono2, 0, multi, 0 );
+  ret += TestRLECodecRoundTrip( rgb, rgbpi, 0, small, 1 );
+  ret += TestRLECodecRoundTrip( rgb, rgbpi, 1, small, 1 );
+  ret += TestRLECodecRoundTrip( rgb, rgbpi, 0, multi, 2 );
+  ret += TestRLECodecRoundTrip( rgb16, rgbpi, 0, small, 1 );
+  ret += TestRLECodecRoundTrip( rgb16, rgbpi, 1, multi, 4 );
+  ret += TestRLECodecRoundTrip( mono16, mono2, 0, large, 4 );
+  ret += TestRLECodecRoundTrip( rgb, rgbpi, 0, large, 0 );
+
+  return ret;
+}
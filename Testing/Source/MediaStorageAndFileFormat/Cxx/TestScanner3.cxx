@@ -0,0 +1,151 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmScanner.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+#include "gdcmSystem.h"
+#include "gdcmTesting.h"
+#include "gdcmTrace.h"
+
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+// The result of a Scan does not depend on the number of threads
+typedef std::map<gdcm::Tag, std::string> Values;
+typedef std::map<std::string, Values> Mappings;
+
+static bool WriteFile(const std::string &filename, int i)
+{
+  gdcm::Writer w;
+  gdcm::DataSet &ds = w.GetFile().GetDataSet();
+  gdcm::Attribute<0x0008,0x0016> sopclass = { "1.2.840.10008.5.1.4.1.1.7" };
+  ds.Insert( sopclass.GetAsDataElement() );
+  std::ostringstream uid;
+  uid << "1.2.3.4.5." << i;
+  gdcm::Attribute<0x0008,0x0018> sopinstance = { uid.str() };
+  ds.Insert( sopinstance.GetAsDataElement() );
+  if( i % 3 )
+    {
+    // Patient's Name is missing from some files:
+    gdcm::Attribute<0x0010,0x0010> patientname = { i % 2 ? "ODD^PATIENT" : "EVEN^PATIENT" };
+    ds.Insert( patientname.GetAsDataElement() );
+    }
+  std::ostringstream seriesuid;
+  seriesuid << "1.2.3.4.6." << i % 4;
+  gdcm::Attribute<0x0020,0x000e> series = { seriesuid.str() };
+  ds.Insert( series.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x0013> instance = { i };
+  ds.Insert( instance.GetAsDataElement() );
+  w.GetFile().GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  w.SetFileName( filename.c_str() );
+  return w.Write();
+}
+
+static bool Scan(gdcm::Directory::FilenamesType const &filenames,
+  unsigned int nthreads, Mappings &mappings, std::string &table)
+{
+  gdcm::Scanner s;
+  s.AddTag( gdcm::Tag(0x0008,0x0018) );
+  s.AddTag( gdcm::Tag(0x0010,0x0010) );
+  s.AddTag( gdcm::Tag(0x0020,0x000e) );
+  s.AddTag( gdcm::Tag(0x0020,0x0013) );
+  s.AddTag( gdcm::Tag(0x0028,0x0010) ); // never found
+  s.SetNumberOfThreads( nthreads );
+  if( !s.Scan( filenames ) ) return false;
+  if( s.GetFilenames() != filenames ) return false;
+
+  mappings.clear();
+  for( gdcm::Scanner::ConstIterator it = s.Begin(); it != s.End(); ++it )
+    {
+    Values &v = mappings[ it->first ];
+    const gdcm::Scanner::TagToValue &ttv = it->second;
+    for( gdcm::Scanner::TagToValue::const_iterator t = ttv.begin(); t != ttv.end(); ++t )
+      {
+      v[ t->first ] = t->second;
+      }
+    }
+  // Values of the lookup tables:
+  if( s.GetValues( gdcm::Tag(0x0020,0x000e) ).size() != 4 ) return false;
+  if( s.GetValues( gdcm::Tag(0x0010,0x0010) ).size() != 2 ) return false;
+  if( !s.GetValues( gdcm::Tag(0x0028,0x0010) ).empty() ) return false;
+  if( s.GetAllFilenamesFromTagToValue( gdcm::Tag(0x0020,0x000e), "1.2.3.4.6.1" ).size()
+    != 10 ) return false;
+
+  std::ostringstream os;
+  s.PrintTable( os );
+  table = os.str();
+  return true;
+}
+
+int TestScanner3(int, char *[])
+{
+  gdcm::Trace::WarningOff();
+  gdcm::Trace::ErrorOff();
+
+  const char subdir[] = "TestScanner3";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+
+  gdcm::Directory::FilenamesType filenames;
+  const int nfiles = 40;
+  for( int i = 0; i < nfiles; ++i )
+    {
+    std::ostringstream name;
+    name << "file" << i << ".dcm";
+    const std::string filename = gdcm::Testing::GetTempFilename( name.str().c_str(), subdir );
+    if( !WriteFile( filename, i ) ) return 1;
+    filenames.push_back( filename );
+    }
+  // Not a DICOM file and not a file at all, in the middle of the list:
+  const std::string text = gdcm::Testing::GetTempFilename( "text.txt", subdir );
+    {
+    std::ofstream os( text.c_str() );
+    os << "not a DICOM file" << std::endl;
+    }
+  filenames.insert( filenames.begin() + 7, text );
+  filenames.insert( filenames.begin() + 21, gdcm::Testing::GetTempFilename( "missing.dcm", subdir ) );
+
+  Mappings reference;
+  std::string referencetable;
+  if( !Scan( filenames, 1, reference, referencetable ) )
+    {
+    std::cerr << "Could not scan" << std::endl;
+    return 1;
+    }
+  // nothing is found in the files which could not be read:
+  if( reference.size() < (size_t)nfiles ) return 1;
+  if( reference.count( text ) && !reference.find( text )->second.empty() ) return 1;
+  const Values &v = reference[ filenames[0] ];
+  if( v.size() != 3 || v.find( gdcm::Tag(0x0020,0x0013) )->second != "0 " ) return 1;
+
+  const unsigned int nthreads[] = { 2, 5, 0 };
+  for( int t = 0; t < 3; ++t )
+    {
+    Mappings mappings;
+    std::string table;
+    if( !Scan( filenames, nthreads[t], mappings, table ) ) return 1;
+    if( mappings != reference || table != referencetable )
+      {
+      std::cerr << "Scan with " << nthreads[t] << " threads differs" << std::endl;
+      return 1;
+      }
+    }
+
+  return 0;
+}
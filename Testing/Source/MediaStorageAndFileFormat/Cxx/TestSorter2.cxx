@@ -0,0 +1,174 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmSorter.h"
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+#include "gdcmWriter.h"
+#include "gdcmAttribute.h"
+
+#include <sstream>
+
+static bool WriteFile(const std::string &filename, int instance, int series)
+{
+  gdcm::Writer w;
+  gdcm::DataSet &ds = w.GetFile().GetDataSet();
+  std::ostringstream uid;
+  uid << "1.2.3.4." << series << "." << instance;
+  gdcm::Attribute<0x0008,0x0016> sopclass = { "1.2.840.10008.5.1.4.1.1.7" };
+  ds.Insert( sopclass.GetAsDataElement() );
+  gdcm::Attribute<0x0008,0x0018> sopinstance = { uid.str() };
+  ds.Insert( sopinstance.GetAsDataElement() );
+  std::ostringstream seriesuid;
+  seriesuid << "1.2.3.4." << series;
+  gdcm::Attribute<0x0020,0x000e> seriesinstance = { seriesuid.str() };
+  ds.Insert( seriesinstance.GetAsDataElement() );
+  gdcm::Attribute<0x0020,0x0013> number = { instance };
+  ds.Insert( number.GetAsDataElement() );
+  const std::string pixels( 4096, (char)instance );
+  gdcm::DataElement pixeldata( gdcm::Tag(0x7fe0,0x0010), 0, gdcm::VR::OB );
+  pixeldata.SetByteValue( pixels.c_str(), (uint32_t)pixels.size() );
+  ds.Insert( pixeldata );
+  w.GetFile().GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  w.SetFileName( filename.c_str() );
+  return w.Write();
+}
+
+// Series Instance UID, then Instance Number
+static bool GetKey(gdcm::DataSet const &ds, gdcm::SortKey &key, void *)
+{
+  // keys are extracted without the pixel data:
+  if( ds.FindDataElement( gdcm::Tag(0x7fe0,0x0010) ) ) return false;
+  if( !ds.FindDataElement( gdcm::Tag(0x0020,0x0013) ) ) return false;
+  gdcm::Attribute<0x0020,0x000e> seriesuid;
+  seriesuid.SetFromDataSet( ds );
+  gdcm::Attribute<0x0020,0x0013> instance;
+  instance.SetFromDataSet( ds );
+  key.Append( seriesuid.GetValue() );
+  key.Append( instance.GetValue() );
+  return true;
+}
+
+// Instance Number, times the sign given as userdata (ascending by default)
+static bool GetInstanceKey(gdcm::DataSet const &ds, gdcm::SortKey &key, void *userdata)
+{
+  const double sign = userdata ? *(const double*)userdata : 1.;
+  gdcm::Attribute<0x0020,0x0013> instance;
+  instance.SetFromDataSet( ds );
+  key.Append( sign * instance.GetValue() );
+  return true;
+}
+
+static bool NoKey(gdcm::DataSet const &, gdcm::SortKey &, void *)
+{
+  return false;
+}
+
+int TestSorter2(int, char *[])
+{
+  const char subdir[] = "TestSorter2";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+
+  // two series, instance numbers given in a shuffled order:
+  const int nfiles = 40;
+  std::vector<std::string> filenames;
+  for( int i = 0; i < nfiles; ++i )
+    {
+    std::ostringstream name;
+    name << "file" << i << ".dcm";
+    const std::string filename = gdcm::Testing::GetTempFilename( name.str().c_str(), subdir );
+    const int instance = (i / 2 * 7) % (nfiles / 2) + 1;
+    if( !WriteFile( filename, instance, i % 2 ) ) return 1;
+    filenames.push_back( filename );
+    }
+
+  std::vector<std::string> expected( nfiles );
+  for( int i = 0; i < nfiles; ++i )
+    {
+    const int instance = (i / 2 * 7) % (nfiles / 2) + 1;
+    expected[ (i % 2) * (nfiles / 2) + instance - 1 ] = filenames[i];
+    }
+
+  const unsigned int nthreads[] = { 1, 4, 0 };
+  for( int t = 0; t < 3; ++t )
+    {
+    gdcm::Sorter s;
+    s.SetKeyFunction( GetKey );
+    s.SetNumberOfThreads( nthreads[t] );
+    if( !s.Sort( filenames ) || s.GetFilenames() != expected )
+      {
+      std::cerr << "Sort failed with " << nthreads[t] << " threads" << std::endl;
+      return 1;
+      }
+    if( !s.StableSort( filenames ) || s.GetFilenames() != expected )
+      {
+      std::cerr << "StableSort failed with " << nthreads[t] << " threads" << std::endl;
+      return 1;
+      }
+    // sorting our own output:
+    if( !s.StableSort( s.GetFilenames() ) || s.GetFilenames() != expected ) return 1;
+    }
+
+  // Same instance numbers in both series: the input order is kept
+  gdcm::Sorter stable;
+  stable.SetKeyFunction( GetInstanceKey );
+  std::set<gdcm::Tag> tags;
+  tags.insert( gdcm::Tag(0x0020,0x0013) );
+  stable.SetTagsToRead( tags );
+  stable.SetNumberOfThreads( 4 );
+  if( !stable.StableSort( filenames ) ) return 1;
+  const std::vector<std::string> &sorted = stable.GetFilenames();
+  for( int i = 0; i < nfiles; i += 2 )
+    {
+    // series 0 is before series 1 in the input:
+    if( sorted[i] != expected[i / 2] || sorted[i + 1] != expected[nfiles / 2 + i / 2] )
+      {
+      std::cerr << "StableSort is not stable" << std::endl;
+      return 1;
+      }
+    }
+
+  // Key function parameters given as userdata:
+  double descending = -1.;
+  gdcm::Sorter reverse;
+  reverse.SetKeyFunction( GetInstanceKey, &descending );
+  reverse.SetTagsToRead( tags );
+  if( !reverse.StableSort( filenames ) ) return 1;
+  const std::vector<std::string> &rsorted = reverse.GetFilenames();
+  for( int i = 0; i < nfiles; i += 2 )
+    {
+    if( rsorted[i] != expected[nfiles / 2 - 1 - i / 2]
+      || rsorted[i + 1] != expected[nfiles - 1 - i / 2] )
+      {
+      std::cerr << "Descending sort failed" << std::endl;
+      return 1;
+      }
+    }
+
+  // Errors:
+  gdcm::Sorter nokey;
+  nokey.SetKeyFunction( NoKey );
+  if( nokey.Sort( filenames ) ) return 1;
+  std::vector<std::string> missing = filenames;
+  missing.push_back( gdcm::Testing::GetTempFilename( "missing.dcm", subdir ) );
+  gdcm::Sorter s;
+  s.SetKeyFunction( GetKey );
+  s.SetNumberOfThreads( 4 );
+  if( s.Sort( missing ) ) return 1;
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmSplitMosaicFilter.h"
+
+#include <iostream>
+#include <vector>
+
+// Tile copies of SplitMosaicFilter, on a synthetic 2x2 mosaic of 4x3 tiles
+// (the last tile is padding)
+int TestSplitMosaicFilter4(int, char *[])
+{
+  const unsigned int inputdims[2] = { 8, 6 };
+  const unsigned int dims[3] = { 4, 3, 3 };
+  const unsigned int pixelsize = 2;
+  std::vector<unsigned short> mosaic( inputdims[0] * inputdims[1] );
+  for( unsigned int y = 0; y < inputdims[1]; ++y )
+    for( unsigned int x = 0; x < inputdims[0]; ++x )
+      mosaic[ y * inputdims[0] + x ] = (unsigned short)(y * 100 + x);
+  const char *input = (const char*)mosaic.data();
+  const unsigned int tiles = 2;
+
+  std::vector<unsigned short> slice( dims[0] * dims[1] );
+  for( unsigned int z = 0; z < dims[2]; ++z )
+    {
+    if( !gdcm::SplitMosaicFilter::ExtractTile( input, inputdims, dims,
+        pixelsize, z, (char*)slice.data() ) ) return 1;
+    const unsigned int ox = (z % tiles) * dims[0];
+    const unsigned int oy = (z / tiles) * dims[1];
+    for( unsigned int y = 0; y < dims[1]; ++y )
+      for( unsigned int x = 0; x < dims[0]; ++x )
+        {
+        if( slice[ y * dims[0] + x ] != mosaic[ (oy + y) * inputdims[0] + ox + x ] )
+          {
+          std::cerr << "Wrong value in tile " << z << std::endl;
+          return 1;
+          }
+        }
+    }
+  // there is no such tile in the mosaic:
+  if( gdcm::SplitMosaicFilter::ExtractTile( input, inputdims, dims,
+      pixelsize, 3, (char*)slice.data() ) ) return 1;
+
+  const size_t slicelen = dims[0] * dims[1];
+  std::vector<unsigned short> volume( slicelen * dims[2] );
+  std::vector<unsigned short> inverted( slicelen * dims[2] );
+  if( !gdcm::SplitMosaicFilter::ReorganizeMosaic( input, inputdims, dims,
+      pixelsize, false, (char*)volume.data() ) ) return 1;
+  if( !gdcm::SplitMosaicFilter::ReorganizeMosaic( input, inputdims, dims,
+      pixelsize, true, (char*)inverted.data() ) ) return 1;
+  for( unsigned int z = 0; z < dims[2]; ++z )
+    {
+    for( size_t i = 0; i < slicelen; ++i )
+      {
+      if( volume[ z * slicelen + i ] != inverted[ (dims[2] - 1 - z) * slicelen + i ] )
+        {
+        std::cerr << "Inverted slice " << z << " does not match" << std::endl;
+        return 1;
+        }
+      }
+    }
+  // the first slice is the top left tile:
+  if( volume[0] != 0 || volume[ slicelen ] != 4 || volume[ 2 * slicelen ] != 300 )
+    return 1;
+
+  // tiles do not fit in the mosaic:
+  const unsigned int toolarge[3] = { 4, 3, 5 };
+  std::vector<unsigned short> dummy( slicelen * toolarge[2] );
+  if( gdcm::SplitMosaicFilter::ReorganizeMosaic( input, inputdims, toolarge,
+      pixelsize, false, (char*)dummy.data() ) ) return 1;
+
+  return 0;
+}
@@ -0,0 +1,205 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmAnonymizer.h"
+#include "gdcmDefs.h"
+#include "gdcmDicts.h"
+#include "gdcmGlobal.h"
+#include "gdcmReader.h"
+#include "gdcmUIDGenerator.h"
+#include "gdcmWriter.h"
+
+#include <cstring>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Stress test for the process wide state: many threads parse, anonymize,
+// write and generate UIDs at the same time.
+static const unsigned int nthreads = 8;
+static const unsigned int niterations = 50;
+static const unsigned int nuids = 100;
+
+static const char OrigSOPInstanceUID[] = "1.2.3.4.5.6.7.8.9.10";
+
+namespace
+{
+class ProtectAnonymizer : public gdcm::Anonymizer
+{
+public:
+  bool Protect(gdcm::Tag const &tag)
+    {
+    const gdcm::Defs &defs = gdcm::Global::GetInstance().GetDefs();
+    const gdcm::IOD &iod = defs.GetIODFromFile( GetFile() );
+    return BALCPProtect( GetFile().GetDataSet(), tag, iod );
+    }
+};
+
+struct Result
+{
+  Result():OK(false) {}
+  bool OK;
+  std::string SOPInstanceUID;
+  std::string Modality;
+  std::vector<std::string> UIDs;
+};
+}
+
+static void Insert(gdcm::DataSet &ds, uint16_t g, uint16_t e, gdcm::VR const &vr, const char *value)
+{
+  gdcm::DataElement de( gdcm::Tag(g,e), 0, vr );
+  std::string v = value;
+  if( v.size() % 2 ) v.push_back( vr == gdcm::VR::UI ? '\0' : ' ' );
+  de.SetByteValue( v.c_str(), (uint32_t)v.size() );
+  ds.Insert( de );
+}
+
+static std::string GetValue(gdcm::DataSet const &ds, gdcm::Tag const &t)
+{
+  const gdcm::ByteValue *bv = ds.GetDataElement( t ).GetByteValue();
+  return bv ? std::string( bv->GetPointer(), bv->GetLength() ) : std::string();
+}
+
+static void Worker(const std::string *input, unsigned int id, Result *result)
+{
+  gdcm::Global &g = gdcm::Global::GetInstance();
+  if( !g.LoadResourcesFiles() ) return;
+  const gdcm::Dicts &dicts = g.GetDicts();
+  gdcm::UIDGenerator uid;
+  for( unsigned int i = 0; i < niterations; ++i )
+    {
+    std::istringstream is( *input );
+    gdcm::Reader reader;
+    reader.SetStream( is );
+    if( !reader.Read() ) return;
+    gdcm::File &file = reader.GetFile();
+    const gdcm::DataSet &ds = file.GetDataSet();
+
+    const gdcm::DictEntry &entry = dicts.GetDictEntry( gdcm::Tag(0x0010,0x0010) );
+    if( strcmp( entry.GetName(), "Patient's Name" ) != 0 ) return;
+    if( ds.GetDataElement( gdcm::Tag(0x0008,0x0018) ).GetVR() != gdcm::VR::UI ) return;
+
+    ProtectAnonymizer ano;
+    ano.SetFile( file );
+    if( !ano.RemovePrivateTags() || !ano.RemoveRetired() ) return;
+    if( ds.FindDataElement( gdcm::Tag(0x0009,0x0010) )
+      || ds.FindDataElement( gdcm::Tag(0x0008,0x0010) ) ) return;
+    if( !ano.Protect( gdcm::Tag(0x0008,0x0018) )
+      || !ano.Protect( gdcm::Tag(0x0008,0x0060) ) ) return;
+    // dummy values (Type 1 attributes) are shared by all threads:
+    const std::string sopinstanceuid = GetValue( ds, gdcm::Tag(0x0008,0x0018) );
+    const std::string modality = GetValue( ds, gdcm::Tag(0x0008,0x0060) );
+    if( sopinstanceuid.empty() || modality == "OT" ) return;
+    if( i == 0 )
+      {
+      result->SOPInstanceUID = sopinstanceuid;
+      result->Modality = modality;
+      }
+    else if( sopinstanceuid != result->SOPInstanceUID
+      || modality != result->Modality ) return;
+
+    std::ostringstream os;
+    gdcm::Writer writer;
+    writer.SetStream( os );
+    writer.SetFile( file );
+    if( !writer.Write() ) return;
+
+    // one thread keeps changing the root while the others generate:
+    if( id == 0 )
+      {
+      gdcm::UIDGenerator::SetRoot( i % 2 ? "1.2.3.4" : gdcm::UIDGenerator::GetGDCMUID() );
+      }
+    for( unsigned int u = 0; u < nuids; ++u )
+      {
+      const char *s = uid.Generate();
+      if( !s ) return;
+      result->UIDs.emplace_back( s );
+      }
+    }
+  result->OK = true;
+}
+
+int TestThreadSafety(int, char *[])
+{
+  gdcm::SmartPointer<gdcm::File> file = new gdcm::File;
+  gdcm::DataSet &ds = file->GetDataSet();
+  Insert(ds, 0x0008, 0x0010, gdcm::VR::SH, "RETIRED"); // Recognition Code (retired)
+  Insert(ds, 0x0008, 0x0016, gdcm::VR::UI, "1.2.840.10008.5.1.4.1.1.7"); // Secondary Capture
+  Insert(ds, 0x0008, 0x0018, gdcm::VR::UI, OrigSOPInstanceUID);
+  Insert(ds, 0x0008, 0x0060, gdcm::VR::CS, "OT");
+  Insert(ds, 0x0009, 0x0010, gdcm::VR::LO, "PRIVATE CREATOR");
+  Insert(ds, 0x0009, 0x1001, gdcm::VR::LO, "private value");
+  Insert(ds, 0x0010, 0x0010, gdcm::VR::PN, "Doe^John");
+  Insert(ds, 0x0010, 0x0020, gdcm::VR::LO, "123456");
+  Insert(ds, 0x0020, 0x000d, gdcm::VR::UI, "1.2.3.4.5");
+  Insert(ds, 0x0020, 0x000e, gdcm::VR::UI, "1.2.3.4.5.6");
+  file->GetHeader().SetDataSetTransferSyntax( gdcm::TransferSyntax::ExplicitVRLittleEndian );
+  std::ostringstream os;
+  gdcm::Writer w;
+  w.SetStream( os );
+  w.SetFile( *file );
+  if( !w.Write() ) return 1;
+  const std::string input = os.str();
+
+  Result results[nthreads];
+  std::vector<std::thread> threads;
+  for( unsigned int t = 0; t < nthreads; ++t )
+    {
+    threads.emplace_back( Worker, &input, t, results + t );
+    }
+  for( unsigned int t = 0; t < nthreads; ++t )
+    {
+    threads[t].join();
+    }
+  gdcm::UIDGenerator::SetRoot( gdcm::UIDGenerator::GetGDCMUID() );
+
+  std::set<std::string> uids;
+  for( unsigned int t = 0; t < nthreads; ++t )
+    {
+    if( !results[t].OK )
+      {
+      std::cerr << "Thread " << t << " failed" << std::endl;
+      return 1;
+      }
+    if( results[t].SOPInstanceUID != results[0].SOPInstanceUID
+      || results[t].Modality != results[0].Modality )
+      {
+      std::cerr << "Inconsistent dummy values in thread " << t << std::endl;
+      return 1;
+      }
+    for( size_t u = 0; u < results[t].UIDs.size(); ++u )
+      {
+      const std::string &s = results[t].UIDs[u];
+      if( !gdcm::UIDGenerator::IsValid( s.c_str() ) )
+        {
+        std::cerr << "Invalid UID: " << s << std::endl;
+        return 1;
+        }
+      uids.insert( s );
+      }
+    }
+  if( uids.size() != nthreads * niterations * nuids )
+    {
+    std::cerr << "Duplicate UIDs: " << uids.size() << std::endl;
+    return 1;
+    }
+  if( results[0].SOPInstanceUID.find( OrigSOPInstanceUID ) != std::string::npos )
+    {
+    return 1;
+    }
+
+  return 0;
+}
@@ -16,6 +16,7 @@
 #include <iostream>
 #include <string>
 #include <set>
+#include <vector>
 
 #include <cstring>
 
@@ -91,6 +92,41 @@ int TestUIDGeneratorValid()
   return 0; // no error
 }
 
+int TestUIDGeneratorBatch(const char *root)
+{
+  gdcm::UIDGenerator::SetRoot( root );
+  gdcm::UIDGenerator uid;
+  std::set<std::string> uids;
+  for(unsigned int b = 0; b < 10; ++b)
+    {
+    std::vector<std::string> batch;
+    if( !uid.Generate( batch, 1000 ) || batch.size() != 1000 )
+      {
+      return 1;
+      }
+    for(size_t i = 0; i < batch.size(); ++i)
+      {
+      if( !gdcm::UIDGenerator::IsValid( batch[i].c_str() )
+        || batch[i].compare( 0, strlen(root), root ) != 0 )
+        {
+        std::cerr << "Invalid UID: " << batch[i] << std::endl;
+        return 1;
+        }
+      uids.insert( batch[i] );
+      }
+    }
+  if( uids.size() != 10 * 1000 )
+    {
+    std::cerr << "Duplicate UIDs in batch" << std::endl;
+    return 1;
+    }
+  char buffer[3][65];
+  if( !uid.Generate( buffer, 3 ) ) return 1;
+  if( strcmp( buffer[0], buffer[1] ) == 0 || strcmp( buffer[1], buffer[2] ) == 0 ) return 1;
+  if( !uid.Generate( buffer, 0 ) ) return 1;
+  return 0;
+}
+
 int TestUIDGenerator(int , char *[])
 {
   gdcm::UIDGenerator uid;
@@ -175,6 +211,9 @@ int TestUIDGenerator(int , char *[])
     }
   int ret = 0;
   ret += TestUIDGeneratorValid();
+  ret += TestUIDGeneratorBatch( gdcm::UIDGenerator::GetGDCMUID() );
+  // no room left for a full 128bits number, the high bits are truncated:
+  ret += TestUIDGeneratorBatch( "1.2.3.4.5.6.7.8.9.10.11.12.13.14.15.16" );
 
   return ret;
 }
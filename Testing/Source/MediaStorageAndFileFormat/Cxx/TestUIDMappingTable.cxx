@@ -0,0 +1,123 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "gdcmUIDMappingTable.h"
+#include "gdcmUIDGenerator.h"
+#include "gdcmTesting.h"
+#include "gdcmSystem.h"
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <set>
+
+static const unsigned int nuids = 200;
+
+static std::string GetOldUID(unsigned int i)
+{
+  std::ostringstream os;
+  os << "1.2.3.4." << i;
+  return os.str();
+}
+
+static void func(gdcm::UIDMappingTable *table, std::vector<std::string> *result)
+{
+  result->resize( nuids );
+  for(unsigned int i = 0; i < nuids; i++)
+    {
+    (*result)[i] = table->GetOrCreate( GetOldUID(i).c_str() );
+    }
+}
+
+int TestUIDMappingTable(int , char *[])
+{
+  gdcm::UIDMappingTable table;
+
+  // All threads ask for the same set of UIDs, they must all agree:
+  const unsigned int nthreads = 8;
+  std::vector<std::string> results[nthreads];
+  std::vector<std::thread> threads;
+  for(unsigned int t = 0; t < nthreads; t++)
+    {
+    threads.push_back( std::thread( func, &table, results + t ) );
+    }
+  for(unsigned int t = 0; t < nthreads; t++)
+    {
+    threads[t].join();
+    }
+  for(unsigned int t = 1; t < nthreads; t++)
+    {
+    if( results[t] != results[0] )
+      {
+      std::cerr << "Inconsistent mapping in thread " << t << std::endl;
+      return 1;
+      }
+    }
+  std::set<std::string> unique( results[0].begin(), results[0].end() );
+  if( unique.size() != nuids || table.GetNumberOfEntries() != nuids )
+    {
+    std::cerr << "Wrong number of entries: " << table.GetNumberOfEntries() << std::endl;
+    return 1;
+    }
+  for(unsigned int i = 0; i < nuids; i++)
+    {
+    if( !gdcm::UIDGenerator::IsValid( results[0][i].c_str() ) )
+      {
+      std::cerr << "Invalid UID: " << results[0][i] << std::endl;
+      return 1;
+      }
+    }
+
+  // Conflicting insertion is refused:
+  if( table.Insert( GetOldUID(0).c_str(), "1.2.3" ) )
+    {
+    return 1;
+    }
+
+  // Save / Load round trip:
+  const char subdir[] = "TestUIDMappingTable";
+  std::string tmpdir = gdcm::Testing::GetTempDirectory( subdir );
+  if( !gdcm::System::FileIsDirectory( tmpdir.c_str() ) )
+    {
+    gdcm::System::MakeDirectory( tmpdir.c_str() );
+    }
+  std::string filename = gdcm::Testing::GetTempFilename( "uidmap.txt", subdir );
+  if( !table.Save( filename.c_str() ) )
+    {
+    std::cerr << "Could not save: " << filename << std::endl;
+    return 1;
+    }
+
+  gdcm::UIDMappingTable table2;
+  if( !table2.Load( filename.c_str() ) )
+    {
+    std::cerr << "Could not load: " << filename << std::endl;
+    return 1;
+    }
+  for(unsigned int i = 0; i < nuids; i++)
+    {
+    std::string newuid;
+    if( !table2.Find( GetOldUID(i).c_str(), newuid ) || newuid != results[0][i] )
+      {
+      std::cerr << "Mapping lost for: " << GetOldUID(i) << std::endl;
+      return 1;
+      }
+    }
+
+  table2.Clear();
+  if( table2.GetNumberOfEntries() != 0 ) return 1;
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+############################################################################
+#
+#  Program: GDCM (Grassroots DICOM). A DICOM library
+#
+#  Copyright (c) 2006-2011 Mathieu Malaterre
+#  All rights reserved.
+#  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+#
+#     This software is distributed WITHOUT ANY WARRANTY; without even
+#     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+#     PURPOSE.  See the above copyright notice for more information.
+#
+############################################################################
+import gdcm
+import os,sys
+
+def TestMemoryView(filename, verbose = False):
+  r = gdcm.ImageReader()
+  r.SetFileName( filename )
+  if not r.Read():
+    return 0 # not an image
+  image = r.GetImage()
+  try:
+    mv = image.GetMemoryView()
+  except ValueError:
+    return 0 # e.g. SINGLEBIT, packed
+  if verbose: print(mv.format, mv.shape)
+  if mv.tobytes() != image.GetBuffer():
+    print("MemoryView differs from GetBuffer for: %s" % filename)
+    return 1
+  ds = r.GetFile().GetDataSet()
+  pixeldata = gdcm.Tag(0x7fe0,0x0010)
+  if ds.FindDataElement( pixeldata ):
+    de = ds.GetDataElement( pixeldata )
+    if de.GetByteValue():
+      raw = de.GetMemoryView()
+      if not raw.readonly or raw.nbytes != int(str(de.GetVL())):
+        print("Invalid raw MemoryView for: %s" % filename)
+        return 1
+  return 0
+
+if __name__ == "__main__":
+  success = 0
+  try:
+    filename = os.sys.argv[1]
+    success += TestMemoryView( filename, True )
+  except IndexError:
+    # loop over all files:
+    gdcm.Trace.DebugOff()
+    gdcm.Trace.WarningOff()
+    t = gdcm.Testing()
+    nfiles = t.GetNumberOfFileNames()
+    for i in range(0,nfiles):
+      filename = t.GetFileName(i)
+      success += TestMemoryView( filename )
+
+  # Test succeed ?
+  sys.exit(success)
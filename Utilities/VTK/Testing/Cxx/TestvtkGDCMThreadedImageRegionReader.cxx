@@ -0,0 +1,113 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkGDCMThreadedImageRegionReader.h"
+
+#include "vtkImageData.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkInformation.h"
+#include "vtkVersion.h"
+
+#include "gdcmTesting.h"
+#include "gdcmTrace.h"
+
+#include <string.h>
+
+// Read the whole image, then a sub extent (twice, to go through the header
+// cache) and check it matches the corresponding part of the whole image.
+static int TestvtkGDCMThreadedImageRegionRead(const char *filename, bool verbose)
+{
+  if( verbose )
+    std::cerr << "Reading : " << filename << std::endl;
+
+  vtkGDCMThreadedImageRegionReader *reader = vtkGDCMThreadedImageRegionReader::New();
+  reader->SetFileName( filename );
+  reader->SetNumberOfThreads( 4 );
+  reader->UpdateInformation();
+  int wext[6] = { 0, -1, 0, -1, 0, -1 };
+  reader->GetOutputInformation(0)->Get(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), wext);
+  if( wext[1] < wext[0] )
+    {
+    // not an image we can handle
+    reader->Delete();
+    return 0;
+    }
+  reader->Update();
+  vtkImageData *full = vtkImageData::New();
+  full->DeepCopy( reader->GetOutput() );
+
+  int subext[6];
+  memcpy(subext, wext, sizeof(subext));
+  subext[0] = (wext[0] + wext[1]) / 3;
+  subext[1] = (wext[0] + wext[1]) / 2;
+  subext[2] = (wext[2] + wext[3]) / 4;
+  subext[3] = wext[3];
+  subext[4] = (wext[4] + wext[5]) / 2;
+
+  int ret = 0;
+  for( int pass = 0; pass < 2 && !ret; ++pass )
+    {
+#if VTK_MAJOR_VERSION > 7 || (VTK_MAJOR_VERSION == 7 && VTK_MINOR_VERSION >= 1)
+    reader->UpdateExtent( subext );
+#else
+    vtkStreamingDemandDrivenPipeline::SetUpdateExtent( reader->GetOutputInformation(0), subext );
+    reader->Update();
+#endif
+    vtkImageData *sub = reader->GetOutput();
+    const size_t rowlen = (subext[1] - subext[0] + 1)
+      * sub->GetScalarSize() * sub->GetNumberOfScalarComponents();
+    for( int z = subext[4]; z <= subext[5]; ++z )
+      {
+      for( int y = subext[2]; y <= subext[3]; ++y )
+        {
+        const void *p1 = full->GetScalarPointer( subext[0], y, z );
+        const void *p2 = sub->GetScalarPointer( subext[0], y, z );
+        if( !p2 || memcmp( p1, p2, rowlen ) != 0 )
+          {
+          std::cerr << "Sub extent differs for: " << filename << " at y=" << y << " z=" << z << std::endl;
+          ret = 1;
+          break;
+          }
+        }
+      if( ret ) break;
+      }
+    }
+
+  full->Delete();
+  reader->Delete();
+  return ret;
+}
+
+int TestvtkGDCMThreadedImageRegionReader(int argc, char *argv[])
+{
+  if( argc == 2 )
+    {
+    const char *filename = argv[1];
+    return TestvtkGDCMThreadedImageRegionRead(filename, true);
+    }
+
+  // else
+  gdcm::Trace::DebugOff();
+  gdcm::Trace::WarningOff();
+  gdcm::Trace::ErrorOff();
+  int r = 0, i = 0;
+  const char *filename;
+  const char * const *filenames = gdcm::Testing::GetFileNames();
+  while( (filename = filenames[i]) )
+    {
+    r += TestvtkGDCMThreadedImageRegionRead( filename, false );
+    ++i;
+    }
+
+  return r;
+}
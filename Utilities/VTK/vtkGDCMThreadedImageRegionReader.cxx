@@ -0,0 +1,514 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+#include "vtkGDCMThreadedImageRegionReader.h"
+
+#include "vtkObjectFactory.h"
+#include "vtkImageData.h"
+#include "vtkPointData.h"
+#include "vtkDataArray.h"
+#include "vtkStringArray.h"
+#include "vtkInformationVector.h"
+#include "vtkInformation.h"
+#include "vtkStreamingDemandDrivenPipeline.h"
+#include "vtkVersion.h"
+
+#include "gdcmImageRegionReader.h"
+#include "gdcmBoxRegion.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <string.h>
+
+vtkStandardNewMacro(vtkGDCMThreadedImageRegionReader)
+
+namespace
+{
+// Process wide pool of worker threads, shared by all reader instances, so
+// that several readers updating at once do not oversubscribe the machine.
+class RegionReaderThreadPool
+{
+public:
+  static RegionReaderThreadPool &GetInstance()
+    {
+    static RegionReaderThreadPool pool;
+    return pool;
+    }
+
+  unsigned int GetNumberOfThreads() const
+    {
+    return (unsigned int)Workers.size() + 1; // + calling thread
+    }
+
+  // Call body(i, mainthread) for i in [0,n), using at most nthreads threads
+  // (calling thread included). Iterations are handed out one by one from an
+  // atomic counter, idle threads simply grab the next one.
+  void ParallelFor(size_t n, unsigned int nthreads,
+    const std::function<void(size_t, bool)> &body)
+    {
+    std::shared_ptr<Job> job = std::make_shared<Job>( n, body );
+    nthreads = std::min<unsigned int>( nthreads, GetNumberOfThreads() );
+    if( nthreads > n ) nthreads = (unsigned int)n;
+    if( nthreads > 1 )
+      {
+      std::lock_guard<std::mutex> lock( QueueLock );
+      for( unsigned int t = 1; t < nthreads; ++t )
+        Queue.push_back( job );
+      }
+    QueueCondition.notify_all();
+    job->Run( true );
+    // helpers that have not started yet will not touch the job anymore,
+    // wait for the one that are still working:
+    std::unique_lock<std::mutex> lock( job->Lock );
+    job->Closed = true;
+    job->Done.wait( lock, [&job]{ return job->Running == 0; } );
+    }
+
+private:
+  struct Job
+  {
+    Job(size_t n, const std::function<void(size_t, bool)> &body):
+      Size(n), Body(body), Next(0), Running(0), Closed(false) {}
+    void Run(bool mainthread)
+      {
+      size_t i;
+      while( (i = Next++) < Size )
+        Body( i, mainthread );
+      }
+    const size_t Size;
+    const std::function<void(size_t, bool)> &Body;
+    std::atomic<size_t> Next;
+    std::mutex Lock;
+    std::condition_variable Done;
+    unsigned int Running;
+    bool Closed;
+  };
+
+  RegionReaderThreadPool():Stop(false)
+    {
+    const unsigned int hw = std::thread::hardware_concurrency();
+    for( unsigned int t = 1; t < hw; ++t )
+      Workers.push_back( std::thread( &RegionReaderThreadPool::WorkerLoop, this ) );
+    }
+  ~RegionReaderThreadPool()
+    {
+      {
+      std::lock_guard<std::mutex> lock( QueueLock );
+      Stop = true;
+      }
+    QueueCondition.notify_all();
+    for( size_t t = 0; t < Workers.size(); ++t )
+      Workers[t].join();
+    }
+
+  void WorkerLoop()
+    {
+    for( ;; )
+      {
+      std::shared_ptr<Job> job;
+        {
+        std::unique_lock<std::mutex> lock( QueueLock );
+        QueueCondition.wait( lock, [this]{ return Stop || !Queue.empty(); } );
+        if( Stop ) return;
+        job = Queue.front();
+        Queue.pop_front();
+        }
+        {
+        std::lock_guard<std::mutex> lock( job->Lock );
+        if( job->Closed ) continue; // too late, calling thread did it all
+        ++job->Running;
+        }
+      job->Run( false );
+        {
+        std::lock_guard<std::mutex> lock( job->Lock );
+        --job->Running;
+        }
+      job->Done.notify_all();
+      }
+    }
+
+  std::vector<std::thread> Workers;
+  std::deque< std::shared_ptr<Job> > Queue;
+  std::mutex QueueLock;
+  std::condition_variable QueueCondition;
+  bool Stop;
+};
+}
+
+// Keep parsed headers (ImageRegionReader after ReadInformation) around so
+// that subsequent updates only seek and decode. A reader can only serve one
+// region at a time, so a file may have several idle readers in the cache.
+class vtkGDCMThreadedImageRegionReaderInternals
+{
+public:
+  struct CachedReader
+  {
+    vtkIdType FileIndex;
+    gdcm::ImageRegionReader *Reader;
+  };
+
+  ~vtkGDCMThreadedImageRegionReaderInternals()
+    {
+    Clear();
+    }
+
+  // Return a reader on which ReadInformation was successful or NULL
+  gdcm::ImageRegionReader *Acquire(vtkIdType fileindex, const char *filename)
+    {
+      {
+      std::lock_guard<std::mutex> lock( Lock );
+      std::list<CachedReader>::iterator it = Idle.begin();
+      for( ; it != Idle.end(); ++it )
+        {
+        if( it->FileIndex == fileindex )
+          {
+          gdcm::ImageRegionReader *reader = it->Reader;
+          Idle.erase( it );
+          return reader;
+          }
+        }
+      }
+    gdcm::ImageRegionReader *reader = new gdcm::ImageRegionReader;
+    reader->SetFileName( filename );
+    if( !reader->ReadInformation() )
+      {
+      delete reader;
+      return NULL;
+      }
+    return reader;
+    }
+
+  // Most recently used readers are kept, oldest are closed first
+  void Release(vtkIdType fileindex, gdcm::ImageRegionReader *reader, size_t maxsize)
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    CachedReader cr = { fileindex, reader };
+    Idle.push_front( cr );
+    while( Idle.size() > maxsize )
+      {
+      delete Idle.back().Reader;
+      Idle.pop_back();
+      }
+    }
+
+  void Clear()
+    {
+    std::lock_guard<std::mutex> lock( Lock );
+    std::list<CachedReader>::iterator it = Idle.begin();
+    for( ; it != Idle.end(); ++it )
+      {
+      delete it->Reader;
+      }
+    Idle.clear();
+    }
+
+private:
+  std::mutex Lock;
+  std::list<CachedReader> Idle;
+};
+
+//----------------------------------------------------------------------------
+vtkGDCMThreadedImageRegionReader::vtkGDCMThreadedImageRegionReader()
+{
+  this->SetNumberOfInputPorts(0);
+  this->FileName = NULL;
+  this->FileNames = NULL;
+  this->FileLowerLeft = 0;
+  this->NumberOfThreads = 0;
+  this->MaximumNumberOfCachedReaders = 256;
+  this->Shift = 0.;
+  this->Scale = 1.;
+  memset(this->DataExtent,0,6*sizeof(*DataExtent));
+  this->DataScalarType = VTK_VOID;
+  this->NumberOfScalarComponents = 1;
+  this->Internals = new vtkGDCMThreadedImageRegionReaderInternals;
+}
+
+//----------------------------------------------------------------------------
+vtkGDCMThreadedImageRegionReader::~vtkGDCMThreadedImageRegionReader()
+{
+  delete this->Internals;
+  if( this->FileNames )
+    {
+    this->FileNames->UnRegister(this);
+    }
+  delete[] this->FileName;
+}
+
+//----------------------------------------------------------------------------
+void vtkGDCMThreadedImageRegionReader::SetFileName(const char *filename)
+{
+  if( this->FileName && filename && strcmp(this->FileName, filename) == 0 )
+    {
+    return;
+    }
+  delete[] this->FileName;
+  this->FileName = NULL;
+  if( filename )
+    {
+    this->FileName = new char[strlen(filename) + 1];
+    strcpy(this->FileName, filename);
+    }
+  this->ClearCache();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkGDCMThreadedImageRegionReader::SetFileNames(vtkStringArray *filenames)
+{
+  if( filenames == this->FileNames )
+    {
+    return;
+    }
+  if( this->FileNames )
+    {
+    this->FileNames->UnRegister(this);
+    }
+  this->FileNames = filenames;
+  if( this->FileNames )
+    {
+    this->FileNames->Register(this);
+    }
+  this->ClearCache();
+  this->Modified();
+}
+
+//----------------------------------------------------------------------------
+void vtkGDCMThreadedImageRegionReader::ClearCache()
+{
+  this->Internals->Clear();
+}
+
+//----------------------------------------------------------------------------
+static int PixelFormatToScalarType(const gdcm::PixelFormat &pf)
+{
+  switch( pf.GetScalarType() )
+    {
+  case gdcm::PixelFormat::INT8:
+    return VTK_SIGNED_CHAR;
+  case gdcm::PixelFormat::UINT8:
+    return VTK_UNSIGNED_CHAR;
+  case gdcm::PixelFormat::INT12:
+  case gdcm::PixelFormat::INT16:
+    return VTK_SHORT;
+  case gdcm::PixelFormat::UINT12:
+  case gdcm::PixelFormat::UINT16:
+    return VTK_UNSIGNED_SHORT;
+  case gdcm::PixelFormat::INT32:
+    return VTK_INT;
+  case gdcm::PixelFormat::UINT32:
+    return VTK_UNSIGNED_INT;
+  case gdcm::PixelFormat::FLOAT32:
+    return VTK_FLOAT;
+  case gdcm::PixelFormat::FLOAT64:
+    return VTK_DOUBLE;
+  default:
+    ;
+    }
+  return VTK_VOID;
+}
+
+//----------------------------------------------------------------------------
+int vtkGDCMThreadedImageRegionReader::RequestInformation (
+  vtkInformation * vtkNotUsed( request ),
+  vtkInformationVector** vtkNotUsed( inputVector ),
+  vtkInformationVector *outputVector)
+{
+  const bool isseries = this->FileNames && this->FileNames->GetNumberOfValues() > 0;
+  if( !isseries && !this->FileName )
+    {
+    vtkErrorMacro( "A FileName or FileNames must be specified." );
+    return 0;
+    }
+  const char *filename = isseries ? this->FileNames->GetValue( 0 ).c_str() : this->FileName;
+
+  gdcm::ImageRegionReader *reader = this->Internals->Acquire( 0, filename );
+  if( !reader )
+    {
+    vtkErrorMacro( "ImageRegionReader failed: " << filename );
+    return 0;
+    }
+  const gdcm::Image &image = reader->GetImage();
+  const unsigned int *dims = image.GetDimensions();
+  const gdcm::PixelFormat &pf = image.GetPixelFormat();
+  const int datascalartype = PixelFormatToScalarType( pf );
+  const unsigned int planarconf = image.GetPlanarConfiguration();
+  double spacing[3];
+  double origin[3];
+  for( int i = 0; i < 3; ++i )
+    {
+    spacing[i] = image.GetSpacing(i);
+    origin[i] = image.GetOrigin(i);
+    }
+  this->Shift = image.GetIntercept();
+  this->Scale = image.GetSlope();
+  this->DataExtent[0] = 0;
+  this->DataExtent[1] = dims[0] - 1;
+  this->DataExtent[2] = 0;
+  this->DataExtent[3] = dims[1] - 1;
+  this->DataExtent[4] = 0;
+  this->DataExtent[5] = isseries ? (int)this->FileNames->GetNumberOfValues() - 1
+    : (image.GetNumberOfDimensions() == 3 ? (int)dims[2] - 1 : 0);
+  this->Internals->Release( 0, reader, this->MaximumNumberOfCachedReaders );
+
+  if( datascalartype == VTK_VOID )
+    {
+    vtkErrorMacro( "Unhandled Pixel Format: " << pf );
+    return 0;
+    }
+  if( planarconf )
+    {
+    vtkErrorMacro( "Planar Configuration is not handled: " << filename );
+    return 0;
+    }
+  this->DataScalarType = datascalartype;
+  this->NumberOfScalarComponents = pf.GetSamplesPerPixel();
+
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  outInfo->Set(vtkStreamingDemandDrivenPipeline::WHOLE_EXTENT(), this->DataExtent, 6);
+  outInfo->Set(vtkDataObject::SPACING(), spacing, 3);
+  outInfo->Set(vtkDataObject::ORIGIN(), origin, 3);
+  vtkDataObject::SetPointDataActiveScalarInfo(outInfo, this->DataScalarType, this->NumberOfScalarComponents);
+#if VTK_MAJOR_VERSION >= 7
+  // Any sub-extent can be decoded, no need to read the whole extent
+  outInfo->Set(vtkAlgorithm::CAN_PRODUCE_SUB_EXTENT(), 1);
+#endif
+
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+int vtkGDCMThreadedImageRegionReader::RequestData(
+  vtkInformation * vtkNotUsed( request ),
+  vtkInformationVector** vtkNotUsed( inputVector ),
+  vtkInformationVector *outputVector)
+{
+  vtkInformation *outInfo = outputVector->GetInformationObject(0);
+  vtkImageData *output = vtkImageData::SafeDownCast(outInfo->Get(vtkDataObject::DATA_OBJECT()));
+  int outExt[6];
+  outInfo->Get(vtkStreamingDemandDrivenPipeline::UPDATE_EXTENT(), outExt);
+  this->AllocateOutputData(output, outInfo, outExt);
+  output->GetPointData()->GetScalars()->SetName("GDCMImage");
+  if( outExt[0] > outExt[1] || outExt[2] > outExt[3] || outExt[4] > outExt[5] )
+    {
+    return 1; // empty extent
+    }
+
+  const bool isseries = this->FileNames && this->FileNames->GetNumberOfValues() > 0;
+  const int ncols = outExt[1] - outExt[0] + 1;
+  const int nrows = outExt[3] - outExt[2] + 1;
+  const size_t rowlen = (size_t)ncols * output->GetScalarSize() * this->NumberOfScalarComponents;
+  const size_t slicelen = rowlen * nrows;
+  // DICOM rows are stored top to bottom:
+  int ymin = outExt[2];
+  int ymax = outExt[3];
+  if( !this->FileLowerLeft )
+    {
+    ymin = this->DataExtent[3] - outExt[3];
+    ymax = this->DataExtent[3] - outExt[2];
+    }
+
+  std::vector<std::string> filenames;
+  if( isseries )
+    {
+    for( int z = outExt[4]; z <= outExt[5]; ++z )
+      {
+      filenames.push_back( this->FileNames->GetValue( z ) );
+      }
+    }
+  const size_t nslices = outExt[5] - outExt[4] + 1;
+  const size_t maxcached = this->MaximumNumberOfCachedReaders;
+  vtkGDCMThreadedImageRegionReaderInternals *internals = this->Internals;
+  const int flip = !this->FileLowerLeft;
+  std::atomic<size_t> ndone( 0 );
+  std::atomic<size_t> nfailed( 0 );
+
+  // output is contiguous over outExt, slice i starts at base + i * slicelen
+  char *base = static_cast<char*>(output->GetScalarPointerForExtent(outExt));
+
+  const std::function<void(size_t, bool)> body =
+    [&](size_t i, bool mainthread)
+    {
+    const int z = outExt[4] + (int)i;
+    char *pointer = base + i * slicelen;
+    const vtkIdType fileindex = isseries ? z : 0;
+    const char *filename = isseries ? filenames[i].c_str() : this->FileName;
+    gdcm::BoxRegion box;
+    if( isseries )
+      box.SetDomain(outExt[0], outExt[1], ymin, ymax, 0, 0);
+    else
+      box.SetDomain(outExt[0], outExt[1], ymin, ymax, z, z);
+    bool success = false;
+    gdcm::ImageRegionReader *reader = internals->Acquire( fileindex, filename );
+    if( reader )
+      {
+      reader->SetRegion( box );
+      success = reader->ComputeBufferLength() == slicelen
+        && reader->ReadIntoBuffer( pointer, slicelen );
+      internals->Release( fileindex, reader, maxcached );
+      }
+    if( !success )
+      {
+      // fill the slice with 0, hopefully this is the right thing to do
+      memset( pointer, 0, slicelen );
+      ++nfailed;
+      }
+    else if( flip )
+      {
+      std::vector<char> line( rowlen );
+      for( int y = 0; y < nrows / 2; ++y )
+        {
+        char *top = pointer + y * rowlen;
+        char *bottom = pointer + (nrows - 1 - y) * rowlen;
+        memcpy( &line[0], top, rowlen );
+        memcpy( top, bottom, rowlen );
+        memcpy( bottom, &line[0], rowlen );
+        }
+      }
+    const size_t done = ++ndone;
+    if( mainthread )
+      {
+      this->UpdateProgress( (double)done / (double)nslices );
+      }
+    };
+
+  unsigned int nthreads = this->NumberOfThreads > 0 ?
+    (unsigned int)this->NumberOfThreads : std::thread::hardware_concurrency();
+  if( !nthreads ) nthreads = 1;
+  RegionReaderThreadPool::GetInstance().ParallelFor( nslices, nthreads, body );
+
+  if( nfailed )
+    {
+    vtkWarningMacro( "Could not read " << nfailed.load() << " slice(s) out of " << nslices );
+    }
+  return 1;
+}
+
+//----------------------------------------------------------------------------
+void vtkGDCMThreadedImageRegionReader::PrintSelf(ostream& os, vtkIndent indent)
+{
+  this->Superclass::PrintSelf(os,indent);
+  os << indent << "FileName: " << (this->FileName ? this->FileName : "(none)") << "\n";
+  os << indent << "FileLowerLeft: " << this->FileLowerLeft << "\n";
+  os << indent << "NumberOfThreads: " << this->NumberOfThreads << "\n";
+  os << indent << "MaximumNumberOfCachedReaders: " << this->MaximumNumberOfCachedReaders << "\n";
+}
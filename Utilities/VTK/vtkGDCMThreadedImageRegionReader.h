@@ -0,0 +1,129 @@
+/*=========================================================================
+
+  Program: GDCM (Grassroots DICOM). A DICOM library
+
+  Copyright (c) 2006-2011 Mathieu Malaterre
+  All rights reserved.
+  See Copyright.txt or http://gdcm.sourceforge.net/Copyright.html for details.
+
+     This software is distributed WITHOUT ANY WARRANTY; without even
+     the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+     PURPOSE.  See the above copyright notice for more information.
+
+=========================================================================*/
+// .NAME vtkGDCMThreadedImageRegionReader - read the update extent of DICOM files with multiple threads
+// .SECTION Description
+// vtkGDCMThreadedImageRegionReader is a source object that reads either a
+// single (multi-frame) DICOM file or an ordered list of 2D DICOM files.
+// Only the requested update extent is decoded (see gdcm::ImageRegionReader),
+// so that a viewer slicing through a large dataset only pays for what is
+// visible.
+//
+// Slices are decoded in parallel on a thread pool shared by all instances of
+// this class. Slices are handed out one at a time, so that threads that are
+// done early pick up the remaining work. The calling thread takes part in the
+// work and is the only one to emit ProgressEvent.
+//
+// Parsed headers (and their open file handles) are kept in a cache and reused
+// across pipeline updates, up to MaximumNumberOfCachedReaders. The cache is
+// flushed whenever the file names are changed.
+//
+// .SECTION Implementation note: when FileLowerLeft is set to on the image is not flipped
+// upside down as VTK would expect, use this option only if you know what you are doing.
+//
+// .SECTION Implementation note: Stored values are returned, the Rescale
+// Slope/Intercept found in the first file are only reported (see GetShift and GetScale).
+//
+// .SECTION Implementation note: information (extent, scalar type, spacing, origin) is
+// taken from the first file. All other files in the list are expected to share it.
+//
+// .SECTION TODO
+// No support for overlays, icon image, lookup table or Planar Configuration = 1.
+
+// .SECTION See Also
+// vtkGDCMImageReader2 vtkGDCMThreadedImageReader2
+
+#ifndef VTKGDCMTHREADEDIMAGEREGIONREADER_H
+#define VTKGDCMTHREADEDIMAGEREGIONREADER_H
+
+#include "vtkgdcmModule.h"
+#include "vtkImageAlgorithm.h"
+
+class vtkStringArray;
+//BTX
+class vtkGDCMThreadedImageRegionReaderInternals;
+//ETX
+class VTKGDCM_EXPORT vtkGDCMThreadedImageRegionReader : public vtkImageAlgorithm
+{
+public:
+  static vtkGDCMThreadedImageRegionReader *New();
+  vtkTypeMacro(vtkGDCMThreadedImageRegionReader,vtkImageAlgorithm);
+  virtual void PrintSelf(ostream& os, vtkIndent indent);
+
+  // Description:
+  // Specify a single (possibly multi-frame) file to read.
+  virtual void SetFileName(const char *filename);
+  vtkGetStringMacro(FileName);
+
+  // Description:
+  // Specify an ordered list of 2D files, one per slice.
+  virtual void SetFileNames(vtkStringArray*);
+  vtkGetObjectMacro(FileNames, vtkStringArray);
+
+  vtkGetMacro(FileLowerLeft,int);
+  vtkSetMacro(FileLowerLeft,int);
+  vtkBooleanMacro(FileLowerLeft,int);
+
+  // Description:
+  // Set/Get the number of threads used to decode slices. 0 (default) means
+  // use the number of hardware threads.
+  vtkSetMacro(NumberOfThreads,int);
+  vtkGetMacro(NumberOfThreads,int);
+
+  // Description:
+  // Set/Get the maximum number of parsed headers kept open between updates.
+  // Default is 256.
+  vtkSetMacro(MaximumNumberOfCachedReaders,int);
+  vtkGetMacro(MaximumNumberOfCachedReaders,int);
+
+  // Description:
+  // Read only: Rescale Intercept (0028,1052) and Rescale Slope (0028,1053)
+  // found in the first file. They are not applied.
+  vtkGetMacro(Shift,double);
+  vtkGetMacro(Scale,double);
+
+  // Description:
+  // Drop all cached headers (and close the associated files).
+  void ClearCache();
+
+protected:
+  vtkGDCMThreadedImageRegionReader();
+  ~vtkGDCMThreadedImageRegionReader();
+
+  int RequestInformation(vtkInformation *request,
+                         vtkInformationVector **inputVector,
+                         vtkInformationVector *outputVector);
+  int RequestData(vtkInformation *request,
+                  vtkInformationVector **inputVector,
+                  vtkInformationVector *outputVector);
+
+private:
+  char *FileName;
+  vtkStringArray *FileNames;
+  int FileLowerLeft;
+  int NumberOfThreads;
+  int MaximumNumberOfCachedReaders;
+  double Shift;
+  double Scale;
+  int DataExtent[6];
+  int DataScalarType;
+  int NumberOfScalarComponents;
+
+  vtkGDCMThreadedImageRegionReaderInternals *Internals;
+
+private:
+  vtkGDCMThreadedImageRegionReader(const vtkGDCMThreadedImageRegionReader&);  // Not implemented.
+  void operator=(const vtkGDCMThreadedImageRegionReader&);  // Not implemented.
+};
+
+#endif
@@ -701,8 +701,16 @@ void uuid_generate_random(uuid_t out)
  */
 void uuid_generate(uuid_t out)
 {
+#if defined(HAVE_GETRANDOM) || defined(HAVE_GETENTROPY)
+	/*
+	 * The kernel random source is always available, does not need any
+	 * (shared, lazily initialized) file descriptor and is thread safe.
+	 */
+	uuid_generate_random(out);
+#else
 	if (get_random_fd() >= 0)
 		uuid_generate_random(out);
 	else
 		uuid_generate_time(out);
+#endif
 }
@@ -333,6 +333,125 @@ EXTEND_CLASS_PRINT(gdcm::ByteValue)
     return copy;
   }
 };
+%{
+// Expose memory owned by GDCM to Python through the buffer protocol, so that
+// memoryview / numpy.asarray can access it without a copy.
+struct gdcmBufferViewObject
+{
+  PyObject_HEAD
+  gdcm::SmartPointer<gdcm::Value> *KeepAlive; // value referenced by the view
+  char *Data;
+  bool OwnData; // Data was malloc'ed by the view (writable)
+  Py_ssize_t Length;
+  Py_ssize_t ItemSize;
+  int NDim;
+  Py_ssize_t Shape[4];
+  Py_ssize_t Strides[4];
+  char Format[2];
+};
+
+static void gdcmBufferView_dealloc(PyObject *obj)
+{
+  gdcmBufferViewObject *self = (gdcmBufferViewObject*)obj;
+  delete self->KeepAlive;
+  if( self->OwnData ) free( self->Data );
+  PyObject_Del( obj );
+}
+
+static int gdcmBufferView_getbuffer(PyObject *obj, Py_buffer *view, int flags)
+{
+  gdcmBufferViewObject *self = (gdcmBufferViewObject*)obj;
+  if( (flags & PyBUF_WRITABLE) == PyBUF_WRITABLE && !self->OwnData )
+    {
+    PyErr_SetString(PyExc_BufferError, "buffer is read-only");
+    view->obj = NULL;
+    return -1;
+    }
+  view->obj = obj;
+  Py_INCREF( obj );
+  view->buf = self->Data;
+  view->len = self->Length;
+  view->readonly = self->OwnData ? 0 : 1;
+  view->itemsize = self->ItemSize;
+  view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? self->Format : NULL;
+  if( (flags & PyBUF_ND) == PyBUF_ND )
+    {
+    view->ndim = self->NDim;
+    view->shape = self->Shape;
+    }
+  else
+    {
+    view->ndim = 1;
+    view->shape = NULL;
+    }
+  // always C-contiguous:
+  view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? self->Strides : NULL;
+  view->suboffsets = NULL;
+  view->internal = NULL;
+  return 0;
+}
+
+static PyBufferProcs gdcmBufferView_as_buffer;
+static PyTypeObject gdcmBufferViewType = { PyVarObject_HEAD_INIT(NULL, 0) };
+
+static int gdcmBufferViewTypeInit()
+{
+  gdcmBufferView_as_buffer.bf_getbuffer = gdcmBufferView_getbuffer;
+  gdcmBufferViewType.tp_name = "gdcmswig.BufferView";
+  gdcmBufferViewType.tp_basicsize = sizeof(gdcmBufferViewObject);
+  gdcmBufferViewType.tp_dealloc = gdcmBufferView_dealloc;
+  gdcmBufferViewType.tp_as_buffer = &gdcmBufferView_as_buffer;
+#if PY_MAJOR_VERSION < 3
+  gdcmBufferViewType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+#else
+  gdcmBufferViewType.tp_flags = Py_TPFLAGS_DEFAULT;
+#endif
+  gdcmBufferViewType.tp_doc = "GDCM memory exported through the buffer protocol";
+  return PyType_Ready( &gdcmBufferViewType );
+}
+
+// Wrap the exporter into a memoryview. shape is in C order (slowest first).
+static PyObject *gdcmNewMemoryView(char *data, bool owndata,
+  gdcm::SmartPointer<gdcm::Value> *keepalive,
+  char format, Py_ssize_t itemsize, int ndim, const Py_ssize_t *shape)
+{
+  gdcmBufferViewObject *self = PyObject_New(gdcmBufferViewObject, &gdcmBufferViewType);
+  if( !self )
+    {
+    if( owndata ) free( data );
+    delete keepalive;
+    return NULL;
+    }
+  self->KeepAlive = keepalive;
+  self->Data = data;
+  self->OwnData = owndata;
+  self->ItemSize = itemsize;
+  self->NDim = ndim;
+  self->Format[0] = format;
+  self->Format[1] = 0;
+  Py_ssize_t stride = itemsize;
+  for( int i = ndim - 1; i >= 0; --i )
+    {
+    self->Shape[i] = shape[i];
+    self->Strides[i] = stride;
+    stride *= shape[i];
+    }
+  self->Length = stride;
+  PyObject *mv = PyMemoryView_FromObject( (PyObject*)self );
+  Py_DECREF( self ); // the memoryview now holds the only reference
+  return mv;
+}
+%}
+%init %{
+  if( gdcmBufferViewTypeInit() < 0 )
+    {
+#if PY_MAJOR_VERSION >= 3
+    return NULL;
+#else
+    return;
+#endif
+    }
+%}
 %include "gdcmASN1.h"
 %include "gdcmSmartPointer.h"
 %template(SmartPtrSQ) gdcm::SmartPointer<gdcm::SequenceOfItems>;
@@ -354,6 +473,19 @@ EXTEND_CLASS_PRINT(gdcm::ByteValue)
     void SetByteStringValue(const char *array, uint32_t length) {
         self->SetByteValue(array, gdcm::VL(length));
     }
+    // Read-only memoryview on the ByteValue, no copy is done. The view keeps
+    // the value alive, even if the DataElement is modified or destroyed.
+    PyObject *GetMemoryView() const {
+        const gdcm::ByteValue *bv = self->GetByteValue();
+        if( !bv ) {
+            PyErr_SetString(PyExc_ValueError, "DataElement has no ByteValue");
+            return NULL;
+        }
+        const Py_ssize_t shape[1] = { (Py_ssize_t)bv->GetLength() };
+        return gdcmNewMemoryView( const_cast<char*>(bv->GetPointer()), false,
+          new gdcm::SmartPointer<gdcm::Value>( const_cast<gdcm::Value*>(&self->GetValue()) ),
+          'B', 1, 1, shape );
+    }
 }
 EXTEND_CLASS_PRINT(gdcm::DataElement)
 %include "gdcmItem.h"
@@ -444,6 +576,58 @@ EXTEND_CLASS_PRINT(gdcm::Bitmap)
       *size = 0;
     }
   }
+  // Decode the pixel data directly into a buffer exported as a writable
+  // memoryview (numpy.asarray() on it does not copy).
+  // Shape is (z,) y, x (, samples) or (z,) samples, y, x for planar data.
+  PyObject *GetMemoryView() {
+    const gdcm::PixelFormat &pf = self->GetPixelFormat();
+    char format;
+    switch( pf.GetScalarType() )
+      {
+    case gdcm::PixelFormat::UINT8:   format = 'B'; break;
+    case gdcm::PixelFormat::INT8:    format = 'b'; break;
+    case gdcm::PixelFormat::UINT12:  format = 'H'; break;
+    case gdcm::PixelFormat::INT12:   format = 'h'; break;
+    case gdcm::PixelFormat::UINT16:  format = 'H'; break;
+    case gdcm::PixelFormat::INT16:   format = 'h'; break;
+    case gdcm::PixelFormat::UINT32:  format = 'I'; break;
+    case gdcm::PixelFormat::INT32:   format = 'i'; break;
+    case gdcm::PixelFormat::FLOAT16: format = 'e'; break;
+    case gdcm::PixelFormat::FLOAT32: format = 'f'; break;
+    case gdcm::PixelFormat::FLOAT64: format = 'd'; break;
+    default:
+      PyErr_SetString(PyExc_ValueError, "unsupported pixel format, use GetBuffer()");
+      return NULL;
+      }
+    const unsigned int spp = pf.GetSamplesPerPixel();
+    const Py_ssize_t itemsize = pf.GetPixelSize() / spp;
+    Py_ssize_t shape[4];
+    int ndim = 0;
+    if( self->GetNumberOfDimensions() == 3 )
+      shape[ndim++] = self->GetDimension(2);
+    if( spp > 1 && self->GetPlanarConfiguration() )
+      shape[ndim++] = spp;
+    shape[ndim++] = self->GetDimension(1);
+    shape[ndim++] = self->GetDimension(0);
+    if( spp > 1 && !self->GetPlanarConfiguration() )
+      shape[ndim++] = spp;
+    size_t len = itemsize;
+    for( int i = 0; i < ndim; ++i ) len *= shape[i];
+    if( len != self->GetBufferLength() )
+      {
+      PyErr_SetString(PyExc_ValueError, "pixel data is not byte aligned, use GetBuffer()");
+      return NULL;
+      }
+    char *buffer = (char*)malloc(len);
+    if( !buffer ) return PyErr_NoMemory();
+    if( !self->GetBuffer(buffer) )
+      {
+      free(buffer);
+      PyErr_SetString(PyExc_RuntimeError, "could not decode pixel data");
+      return NULL;
+      }
+    return gdcmNewMemoryView( buffer, true, NULL, format, itemsize, ndim, shape );
+  }
 };
 %include "gdcmIconImage.h"
 EXTEND_CLASS_PRINT(gdcm::IconImage)